@@ -43,8 +43,8 @@
 #include <zone.h>
 #include <convert_basic_shapes_to_polygon.h>
 #include <trigo.h>
+#include <thread_pool.h>
 #include <vector>
-#include <thread>
 #include <algorithm>
 #include <atomic>
 
@@ -712,12 +712,11 @@ void BOARD_ADAPTER::createLayers( REPORTER* aStatusReporter )
         // Add zones objects
         // /////////////////////////////////////////////////////////////////////
         std::atomic<size_t> nextZone( 0 );
-        std::atomic<size_t> threadsFinished( 0 );
+        TASK_GROUP tasks;
 
-        size_t parallelThreadCount = std::max<size_t>( std::thread::hardware_concurrency(), 2 );
-        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+        for( size_t ii = 0; ii < tasks.GetPool().GetThreadCount(); ++ii )
         {
-            std::thread t = std::thread( [&]()
+            tasks.Run( [&]()
             {
                 for( size_t areaId = nextZone.fetch_add( 1 );
                             areaId < zones.size();
@@ -735,15 +734,10 @@ void BOARD_ADAPTER::createLayers( REPORTER* aStatusReporter )
                     if( layerContainer != m_layers_container2D.end() )
                         AddSolidAreasShapesToContainer( zone, layerContainer->second, layer );
                 }
-
-                threadsFinished++;
             } );
-
-            t.detach();
         }
 
-        while( threadsFinished < parallelThreadCount )
-            std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+        tasks.Wait();
 
     }
 
@@ -780,17 +774,17 @@ void BOARD_ADAPTER::createLayers( REPORTER* aStatusReporter )
             if( m_F_Cu_PlatedPads_poly && ( m_layers_poly.find( F_Cu ) != m_layers_poly.end() ) )
             {
                 SHAPE_POLY_SET *layerPoly_F_Cu = m_layers_poly[F_Cu];
-                layerPoly_F_Cu->BooleanSubtract( *m_F_Cu_PlatedPads_poly, SHAPE_POLY_SET::POLYGON_MODE::PM_FAST );
+                layerPoly_F_Cu->ParallelBooleanSubtract( *m_F_Cu_PlatedPads_poly, SHAPE_POLY_SET::POLYGON_MODE::PM_FAST );
 
-                m_F_Cu_PlatedPads_poly->Simplify( SHAPE_POLY_SET::PM_FAST );
+                m_F_Cu_PlatedPads_poly->ParallelSimplify( SHAPE_POLY_SET::PM_FAST );
             }
 
             if( m_B_Cu_PlatedPads_poly && ( m_layers_poly.find( B_Cu ) != m_layers_poly.end() ) )
             {
                 SHAPE_POLY_SET *layerPoly_B_Cu = m_layers_poly[B_Cu];
-                layerPoly_B_Cu->BooleanSubtract( *m_B_Cu_PlatedPads_poly, SHAPE_POLY_SET::POLYGON_MODE::PM_FAST );
+                layerPoly_B_Cu->ParallelBooleanSubtract( *m_B_Cu_PlatedPads_poly, SHAPE_POLY_SET::POLYGON_MODE::PM_FAST );
 
-                m_B_Cu_PlatedPads_poly->Simplify( SHAPE_POLY_SET::PM_FAST );
+                m_B_Cu_PlatedPads_poly->ParallelSimplify( SHAPE_POLY_SET::PM_FAST );
             }
         }
 
@@ -816,14 +810,14 @@ void BOARD_ADAPTER::createLayers( REPORTER* aStatusReporter )
         if( selected_layer_id.size() > 0 )
         {
             std::atomic<size_t> nextItem( 0 );
-            std::atomic<size_t> threadsFinished( 0 );
+            TASK_GROUP tasks;
+
+            size_t parallelThreadCount = std::min<size_t>( tasks.GetPool().GetThreadCount(),
+                                                           selected_layer_id.size() );
 
-            size_t parallelThreadCount = std::min<size_t>(
-                    std::max<size_t>( std::thread::hardware_concurrency(), 2 ),
-                    selected_layer_id.size() );
             for( size_t ii = 0; ii < parallelThreadCount; ++ii )
             {
-                std::thread t = std::thread( [&nextItem, &threadsFinished, &selected_layer_id, this]()
+                tasks.Run( [&nextItem, &selected_layer_id, this]()
                 {
                     for( size_t i = nextItem.fetch_add( 1 );
                                 i < selected_layer_id.size();
@@ -833,17 +827,12 @@ void BOARD_ADAPTER::createLayers( REPORTER* aStatusReporter )
 
                         if( layerPoly != m_layers_poly.end() )
                             // This will make a union of all added contours
-                            layerPoly->second->Simplify( SHAPE_POLY_SET::PM_FAST );
+                            layerPoly->second->ParallelSimplify( SHAPE_POLY_SET::PM_FAST );
                     }
-
-                    threadsFinished++;
                 } );
-
-                t.detach();
             }
 
-            while( threadsFinished < parallelThreadCount )
-                std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+            tasks.Wait();
         }
     }
 
@@ -858,22 +847,22 @@ void BOARD_ADAPTER::createLayers( REPORTER* aStatusReporter )
         {
             // found
             SHAPE_POLY_SET *polyLayer = m_layers_outer_holes_poly[layer];
-            polyLayer->Simplify( SHAPE_POLY_SET::PM_FAST );
+            polyLayer->ParallelSimplify( SHAPE_POLY_SET::PM_FAST );
 
             wxASSERT( m_layers_inner_holes_poly.find( layer ) != m_layers_inner_holes_poly.end() );
 
             polyLayer = m_layers_inner_holes_poly[layer];
-            polyLayer->Simplify( SHAPE_POLY_SET::PM_FAST );
+            polyLayer->ParallelSimplify( SHAPE_POLY_SET::PM_FAST );
         }
     }
 
     // End Build Copper layers
 
     // This will make a union of all added contourns
-    m_through_outer_holes_poly.Simplify( SHAPE_POLY_SET::PM_FAST );
-    m_through_outer_holes_poly_NPTH.Simplify( SHAPE_POLY_SET::PM_FAST );
-    m_through_outer_holes_vias_poly.Simplify( SHAPE_POLY_SET::PM_FAST );
-    m_through_outer_ring_holes_poly.Simplify( SHAPE_POLY_SET::PM_FAST );
+    m_through_outer_holes_poly.ParallelSimplify( SHAPE_POLY_SET::PM_FAST );
+    m_through_outer_holes_poly_NPTH.ParallelSimplify( SHAPE_POLY_SET::PM_FAST );
+    m_through_outer_holes_vias_poly.ParallelSimplify( SHAPE_POLY_SET::PM_FAST );
+    m_through_outer_ring_holes_poly.ParallelSimplify( SHAPE_POLY_SET::PM_FAST );
 
     // Build Tech layers
     // Based on: https://github.com/KiCad/kicad-source-mirror/blob/master/3d-viewer/3d_draw.cpp#L1059
@@ -1048,7 +1037,7 @@ void BOARD_ADAPTER::createLayers( REPORTER* aStatusReporter )
         }
 
         // This will make a union of all added contours
-        layerPoly->Simplify( SHAPE_POLY_SET::PM_FAST );
+        layerPoly->ParallelSimplify( SHAPE_POLY_SET::PM_FAST );
     }
     // End Build Tech layers
 
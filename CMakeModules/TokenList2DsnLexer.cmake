@@ -199,6 +199,150 @@ if( NOT ( tokensBefore EQUAL tokensAfter ) )
     message( FATAL_ERROR "Duplicate tokens found in file <${inputFile}>." )
 endif()
 
+# Build a perfect hash of the tokens for DSNLEXER::findToken(), by hash and displace: every
+# token has two hashes h1 and h2, h1 selects a bucket and the token lives in slot
+# ( h2 + displacement of the bucket ) of the table.  The displacements are chosen bucket by
+# bucket, largest first, so that no two tokens share a slot.  The hashes must match the ones
+# computed in dsnlexer.cpp.
+
+set( hashAlphabet "_0123456789abcdefghijklmnopqrstuvwxyz" )
+
+set( tokenIndex 0 )
+
+foreach( token ${tokens} )
+    string( LENGTH "${token}" tokenLength )
+    math( EXPR lastChar "${tokenLength} - 1" )
+
+    set( h1 0 )
+    set( h2 0 )
+
+    foreach( charIndex RANGE ${lastChar} )
+        string( SUBSTRING "${token}" ${charIndex} 1 char )
+        string( FIND "${hashAlphabet}" "${char}" code )
+        math( EXPR h1 "( ( ${h1} ^ ( ${h1} >> 12 ) ) * 31 + ${code} + 1 ) & 33554431" )
+        math( EXPR h2 "( ( ${h2} ^ ( ${h2} >> 12 ) ) * 37 + ${code} + 1 ) & 33554431" )
+    endforeach()
+
+    set( h1_${tokenIndex} ${h1} )
+    set( h2_${tokenIndex} ${h2} )
+    math( EXPR tokenIndex "${tokenIndex} + 1" )
+endforeach()
+
+# Buckets: a power of two holding one or two tokens on average.  Slots: a power of two at
+# least twice the token count, doubled until the displacements can be found.
+set( bucketCount 1 )
+
+while( bucketCount LESS tokensAfter )
+    math( EXPR bucketCount "${bucketCount} * 2" )
+endwhile()
+
+math( EXPR slotCount "${bucketCount} * 2" )
+
+if( bucketCount GREATER 1 )
+    math( EXPR bucketCount "${bucketCount} / 2" )
+endif()
+
+math( EXPR lastBucket "${bucketCount} - 1" )
+math( EXPR lastToken "${tokensAfter} - 1" )
+
+set( hashFound FALSE )
+
+while( NOT hashFound )
+    math( EXPR slotMask "${slotCount} - 1" )
+    math( EXPR lastSlot "${slotCount} - 1" )
+
+    if( slotCount GREATER 32768 )
+        message( FATAL_ERROR "${dsnErrorMsg} cannot hash the tokens of <${inputFile}>." )
+    endif()
+
+    foreach( bucket RANGE ${lastBucket} )
+        set( bucket_${bucket} "" )
+        set( displacement_${bucket} 0 )
+    endforeach()
+
+    foreach( slot RANGE ${lastSlot} )
+        set( slot_${slot} -1 )
+    endforeach()
+
+    set( maxBucketSize 0 )
+
+    if( tokensAfter GREATER 0 )
+        foreach( tokenIndex RANGE ${lastToken} )
+            math( EXPR bucket "${h1_${tokenIndex}} & ${lastBucket}" )
+            list( APPEND bucket_${bucket} ${tokenIndex} )
+            list( LENGTH bucket_${bucket} bucketSize )
+
+            if( bucketSize GREATER maxBucketSize )
+                set( maxBucketSize ${bucketSize} )
+            endif()
+        endforeach()
+    endif()
+
+    set( hashFound TRUE )
+    set( bucketSize ${maxBucketSize} )
+
+    while( hashFound AND bucketSize GREATER 0 )
+        foreach( bucket RANGE ${lastBucket} )
+            list( LENGTH bucket_${bucket} size )
+
+            if( hashFound AND size EQUAL bucketSize )
+                set( placed FALSE )
+                set( displacement 0 )
+
+                while( NOT placed AND NOT displacement GREATER lastSlot )
+                    set( placed TRUE )
+                    set( bucketSlots "" )
+
+                    foreach( tokenIndex ${bucket_${bucket}} )
+                        math( EXPR slot "( ${h2_${tokenIndex}} + ${displacement} ) & ${slotMask}" )
+                        list( FIND bucketSlots ${slot} taken )
+
+                        if( NOT slot_${slot} EQUAL -1 OR NOT taken EQUAL -1 )
+                            set( placed FALSE )
+                            break()
+                        endif()
+
+                        list( APPEND bucketSlots ${slot} )
+                    endforeach()
+
+                    if( NOT placed )
+                        math( EXPR displacement "${displacement} + 1" )
+                    endif()
+                endwhile()
+
+                if( placed )
+                    set( displacement_${bucket} ${displacement} )
+
+                    foreach( tokenIndex ${bucket_${bucket}} )
+                        math( EXPR slot "( ${h2_${tokenIndex}} + ${displacement} ) & ${slotMask}" )
+                        set( slot_${slot} ${tokenIndex} )
+                    endforeach()
+                else()
+                    set( hashFound FALSE )
+                endif()
+            endif()
+        endforeach()
+
+        math( EXPR bucketSize "${bucketSize} - 1" )
+    endwhile()
+
+    if( NOT hashFound )
+        math( EXPR slotCount "${slotCount} * 2" )
+    endif()
+endwhile()
+
+set( displacementTable "" )
+
+foreach( bucket RANGE ${lastBucket} )
+    set( displacementTable "${displacementTable}    ${displacement_${bucket}},\n" )
+endforeach()
+
+set( slotTable "" )
+
+foreach( slot RANGE ${lastSlot} )
+    set( slotTable "${slotTable}    ${slot_${slot}},\n" )
+endforeach()
+
 file( WRITE "${outHeaderFile}" "${includeFileHeader}" )
 file( WRITE "${outCppFile}" "${sourceFileHeader}" )
 
@@ -236,9 +380,10 @@ file( APPEND "${outHeaderFile}"
  */
 class ${LEXERCLASS} : public DSNLEXER
 {
-    /// Auto generated lexer keywords table and length:
-    static const KEYWORD  keywords[];
-    static const unsigned keyword_count;
+    /// Auto generated lexer keywords table, length and perfect hash:
+    static const KEYWORD      keywords[];
+    static const unsigned     keyword_count;
+    static const KEYWORD_HASH keyword_perfect_hash;
 
 public:
     /**
@@ -248,7 +393,7 @@ public:
      *   If left empty, then _(\"clipboard\") is used.
      */
     ${LEXERCLASS}( const std::string& aSExpression, const wxString& aSource = wxEmptyString ) :
-        DSNLEXER( keywords, keyword_count, aSExpression, aSource )
+        DSNLEXER( keywords, keyword_count, aSExpression, aSource, &keyword_perfect_hash )
     {
     }
 
@@ -262,7 +407,7 @@ public:
      * @param aFilename is the name of the opened file, needed for error reporting.
      */
     ${LEXERCLASS}( FILE* aFile, const wxString& aFilename ) :
-        DSNLEXER( keywords, keyword_count, aFile, aFilename )
+        DSNLEXER( keywords, keyword_count, aFile, aFilename, &keyword_perfect_hash )
     {
     }
 
@@ -278,7 +423,7 @@ public:
      *  STRING_LINE_READER or FILE_LINE_READER.  No ownership is taken of aLineReader.
      */
     ${LEXERCLASS}( LINE_READER* aLineReader ) :
-        DSNLEXER( keywords, keyword_count, aLineReader )
+        DSNLEXER( keywords, keyword_count, aLineReader, &keyword_perfect_hash )
     {
     }
 
@@ -379,6 +524,20 @@ file( APPEND "${outCppFile}"
 const unsigned ${LEXERCLASS}::keyword_count = unsigned( sizeof( ${LEXERCLASS}::keywords )/sizeof( ${LEXERCLASS}::keywords[0] ) );
 
 
+static const short keyword_displacements[] = {
+${displacementTable}};
+
+static const short keyword_slots[] = {
+${slotTable}};
+
+const KEYWORD_HASH ${LEXERCLASS}::keyword_perfect_hash = {
+    ${bucketCount},
+    ${slotCount},
+    keyword_displacements,
+    keyword_slots
+};
+
+
 const char* ${LEXERCLASS}::TokenName( T aTok )
 {
     const char* ret;
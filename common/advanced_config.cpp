@@ -104,6 +104,13 @@ static const wxChar ShowRouterDebugGraphics[] = wxT( "ShowRouterDebugGraphics" )
  */
 static const wxChar CompactFileSave[] = wxT( "CompactSave" );
 
+/**
+ * When set to true, zone fills are saved to a compressed binary .kicad_fill file next to the
+ * board instead of in the board file.  This makes board files much smaller and quicker to load
+ * and save, and keeps refills out of version control diffs of the board.
+ */
+static const wxChar ZoneFillCache[] = wxT( "ZoneFillCache" );
+
 /**
  * For drawsegments - arcs.
  * Distance from an arc end point and the estimated end point,
@@ -223,6 +230,7 @@ ADVANCED_CFG::ADVANCED_CFG()
     m_realTimeConnectivity      = true;
     m_coroutineStackSize        = AC_STACK::default_stack;
     m_ShowRouterDebugGraphics   = false;
+    m_ZoneFillCache             = false;
     m_drawArcAccuracy           = 10.0;
     m_drawArcCenterMaxAngle     = 50.0;
     m_DrawTriangulationOutlines = false;
@@ -302,6 +310,9 @@ void ADVANCED_CFG::loadSettings( wxConfigBase& aCfg )
     configParams.push_back( new PARAM_CFG_BOOL( true, AC_KEYS::CompactFileSave,
                                                 &m_CompactSave, false ) );
 
+    configParams.push_back( new PARAM_CFG_BOOL( true, AC_KEYS::ZoneFillCache,
+                                                &m_ZoneFillCache, false ) );
+
     configParams.push_back( new PARAM_CFG_DOUBLE( true, AC_KEYS::DrawArcAccuracy,
                                                   &m_drawArcAccuracy, 10.0, 0.0, 100000.0 ) );
 
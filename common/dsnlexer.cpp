@@ -27,6 +27,7 @@
 #include <cstdarg>
 #include <cstdio>
 #include <cstdlib>         // bsearch()
+#include <cstring>
 #include <cctype>
 
 #include <dsnlexer.h>
@@ -48,6 +49,12 @@ void DSNLEXER::init()
     commentsAreTokens = false;
 
     curOffset = 0;
+    leftLineNumber = 0;
+    leftOffset = 0;
+
+    // Lexers generated by TokenList2DsnLexer.cmake come with a perfect hash of their keywords
+    if( keywordPerfectHash )
+        return;
 
 #if 1
     if( keywordCount > 11 )
@@ -69,14 +76,15 @@ void DSNLEXER::init()
 
 
 DSNLEXER::DSNLEXER( const KEYWORD* aKeywordTable, unsigned aKeywordCount,
-                    FILE* aFile, const wxString& aFilename ) :
+                    FILE* aFile, const wxString& aFilename, const KEYWORD_HASH* aKeywordHash ) :
     iOwnReaders( true ),
     start( NULL ),
     next( NULL ),
     limit( NULL ),
     reader( NULL ),
     keywords( aKeywordTable ),
-    keywordCount( aKeywordCount )
+    keywordCount( aKeywordCount ),
+    keywordPerfectHash( aKeywordHash )
 {
     FILE_LINE_READER* fileReader = new FILE_LINE_READER( aFile, aFilename );
     PushReader( fileReader );
@@ -85,14 +93,16 @@ DSNLEXER::DSNLEXER( const KEYWORD* aKeywordTable, unsigned aKeywordCount,
 
 
 DSNLEXER::DSNLEXER( const KEYWORD* aKeywordTable, unsigned aKeywordCount,
-                    const std::string& aClipboardTxt, const wxString& aSource ) :
+                    const std::string& aClipboardTxt, const wxString& aSource,
+                    const KEYWORD_HASH* aKeywordHash ) :
     iOwnReaders( true ),
     start( NULL ),
     next( NULL ),
     limit( NULL ),
     reader( NULL ),
     keywords( aKeywordTable ),
-    keywordCount( aKeywordCount )
+    keywordCount( aKeywordCount ),
+    keywordPerfectHash( aKeywordHash )
 {
     STRING_LINE_READER* stringReader = new STRING_LINE_READER( aClipboardTxt, aSource.IsEmpty() ?
                                         wxString( FMT_CLIPBOARD ) : aSource );
@@ -102,14 +112,15 @@ DSNLEXER::DSNLEXER( const KEYWORD* aKeywordTable, unsigned aKeywordCount,
 
 
 DSNLEXER::DSNLEXER( const KEYWORD* aKeywordTable, unsigned aKeywordCount,
-                    LINE_READER* aLineReader ) :
+                    LINE_READER* aLineReader, const KEYWORD_HASH* aKeywordHash ) :
     iOwnReaders( false ),
     start( NULL ),
     next( NULL ),
     limit( NULL ),
     reader( NULL ),
     keywords( aKeywordTable ),
-    keywordCount( aKeywordCount )
+    keywordCount( aKeywordCount ),
+    keywordPerfectHash( aKeywordHash )
 {
     if( aLineReader )
         PushReader( aLineReader );
@@ -126,7 +137,8 @@ DSNLEXER::DSNLEXER( const std::string& aSExpression, const wxString& aSource ) :
     limit( NULL ),
     reader( NULL ),
     keywords( empty_keywords ),
-    keywordCount( 0 )
+    keywordCount( 0 ),
+    keywordPerfectHash( NULL )
 {
     STRING_LINE_READER* stringReader = new STRING_LINE_READER( aSExpression, aSource.IsEmpty() ?
                                         wxString( FMT_CLIPBOARD ) : aSource );
@@ -225,8 +237,60 @@ LINE_READER* DSNLEXER::PopReader()
 }
 
 
+/**
+ * Codes of the characters allowed in keywords by TokenList2DsnLexer.cmake, which computes the
+ * same hashes: the (1 based) position in "_0123456789abcdefghijklmnopqrstuvwxyz", or 0.
+ */
+struct KEYWORD_CHAR_CODES
+{
+    unsigned char code[256];
+
+    KEYWORD_CHAR_CODES()
+    {
+        static const char alphabet[] = "_0123456789abcdefghijklmnopqrstuvwxyz";
+
+        memset( code, 0, sizeof( code ) );
+
+        for( unsigned i = 0; alphabet[i]; ++i )
+            code[(unsigned char) alphabet[i]] = i + 1;
+    }
+};
+
+
 int DSNLEXER::findToken( const std::string& tok )
 {
+    if( keywordPerfectHash )
+    {
+        static const KEYWORD_CHAR_CODES codes;
+
+        // Must match the hashes computed by TokenList2DsnLexer.cmake.  The masks keep the
+        // intermediate values within what CMake's math() can hold on every platform.
+        unsigned h1 = 0;
+        unsigned h2 = 0;
+
+        for( char c : tok )
+        {
+            unsigned code = codes.code[(unsigned char) c];
+
+            if( !code )
+                return DSN_SYMBOL;  // cannot be a keyword
+
+            h1 = ( ( h1 ^ ( h1 >> 12 ) ) * 31 + code ) & 0x1FFFFFF;
+            h2 = ( ( h2 ^ ( h2 >> 12 ) ) * 37 + code ) & 0x1FFFFFF;
+        }
+
+        const KEYWORD_HASH& hash = *keywordPerfectHash;
+
+        unsigned bucket = h1 & ( hash.bucketCount - 1 );
+        unsigned slot = ( h2 + hash.displacements[bucket] ) & ( hash.slotCount - 1 );
+        int      token = hash.slots[slot];
+
+        if( token >= 0 && tok == keywords[token].name )
+            return token;
+
+        return DSN_SYMBOL;
+    }
+
     KEYWORD_MAP::const_iterator it = keyword_hash.find( tok.c_str() );
 
     if( it != keyword_hash.end() )
@@ -573,6 +637,8 @@ L_read:
         curText = *cur;
         curTok = DSN_LEFT;
         head = cur+1;
+        leftLineNumber = CurLineNumber();
+        leftOffset = cur - start;
         goto exit;
     }
 
@@ -591,7 +657,8 @@ L_read:
         // a quoted string, will return DSN_STRING
         if( *cur == stringDelimiter )
         {
-            // copy the token, character by character so we can remove doubled up quotes.
+            // copy the token, a run of plain characters at a time, so we can decode the
+            // escape sequences.
             curText.clear();
 
             ++cur;  // skip over the leading delimiter, which is always " in non-specctraMode
@@ -600,6 +667,16 @@ L_read:
 
             while( head<limit )
             {
+                const char* run = head;
+
+                while( head<limit && *head != '\\' && *head != '"' )
+                    ++head;
+
+                curText.append( run, head );
+
+                if( head >= limit )
+                    break;  // throw exception at L_unterminated
+
                 // ESCAPE SEQUENCES:
                 if( *head =='\\' )
                 {
@@ -657,16 +734,12 @@ L_read:
                     curText += c;
                 }
 
-                else if( *head == '"' )     // end of the non-specctraMode DSN_STRING
+                else    // *head == '"', end of the non-specctraMode DSN_STRING
                 {
                     curTok = DSN_STRING;
                     ++head;                 // omit this trailing double quote
                     goto exit;
                 }
-
-                else
-                    curText += *head++;
-
             }   // while
 
             // L_unterminated:
@@ -746,13 +819,13 @@ L_read:
     }           // specctraMode
 
     // non-quoted token, read it into curText.
-    curText.clear();
-
     head = cur;
     while( head<limit && !isSep( *head ) )
-        curText += *head++;
+        ++head;
+
+    curText.assign( cur, head );
 
-    if( isNumber( curText.c_str(), curText.c_str() + curText.size() ) )
+    if( isNumber( cur, head ) )
     {
         curTok = DSN_NUMBER;
         goto exit;
@@ -797,3 +870,93 @@ wxArrayString* DSNLEXER::ReadCommentLines()
 
     return ret;
 }
+
+
+int DSNLEXER::CopyList( std::string& aText )
+{
+    wxASSERT( !specctraMode && prevTok == DSN_LEFT );
+
+    int         lineNumber = leftLineNumber - 1;
+    const char* cur;
+    const char* run;
+    int         depth = 1;
+
+    aText.assign( leftOffset, ' ' );
+
+    if( leftLineNumber == CurLineNumber() )
+    {
+        run = start + leftOffset;
+        cur = run + 1;
+    }
+    else
+    {
+        // The '(' was on an earlier line, which the reader no longer holds.  Only blanks and
+        // comments could follow it there, so blank lines keep the line numbers in step.
+        aText += '(';
+        aText.append( CurLineNumber() - leftLineNumber, '\n' );
+
+        run = start;
+        cur = start;
+    }
+
+    for(;;)
+    {
+        if( cur >= limit )
+        {
+            aText.append( run, cur );
+
+            if( readLine() == 0 )
+            {
+                wxString errtxt( _( "Un-terminated list" ) );
+                THROW_PARSE_ERROR( errtxt, CurSource(), CurLine(), CurLineNumber(), 0 );
+            }
+
+            cur = start;
+            run = start;
+
+            // a comment line, as skipped by NextTok(), may hold unbalanced parentheses
+            while( cur < limit && isSpace( *cur ) )
+                ++cur;
+
+            if( cur < limit && *cur == '#' )
+                cur = limit;
+
+            continue;
+        }
+
+        char cc = *cur++;
+
+        if( cc == '"' )
+        {
+            // quoted strings do not span lines, and may hold escaped quotes
+            while( cur < limit && *cur != '"' )
+            {
+                if( *cur == '\\' && cur + 1 < limit )
+                    ++cur;
+
+                ++cur;
+            }
+
+            if( cur < limit )
+                ++cur;
+        }
+        else if( cc == '(' )
+        {
+            ++depth;
+        }
+        else if( cc == ')' && --depth == 0 )
+        {
+            break;
+        }
+    }
+
+    aText.append( run, cur );
+
+    prevTok   = curTok;
+    curTok    = DSN_RIGHT;
+    curText   = ')';
+    curOffset = cur - 1 - start;
+    next      = cur;
+
+    return lineNumber;
+}
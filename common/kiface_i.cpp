@@ -29,6 +29,7 @@
 #include <kiface_i.h>
 #include <pgm_base.h>
 #include <systemdirsappend.h>
+#include <thread_pool.h>
 
 #include <common.h>
 
@@ -91,12 +92,17 @@ bool KIFACE_I::start_common( int aCtlBits )
     m_bm.Init();
     setSearchPaths( &m_bm.m_search, m_id );
 
+    // This DSO has its own copy of the pool's statics; share the program's pool instead
+    if( THREAD_POOL* pool = Pgm().GetThreadPool() )
+        THREAD_POOL::SetInstance( pool );
+
     return true;
 }
 
 
 void KIFACE_I::end_common()
 {
+    THREAD_POOL::SetInstance( nullptr );
     m_bm.End();
 }
 
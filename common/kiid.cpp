@@ -30,8 +30,14 @@
 #include <boost/uuid/uuid_io.hpp>
 #include <boost/functional/hash.hpp>
 
-// Create only once, as seeding is *very* expensive
-static boost::uuids::random_generator randomGenerator;
+// Create only once per thread, as seeding is *very* expensive and the generator is not
+// thread safe (boards and footprint libraries are parsed on several threads)
+static boost::uuids::uuid randomUuid()
+{
+    static thread_local boost::uuids::random_generator randomGenerator;
+
+    return randomGenerator();
+}
 
 // These don't have the same performance penalty, but might as well be consistent
 static boost::uuids::string_generator stringGenerator;
@@ -48,7 +54,7 @@ KIID& NilUuid()
 }
 
 
-KIID::KIID() : m_uuid( randomGenerator() ), m_cached_timestamp( 0 )
+KIID::KIID() : m_uuid( randomUuid() ), m_cached_timestamp( 0 )
 {
 }
 
@@ -87,7 +93,7 @@ KIID::KIID( const wxString& aString ) : m_uuid(), m_cached_timestamp( 0 )
         {
             // Failed to parse string representation; best we can do is assign a new
             // random one.
-            m_uuid = randomGenerator();
+            m_uuid = randomUuid();
         }
     }
 }
@@ -189,7 +195,7 @@ void KIID::ConvertTimestampToUuid()
         return;
 
     m_cached_timestamp = 0;
-    m_uuid             = randomGenerator();
+    m_uuid             = randomUuid();
 }
 
 
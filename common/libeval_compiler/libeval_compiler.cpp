@@ -70,6 +70,7 @@ TREE_NODE* newNode( LIBEVAL::COMPILER* compiler, int op, const T_TOKEN_VALUE& va
     t2->isTerminal   = false;
     t2->srcPos       = compiler->GetSourcePos();
     t2->uop          = nullptr;
+    t2->jump         = nullptr;
 
     libeval_dbg(10, " ostr %p nstr %p nnode %p op %d", value.str, t2->value.str, t2, t2->op );
 
@@ -154,6 +155,14 @@ wxString UOP::Format() const
         str = wxString::Format( "FCALL" );
         break;
 
+    case TR_UOP_JUMP_IF_FALSE:
+        str = wxString::Format( "JUMP IF FALSE [%lu]", (unsigned long) m_target );
+        break;
+
+    case TR_UOP_JUMP_IF_TRUE:
+        str = wxString::Format( "JUMP IF TRUE [%lu]", (unsigned long) m_target );
+        break;
+
     default:
         str = wxString::Format( "%s %d", formatOpName( m_op ).c_str(), m_op );
         break;
@@ -172,6 +181,51 @@ UCODE::~UCODE()
 }
 
 
+void UCODE::FoldConstants()
+{
+    if( m_ucode.empty() )
+        return;
+
+    int    op = m_ucode.back()->GetOp();
+    size_t argCount;
+
+    if( op & TR_OP_BINARY_MASK )
+        argCount = 2;
+    else if( op & TR_OP_UNARY_MASK )
+        argCount = 1;
+    else
+        return;
+
+    if( m_ucode.size() < argCount + 1 )
+        return;
+
+    size_t first = m_ucode.size() - argCount - 1;
+
+    for( size_t ii = first; ii < m_ucode.size() - 1; ++ii )
+    {
+        if( !m_ucode[ii]->IsConstant() )
+            return;
+    }
+
+    CONTEXT ctx;
+
+    for( size_t ii = first; ii < m_ucode.size(); ++ii )
+        m_ucode[ii]->Exec( &ctx );
+
+    if( ctx.IsErrorPending() || ctx.SP() != 1 )
+        return;
+
+    std::unique_ptr<VALUE> result = std::make_unique<VALUE>();
+    result->Set( *ctx.Pop() );
+
+    for( size_t ii = first; ii < m_ucode.size(); ++ii )
+        delete m_ucode[ii];
+
+    m_ucode.resize( first );
+    m_ucode.push_back( new UOP( TR_UOP_PUSH_VALUE, std::move( result ) ) );
+}
+
+
 wxString UCODE::Dump() const
 {
     wxString rv;
@@ -1034,6 +1088,17 @@ bool COMPILER::generateUCode( UCODE* aCode, CONTEXT* aPreflightContext )
             }
             else if( node->leaf[1] && !node->leaf[1]->isVisited )
             {
+                // The left operand's code is complete; if it decides the result of && or ||
+                // the right operand doesn't need to be evaluated.
+                if( node->op == TR_OP_BOOL_AND || node->op == TR_OP_BOOL_OR )
+                {
+                    bool isAnd = node->op == TR_OP_BOOL_AND;
+
+                    node->jump = new UOP( isAnd ? TR_UOP_JUMP_IF_FALSE : TR_UOP_JUMP_IF_TRUE,
+                                          std::make_unique<VALUE>( isAnd ? 0.0 : 1.0 ) );
+                    aCode->AddOp( node->jump );
+                }
+
                 stack.push_back( node->leaf[1] );
                 node->leaf[1]->isVisited = true;
             }
@@ -1046,9 +1111,16 @@ bool COMPILER::generateUCode( UCODE* aCode, CONTEXT* aPreflightContext )
         if( node->uop )
         {
             aCode->AddOp( node->uop );
+            aCode->FoldConstants();
             node->uop = nullptr;
         }
 
+        if( node->jump )
+        {
+            node->jump->SetTarget( aCode->GetOpCount() );
+            node->jump = nullptr;
+        }
+
         stack.pop_back();
     }
 
@@ -1058,7 +1130,7 @@ bool COMPILER::generateUCode( UCODE* aCode, CONTEXT* aPreflightContext )
 }
 
 
-void UOP::Exec( CONTEXT* ctx )
+bool UOP::Exec( CONTEXT* ctx )
 {
     switch( m_op )
     {
@@ -1072,11 +1144,29 @@ void UOP::Exec( CONTEXT* ctx )
 
     case TR_UOP_PUSH_VALUE:
         ctx->Push( m_value.get() );
-        return;
+        return false;
 
     case TR_OP_METHOD_CALL:
         m_func( ctx, m_ref.get() );
-        return;
+        return false;
+
+    case TR_UOP_JUMP_IF_FALSE:
+    case TR_UOP_JUMP_IF_TRUE:
+    {
+        // Left operand of && or ||.  When it decides the result, replace it with the result
+        // (held in m_value) and skip over the right operand and the operator.
+        VALUE* arg = ctx->Pop();
+        bool   truth = arg && arg->AsDouble() != 0.0;
+
+        if( truth == ( m_op == TR_UOP_JUMP_IF_TRUE ) )
+        {
+            ctx->Push( m_value.get() );
+            return true;
+        }
+
+        ctx->Push( arg );
+        return false;
+    }
 
     default:
         break;
@@ -1136,7 +1226,7 @@ void UOP::Exec( CONTEXT* ctx )
         auto rp = ctx->AllocValue();
         rp->Set( result );
         ctx->Push( rp );
-        return;
+        return false;
     }
     else if( m_op & TR_OP_UNARY_MASK )
     {
@@ -1157,8 +1247,10 @@ void UOP::Exec( CONTEXT* ctx )
         auto rp = ctx->AllocValue();
         rp->Set( result );
         ctx->Push( rp );
-        return;
+        return false;
     }
+
+    return false;
 }
 
 
@@ -1168,8 +1260,13 @@ VALUE* UCODE::Run( CONTEXT* ctx )
 
     try
     {
-        for( UOP* op : m_ucode )
-            op->Exec( ctx );
+        for( size_t pc = 0; pc < m_ucode.size(); )
+        {
+            UOP* op = m_ucode[ pc++ ];
+
+            if( op->Exec( ctx ) )
+                pc = op->GetTarget();
+        }
     }
     catch(...)
     {
@@ -57,6 +57,7 @@
 #include <settings/common_settings.h>
 #include <settings/settings_manager.h>
 #include <systemdirsappend.h>
+#include <thread_pool.h>
 #include <trace_helpers.h>
 
 
@@ -123,6 +124,12 @@ void PGM_BASE::Destroy()
 
     delete m_locale;
     m_locale = 0;
+
+    if( m_thread_pool )
+    {
+        THREAD_POOL::SetInstance( nullptr );
+        m_thread_pool.reset();
+    }
 }
 
 
@@ -219,6 +226,10 @@ bool PGM_BASE::InitPgm()
             return false;
     }
 
+    // One pool for the whole process; the kifaces pick it up in KIFACE_I::start_common()
+    m_thread_pool = std::make_unique<THREAD_POOL>();
+    THREAD_POOL::SetInstance( m_thread_pool.get() );
+
     m_settings_manager = std::make_unique<SETTINGS_MANAGER>();
 
     // Something got in the way of settings load: can't continue
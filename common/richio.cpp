@@ -32,6 +32,15 @@
 #include <wx/file.h>
 #include <wx/translation.h>
 
+#ifdef __WINDOWS__
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 
 // Fall back to getc() when getc_unlocked() is not available on the target platform.
 #if !defined( HAVE_FGETC_NOLOCK )
@@ -229,13 +238,15 @@ char* FILE_LINE_READER::ReadLine()
 }
 
 
-STRING_LINE_READER::STRING_LINE_READER( const std::string& aString, const wxString& aSource ):
+STRING_LINE_READER::STRING_LINE_READER( const std::string& aString, const wxString& aSource,
+                                        unsigned aStartingLineNumber ):
     LINE_READER( LINE_READER_LINE_DEFAULT_MAX ),
     m_lines( aString ), m_ndx( 0 )
 {
     // Clipboard text should be nice and _use multiple lines_ so that
     // we can report _line number_ oriented error messages when parsing.
-    m_source = aSource;
+    m_source  = aSource;
+    m_lineNum = aStartingLineNumber;
 }
 
 
@@ -282,6 +293,161 @@ char* STRING_LINE_READER::ReadLine()
 }
 
 
+MAPPED_FILE_LINE_READER::MAPPED_FILE_LINE_READER( const wxString& aFileName,
+            unsigned aStartingLineNumber, unsigned aMaxLineLength ):
+    LINE_READER( aMaxLineLength ),
+    m_data( NULL ), m_size( 0 ), m_ndx( 0 ), m_mapping( NULL )
+{
+    m_source  = aFileName;
+    m_lineNum = aStartingLineNumber;
+
+    bool opened = false;
+
+#ifdef __WINDOWS__
+    // Share everything, as fopen() does: the file may well be open for writing elsewhere,
+    // e.g. in an editor.  Windows won't let the file be truncated while it is mapped.
+    HANDLE file = CreateFileW( aFileName.wc_str(), GENERIC_READ,
+                               FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL,
+                               OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL );
+
+    if( file != INVALID_HANDLE_VALUE )
+    {
+        LARGE_INTEGER size;
+
+        opened = true;
+
+        if( GetFileSizeEx( file, &size ) && size.QuadPart > 0 )
+        {
+            HANDLE mapping = CreateFileMappingW( file, NULL, PAGE_READONLY, 0, 0, NULL );
+
+            if( mapping )
+            {
+                m_data = (const char*) MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+
+                if( m_data )
+                {
+                    m_mapping = mapping;
+                    m_size = (size_t) size.QuadPart;
+                }
+                else
+                {
+                    CloseHandle( mapping );
+                }
+            }
+        }
+
+        CloseHandle( file );
+    }
+#else
+    int fd = open( aFileName.fn_str(), O_RDONLY );
+
+    if( fd >= 0 )
+    {
+        struct stat st;
+
+        opened = true;
+
+        if( fstat( fd, &st ) == 0 && st.st_size > 0 )
+        {
+            void* addr = mmap( NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+
+            if( addr != MAP_FAILED )
+            {
+#ifdef POSIX_MADV_SEQUENTIAL
+                posix_madvise( addr, (size_t) st.st_size, POSIX_MADV_SEQUENTIAL );
+#endif
+                m_mapping = addr;
+                m_data = (const char*) addr;
+                m_size = (size_t) st.st_size;
+            }
+        }
+
+        close( fd );
+    }
+#endif
+
+    if( !opened )
+    {
+        wxString msg = wxString::Format(
+            _( "Unable to open filename \"%s\" for reading" ), aFileName.GetData() );
+        THROW_IO_ERROR( msg );
+    }
+
+    if( !m_mapping )
+    {
+        // Empty, or not mappable: fall back to reading the whole file.
+        wxFile file( aFileName );
+        wxFileOffset length = file.IsOpened() ? file.Length() : wxInvalidOffset;
+
+        if( length == wxInvalidOffset )
+        {
+            wxString msg = wxString::Format(
+                _( "Unable to read file \"%s\"" ), aFileName.GetData() );
+            THROW_IO_ERROR( msg );
+        }
+
+        m_buffer.resize( (size_t) length );
+
+        if( length > 0 && file.Read( m_buffer.data(), (size_t) length ) != length )
+        {
+            wxString msg = wxString::Format(
+                _( "Unable to read file \"%s\"" ), aFileName.GetData() );
+            THROW_IO_ERROR( msg );
+        }
+
+        m_data = m_buffer.data();
+        m_size = m_buffer.size();
+    }
+}
+
+
+MAPPED_FILE_LINE_READER::~MAPPED_FILE_LINE_READER()
+{
+    if( !m_mapping )
+        return;
+
+#ifdef __WINDOWS__
+    UnmapViewOfFile( m_data );
+    CloseHandle( (HANDLE) m_mapping );
+#else
+    munmap( m_mapping, m_size );
+#endif
+}
+
+
+char* MAPPED_FILE_LINE_READER::ReadLine()
+{
+    m_length = 0;
+
+    if( m_ndx < m_size )
+    {
+        const char* line = m_data + m_ndx;
+        const char* eol  = (const char*) memchr( line, '\n', m_size - m_ndx );
+
+        // include the newline, so +1
+        size_t length = eol ? eol - line + 1 : m_size - m_ndx;
+
+        if( length > m_maxLineLength )
+            THROW_IO_ERROR( _( "Maximum line length exceeded" ) );
+
+        if( length + 1 > m_capacity )   // +1 for terminating nul
+            expandCapacity( length + 1 );
+
+        memcpy( m_line, line, length );
+        m_length = (unsigned) length;
+        m_ndx += length;
+    }
+
+    m_line[m_length] = 0;
+
+    // m_lineNum is incremented even if there was no line read, because this
+    // leads to better error reporting when we hit an end of file.
+    ++m_lineNum;
+
+    return m_length ? m_line : NULL;
+}
+
+
 INPUTSTREAM_LINE_READER::INPUTSTREAM_LINE_READER( wxInputStream* aStream, const wxString& aSource ) :
     LINE_READER( LINE_READER_LINE_DEFAULT_MAX ),
     m_stream( aStream )
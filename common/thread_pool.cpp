@@ -0,0 +1,50 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <thread_pool.h>
+#include <widgets/progress_reporter.h>
+
+
+void TASK_GROUP::Wait( PROGRESS_REPORTER* aReporter )
+{
+    if( !aReporter )
+    {
+        Wait();
+        return;
+    }
+
+    // The reporter is refreshed on every timeout so the UI stays responsive; the tasks
+    // themselves only touch its thread-safe methods.  A group waited on from inside the pool
+    // can't touch the UI, so it just watches for cancellation.
+    bool isWorker = m_pool.IsWorkerThread();
+
+    while( !waitFor( std::chrono::milliseconds( 100 ) ) )
+    {
+        if( isWorker ? aReporter->IsCancelled() : !aReporter->KeepRefreshing() )
+            Cancel();
+    }
+
+    if( aReporter->IsCancelled() )
+        Cancel();
+
+    rethrow();
+}
@@ -139,6 +139,7 @@ const std::string ArchiveFileExtension( "zip" );
 
 const std::string LegacyPcbFileExtension( "brd" );
 const std::string KiCadPcbFileExtension( "kicad_pcb" );
+const std::string ZoneFillCacheFileExtension( "kicad_fill" );
 const std::string PageLayoutDescrFileExtension( "kicad_wks" );
 const std::string DesignRulesFileExtension( "kicad_dru" );
 
@@ -19,11 +19,10 @@
  */
 
 #include <list>
-#include <thread>
 #include <algorithm>
-#include <future>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 #include <profile.h>
 #include <common.h>
 #include <erc.h>
@@ -40,6 +39,7 @@
 #include <connection_graph.h>
 #include <widgets/ui_common.h>
 #include <kicad_string.h>
+#include <thread_pool.h>
 
 #include <advanced_config.h> // for realtime connectivity switch
 
@@ -403,6 +403,7 @@ void CONNECTION_GRAPH::Reset()
     for( auto& subgraph : m_subgraphs )
         delete subgraph;
 
+    m_sheetList.clear();
     m_items.clear();
     m_subgraphs.clear();
     m_driver_subgraphs.clear();
@@ -426,31 +427,100 @@ void CONNECTION_GRAPH::Recalculate( const SCH_SHEET_LIST& aSheetList, bool aUnco
 {
     PROF_COUNTER recalc_time( "CONNECTION_GRAPH::Recalculate" );
 
-    if( aUnconditional )
-        Reset();
+    // The graphical connectivity of a sheet only depends on the items of its screen, so it
+    // can be kept for the sheets that were already part of the last calculation and whose
+    // screen was not edited since.  Dirty flags are cleared while sheets are visited, and
+    // a screen may be shared by several sheets, so collect the edited screens up front.
+    std::unordered_set<SCH_SHEET_PATH> known_sheets;
+    std::unordered_set<SCH_SCREEN*>    visited_screens;
+    std::unordered_set<SCH_SCREEN*>    dirty_screens;
+    bool                               update_all = aUnconditional;
+    bool                               first_calculation = m_sheetList.empty();
+
+    if( !update_all )
+    {
+        known_sheets.insert( m_sheetList.begin(), m_sheetList.end() );
+
+        for( const SCH_SHEET_PATH& sheet : aSheetList )
+        {
+            SCH_SCREEN* screen = sheet.LastScreen();
+
+            if( !visited_screens.insert( screen ).second )
+                continue;
+
+            bool dirty = screen->IsConnectivityDirty();
+
+            for( SCH_ITEM* item : screen->Items() )
+            {
+                if( !item->IsConnectable() || !item->IsConnectivityDirty() )
+                    continue;
+
+                dirty = true;
+
+                // An edited sheet may now point to another screen, whose items have never
+                // been connected on the sheet paths below it.
+                if( item->Type() == SCH_SHEET_T )
+                {
+                    update_all = true;
+                    break;
+                }
+            }
+
+            if( dirty )
+                dirty_screens.insert( screen );
+
+            if( update_all )
+                break;
+        }
+    }
+
+    // Subgraphs, net names and codes are always rebuilt: they are what the reused item
+    // connectivity is resolved into, and they span sheets.
+    Reset();
 
     PROF_COUNTER update_items( "updateItemConnectivity" );
 
     m_sheetList = aSheetList;
 
+    int updated_sheets = 0;
+
     for( const SCH_SHEET_PATH& sheet : aSheetList )
     {
+        SCH_SCREEN* screen = sheet.LastScreen();
+        bool        update = update_all || dirty_screens.count( screen )
+                                        || !known_sheets.count( sheet );
+
         std::vector<SCH_ITEM*> items;
 
-        for( SCH_ITEM* item : sheet.LastScreen()->Items() )
+        for( SCH_ITEM* item : screen->Items() )
         {
-            if( item->IsConnectable() && ( aUnconditional || item->IsConnectivityDirty() ) )
+            if( item->IsConnectable() )
                 items.push_back( item );
         }
 
         m_items.reserve( m_items.size() + items.size() );
 
-        updateItemConnectivity( sheet, items );
+        if( update )
+        {
+            updateItemConnectivity( sheet, items );
 
-        // UpdateDanglingState() also adds connected items for SCH_TEXT
-        sheet.LastScreen()->TestDanglingEnds( &sheet );
+            // UpdateDanglingState() also adds connected items for SCH_TEXT
+            screen->TestDanglingEnds( &sheet );
+            updated_sheets++;
+        }
+        else
+        {
+            for( SCH_ITEM* item : items )
+                initItemConnection( sheet, item );
+        }
     }
 
+    for( const SCH_SHEET_PATH& sheet : aSheetList )
+        sheet.LastScreen()->SetConnectivityDirty( false );
+
+    wxLogTrace( ConnProfileMask, "Updated connectivity of %d of %d sheets", updated_sheets,
+                (int) aSheetList.size() );
+
     if( wxLog::IsAllowedTraceMask( ConnProfileMask ) )
         update_items.Show();
 
@@ -467,11 +537,13 @@ void CONNECTION_GRAPH::Recalculate( const SCH_SHEET_LIST& aSheetList, bool aUnco
         recalc_time.Show();
 
 #ifndef DEBUG
-    // Pressure relief valve for release builds
+    // Pressure relief valve for release builds.  The first calculation, when a schematic is
+    // loaded, is expected to take a while and says nothing about how long an edit will.
     const double max_recalc_time_msecs = 250.;
 
-    if( m_allowRealTime && ADVANCED_CFG::GetCfg().m_realTimeConnectivity &&
-        recalc_time.msecs() > max_recalc_time_msecs )
+    if( m_allowRealTime && ADVANCED_CFG::GetCfg().m_realTimeConnectivity
+            && !first_calculation
+            && recalc_time.msecs() > max_recalc_time_msecs )
     {
         m_allowRealTime = false;
     }
@@ -479,6 +551,64 @@ void CONNECTION_GRAPH::Recalculate( const SCH_SHEET_LIST& aSheetList, bool aUnco
 }
 
 
+void CONNECTION_GRAPH::initItemConnection( const SCH_SHEET_PATH& aSheet, SCH_ITEM* aItem )
+{
+    if( aItem->Type() == SCH_SHEET_T )
+    {
+        for( SCH_SHEET_PIN* pin : static_cast<SCH_SHEET*>( aItem )->GetPins() )
+        {
+            pin->InitializeConnection( aSheet, this );
+            m_items.emplace_back( pin );
+        }
+    }
+    else if( aItem->Type() == SCH_COMPONENT_T )
+    {
+        SCH_COMPONENT* component = static_cast<SCH_COMPONENT*>( aItem );
+
+        for( SCH_PIN* pin : component->GetPins( &aSheet ) )
+        {
+            pin->InitializeConnection( aSheet, this );
+
+            // because calling the first time is not thread-safe
+            pin->GetDefaultNetName( aSheet );
+
+            // Invisible power pins need to be post-processed later
+
+            if( pin->IsPowerConnection() && !pin->IsVisible() )
+                m_invisible_power_pins.emplace_back( std::make_pair( aSheet, pin ) );
+
+            m_items.emplace_back( pin );
+        }
+    }
+    else
+    {
+        m_items.emplace_back( aItem );
+        SCH_CONNECTION* conn = aItem->InitializeConnection( aSheet, this );
+
+        // Set bus/net property here so that the propagation code uses it
+        switch( aItem->Type() )
+        {
+        case SCH_LINE_T:
+            conn->SetType( aItem->GetLayer() == LAYER_BUS ? CONNECTION_TYPE::BUS :
+                                                            CONNECTION_TYPE::NET );
+            break;
+
+        case SCH_BUS_BUS_ENTRY_T:
+            conn->SetType( CONNECTION_TYPE::BUS );
+            break;
+
+        case SCH_PIN_T:
+        case SCH_BUS_WIRE_ENTRY_T:
+            conn->SetType( CONNECTION_TYPE::NET );
+            break;
+
+        default:
+            break;
+        }
+    }
+}
+
+
 void CONNECTION_GRAPH::updateItemConnectivity( const SCH_SHEET_PATH& aSheet,
                                                const std::vector<SCH_ITEM*>& aItemList )
 {
@@ -489,18 +619,15 @@ void CONNECTION_GRAPH::updateItemConnectivity( const SCH_SHEET_PATH& aSheet,
         std::vector< wxPoint > points = item->GetConnectionPoints();
         item->ConnectedItems( aSheet ).clear();
 
+        initItemConnection( aSheet, item );
+
         if( item->Type() == SCH_SHEET_T )
         {
             for( SCH_SHEET_PIN* pin : static_cast<SCH_SHEET*>( item )->GetPins() )
             {
-                if( !pin->Connection( &aSheet ) )
-                    pin->InitializeConnection( aSheet, this );
-
                 pin->ConnectedItems( aSheet ).clear();
-                pin->Connection( &aSheet )->Reset();
 
                 connection_map[ pin->GetTextPos() ].push_back( pin );
-                m_items.emplace_back( pin );
             }
         }
         else if( item->Type() == SCH_COMPONENT_T )
@@ -516,50 +643,22 @@ void CONNECTION_GRAPH::updateItemConnectivity( const SCH_SHEET_PATH& aSheet,
 
             for( SCH_PIN* pin : component->GetPins( &aSheet ) )
             {
-                pin->InitializeConnection( aSheet, this );
-
-                wxPoint pos = pin->GetPosition();
-
-                // because calling the first time is not thread-safe
-                pin->GetDefaultNetName( aSheet );
                 pin->ConnectedItems( aSheet ).clear();
 
-                // Invisible power pins need to be post-processed later
-
-                if( pin->IsPowerConnection() && !pin->IsVisible() )
-                    m_invisible_power_pins.emplace_back( std::make_pair( aSheet, pin ) );
-
-                connection_map[ pos ].push_back( pin );
-                m_items.emplace_back( pin );
+                connection_map[ pin->GetPosition() ].push_back( pin );
             }
         }
         else
         {
-            m_items.emplace_back( item );
-            auto conn = item->InitializeConnection( aSheet, this );
-
-            // Set bus/net property here so that the propagation code uses it
+            // clean previous (old) links:
             switch( item->Type() )
             {
-            case SCH_LINE_T:
-                conn->SetType( item->GetLayer() == LAYER_BUS ? CONNECTION_TYPE::BUS :
-                                                               CONNECTION_TYPE::NET );
-                break;
-
             case SCH_BUS_BUS_ENTRY_T:
-                conn->SetType( CONNECTION_TYPE::BUS );
-                // clean previous (old) links:
                 static_cast<SCH_BUS_BUS_ENTRY*>( item )->m_connected_bus_items[0] = nullptr;
                 static_cast<SCH_BUS_BUS_ENTRY*>( item )->m_connected_bus_items[1] = nullptr;
                 break;
 
-            case SCH_PIN_T:
-                conn->SetType( CONNECTION_TYPE::NET );
-                break;
-
             case SCH_BUS_WIRE_ENTRY_T:
-                conn->SetType( CONNECTION_TYPE::NET );
-                // clean previous (old) link:
                 static_cast<SCH_BUS_WIRE_ENTRY*>( item )->m_connected_bus_item = nullptr;
                 break;
 
@@ -795,12 +894,6 @@ void CONNECTION_GRAPH::buildConnectionGraph()
 
     // Resolve drivers for subgraphs and propagate connectivity info
 
-    // We don't want to spin up a new thread for fewer than 8 nets (overhead costs)
-    size_t parallelThreadCount = std::min<size_t>( std::thread::hardware_concurrency(),
-            ( m_subgraphs.size() + 3 ) / 4 );
-
-    std::atomic<size_t> nextSubgraph( 0 );
-    std::vector<std::future<size_t>> returns( parallelThreadCount );
     std::vector<CONNECTION_SUBGRAPH*> dirty_graphs;
 
     std::copy_if( m_subgraphs.begin(), m_subgraphs.end(), std::back_inserter( dirty_graphs ),
@@ -809,76 +902,64 @@ void CONNECTION_GRAPH::buildConnectionGraph()
                       return candidate->m_dirty;
                   } );
 
-    auto update_lambda = [&nextSubgraph, &dirty_graphs]() -> size_t
+    auto update_lambda = [&dirty_graphs]( size_t aIndex )
     {
-        for( size_t subgraphId = nextSubgraph++; subgraphId < dirty_graphs.size(); subgraphId = nextSubgraph++ )
-        {
-            auto subgraph = dirty_graphs[subgraphId];
+        auto subgraph = dirty_graphs[aIndex];
 
-            if( !subgraph->m_dirty )
-                continue;
+        if( !subgraph->m_dirty )
+            return;
 
-            // Special processing for some items
-            for( auto item : subgraph->m_items )
+        // Special processing for some items
+        for( auto item : subgraph->m_items )
+        {
+            switch( item->Type() )
             {
-                switch( item->Type() )
-                {
-                case SCH_NO_CONNECT_T:
-                    subgraph->m_no_connect = item;
-                    break;
-
-                case SCH_BUS_WIRE_ENTRY_T:
-                    subgraph->m_bus_entry = item;
-                    break;
+            case SCH_NO_CONNECT_T:
+                subgraph->m_no_connect = item;
+                break;
 
-                case SCH_PIN_T:
-                {
-                    auto pin = static_cast<SCH_PIN*>( item );
+            case SCH_BUS_WIRE_ENTRY_T:
+                subgraph->m_bus_entry = item;
+                break;
 
-                    if( pin->GetType() == ELECTRICAL_PINTYPE::PT_NC )
-                        subgraph->m_no_connect = item;
+            case SCH_PIN_T:
+            {
+                auto pin = static_cast<SCH_PIN*>( item );
 
-                    break;
-                }
+                if( pin->GetType() == ELECTRICAL_PINTYPE::PT_NC )
+                    subgraph->m_no_connect = item;
 
-                default:
-                    break;
-                }
+                break;
             }
 
-            if( !subgraph->ResolveDrivers() )
-            {
-                subgraph->m_dirty = false;
+            default:
+                break;
             }
-            else
-            {
-                // Now the subgraph has only one driver
-                SCH_ITEM* driver = subgraph->m_driver;
-                SCH_SHEET_PATH sheet = subgraph->m_sheet;
-                SCH_CONNECTION* connection = driver->Connection( &sheet );
-
-                connection->ConfigureFromLabel( subgraph->GetNameForDriver( driver ) );
-                connection->SetDriver( driver );
-                connection->ClearDirty();
+        }
 
-                subgraph->m_dirty = false;
-            }
+        if( !subgraph->ResolveDrivers() )
+        {
+            subgraph->m_dirty = false;
         }
+        else
+        {
+            // Now the subgraph has only one driver
+            SCH_ITEM* driver = subgraph->m_driver;
+            SCH_SHEET_PATH sheet = subgraph->m_sheet;
+            SCH_CONNECTION* connection = driver->Connection( &sheet );
+
+            connection->ConfigureFromLabel( subgraph->GetNameForDriver( driver ) );
+            connection->SetDriver( driver );
+            connection->ClearDirty();
 
-        return 1;
+            subgraph->m_dirty = false;
+        }
     };
 
-    if( parallelThreadCount == 1 )
-        update_lambda();
-    else
-    {
-        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
-            returns[ii] = std::async( std::launch::async, update_lambda );
+    TASK_GROUP tasks;
 
-        // Finalize the threads
-        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
-            returns[ii].wait();
-    }
+    tasks.ParallelFor( dirty_graphs.size(), update_lambda );
+    tasks.Wait();
 
     // Now discard any non-driven subgraphs from further consideration
 
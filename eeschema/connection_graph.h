@@ -252,6 +252,12 @@ public:
     /**
      * Updates the connection graph for the given list of sheets.
      *
+     * Unless aUnconditional is set, the graphical connectivity of the items (which items touch
+     * which) is only rebuilt on sheets that are new since the last call or whose screen was
+     * edited, as reported by SCH_SCREEN::IsConnectivityDirty() and SCH_ITEM::IsConnectivityDirty().
+     * Subgraphs, net names and net codes are resolved again for the whole schematic either way,
+     * so both modes give the same result.
+     *
      * @param aSheetList is the list of possibly modified sheets
      * @param aUnconditional is true if an unconditional full recalculation should be done
      */
@@ -308,7 +314,7 @@ public:
     static bool m_allowRealTime;
 
 private:
-    // All the sheets in the schematic (as long as we don't have partial updates)
+    // All the sheets in the schematic, as of the last recalculation
     SCH_SHEET_LIST m_sheetList;
 
     // All connectable items in the schematic
@@ -382,6 +388,18 @@ private:
     void updateItemConnectivity( const SCH_SHEET_PATH& aSheet,
                                  const std::vector<SCH_ITEM*>& aItemList );
 
+    /**
+     * Resets the connection of an item (or of its pins) on the given sheet and loads it into
+     * m_items for buildConnectionGraph(), leaving its graphical connections untouched.
+     *
+     * This is the part of updateItemConnectivity() that must also be done for the items of
+     * sheets whose graphical connectivity is still valid.
+     *
+     * @param aSheet is the path to the sheet of the item
+     * @param aItem is the item to reset
+     */
+    void initItemConnection( const SCH_SHEET_PATH& aSheet, SCH_ITEM* aItem );
+
     /**
      * Generates the connection graph (after all item connectivity has been updated)
      *
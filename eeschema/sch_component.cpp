@@ -277,6 +277,9 @@ void SCH_COMPONENT::UpdatePins()
     m_pins.clear();
     m_pinMap.clear();
 
+    // Items connected to the old pins still point to them
+    SetConnectivityDirty();
+
     if( !m_part )
         return;
 
@@ -1237,7 +1237,8 @@ void SCH_EDIT_FRAME::RecalculateConnections( SCH_CLEANUP_FLAGS aCleanupFlags )
     if( settings.m_IntersheetsRefShow == true )
         RecomputeIntersheetsRefs();
 
-    Schematic().ConnectionGraph()->Recalculate( list, true );
+    // Only the sheets edited since the last call need their item connectivity rebuilt
+    Schematic().ConnectionGraph()->Recalculate( list, false );
 }
 
 int SCH_EDIT_FRAME::RecomputeIntersheetsRefs()
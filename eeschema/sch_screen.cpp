@@ -54,11 +54,10 @@
 #include <sch_text.h>
 #include <schematic.h>
 #include <symbol_lib_table.h>
+#include <thread_pool.h>
 #include <tool/common_tools.h>
 
-#include <thread>
 #include <algorithm>
-#include <future>
 
 // TODO(JE) Debugging only
 #include <profile.h>
@@ -69,6 +68,7 @@ SCH_SCREEN::SCH_SCREEN( EDA_ITEM* aParent ) :
     m_paper( wxT( "A4" ) )
 {
     m_modification_sync = 0;
+    m_connectivityDirty = true;
 
     m_refCount = 0;
 
@@ -176,6 +176,9 @@ void SCH_SCREEN::Append( SCH_ITEM* aItem )
 
         m_rtree.insert( aItem );
         --m_modification_sync;
+
+        if( aItem->IsConnectable() )
+            m_connectivityDirty = true;
     }
 }
 
@@ -205,6 +208,8 @@ void SCH_SCREEN::Clear( bool aFree )
         m_rtree.clear();
     }
 
+    m_connectivityDirty = true;
+
     // Clear the project settings
     m_virtualPageNumber = m_pageCount = 1;
 
@@ -225,6 +230,7 @@ void SCH_SCREEN::FreeDrawList()
             } );
 
     m_rtree.clear();
+    m_connectivityDirty = true;
 
     for( auto item : delete_list )
         delete item;
@@ -242,6 +248,9 @@ bool SCH_SCREEN::Remove( SCH_ITEM* aItem )
 {
     bool retv = m_rtree.remove( aItem );
 
+    if( retv && aItem->IsConnectable() )
+        m_connectivityDirty = true;
+
     // Check if the library symbol for the removed schematic symbol is still required.
     if( retv && aItem->Type() == SCH_COMPONENT_T )
     {
@@ -731,6 +740,9 @@ void SCH_SCREEN::UpdateLocalLibSymbolLinks()
         symbol->SetLibSymbol( libSymbol );
 
         m_rtree.insert( symbol );
+
+        // The pins were rebuilt from the new library symbol
+        m_connectivityDirty = true;
     }
 }
 
@@ -1354,31 +1366,15 @@ void SCH_SCREENS::TestDanglingEnds()
     for( SCH_SCREEN* screen = GetFirst(); screen; screen = GetNext() )
         screens.push_back( screen );
 
-    size_t parallelThreadCount = std::min<size_t>( std::thread::hardware_concurrency(),
-            screens.size() );
-
-    std::atomic<size_t> nextScreen( 0 );
-    std::vector<std::future<size_t>> returns( parallelThreadCount );
-
-    auto update_lambda = [&screens, &nextScreen]() -> size_t
-    {
-        for( auto i = nextScreen++; i < screens.size(); i = nextScreen++ )
-            screens[i]->TestDanglingEnds();
+    TASK_GROUP tasks;
 
-        return 1;
-    };
-
-    if( parallelThreadCount == 1 )
-        update_lambda();
-    else
-    {
-        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
-            returns[ii] = std::async( std::launch::async, update_lambda );
+    tasks.ParallelFor( screens.size(),
+            [&screens]( size_t aIndex )
+            {
+                screens[aIndex]->TestDanglingEnds();
+            } );
 
-        // Finalize the threads
-        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
-            returns[ii].wait();
-    }
+    tasks.Wait();
 }
 
 
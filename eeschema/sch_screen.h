@@ -116,6 +116,9 @@ private:
     int         m_modification_sync; // inequality with PART_LIBS::GetModificationHash() will
                                      //   trigger ResolveAll().
 
+    bool        m_connectivityDirty; // Connectable items were added or removed since the
+                                     //   connection graph last visited this screen.
+
     /// List of bus aliases stored in this screen
     std::unordered_set< std::shared_ptr< BUS_ALIAS > > m_aliases;
 
@@ -210,6 +213,15 @@ public:
 
     void Append( SCH_ITEM* aItem );
 
+    /**
+     * Connectable items were added to or removed from this screen since the flag was last
+     * cleared.  Used by #CONNECTION_GRAPH to only rebuild the item connectivity of the sheets
+     * that were edited; changes to items left in place are tracked by the items themselves
+     * (see SCH_ITEM::IsConnectivityDirty()).
+     */
+    bool IsConnectivityDirty() const { return m_connectivityDirty; }
+    void SetConnectivityDirty( bool aDirty = true ) { m_connectivityDirty = aDirty; }
+
     /**
      * Copy the contents of \a aScreen into this #SCH_SCREEN object.
      *
@@ -120,6 +120,12 @@ public:
      */
     bool m_CompactSave;
 
+    /**
+     * Save zone fills to a binary fill cache next to the board file rather than as
+     * filled_polygon lists in the board file itself
+     */
+    bool m_ZoneFillCache;
+
     /**
      * When true, strokes the triangulations with visible color
      */
@@ -42,6 +42,23 @@ struct KEYWORD
     const char* name;       ///< unique keyword.
     int         token;      ///< a zero based index into an array of KEYWORDs
 };
+
+
+/**
+ * Struct KEYWORD_HASH
+ * is a perfect hash of a KEYWORD table, generated along with the table by
+ * TokenList2DsnLexer.cmake.  A keyword whose hashes are ( h1, h2 ) (see
+ * DSNLEXER::findToken()) can only be in slot
+ * ( h2 + displacements[ h1 % bucketCount ] ) % slotCount, so a lookup costs one pass over
+ * the text and a single string compare.
+ */
+struct KEYWORD_HASH
+{
+    unsigned        bucketCount;    ///< count of displacements, a power of two
+    unsigned        slotCount;      ///< count of slots, a power of two
+    const short*    displacements;  ///< slot offset of each bucket
+    const short*    slots;          ///< token of the keyword in each slot, or -1
+};
 #endif
 
 // something like this macro can be used to help initialize a KEYWORD table.
@@ -104,13 +121,17 @@ protected:
 
     int                 prevTok;                ///< curTok from previous NextTok() call.
     int                 curOffset;              ///< offset within current line of the current token
+    int                 leftLineNumber;         ///< line number of the last DSN_LEFT, for CopyList()
+    int                 leftOffset;             ///< offset within its line of the last DSN_LEFT
 
     int                 curTok;                 ///< the current token obtained on last NextTok()
     std::string         curText;                ///< the text of the current token
 
     const KEYWORD*      keywords;               ///< table sorted by CMake for bsearch()
     unsigned            keywordCount;           ///< count of keywords table
-    KEYWORD_MAP         keyword_hash;           ///< fast, specialized "C string" hashtable
+    const KEYWORD_HASH* keywordPerfectHash;     ///< perfect hash of keywords, or NULL
+    KEYWORD_MAP         keyword_hash;           ///< fast, specialized "C string" hashtable,
+                                                ///< filled only without keywordPerfectHash
 
     void init();
 
@@ -169,9 +190,11 @@ public:
      * @param aKeywordCount is the count of tokens in aKeywordTable.
      * @param aFile is an open file, which will be closed when this is destructed.
      * @param aFileName is the name of the file
+     * @param aKeywordHash is an optional perfect hash of aKeywordTable.
      */
     DSNLEXER( const KEYWORD* aKeywordTable, unsigned aKeywordCount,
-              FILE* aFile, const wxString& aFileName );
+              FILE* aFile, const wxString& aFileName,
+              const KEYWORD_HASH* aKeywordHash = NULL );
 
     /**
      * Constructor ( const KEYWORD*, unsigned, const std::string&, const wxString& )
@@ -182,9 +205,11 @@ public:
      * @param aKeywordCount is the count of tokens in aKeywordTable.
      * @param aSExpression is text to feed through a STRING_LINE_READER
      * @param aSource is a description of aSExpression, used for error reporting.
+     * @param aKeywordHash is an optional perfect hash of aKeywordTable.
      */
     DSNLEXER( const KEYWORD* aKeywordTable, unsigned aKeywordCount,
-              const std::string& aSExpression, const wxString& aSource = wxEmptyString );
+              const std::string& aSExpression, const wxString& aSource = wxEmptyString,
+              const KEYWORD_HASH* aKeywordHash = NULL );
 
     /**
      * Constructor ( const std::string&, const wxString& )
@@ -209,9 +234,11 @@ public:
      *
      * @param aLineReader is any subclassed instance of LINE_READER, such as
      *  STRING_LINE_READER or FILE_LINE_READER.  No ownership is taken.
+     *
+     * @param aKeywordHash is an optional perfect hash of aKeywordTable.
      */
     DSNLEXER( const KEYWORD* aKeywordTable, unsigned aKeywordCount,
-              LINE_READER* aLineReader = NULL );
+              LINE_READER* aLineReader = NULL, const KEYWORD_HASH* aKeywordHash = NULL );
 
     virtual ~DSNLEXER();
 
@@ -398,6 +425,22 @@ public:
      */
     wxArrayString* ReadCommentLines();
 
+    /**
+     * Function CopyList
+     * copies the source text of the list whose opening '(' and first token were the last two
+     * tokens read, up to and including its closing ')', which becomes CurTok().  The copy can
+     * be parsed later, for instance on another thread, by a lexer reading from a
+     * STRING_LINE_READER started at the returned line number.  The first line of the copy is
+     * padded with blanks up to the '(' so that error offsets match the source too, and when
+     * the '(' is on an earlier line than the first token, the lines in between are left blank.
+     * Only available outside of specctraMode.
+     *
+     * @param aText receives the text of the list.
+     * @return int - the line number preceding the first line of the list.
+     * @throw IO_ERROR if the input ends before the list is closed.
+     */
+    int CopyList( std::string& aText );
+
     /**
      * Function IsSymbol
      * tests a token to see if it is a symbol.  This means it cannot be a
@@ -55,6 +55,8 @@
 #define TR_OP_METHOD_CALL 25
 #define TR_UOP_PUSH_VAR 1
 #define TR_UOP_PUSH_VALUE 2
+#define TR_UOP_JUMP_IF_FALSE 3
+#define TR_UOP_JUMP_IF_TRUE 4
 
 // This namespace is used for the lemon parser
 namespace LIBEVAL
@@ -136,6 +138,7 @@ public:
     int        op;
     TREE_NODE* leaf[2];
     UOP*       uop;
+    UOP*       jump;        // short-circuit jump over the right operand of && and ||
     bool       valid;
     bool       isTerminal;
     bool       isVisited;
@@ -262,6 +265,10 @@ public:
 class CONTEXT
 {
 public:
+    CONTEXT() :
+        m_usedValues( 0 )
+    {};
+
     virtual ~CONTEXT()
     {
         for( VALUE* value : m_ownedValues )
@@ -270,11 +277,28 @@ public:
 
     VALUE* AllocValue()
     {
-        VALUE* value = new VALUE();
-        m_ownedValues.push_back( value );
+        if( m_usedValues == m_ownedValues.size() )
+            m_ownedValues.push_back( new VALUE() );
+
+        VALUE* value = m_ownedValues[ m_usedValues++ ];
+        *value = VALUE();
         return value;
     }
 
+    /**
+     * Prepare the context for another evaluation.  The values of the previous evaluation
+     * (including its result) are recycled rather than freed.
+     */
+    void Reset()
+    {
+        m_usedValues = 0;
+
+        while( !m_stack.empty() )
+            m_stack.pop();
+
+        m_errorStatus = ERROR_STATUS();
+    }
+
     void Push( VALUE* v )
     {
         m_stack.push( v );
@@ -308,9 +332,10 @@ public:
     const ERROR_STATUS& GetError() const { return m_errorStatus; }
 
 private:
-    std::vector<VALUE*> m_ownedValues;
-    std::stack<VALUE*>  m_stack;
-    ERROR_STATUS        m_errorStatus;
+    std::vector<VALUE*>                     m_ownedValues;
+    size_t                                  m_usedValues;
+    std::stack<VALUE*, std::vector<VALUE*>> m_stack;
+    ERROR_STATUS                            m_errorStatus;
 
     std::function<void( const wxString& aMessage, int aOffset )> m_errorCallback;
 };
@@ -326,6 +351,13 @@ public:
         m_ucode.push_back(uop);
     }
 
+    size_t GetOpCount() const { return m_ucode.size(); }
+
+    /**
+     * Replace the last op by a constant if it is an operator applied to constants only.
+     */
+    void FoldConstants();
+
     VALUE* Run( CONTEXT* ctx );
     wxString Dump() const;
 
@@ -351,36 +383,50 @@ public:
     UOP( int op, std::unique_ptr<VALUE> value ) :
         m_op( op ),
         m_ref(nullptr),
-        m_value( std::move( value ) )
+        m_value( std::move( value ) ),
+        m_target( 0 )
     {};
 
     UOP( int op, std::unique_ptr<VAR_REF> vref ) :
         m_op( op ),
         m_ref( std::move( vref ) ),
-        m_value(nullptr)
+        m_value(nullptr),
+        m_target( 0 )
     {};
 
     UOP( int op, FUNC_CALL_REF func, std::unique_ptr<VAR_REF> vref = nullptr ) :
         m_op( op ),
         m_func( std::move( func ) ),
         m_ref( std::move( vref ) ),
-        m_value(nullptr)
+        m_value(nullptr),
+        m_target( 0 )
     {};
 
     ~UOP()
     {
     }
 
-    void Exec( CONTEXT* ctx );
+    /**
+     * @return true if execution continues at GetTarget() rather than at the next op.
+     */
+    bool Exec( CONTEXT* ctx );
 
     wxString Format() const;
 
+    int GetOp() const { return m_op; }
+
+    bool IsConstant() const { return m_op == TR_UOP_PUSH_VALUE && m_value; }
+
+    size_t GetTarget() const { return m_target; }
+    void SetTarget( size_t aTarget ) { m_target = aTarget; }
+
 private:
     int                      m_op;
 
     FUNC_CALL_REF            m_func;
     std::unique_ptr<VAR_REF> m_ref;
     std::unique_ptr<VALUE>   m_value;
+    size_t                   m_target;      // index of the next op when a jump is taken
 };
 
 class TOKENIZER
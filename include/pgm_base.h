@@ -46,6 +46,7 @@ class wxWindow;
 
 class COMMON_SETTINGS;
 class SETTINGS_MANAGER;
+class THREAD_POOL;
 
 /**
  *   A small class to handle the list of existing translations.
@@ -174,6 +175,12 @@ public:
 
     VTBL_ENTRY SETTINGS_MANAGER& GetSettingsManager() const { return *m_settings_manager; }
 
+    /**
+     * @return the thread pool shared by the program and all its kifaces, or nullptr before
+     *         InitPgm().  Each kiface registers it as its THREAD_POOL::GetInstance().
+     */
+    VTBL_ENTRY THREAD_POOL* GetThreadPool() const { return m_thread_pool.get(); }
+
     VTBL_ENTRY COMMON_SETTINGS* GetCommonSettings() const;
 
     VTBL_ENTRY void SetEditorName( const wxString& aFileName );
@@ -347,6 +354,8 @@ protected:
 
     std::unique_ptr<SETTINGS_MANAGER> m_settings_manager;
 
+    std::unique_ptr<THREAD_POOL> m_thread_pool;
+
     /// prevents multiple instances of a program from being run at the same time.
     wxSingleInstanceChecker* m_pgm_checker;
 
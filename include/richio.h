@@ -269,8 +269,12 @@ public:
      *
      * @param aSource describes the source of aString for error reporting purposes
      *  can be anything meaninful, such as wxT( "clipboard" ).
+     *
+     * @param aStartingLineNumber is the initial line number to report on error, for when
+     *  aString was taken from the middle of aSource.
      */
-    STRING_LINE_READER( const std::string& aString, const wxString& aSource );
+    STRING_LINE_READER( const std::string& aString, const wxString& aSource,
+                        unsigned aStartingLineNumber = 0 );
 
     /**
      * Constructor STRING_LINE_READER( const STRING_LINE_READER& )
@@ -284,6 +288,61 @@ public:
 };
 
 
+/**
+ * MAPPED_FILE_LINE_READER
+ * is a LINE_READER that maps a whole file into memory and hands out its lines from there,
+ * rather than pulling them one character at a time through stdio.
+ *
+ * The lines are still copied into the nul terminated line buffer of LINE_READER, but with a
+ * single memchr() and memcpy() each.  Unlike FILE_LINE_READER, the file is read in binary
+ * mode: "\r\n" line endings reach the caller unchanged, which is harmless for DSNLEXER.
+ * If the file cannot be mapped (e.g. on some network shares) it is read into memory instead.
+ *
+ * The mapping is not a snapshot: on POSIX systems, another process truncating the file while
+ * it is being read makes the reader crash with SIGBUS, rather than see a short file.  Keep
+ * readers short-lived, and use FILE_LINE_READER for files that may be rewritten meanwhile.
+ */
+class MAPPED_FILE_LINE_READER : public LINE_READER
+{
+protected:
+    const char*       m_data;       ///< start of the file contents
+    size_t            m_size;       ///< size of the file contents
+    size_t            m_ndx;        ///< offset of the next line in m_data
+    void*             m_mapping;    ///< platform handle of the mapping, or NULL
+    std::vector<char> m_buffer;     ///< file contents when mapping was not possible
+
+public:
+
+    /**
+     * Constructor MAPPED_FILE_LINE_READER
+     * opens and maps @a aFileName.
+     *
+     * @param aFileName is the name of the file to open and to use for error reporting purposes.
+     * @param aStartingLineNumber is the initial line number to report on error.
+     * @param aMaxLineLength is the maximum length of a line.
+     *
+     * @throw IO_ERROR if @a aFileName cannot be opened or read.
+     */
+    MAPPED_FILE_LINE_READER( const wxString& aFileName,
+            unsigned aStartingLineNumber = 0,
+            unsigned aMaxLineLength = LINE_READER_LINE_DEFAULT_MAX );
+
+    ~MAPPED_FILE_LINE_READER();
+
+    char* ReadLine() override;
+
+    /**
+     * Function Rewind
+     * goes back to the start of the file and resets the line number back to zero.
+     */
+    void Rewind()
+    {
+        m_ndx = 0;
+        m_lineNum = 0;
+    }
+};
+
+
 /**
  * INPUTSTREAM_LINE_READER
  * is a LINE_READER that reads from a wxInputStream object.
@@ -130,6 +130,7 @@ extern const std::string ArchiveFileExtension;
 extern const std::string LegacyPcbFileExtension;
 extern const std::string KiCadPcbFileExtension;
 #define PcbFileExtension    KiCadPcbFileExtension       // symlink choice
+extern const std::string ZoneFillCacheFileExtension;
 extern const std::string KiCadSymbolLibFileExtension;
 extern const std::string PageLayoutDescrFileExtension;
 extern const std::string DesignRulesFileExtension;
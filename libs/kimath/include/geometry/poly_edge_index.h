@@ -0,0 +1,103 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef __POLY_EDGE_INDEX_H
+#define __POLY_EDGE_INDEX_H
+
+#include <vector>
+
+#include <geometry/seg.h>
+#include <geometry/shape_line_chain.h>
+#include <math/vector2d.h>
+
+/**
+ * Class POLY_EDGE_INDEX
+ *
+ * A bounding volume hierarchy over the edges of a single polygon (its outline and holes),
+ * answering point-in-polygon and nearest-edge queries without visiting every edge.
+ *
+ * The index only stores contour and segment indices, so it doesn't hold on to the polygon: the
+ * polygon it was built from must be passed to every query, unmodified.  It is built by
+ * SHAPE_POLY_SET::CacheEdgeIndex() and used transparently by SHAPE_POLY_SET's queries.
+ */
+class POLY_EDGE_INDEX
+{
+public:
+    typedef std::vector<SHAPE_LINE_CHAIN> POLYGON;
+
+    POLY_EDGE_INDEX( const POLYGON& aPolygon );
+
+    /**
+     * Same result as SHAPE_POLY_SET::containsSingle(): aP is inside the outline (or within
+     * aAccuracy of its edge) and not strictly inside any hole.
+     */
+    bool Contains( const POLYGON& aPolygon, const VECTOR2I& aP, int aAccuracy ) const;
+
+    /**
+     * @return the squared distance from aP to the closest edge of any contour, or
+     *         VECTOR2I::ECOORD_MAX if the polygon has no edges.
+     */
+    SEG::ecoord SquaredEdgeDistance( const POLYGON& aPolygon, const VECTOR2I& aP,
+                                     VECTOR2I* aNearest ) const;
+
+    /**
+     * @return the squared distance from aSeg to the closest edge of any contour, or
+     *         VECTOR2I::ECOORD_MAX if the polygon has no edges.
+     */
+    SEG::ecoord SquaredEdgeDistance( const POLYGON& aPolygon, const SEG& aSeg,
+                                     VECTOR2I* aNearest ) const;
+
+private:
+    struct EDGE
+    {
+        int m_contour;
+        int m_segment;
+    };
+
+    /**
+     * Leaves reference m_count edges starting at m_first; internal nodes (m_count == 0) are
+     * followed by their first child, and m_first holds the index of their second child.
+     */
+    struct NODE
+    {
+        int m_minX;
+        int m_minY;
+        int m_maxX;
+        int m_maxY;
+        int m_first;
+        int m_count;
+    };
+
+    int build( const POLYGON& aPolygon, int aFirst, int aLast );
+
+    bool nearContourEdge( const POLYGON& aPolygon, int aContour, const VECTOR2I& aP,
+                          int aAccuracy ) const;
+
+    std::vector<EDGE> m_edges;
+    std::vector<NODE> m_nodes;
+
+    /// Contours which can contain points at all: closed, with at least 3 points.
+    std::vector<bool> m_solid;
+};
+
+#endif // __POLY_EDGE_INDEX_H
@@ -0,0 +1,135 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef __SEG_BATCH_H
+#define __SEG_BATCH_H
+
+#include <cstdint>
+#include <vector>
+
+#include <geometry/seg.h>
+#include <math/vector2d.h>
+
+/**
+ * Class SEG_BATCH
+ *
+ * A packed (structure of arrays) list of segments, for testing one segment, point or circle
+ * against many candidates at once.
+ *
+ * The queries first compute bounds on the distance to every candidate with SSE2 or AVX (or
+ * plain scalar code when neither is available), in double precision.  Those bounds are wide
+ * enough to cover the rounding of SEG::NearestPoint(), so most candidates are settled without
+ * any integer math; the few whose bounds straddle the threshold are handed to the scalar SEG
+ * routines.  The results are therefore exactly the ones of the equivalent scalar loop.
+ */
+class SEG_BATCH
+{
+public:
+    SEG_BATCH() {}
+
+    void Clear();
+
+    void Reserve( size_t aCount );
+
+    /**
+     * Appends a segment.
+     *
+     * @param aExtra is added to the clearance of every query against this segment (typically
+     *               half the width of a track).
+     */
+    void Add( const SEG& aSeg, int aExtra = 0 );
+
+    size_t Size() const
+    {
+        return m_ax.size();
+    }
+
+    const SEG GetSeg( size_t aIndex ) const
+    {
+        return SEG( m_ax[aIndex], m_ay[aIndex], m_bx[aIndex], m_by[aIndex] );
+    }
+
+    int GetExtra( size_t aIndex ) const
+    {
+        return m_extra[aIndex];
+    }
+
+    /**
+     * Finds the segments for which aSeg.Collide( GetSeg( i ), aClearance + GetExtra( i ) )
+     * is true.
+     *
+     * @param aHits if not null, receives the indices of all colliding segments in ascending
+     *              order.  Otherwise the search stops at the first collision.
+     * @return true if any segment collides.
+     */
+    bool Collide( const SEG& aSeg, int aClearance, std::vector<int>* aHits = nullptr ) const;
+
+    /**
+     * Same as Collide( SEG ), for a circle: the test of each segment matches
+     * SHAPE_CIRCLE( aCenter, aRadius ).Collide( GetSeg( i ), aClearance + GetExtra( i ) ).
+     */
+    bool Collide( const VECTOR2I& aCenter, int aRadius, int aClearance,
+                  std::vector<int>* aHits = nullptr ) const;
+
+    /**
+     * @return the smallest GetSeg( i ).SquaredDistance( aSeg ), or VECTOR2I::ECOORD_MAX if
+     *         the batch is empty.
+     * @param aIndex if not null, receives the index of the (first) closest segment, or -1.
+     */
+    SEG::ecoord SquaredDistance( const SEG& aSeg, int* aIndex = nullptr ) const;
+
+    /**
+     * @return the smallest GetSeg( i ).SquaredDistance( aP ), or VECTOR2I::ECOORD_MAX if
+     *         the batch is empty.
+     * @param aIndex if not null, receives the index of the (first) closest segment, or -1.
+     */
+    SEG::ecoord SquaredDistance( const VECTOR2I& aP, int* aIndex = nullptr ) const;
+
+    /**
+     * Name of the instruction set used by the kernels ("AVX", "SSE2" or "scalar").
+     */
+    static const char* KernelName();
+
+private:
+    template <typename TEST>
+    bool collide( const SEG& aQuery, bool aPoint, int aClearance, std::vector<int>* aHits,
+                  TEST aScalarTest ) const;
+
+    template <typename DIST>
+    SEG::ecoord minDistance( const SEG& aQuery, bool aPoint, int* aIndex,
+                             DIST aScalarDistance ) const;
+
+    void bounds( const SEG& aQuery, bool aPoint, size_t aFirst, size_t aCount, double* aLo,
+                 double* aHi ) const;
+
+    std::vector<int32_t> m_ax;
+    std::vector<int32_t> m_ay;
+    std::vector<int32_t> m_bx;
+    std::vector<int32_t> m_by;
+    std::vector<int32_t> m_extra;
+
+    ///> Segments whose coordinates are too large for the estimates; always tested exactly.
+    std::vector<uint8_t> m_wide;
+};
+
+#endif // __SEG_BATCH_H
@@ -125,15 +125,12 @@ public:
 
         for( auto pt : aV )
             m_points.emplace_back( pt.x, pt.y );
-
-        m_shapes = std::vector<ssize_t>( aV.size(), ssize_t( SHAPE_IS_PT ) );
     }
 
     SHAPE_LINE_CHAIN( const std::vector<VECTOR2I>& aV, bool aClosed = false )
             : SHAPE_LINE_CHAIN_BASE( SH_LINE_CHAIN ), m_closed( aClosed ), m_width( 0 )
     {
         m_points = aV;
-        m_shapes = std::vector<ssize_t>( aV.size(), ssize_t( SHAPE_IS_PT ) );
     }
 
     SHAPE_LINE_CHAIN( const SHAPE_ARC& aArc, bool aClosed = false )
@@ -152,7 +149,6 @@ public:
         m_width( 0 )
     {
         m_points.reserve( aPath.size() );
-        m_shapes = std::vector<ssize_t>( aPath.size(), ssize_t( SHAPE_IS_PT ) );
 
         for( const auto& point : aPath )
             m_points.emplace_back( point.X, point.Y );
@@ -297,7 +293,7 @@ public:
 
         m_points[aIndex] = aPos;
 
-        if( m_shapes[aIndex] != SHAPE_IS_PT )
+        if( isArc( aIndex ) )
             convertArc( m_shapes[aIndex] );
     }
 
@@ -340,10 +336,13 @@ public:
     }
 
     /**
-     * @return the vector of values indicating shape type and location
+     * @return the vector of values indicating shape type and location, one per point
      */
-    const std::vector<ssize_t>& CShapes() const
+    std::vector<ssize_t> CShapes() const
     {
+        if( m_shapes.empty() )
+            return std::vector<ssize_t>( m_points.size(), ssize_t( SHAPE_IS_PT ) );
+
         return m_shapes;
     }
 
@@ -430,7 +429,10 @@ public:
         if( m_points.size() == 0 || aAllowDuplication || CPoint( -1 ) != aP )
         {
             m_points.push_back( aP );
-            m_shapes.push_back( ssize_t( SHAPE_IS_PT ) );
+
+            if( !m_shapes.empty() )
+                m_shapes.push_back( ssize_t( SHAPE_IS_PT ) );
+
             m_bbox.Merge( aP );
         }
     }
@@ -728,6 +730,27 @@ private:
 
     constexpr static ssize_t SHAPE_IS_PT = -1;
 
+    /**
+     * Give every point an entry in m_shapes, before the first arc point is stored.
+     */
+    void expandShapes()
+    {
+        if( m_shapes.empty() )
+            m_shapes.assign( m_points.size(), ssize_t( SHAPE_IS_PT ) );
+    }
+
+    /**
+     * Release m_shapes once the chain no longer contains any arc.
+     */
+    void compactShapes()
+    {
+        if( m_arcs.empty() )
+        {
+            m_shapes.clear();
+            m_shapes.shrink_to_fit();
+        }
+    }
+
     /// array of vertices
     std::vector<VECTOR2I> m_points;
 
@@ -735,6 +758,9 @@ private:
      * Array of indices that refer to the index of the shape if the point is part of a larger
      * shape, e.g. arc or spline.
      * If the value is -1, the point is just a point.
+     *
+     * Most chains (zone fills in particular) hold no arcs at all, so the array is left empty
+     * until the first arc is added and is then kept the same size as m_points.
      */
     std::vector<ssize_t> m_shapes;
 
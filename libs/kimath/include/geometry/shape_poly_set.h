@@ -26,10 +26,12 @@
 #ifndef __SHAPE_POLY_SET_H
 #define __SHAPE_POLY_SET_H
 
+#include <cstdint>
 #include <cstdio>
 #include <deque>                        // for deque
 #include <vector>                       // for vector
 #include <iosfwd>                       // for string, stringstream
+#include <map>
 #include <memory>
 #include <set>                          // for set
 #include <stdexcept>                    // for out_of_range
@@ -44,6 +46,8 @@
 #include <math/vector2d.h>              // for VECTOR2I
 #include <md5_hash.h>
 
+class POLY_EDGE_INDEX;
+
 
 /**
  * SHAPE_POLY_SET
@@ -637,6 +641,7 @@ class SHAPE_POLY_SET : public SHAPE
         ///> Returns the reference to aIndex-th outline in the set
         SHAPE_LINE_CHAIN& Outline( int aIndex )
         {
+            m_edgeIndexValid = false;
             return m_polys[aIndex][0];
         }
 
@@ -659,12 +664,14 @@ class SHAPE_POLY_SET : public SHAPE
         ///> Returns the reference to aHole-th hole in the aIndex-th outline
         SHAPE_LINE_CHAIN& Hole( int aOutline, int aHole )
         {
+            m_edgeIndexValid = false;
             return m_polys[aOutline][aHole + 1];
         }
 
         ///> Returns the aIndex-th subpolygon in the set
         POLYGON& Polygon( int aIndex )
         {
+            m_edgeIndexValid = false;
             return m_polys[aIndex];
         }
 
@@ -928,6 +935,25 @@ class SHAPE_POLY_SET : public SHAPE
         void BooleanIntersection( const SHAPE_POLY_SET& a, const SHAPE_POLY_SET& b,
                                   POLYGON_MODE aFastMode );
 
+        /**
+         * Parallel versions of BooleanAdd(), BooleanSubtract() and BooleanIntersection().
+         *
+         * The polygons of both operands are split into groups whose bounding boxes don't touch
+         * each other's, and each group gets its own Clipper pass on the shared thread pool.
+         * Polygons of different groups can't interact, so the result holds the same polygons
+         * as the serial call, possibly in a different order.  The one exception is that Clipper
+         * snaps intersection points to the scanlines of its whole input, so an intersection may
+         * occasionally be rounded 1 unit differently.
+         *
+         * There's nothing to gain when one polygon overlaps everything else (such as a single
+         * zone outline); the serial path is used then, as well as for small sets.  Splitting
+         * also pays off on a single core, as a Clipper pass over many disjoint polygons scales
+         * worse than linearly.
+         */
+        void ParallelBooleanAdd( const SHAPE_POLY_SET& b, POLYGON_MODE aFastMode );
+        void ParallelBooleanSubtract( const SHAPE_POLY_SET& b, POLYGON_MODE aFastMode );
+        void ParallelBooleanIntersection( const SHAPE_POLY_SET& b, POLYGON_MODE aFastMode );
+
         enum CORNER_STRATEGY    ///< define how inflate transform build inflated polygon
         {
             ALLOW_ACUTE_CORNERS,    ///< just inflate the polygon. Acute angles create spikes
@@ -961,6 +987,11 @@ class SHAPE_POLY_SET : public SHAPE
             Inflate( -aAmount, aCircleSegmentsCount, aCornerStrategy );
         }
 
+        ///> Parallel version of Inflate(), grouping polygons whose inflated bounding boxes
+        ///> touch.  See ParallelBooleanAdd().
+        void ParallelInflate( int aAmount, int aCircleSegmentsCount,
+                              CORNER_STRATEGY aCornerStrategy = ROUND_ALL_CORNERS );
+
         /**
          * Performs outline inflation/deflation, using round corners.  Polygons can have holes,
          * and/or linked holes with main outlines.  The resulting polygons are laso polygons with
@@ -973,6 +1004,10 @@ class SHAPE_POLY_SET : public SHAPE
         ///> For aFastMode meaning, see function booleanOp
         void Fracture( POLYGON_MODE aFastMode );
 
+        ///> Parallel version of Fracture(): simplifies with ParallelSimplify() and fractures
+        ///> each polygon as a separate task.
+        void ParallelFracture( POLYGON_MODE aFastMode );
+
         ///> Converts a single outline slitted ("fractured") polygon into a set ouf outlines
         ///> with holes.
         void Unfracture( POLYGON_MODE aFastMode );
@@ -988,6 +1023,21 @@ class SHAPE_POLY_SET : public SHAPE
         ///> For aFastMode meaning, see function booleanOp
         void Simplify( POLYGON_MODE aFastMode );
 
+        ///> Parallel version of Simplify().  See ParallelBooleanAdd().
+        void ParallelSimplify( POLYGON_MODE aFastMode );
+
+        /**
+         * Merges all polygons of the set like Simplify(), but scales better with sets of many
+         * small, overlapping polygons such as pad and track clearances.
+         *
+         * The polygons are sorted along a Z-order curve and merged in small batches.  The batches
+         * are then merged pairwise, level by level, each step only passing to Clipper the
+         * polygons lying near the other batch.  The steps of each level run on the thread pool.
+         * The result covers the same area as Simplify() but intersections can be rounded
+         * differently.
+         */
+        void CascadedUnion( POLYGON_MODE aFastMode );
+
         /**
          * Function NormalizeAreaOutlines
          * Convert a self-intersecting polygon to one (or more) non self-intersecting polygon(s)
@@ -1329,6 +1379,22 @@ class SHAPE_POLY_SET : public SHAPE
         void booleanOp( ClipperLib::ClipType aType, const SHAPE_POLY_SET& aShape,
                         const SHAPE_POLY_SET& aOtherShape, POLYGON_MODE aFastMode );
 
+        /**
+         * Splits the polygons of this set and of aOther into batches for parallel processing.
+         * Polygons whose bounding boxes, grown by aMargin, touch end up in the same batch;
+         * polygon indices past OutlineCount() refer to aOther.
+         *
+         * @param aNeedSubject drops the groups without any polygon of this set.
+         * @param aNeedOther drops the groups without any polygon of aOther.
+         * @return no batch at all when the work isn't worth splitting.
+         */
+        std::vector<std::vector<int>> parallelBatches( const SHAPE_POLY_SET& aOther, int aMargin,
+                                                       bool aNeedSubject,
+                                                       bool aNeedOther ) const;
+
+        void parallelBooleanOp( ClipperLib::ClipType aType, const SHAPE_POLY_SET& aOtherShape,
+                                POLYGON_MODE aFastMode );
+
         /**
          * containsSingle function
          * Checks whether the point aP is inside the aSubpolyIndex-th polygon of the polyset. If
@@ -1386,9 +1452,26 @@ class SHAPE_POLY_SET : public SHAPE
 
         SHAPE_POLY_SET& operator=( const SHAPE_POLY_SET& );
 
+        /**
+         * Triangulates the polygon set, unless the triangulation is already up to date.
+         *
+         * @param aPartition: cut sets larger than a partition cell into a grid of cells aligned
+         * on absolute coordinates.  Each cell is triangulated independently (in parallel), and
+         * only the cells whose content changed since the previous call (even through an
+         * assignment of another polygon set) are triangulated again.
+         */
         void CacheTriangulation( bool aPartition = true );
         bool IsTriangulationUpToDate() const;
 
+        /**
+         * Builds spatial indexes of the edges of large polygons, making Contains(), Collide()
+         * and SquaredDistance() sublinear in the number of edges.
+         *
+         * The indexes are used until the polygon set is next modified (including through the
+         * non-const accessors), and are only rebuilt by a later call if the checksum changed.
+         */
+        void CacheEdgeIndex();
+
         MD5_HASH GetHash() const;
 
         virtual bool HasIndexableSubshapes() const override;
@@ -1401,10 +1484,44 @@ class SHAPE_POLY_SET : public SHAPE
 
         MD5_HASH checksum() const;
 
-        std::vector<std::unique_ptr<TRIANGULATED_POLYGON>> m_triangulatedPolys;
+        /**
+         * A partition cell of the triangulation.  The key (a hash of the edges touching the cell
+         * and the winding number at its corner) determines the part of the polygon set inside
+         * the cell, so the triangles can be reused as long as the key doesn't change.
+         */
+        struct TRIANGULATION_CELL
+        {
+            uint64_t m_edgeHash[2] = { 0, 0 };
+            int      m_edgeCount = 0;
+            int      m_winding = 0;
+
+            std::vector<std::shared_ptr<TRIANGULATED_POLYGON>> m_polys;
+
+            bool SameContent( const TRIANGULATION_CELL& aOther ) const
+            {
+                return m_edgeHash[0] == aOther.m_edgeHash[0]
+                       && m_edgeHash[1] == aOther.m_edgeHash[1]
+                       && m_edgeCount == aOther.m_edgeCount && m_winding == aOther.m_winding;
+            }
+        };
+
+        typedef std::map<std::pair<int, int>, TRIANGULATION_CELL> TRIANGULATION_CELLS;
+
+        void cacheCellTriangulation( const BOX2I& aBBox );
+
+        std::vector<std::shared_ptr<TRIANGULATED_POLYGON>> m_triangulatedPolys;
         bool m_triangulationValid = false;
         MD5_HASH m_hash;
 
+        ///> Triangulated partition cells, keyed by their position on the grid.  Kept when the
+        ///> set is assigned an untriangulated one, to be reused by the next CacheTriangulation().
+        TRIANGULATION_CELLS m_triangulationCells;
+
+        ///> Edge indexes of the polygons, or nullptr for polygons too small to need one
+        std::vector<std::unique_ptr<POLY_EDGE_INDEX>> m_edgeIndices;
+        bool     m_edgeIndexValid = false;
+        MD5_HASH m_edgeIndexHash;
+
 };
 
 #endif
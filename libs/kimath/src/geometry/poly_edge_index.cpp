@@ -0,0 +1,389 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+
+#include <geometry/poly_edge_index.h>
+#include <math/util.h>      // for rescale
+
+
+/// Maximum number of edges in a leaf node.
+static const int LEAF_SIZE = 8;
+
+/// Traversal stack size.  Nodes are split at the median, so the tree depth is about
+/// log2( edges / LEAF_SIZE ) and each level adds at most one pending node.
+static const int MAX_DEPTH = 64;
+
+
+static SEG::ecoord squaredDistance( int aMinX, int aMinY, int aMaxX, int aMaxY,
+                                    const VECTOR2I& aP )
+{
+    SEG::ecoord dx = std::max<SEG::ecoord>( { 0, (SEG::ecoord) aMinX - aP.x,
+                                              (SEG::ecoord) aP.x - aMaxX } );
+    SEG::ecoord dy = std::max<SEG::ecoord>( { 0, (SEG::ecoord) aMinY - aP.y,
+                                              (SEG::ecoord) aP.y - aMaxY } );
+
+    return dx * dx + dy * dy;
+}
+
+
+static SEG::ecoord squaredDistance( int aMinX, int aMinY, int aMaxX, int aMaxY,
+                                    const BOX2I& aBox )
+{
+    SEG::ecoord dx = std::max<SEG::ecoord>( { 0, (SEG::ecoord) aMinX - aBox.GetRight(),
+                                              (SEG::ecoord) aBox.GetLeft() - aMaxX } );
+    SEG::ecoord dy = std::max<SEG::ecoord>( { 0, (SEG::ecoord) aMinY - aBox.GetBottom(),
+                                              (SEG::ecoord) aBox.GetTop() - aMaxY } );
+
+    return dx * dx + dy * dy;
+}
+
+
+POLY_EDGE_INDEX::POLY_EDGE_INDEX( const POLYGON& aPolygon )
+{
+    for( int contour = 0; contour < (int) aPolygon.size(); contour++ )
+    {
+        const SHAPE_LINE_CHAIN& chain = aPolygon[contour];
+
+        m_solid.push_back( chain.IsClosed() && chain.PointCount() >= 3 );
+
+        for( int segment = 0; segment < chain.SegmentCount(); segment++ )
+            m_edges.push_back( { contour, segment } );
+    }
+
+    if( !m_edges.empty() )
+    {
+        m_nodes.reserve( 2 * m_edges.size() / LEAF_SIZE + 1 );
+        build( aPolygon, 0, m_edges.size() );
+    }
+}
+
+
+int POLY_EDGE_INDEX::build( const POLYGON& aPolygon, int aFirst, int aLast )
+{
+    int  index = m_nodes.size();
+    NODE node = { INT_MAX, INT_MAX, INT_MIN, INT_MIN, aFirst, aLast - aFirst };
+
+    // Bounds of the edges, and of their (doubled) centers to pick the split axis
+    int64_t cMinX = INT64_MAX, cMinY = INT64_MAX, cMaxX = INT64_MIN, cMaxY = INT64_MIN;
+
+    for( int ii = aFirst; ii < aLast; ii++ )
+    {
+        const SEG s = aPolygon[m_edges[ii].m_contour].CSegment( m_edges[ii].m_segment );
+
+        node.m_minX = std::min( { node.m_minX, s.A.x, s.B.x } );
+        node.m_minY = std::min( { node.m_minY, s.A.y, s.B.y } );
+        node.m_maxX = std::max( { node.m_maxX, s.A.x, s.B.x } );
+        node.m_maxY = std::max( { node.m_maxY, s.A.y, s.B.y } );
+
+        int64_t cx = (int64_t) s.A.x + s.B.x;
+        int64_t cy = (int64_t) s.A.y + s.B.y;
+
+        cMinX = std::min( cMinX, cx );
+        cMinY = std::min( cMinY, cy );
+        cMaxX = std::max( cMaxX, cx );
+        cMaxY = std::max( cMaxY, cy );
+    }
+
+    m_nodes.push_back( node );
+
+    if( aLast - aFirst <= LEAF_SIZE )
+        return index;
+
+    bool splitX = cMaxX - cMinX >= cMaxY - cMinY;
+    int  mid = aFirst + ( aLast - aFirst ) / 2;
+
+    std::nth_element( m_edges.begin() + aFirst, m_edges.begin() + mid, m_edges.begin() + aLast,
+            [&]( const EDGE& aA, const EDGE& aB )
+            {
+                const SEG a = aPolygon[aA.m_contour].CSegment( aA.m_segment );
+                const SEG b = aPolygon[aB.m_contour].CSegment( aB.m_segment );
+
+                if( splitX )
+                    return (int64_t) a.A.x + a.B.x < (int64_t) b.A.x + b.B.x;
+                else
+                    return (int64_t) a.A.y + a.B.y < (int64_t) b.A.y + b.B.y;
+            } );
+
+    // The first child immediately follows its parent
+    build( aPolygon, aFirst, mid );
+    int second = build( aPolygon, mid, aLast );
+
+    m_nodes[index].m_first = second;
+    m_nodes[index].m_count = 0;
+
+    return index;
+}
+
+
+bool POLY_EDGE_INDEX::Contains( const POLYGON& aPolygon, const VECTOR2I& aP,
+                                int aAccuracy ) const
+{
+    if( m_nodes.empty() || !m_solid[0] )
+        return false;
+
+    // Same crossing test as SHAPE_LINE_CHAIN_BASE::PointInside(), but only for the edges
+    // spanning aP.y to the right of aP.  Parity is tracked per contour.
+    uint64_t          parityBits = 0;
+    std::vector<bool> parityExtra;
+
+    if( aPolygon.size() > 64 )
+        parityExtra.resize( aPolygon.size(), false );
+
+    int stack[MAX_DEPTH];
+    int sp = 0;
+
+    stack[sp++] = 0;
+
+    while( sp > 0 )
+    {
+        int         index = stack[--sp];
+        const NODE& node = m_nodes[index];
+
+        if( node.m_minY > aP.y || node.m_maxY <= aP.y || node.m_maxX <= aP.x )
+            continue;
+
+        if( node.m_count == 0 )
+        {
+            stack[sp++] = node.m_first;
+            stack[sp++] = index + 1;
+            continue;
+        }
+
+        for( int ii = node.m_first; ii < node.m_first + node.m_count; ii++ )
+        {
+            int contour = m_edges[ii].m_contour;
+
+            if( !m_solid[contour] )
+                continue;
+
+            const SEG      s = aPolygon[contour].CSegment( m_edges[ii].m_segment );
+            const VECTOR2I diff = s.B - s.A;
+
+            if( diff.y != 0 )
+            {
+                const int d = rescale( diff.x, ( aP.y - s.A.y ), diff.y );
+
+                if( ( ( s.A.y > aP.y ) != ( s.B.y > aP.y ) ) && ( aP.x - s.A.x < d ) )
+                {
+                    if( contour < 64 )
+                        parityBits ^= uint64_t( 1 ) << contour;
+                    else
+                        parityExtra[contour] = !parityExtra[contour];
+                }
+            }
+        }
+    }
+
+    auto inside =
+            [&]( int aContour )
+            {
+                if( aContour < 64 )
+                    return ( parityBits >> aContour ) & 1;
+                else
+                    return (uint64_t) parityExtra[aContour];
+            };
+
+    if( !inside( 0 ) && ( aAccuracy <= 1 || !nearContourEdge( aPolygon, 0, aP, aAccuracy ) ) )
+        return false;
+
+    for( int hole = 1; hole < (int) aPolygon.size(); hole++ )
+    {
+        if( inside( hole ) )
+            return false;
+    }
+
+    return true;
+}
+
+
+bool POLY_EDGE_INDEX::nearContourEdge( const POLYGON& aPolygon, int aContour,
+                                       const VECTOR2I& aP, int aAccuracy ) const
+{
+    // Same test as SHAPE_LINE_CHAIN_BASE::EdgeContainingPoint(), with a one unit margin on
+    // the node bounds to absorb rounding in SEG::Distance().
+    SEG::ecoord margin = SEG::Square( aAccuracy + 2 );
+
+    int stack[MAX_DEPTH];
+    int sp = 0;
+
+    stack[sp++] = 0;
+
+    while( sp > 0 )
+    {
+        int         index = stack[--sp];
+        const NODE& node = m_nodes[index];
+
+        if( squaredDistance( node.m_minX, node.m_minY, node.m_maxX, node.m_maxY, aP ) > margin )
+            continue;
+
+        if( node.m_count == 0 )
+        {
+            stack[sp++] = node.m_first;
+            stack[sp++] = index + 1;
+            continue;
+        }
+
+        for( int ii = node.m_first; ii < node.m_first + node.m_count; ii++ )
+        {
+            if( m_edges[ii].m_contour != aContour )
+                continue;
+
+            const SEG s = aPolygon[aContour].CSegment( m_edges[ii].m_segment );
+
+            if( s.A == aP || s.B == aP || s.Distance( aP ) <= aAccuracy + 1 )
+                return true;
+        }
+    }
+
+    return false;
+}
+
+
+SEG::ecoord POLY_EDGE_INDEX::SquaredEdgeDistance( const POLYGON& aPolygon, const VECTOR2I& aP,
+                                                  VECTOR2I* aNearest ) const
+{
+    SEG::ecoord best = VECTOR2I::ECOORD_MAX;
+
+    if( m_nodes.empty() )
+        return best;
+
+    int stack[MAX_DEPTH];
+    int sp = 0;
+
+    stack[sp++] = 0;
+
+    while( sp > 0 && best > 0 )
+    {
+        int         index = stack[--sp];
+        const NODE& node = m_nodes[index];
+
+        if( squaredDistance( node.m_minX, node.m_minY, node.m_maxX, node.m_maxY, aP ) >= best )
+            continue;
+
+        if( node.m_count == 0 )
+        {
+            const NODE& a = m_nodes[index + 1];
+            const NODE& b = m_nodes[node.m_first];
+
+            // Visit the closer child first, so that the farther one is more likely to be pruned
+            if( squaredDistance( a.m_minX, a.m_minY, a.m_maxX, a.m_maxY, aP )
+                    < squaredDistance( b.m_minX, b.m_minY, b.m_maxX, b.m_maxY, aP ) )
+            {
+                stack[sp++] = node.m_first;
+                stack[sp++] = index + 1;
+            }
+            else
+            {
+                stack[sp++] = index + 1;
+                stack[sp++] = node.m_first;
+            }
+
+            continue;
+        }
+
+        for( int ii = node.m_first; ii < node.m_first + node.m_count; ii++ )
+        {
+            const SEG   s = aPolygon[m_edges[ii].m_contour].CSegment( m_edges[ii].m_segment );
+            SEG::ecoord d = s.SquaredDistance( aP );
+
+            if( d < best )
+            {
+                best = d;
+
+                if( aNearest )
+                    *aNearest = s.NearestPoint( aP );
+            }
+        }
+    }
+
+    return best;
+}
+
+
+SEG::ecoord POLY_EDGE_INDEX::SquaredEdgeDistance( const POLYGON& aPolygon, const SEG& aSeg,
+                                                  VECTOR2I* aNearest ) const
+{
+    SEG::ecoord best = VECTOR2I::ECOORD_MAX;
+
+    if( m_nodes.empty() )
+        return best;
+
+    BOX2I segBox( aSeg.A, aSeg.B - aSeg.A );
+    segBox.Normalize();
+
+    int stack[MAX_DEPTH];
+    int sp = 0;
+
+    stack[sp++] = 0;
+
+    while( sp > 0 && best > 0 )
+    {
+        int         index = stack[--sp];
+        const NODE& node = m_nodes[index];
+
+        if( squaredDistance( node.m_minX, node.m_minY, node.m_maxX, node.m_maxY, segBox )
+                >= best )
+        {
+            continue;
+        }
+
+        if( node.m_count == 0 )
+        {
+            const NODE& a = m_nodes[index + 1];
+            const NODE& b = m_nodes[node.m_first];
+
+            if( squaredDistance( a.m_minX, a.m_minY, a.m_maxX, a.m_maxY, segBox )
+                    < squaredDistance( b.m_minX, b.m_minY, b.m_maxX, b.m_maxY, segBox ) )
+            {
+                stack[sp++] = node.m_first;
+                stack[sp++] = index + 1;
+            }
+            else
+            {
+                stack[sp++] = index + 1;
+                stack[sp++] = node.m_first;
+            }
+
+            continue;
+        }
+
+        for( int ii = node.m_first; ii < node.m_first + node.m_count; ii++ )
+        {
+            const SEG   s = aPolygon[m_edges[ii].m_contour].CSegment( m_edges[ii].m_segment );
+            SEG::ecoord d = s.SquaredDistance( aSeg );
+
+            if( d < best )
+            {
+                best = d;
+
+                if( aNearest )
+                    *aNearest = s.NearestPoint( aSeg );
+            }
+        }
+    }
+
+    return best;
+}
@@ -0,0 +1,503 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include <geometry/seg_batch.h>
+
+#if defined( __AVX__ )
+#include <immintrin.h>
+#elif defined( __SSE2__ )
+#include <emmintrin.h>
+#endif
+
+
+/// Segments with a coordinate outside +/- COORD_LIMIT are always tested by the scalar code:
+/// below it all coordinate differences fit an int, as they do in SEG's own math.
+static const int COORD_LIMIT = 1 << 30;
+
+/// How far the scalar distance can be from the estimate.  SEG::NearestPoint() rounds each
+/// coordinate of the projection by less than one unit (so the distance by less than sqrt(2));
+/// the double precision error of the estimate is orders of magnitude below that.
+static const double ESTIMATE_MARGIN = 4.0;
+
+/// Products above this may not be exact in double precision.
+static const double EXACT_LIMIT = 9007199254740992.0;     // 2^53
+
+/// Number of candidates whose bounds are computed at once.
+static const size_t CHUNK_SIZE = 256;
+
+
+namespace
+{
+
+/**
+ * Thin wrappers over the double precision instructions used by the kernel, so it can be
+ * written once for every instruction set.
+ */
+struct LANES_SCALAR
+{
+    typedef double REG;
+    typedef bool   MASK;
+
+    static const int N = 1;
+
+    static REG  Load( const int32_t* aPtr ) { return *aPtr; }
+    static REG  Set( double aValue ) { return aValue; }
+    static void Store( double* aPtr, REG aValue ) { *aPtr = aValue; }
+
+    static REG Add( REG a, REG b ) { return a + b; }
+    static REG Sub( REG a, REG b ) { return a - b; }
+    static REG Mul( REG a, REG b ) { return a * b; }
+    static REG Div( REG a, REG b ) { return a / b; }
+    static REG Min( REG a, REG b ) { return std::min( a, b ); }
+    static REG Max( REG a, REG b ) { return std::max( a, b ); }
+    static REG Sqrt( REG a ) { return std::sqrt( a ); }
+    static REG Abs( REG a ) { return std::fabs( a ); }
+
+    static MASK Gt( REG a, REG b ) { return a > b; }
+    static MASK Lt( REG a, REG b ) { return a < b; }
+    static MASK Eq( REG a, REG b ) { return a == b; }
+    static MASK Ge( REG a, REG b ) { return a >= b; }
+    static MASK And( MASK a, MASK b ) { return a && b; }
+    static MASK Or( MASK a, MASK b ) { return a || b; }
+    static REG  Select( MASK m, REG a, REG b ) { return m ? a : b; }
+};
+
+
+#if defined( __AVX__ )
+
+struct LANES_SIMD
+{
+    typedef __m256d REG;
+    typedef __m256d MASK;
+
+    static const int N = 4;
+
+    static REG Load( const int32_t* aPtr )
+    {
+        return _mm256_cvtepi32_pd( _mm_loadu_si128( (const __m128i*) aPtr ) );
+    }
+
+    static REG  Set( double aValue ) { return _mm256_set1_pd( aValue ); }
+    static void Store( double* aPtr, REG aValue ) { _mm256_storeu_pd( aPtr, aValue ); }
+
+    static REG Add( REG a, REG b ) { return _mm256_add_pd( a, b ); }
+    static REG Sub( REG a, REG b ) { return _mm256_sub_pd( a, b ); }
+    static REG Mul( REG a, REG b ) { return _mm256_mul_pd( a, b ); }
+    static REG Div( REG a, REG b ) { return _mm256_div_pd( a, b ); }
+    static REG Min( REG a, REG b ) { return _mm256_min_pd( a, b ); }
+    static REG Max( REG a, REG b ) { return _mm256_max_pd( a, b ); }
+    static REG Sqrt( REG a ) { return _mm256_sqrt_pd( a ); }
+    static REG Abs( REG a ) { return _mm256_andnot_pd( _mm256_set1_pd( -0.0 ), a ); }
+
+    static MASK Gt( REG a, REG b ) { return _mm256_cmp_pd( a, b, _CMP_GT_OQ ); }
+    static MASK Lt( REG a, REG b ) { return _mm256_cmp_pd( a, b, _CMP_LT_OQ ); }
+    static MASK Eq( REG a, REG b ) { return _mm256_cmp_pd( a, b, _CMP_EQ_OQ ); }
+    static MASK Ge( REG a, REG b ) { return _mm256_cmp_pd( a, b, _CMP_GE_OQ ); }
+    static MASK And( MASK a, MASK b ) { return _mm256_and_pd( a, b ); }
+    static MASK Or( MASK a, MASK b ) { return _mm256_or_pd( a, b ); }
+    static REG  Select( MASK m, REG a, REG b ) { return _mm256_blendv_pd( b, a, m ); }
+};
+
+#define SEG_BATCH_KERNEL "AVX"
+
+#elif defined( __SSE2__ )
+
+struct LANES_SIMD
+{
+    typedef __m128d REG;
+    typedef __m128d MASK;
+
+    static const int N = 2;
+
+    static REG Load( const int32_t* aPtr )
+    {
+        return _mm_cvtepi32_pd( _mm_loadl_epi64( (const __m128i*) aPtr ) );
+    }
+
+    static REG  Set( double aValue ) { return _mm_set1_pd( aValue ); }
+    static void Store( double* aPtr, REG aValue ) { _mm_storeu_pd( aPtr, aValue ); }
+
+    static REG Add( REG a, REG b ) { return _mm_add_pd( a, b ); }
+    static REG Sub( REG a, REG b ) { return _mm_sub_pd( a, b ); }
+    static REG Mul( REG a, REG b ) { return _mm_mul_pd( a, b ); }
+    static REG Div( REG a, REG b ) { return _mm_div_pd( a, b ); }
+    static REG Min( REG a, REG b ) { return _mm_min_pd( a, b ); }
+    static REG Max( REG a, REG b ) { return _mm_max_pd( a, b ); }
+    static REG Sqrt( REG a ) { return _mm_sqrt_pd( a ); }
+    static REG Abs( REG a ) { return _mm_andnot_pd( _mm_set1_pd( -0.0 ), a ); }
+
+    static MASK Gt( REG a, REG b ) { return _mm_cmpgt_pd( a, b ); }
+    static MASK Lt( REG a, REG b ) { return _mm_cmplt_pd( a, b ); }
+    static MASK Eq( REG a, REG b ) { return _mm_cmpeq_pd( a, b ); }
+    static MASK Ge( REG a, REG b ) { return _mm_cmpge_pd( a, b ); }
+    static MASK And( MASK a, MASK b ) { return _mm_and_pd( a, b ); }
+    static MASK Or( MASK a, MASK b ) { return _mm_or_pd( a, b ); }
+
+    static REG Select( MASK m, REG a, REG b )
+    {
+        return _mm_or_pd( _mm_and_pd( m, a ), _mm_andnot_pd( m, b ) );
+    }
+};
+
+#define SEG_BATCH_KERNEL "SSE2"
+
+#else
+
+typedef LANES_SCALAR LANES_SIMD;
+
+#define SEG_BATCH_KERNEL "scalar"
+
+#endif
+
+
+/**
+ * Squared distance from aP to the segment starting at aA with direction aD, without rounding
+ * the projection.
+ */
+template <typename L>
+typename L::REG pointSegment( typename L::REG aPx, typename L::REG aPy, typename L::REG aAx,
+                              typename L::REG aAy, typename L::REG aDx, typename L::REG aDy )
+{
+    typedef typename L::REG REG;
+
+    REG px = L::Sub( aPx, aAx );
+    REG py = L::Sub( aPy, aAy );
+
+    // A zero length segment has t == 0, so clamping its length to 1 yields the start point.
+    REG l_squared = L::Max( L::Add( L::Mul( aDx, aDx ), L::Mul( aDy, aDy ) ), L::Set( 1.0 ) );
+    REG t = L::Add( L::Mul( aDx, px ), L::Mul( aDy, py ) );
+    REG r = L::Min( L::Max( L::Div( t, l_squared ), L::Set( 0.0 ) ), L::Set( 1.0 ) );
+
+    REG ex = L::Sub( px, L::Mul( aDx, r ) );
+    REG ey = L::Sub( py, L::Mul( aDy, r ) );
+
+    return L::Add( L::Mul( ex, ex ), L::Mul( ey, ey ) );
+}
+
+
+/**
+ * Side of the line aX-aY on which aZ lies, as in SEG::ccw(): *aLeft and *aRight are set if
+ * the sign of the cross product is certain; when neither is, the products may have been
+ * rounded to the same value.
+ */
+template <typename L>
+void orientation( typename L::REG aXx, typename L::REG aXy, typename L::REG aYx,
+                  typename L::REG aYy, typename L::REG aZx, typename L::REG aZy,
+                  typename L::MASK* aLeft, typename L::MASK* aRight, typename L::MASK* aUnsure )
+{
+    typedef typename L::REG REG;
+
+    // Comparing the products rather than subtracting them keeps the test exact: rounding is
+    // monotonic, so it can make two different products equal, but never swap them.
+    REG lhs = L::Mul( L::Sub( aZy, aXy ), L::Sub( aYx, aXx ) );
+    REG rhs = L::Mul( L::Sub( aYy, aXy ), L::Sub( aZx, aXx ) );
+
+    *aLeft = L::Gt( lhs, rhs );
+    *aRight = L::Lt( lhs, rhs );
+    *aUnsure = L::And( L::Eq( lhs, rhs ), L::Ge( L::Abs( lhs ), L::Set( EXACT_LIMIT ) ) );
+}
+
+
+/**
+ * Computes bounds on the exact distance between the query and aCount candidates.
+ */
+template <typename L>
+void boundsKernel( const SEG& aQuery, bool aPoint, const int32_t* aCAx, const int32_t* aCAy,
+                   const int32_t* aCBx, const int32_t* aCBy, size_t aCount, double* aLo,
+                   double* aHi )
+{
+    typedef typename L::REG  REG;
+    typedef typename L::MASK MASK;
+
+    const REG ax = L::Set( aQuery.A.x );
+    const REG ay = L::Set( aQuery.A.y );
+    const REG bx = L::Set( aQuery.B.x );
+    const REG by = L::Set( aQuery.B.y );
+    const REG dx = L::Sub( bx, ax );
+    const REG dy = L::Sub( by, ay );
+
+    for( size_t i = 0; i < aCount; i += L::N )
+    {
+        REG cx = L::Load( aCAx + i );
+        REG cy = L::Load( aCAy + i );
+        REG ex = L::Sub( L::Load( aCBx + i ), cx );
+        REG ey = L::Sub( L::Load( aCBy + i ), cy );
+
+        REG dist = pointSegment<L>( ax, ay, cx, cy, ex, ey );
+
+        if( aPoint )
+        {
+            dist = L::Sqrt( dist );
+            L::Store( aLo + i, dist );
+            L::Store( aHi + i, dist );
+            continue;
+        }
+
+        REG ux = L::Add( cx, ex );
+        REG uy = L::Add( cy, ey );
+
+        dist = L::Min( dist, pointSegment<L>( bx, by, cx, cy, ex, ey ) );
+        dist = L::Min( dist, pointSegment<L>( cx, cy, ax, ay, dx, dy ) );
+        dist = L::Min( dist, pointSegment<L>( ux, uy, ax, ay, dx, dy ) );
+        dist = L::Sqrt( dist );
+
+        // The segments cross when each one's ends lie strictly on both sides of the other.
+        MASK l1, r1, u1, l2, r2, u2, l3, r3, u3, l4, r4, u4;
+
+        orientation<L>( ax, ay, cx, cy, ux, uy, &l1, &r1, &u1 );
+        orientation<L>( bx, by, cx, cy, ux, uy, &l2, &r2, &u2 );
+        orientation<L>( ax, ay, bx, by, cx, cy, &l3, &r3, &u3 );
+        orientation<L>( ax, ay, bx, by, ux, uy, &l4, &r4, &u4 );
+
+        MASK cross = L::And( L::Or( L::And( l1, r2 ), L::And( r1, l2 ) ),
+                             L::Or( L::And( l3, r4 ), L::And( r3, l4 ) ) );
+
+        l1 = L::Or( l1, u1 );
+        r1 = L::Or( r1, u1 );
+        l2 = L::Or( l2, u2 );
+        r2 = L::Or( r2, u2 );
+        l3 = L::Or( l3, u3 );
+        r3 = L::Or( r3, u3 );
+        l4 = L::Or( l4, u4 );
+        r4 = L::Or( r4, u4 );
+
+        MASK mayCross = L::And( L::Or( L::And( l1, r2 ), L::And( r1, l2 ) ),
+                                L::Or( L::And( l3, r4 ), L::And( r3, l4 ) ) );
+
+        // Crossing segments are at distance 0; otherwise the distance is the shortest one
+        // between an end and the other segment.
+        L::Store( aLo + i, L::Select( mayCross, L::Set( 0.0 ), dist ) );
+        L::Store( aHi + i, L::Select( cross, L::Set( 0.0 ), dist ) );
+    }
+}
+
+
+bool isWide( const VECTOR2I& aP )
+{
+    return aP.x <= -COORD_LIMIT || aP.x >= COORD_LIMIT || aP.y <= -COORD_LIMIT
+           || aP.y >= COORD_LIMIT;
+}
+
+} // namespace
+
+
+void SEG_BATCH::Clear()
+{
+    m_ax.clear();
+    m_ay.clear();
+    m_bx.clear();
+    m_by.clear();
+    m_extra.clear();
+    m_wide.clear();
+}
+
+
+void SEG_BATCH::Reserve( size_t aCount )
+{
+    m_ax.reserve( aCount );
+    m_ay.reserve( aCount );
+    m_bx.reserve( aCount );
+    m_by.reserve( aCount );
+    m_extra.reserve( aCount );
+    m_wide.reserve( aCount );
+}
+
+
+void SEG_BATCH::Add( const SEG& aSeg, int aExtra )
+{
+    m_ax.push_back( aSeg.A.x );
+    m_ay.push_back( aSeg.A.y );
+    m_bx.push_back( aSeg.B.x );
+    m_by.push_back( aSeg.B.y );
+    m_extra.push_back( aExtra );
+    m_wide.push_back( isWide( aSeg.A ) || isWide( aSeg.B ) );
+}
+
+
+const char* SEG_BATCH::KernelName()
+{
+    return SEG_BATCH_KERNEL;
+}
+
+
+void SEG_BATCH::bounds( const SEG& aQuery, bool aPoint, size_t aFirst, size_t aCount,
+                        double* aLo, double* aHi ) const
+{
+    size_t simd = aCount - aCount % LANES_SIMD::N;
+
+    boundsKernel<LANES_SIMD>( aQuery, aPoint, &m_ax[aFirst], &m_ay[aFirst], &m_bx[aFirst],
+                              &m_by[aFirst], simd, aLo, aHi );
+
+    if( simd < aCount )
+    {
+        size_t tail = aFirst + simd;
+
+        boundsKernel<LANES_SCALAR>( aQuery, aPoint, &m_ax[tail], &m_ay[tail], &m_bx[tail],
+                                    &m_by[tail], aCount - simd, aLo + simd, aHi + simd );
+    }
+}
+
+
+template <typename TEST>
+bool SEG_BATCH::collide( const SEG& aQuery, bool aPoint, int aClearance,
+                         std::vector<int>* aHits, TEST aScalarTest ) const
+{
+    double lo[CHUNK_SIZE];
+    double hi[CHUNK_SIZE];
+    bool   found = false;
+    bool   wideQuery = isWide( aQuery.A ) || isWide( aQuery.B );
+
+    for( size_t first = 0; first < Size(); first += CHUNK_SIZE )
+    {
+        size_t count = std::min( CHUNK_SIZE, Size() - first );
+
+        if( !wideQuery )
+            bounds( aQuery, aPoint, first, count, lo, hi );
+
+        for( size_t i = 0; i < count; i++ )
+        {
+            size_t idx = first + i;
+            int    clearance = aClearance + m_extra[idx];
+            bool   hit;
+
+            // The scalar tests compare squared distances, so the sign of the clearance
+            // doesn't matter.
+            double threshold = std::fabs( (double) clearance );
+
+            if( wideQuery || m_wide[idx] )
+                hit = aScalarTest( idx, clearance );
+            else if( lo[i] - ESTIMATE_MARGIN > 0.0 && lo[i] - ESTIMATE_MARGIN >= threshold )
+                hit = false;
+            else if( hi[i] + ESTIMATE_MARGIN < threshold )
+                hit = true;
+            else
+                hit = aScalarTest( idx, clearance );
+
+            if( hit )
+            {
+                found = true;
+
+                if( !aHits )
+                    return true;
+
+                aHits->push_back( (int) idx );
+            }
+        }
+    }
+
+    return found;
+}
+
+
+template <typename DIST>
+SEG::ecoord SEG_BATCH::minDistance( const SEG& aQuery, bool aPoint, int* aIndex,
+                                    DIST aScalarDistance ) const
+{
+    double      lo[CHUNK_SIZE];
+    double      hi[CHUNK_SIZE];
+    SEG::ecoord best = VECTOR2I::ECOORD_MAX;
+    double      bestDist = HUGE_VAL;
+    int         bestIdx = -1;
+    bool        wideQuery = isWide( aQuery.A ) || isWide( aQuery.B );
+
+    for( size_t first = 0; first < Size(); first += CHUNK_SIZE )
+    {
+        size_t count = std::min( CHUNK_SIZE, Size() - first );
+
+        if( !wideQuery )
+            bounds( aQuery, aPoint, first, count, lo, hi );
+
+        for( size_t i = 0; i < count; i++ )
+        {
+            size_t idx = first + i;
+
+            // A candidate whose distance is certainly larger than the best one so far can be
+            // neither the closest one nor tie with it.  The extra unit covers the rounding of
+            // bestDist.
+            if( !wideQuery && !m_wide[idx] && lo[i] - ESTIMATE_MARGIN > bestDist + 1.0 )
+                continue;
+
+            SEG::ecoord dist = aScalarDistance( idx );
+
+            if( dist < best )
+            {
+                best = dist;
+                bestDist = std::sqrt( (double) dist );
+                bestIdx = (int) idx;
+            }
+        }
+    }
+
+    if( aIndex )
+        *aIndex = bestIdx;
+
+    return best;
+}
+
+
+bool SEG_BATCH::Collide( const SEG& aSeg, int aClearance, std::vector<int>* aHits ) const
+{
+    return collide( aSeg, false, aClearance, aHits,
+                    [&]( size_t aIdx, int aSegClearance )
+                    {
+                        return aSeg.Collide( GetSeg( aIdx ), aSegClearance );
+                    } );
+}
+
+
+bool SEG_BATCH::Collide( const VECTOR2I& aCenter, int aRadius, int aClearance,
+                         std::vector<int>* aHits ) const
+{
+    // Same test as SHAPE_CIRCLE::Collide( SEG ).
+    return collide( SEG( aCenter, aCenter ), true, aClearance + aRadius, aHits,
+                    [&]( size_t aIdx, int aMinDist )
+                    {
+                        VECTOR2I    pn = GetSeg( aIdx ).NearestPoint( aCenter );
+                        SEG::ecoord dist_sq = ( pn - aCenter ).SquaredEuclideanNorm();
+
+                        return dist_sq == 0 || dist_sq < SEG::Square( aMinDist );
+                    } );
+}
+
+
+SEG::ecoord SEG_BATCH::SquaredDistance( const SEG& aSeg, int* aIndex ) const
+{
+    return minDistance( aSeg, false, aIndex,
+                        [&]( size_t aIdx )
+                        {
+                            return GetSeg( aIdx ).SquaredDistance( aSeg );
+                        } );
+}
+
+
+SEG::ecoord SEG_BATCH::SquaredDistance( const VECTOR2I& aP, int* aIndex ) const
+{
+    return minDistance( SEG( aP, aP ), true, aIndex,
+                        [&]( size_t aIdx )
+                        {
+                            return GetSeg( aIdx ).SquaredDistance( aP );
+                        } );
+}
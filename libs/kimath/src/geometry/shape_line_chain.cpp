@@ -82,6 +82,7 @@ void SHAPE_LINE_CHAIN::convertArc( ssize_t aArcIndex )
     }
 
     m_arcs.erase( m_arcs.begin() + aArcIndex );
+    compactShapes();
 }
 
 
@@ -267,7 +268,7 @@ void SHAPE_LINE_CHAIN::Replace( int aStartIndex, int aEndIndex, const VECTOR2I&
     // N.B. This works because convertArc changes m_shapes on the first run
     for( int ind = aStartIndex; ind <= aEndIndex; ind++ )
     {
-        if( m_shapes[ind] != SHAPE_IS_PT )
+        if( isArc( ind ) )
             convertArc( ind );
     }
 
@@ -278,10 +279,11 @@ void SHAPE_LINE_CHAIN::Replace( int aStartIndex, int aEndIndex, const VECTOR2I&
         m_points.erase( m_points.begin() + aStartIndex + 1, m_points.begin() + aEndIndex + 1 );
         m_points[aStartIndex] = aP;
 
-        m_shapes.erase( m_shapes.begin() + aStartIndex + 1, m_shapes.begin() + aEndIndex + 1 );
+        if( !m_shapes.empty() )
+            m_shapes.erase( m_shapes.begin() + aStartIndex + 1, m_shapes.begin() + aEndIndex + 1 );
     }
 
-    assert( m_shapes.size() == m_points.size() );
+    assert( m_shapes.empty() || m_shapes.size() == m_points.size() );
 }
 
 
@@ -295,24 +297,34 @@ void SHAPE_LINE_CHAIN::Replace( int aStartIndex, int aEndIndex, const SHAPE_LINE
 
     Remove( aStartIndex, aEndIndex );
 
-    // The total new arcs index is added to the new arc indices
-    size_t prev_arc_count = m_arcs.size();
-    auto   new_shapes = aLine.m_shapes;
+    if( !aLine.m_shapes.empty() )
+        expandShapes();
+
+    if( !m_shapes.empty() )
+    {
+        // The total new arcs index is added to the new arc indices
+        size_t prev_arc_count = m_arcs.size();
+        std::vector<ssize_t> new_shapes = aLine.CShapes();
+
+        for( ssize_t& shape : new_shapes )
+        {
+            if( shape != SHAPE_IS_PT )
+                shape += prev_arc_count;
+        }
 
-    for( auto& shape : new_shapes )
-        shape += prev_arc_count;
+        m_shapes.insert( m_shapes.begin() + aStartIndex, new_shapes.begin(), new_shapes.end() );
+    }
 
-    m_shapes.insert( m_shapes.begin() + aStartIndex, new_shapes.begin(), new_shapes.end() );
     m_points.insert( m_points.begin() + aStartIndex, aLine.m_points.begin(), aLine.m_points.end() );
     m_arcs.insert( m_arcs.end(), aLine.m_arcs.begin(), aLine.m_arcs.end() );
 
-    assert( m_shapes.size() == m_points.size() );
+    assert( m_shapes.empty() || m_shapes.size() == m_points.size() );
 }
 
 
 void SHAPE_LINE_CHAIN::Remove( int aStartIndex, int aEndIndex )
 {
-    assert( m_shapes.size() == m_points.size() );
+    assert( m_shapes.empty() || m_shapes.size() == m_points.size() );
     if( aEndIndex < 0 )
         aEndIndex += PointCount();
 
@@ -328,16 +340,18 @@ void SHAPE_LINE_CHAIN::Remove( int aStartIndex, int aEndIndex )
     // Remove any overlapping arcs in the point range
     for( int i = aStartIndex; i < aEndIndex; i++ )
     {
-        if( m_shapes[i] != SHAPE_IS_PT )
+        if( isArc( i ) )
             extra_arcs.insert( m_shapes[i] );
     }
 
     for( auto arc : extra_arcs )
         convertArc( arc );
 
-    m_shapes.erase( m_shapes.begin() + aStartIndex, m_shapes.begin() + aEndIndex + 1 );
+    if( !m_shapes.empty() )
+        m_shapes.erase( m_shapes.begin() + aStartIndex, m_shapes.begin() + aEndIndex + 1 );
+
     m_points.erase( m_points.begin() + aStartIndex, m_points.begin() + aEndIndex + 1 );
-    assert( m_shapes.size() == m_points.size() );
+    assert( m_shapes.empty() || m_shapes.size() == m_points.size() );
 }
 
 
@@ -391,7 +405,9 @@ int SHAPE_LINE_CHAIN::Split( const VECTOR2I& aP )
     if( ii >= 0 )
     {
         m_points.insert( m_points.begin() + ii + 1, aP );
-        m_shapes.insert( m_shapes.begin() + ii + 1, ssize_t( SHAPE_IS_PT ) );
+
+        if( !m_shapes.empty() )
+            m_shapes.insert( m_shapes.begin() + ii + 1, ssize_t( SHAPE_IS_PT ) );
 
         return ii + 1;
     }
@@ -439,16 +455,22 @@ const SHAPE_LINE_CHAIN SHAPE_LINE_CHAIN::Slice( int aStartIndex, int aEndIndex )
 
 void SHAPE_LINE_CHAIN::Append( const SHAPE_LINE_CHAIN& aOtherLine )
 {
-    assert( m_shapes.size() == m_points.size() );
+    assert( m_shapes.empty() || m_shapes.size() == m_points.size() );
 
     if( aOtherLine.PointCount() == 0 )
         return;
 
-    else if( PointCount() == 0 || aOtherLine.CPoint( 0 ) != CPoint( -1 ) )
+    if( !aOtherLine.m_shapes.empty() )
+        expandShapes();
+
+    if( PointCount() == 0 || aOtherLine.CPoint( 0 ) != CPoint( -1 ) )
     {
         const VECTOR2I p = aOtherLine.CPoint( 0 );
         m_points.push_back( p );
-        m_shapes.push_back( ssize_t( SHAPE_IS_PT ) );
+
+        if( !m_shapes.empty() )
+            m_shapes.push_back( ssize_t( SHAPE_IS_PT ) );
+
         m_bbox.Merge( p );
     }
 
@@ -460,17 +482,20 @@ void SHAPE_LINE_CHAIN::Append( const SHAPE_LINE_CHAIN& aOtherLine )
         const VECTOR2I p = aOtherLine.CPoint( i );
         m_points.push_back( p );
 
-        ssize_t arcIndex = aOtherLine.ArcIndex( i );
+        if( !m_shapes.empty() )
+        {
+            ssize_t arcIndex = aOtherLine.ArcIndex( i );
 
-        if( arcIndex != ssize_t( SHAPE_IS_PT ) )
-            m_shapes.push_back( num_arcs + arcIndex );
-        else
-            m_shapes.push_back( ssize_t( SHAPE_IS_PT ) );
+            if( arcIndex != ssize_t( SHAPE_IS_PT ) )
+                m_shapes.push_back( num_arcs + arcIndex );
+            else
+                m_shapes.push_back( ssize_t( SHAPE_IS_PT ) );
+        }
 
         m_bbox.Merge( p );
     }
 
-    assert( m_shapes.size() == m_points.size() );
+    assert( m_shapes.empty() || m_shapes.size() == m_points.size() );
 }
 
 
@@ -478,6 +503,8 @@ void SHAPE_LINE_CHAIN::Append( const SHAPE_ARC& aArc )
 {
     auto& chain = aArc.ConvertToPolyline();
 
+    expandShapes();
+
     for( auto& pt : chain.CPoints() )
     {
         m_points.push_back( pt );
@@ -492,21 +519,25 @@ void SHAPE_LINE_CHAIN::Append( const SHAPE_ARC& aArc )
 
 void SHAPE_LINE_CHAIN::Insert( size_t aVertex, const VECTOR2I& aP )
 {
-    if( m_shapes[aVertex] != SHAPE_IS_PT )
+    if( isArc( aVertex ) )
         convertArc( aVertex );
 
     m_points.insert( m_points.begin() + aVertex, aP );
-    m_shapes.insert( m_shapes.begin() + aVertex, ssize_t( SHAPE_IS_PT ) );
 
-    assert( m_shapes.size() == m_points.size() );
+    if( !m_shapes.empty() )
+        m_shapes.insert( m_shapes.begin() + aVertex, ssize_t( SHAPE_IS_PT ) );
+
+    assert( m_shapes.empty() || m_shapes.size() == m_points.size() );
 }
 
 
 void SHAPE_LINE_CHAIN::Insert( size_t aVertex, const SHAPE_ARC& aArc )
 {
-    if( m_shapes[aVertex] != SHAPE_IS_PT )
+    if( isArc( aVertex ) )
         convertArc( aVertex );
 
+    expandShapes();
+
     /// Step 1: Find the position for the new arc in the existing arc vector
     size_t arc_pos = m_arcs.size();
 
@@ -824,11 +855,17 @@ SHAPE_LINE_CHAIN& SHAPE_LINE_CHAIN::Simplify()
     else if( PointCount() == 2 )
     {
         if( m_points[0] == m_points[1] )
+        {
             m_points.pop_back();
 
+            if( !m_shapes.empty() )
+                m_shapes.pop_back();
+        }
+
         return *this;
     }
 
+    bool hasArcs = !m_shapes.empty();
     int i = 0;
     int np = PointCount();
 
@@ -837,11 +874,13 @@ SHAPE_LINE_CHAIN& SHAPE_LINE_CHAIN::Simplify()
     {
         int j = i + 1;
 
-        while( j < np && m_points[i] == m_points[j] && m_shapes[i] == m_shapes[j] )
+        while( j < np && m_points[i] == m_points[j] && ArcIndex( i ) == ArcIndex( j ) )
             j++;
 
         pts_unique.push_back( CPoint( i ) );
-        shapes_unique.push_back( m_shapes[i] );
+
+        if( hasArcs )
+            shapes_unique.push_back( m_shapes[i] );
 
         i = j;
     }
@@ -865,7 +904,9 @@ SHAPE_LINE_CHAIN& SHAPE_LINE_CHAIN::Simplify()
             n++;
 
         m_points.push_back( p0 );
-        m_shapes.push_back( shapes_unique[i] );
+
+        if( hasArcs )
+            m_shapes.push_back( shapes_unique[i] );
 
         if( n > i )
             i = n;
@@ -873,7 +914,10 @@ SHAPE_LINE_CHAIN& SHAPE_LINE_CHAIN::Simplify()
         if( n == np )
         {
             m_points.push_back( pts_unique[n - 1] );
-            m_shapes.push_back( shapes_unique[n - 1] );
+
+            if( hasArcs )
+                m_shapes.push_back( shapes_unique[n - 1] );
+
             return *this;
         }
 
@@ -883,13 +927,17 @@ SHAPE_LINE_CHAIN& SHAPE_LINE_CHAIN::Simplify()
     if( np > 1 )
     {
         m_points.push_back( pts_unique[np - 2] );
-        m_shapes.push_back( shapes_unique[np - 2] );
+
+        if( hasArcs )
+            m_shapes.push_back( shapes_unique[np - 2] );
     }
 
     m_points.push_back( pts_unique[np - 1] );
-    m_shapes.push_back( shapes_unique[np - 1] );
 
-    assert( m_points.size() == m_shapes.size() );
+    if( hasArcs )
+        m_shapes.push_back( shapes_unique[np - 1] );
+
+    assert( m_shapes.empty() || m_points.size() == m_shapes.size() );
 
     return *this;
 }
@@ -1058,6 +1106,8 @@ bool SHAPE_LINE_CHAIN::Parse( std::stringstream& aStream )
         m_arcs.emplace_back( pc, p0, angle );
     }
 
+    compactShapes();
+
     return true;
 }
 
@@ -28,7 +28,9 @@
 
 #include <algorithm>
 #include <assert.h>                          // for assert
+#include <atomic>
 #include <cmath>                             // for sqrt, cos, hypot, isinf
+#include <cstdint>
 #include <cstdio>
 #include <istream>                           // for operator<<, operator>>
 #include <limits>                            // for numeric_limits
@@ -41,6 +43,7 @@
 
 #include <clipper.hpp>                       // for Clipper, PolyNode, Clipp...
 #include <geometry/geometry_utils.h>
+#include <geometry/poly_edge_index.h>
 #include <geometry/polygon_triangulation.h>
 #include <geometry/seg.h>                    // for SEG, OPT_VECTOR2I
 #include <geometry/shape.h>
@@ -50,6 +53,7 @@
 #include <math/util.h>                       // for KiROUND, rescale
 #include <math/vector2d.h>                   // for VECTOR2I, VECTOR2D, VECTOR2
 #include <md5_hash.h>
+#include <thread_pool.h>
 #include <geometry/shape_segment.h>
 #include <geometry/shape_circle.h>
 #include <geometry/shape_simple.h>
@@ -77,7 +81,7 @@ SHAPE_POLY_SET::SHAPE_POLY_SET( const SHAPE_POLY_SET& aOther ) :
     {
         for( unsigned i = 0; i < aOther.TriangulatedPolyCount(); i++ )
             m_triangulatedPolys.push_back(
-                    std::make_unique<TRIANGULATED_POLYGON>( *aOther.TriangulatedPolygon( i ) ) );
+                    std::make_shared<TRIANGULATED_POLYGON>( *aOther.TriangulatedPolygon( i ) ) );
 
         m_hash = aOther.GetHash();
         m_triangulationValid = true;
@@ -187,6 +191,8 @@ bool SHAPE_POLY_SET::GetGlobalIndex( SHAPE_POLY_SET::VERTEX_INDEX aRelativeIndic
 
 int SHAPE_POLY_SET::NewOutline()
 {
+    m_edgeIndexValid = false;
+
     SHAPE_LINE_CHAIN empty_path;
     POLYGON poly;
 
@@ -199,6 +205,8 @@ int SHAPE_POLY_SET::NewOutline()
 
 int SHAPE_POLY_SET::NewHole( int aOutline )
 {
+    m_edgeIndexValid = false;
+
     SHAPE_LINE_CHAIN empty_path;
 
     empty_path.SetClosed( true );
@@ -216,6 +224,8 @@ int SHAPE_POLY_SET::NewHole( int aOutline )
 
 int SHAPE_POLY_SET::Append( int x, int y, int aOutline, int aHole, bool aAllowDuplication )
 {
+    m_edgeIndexValid = false;
+
     assert( m_polys.size() );
 
     if( aOutline < 0 )
@@ -239,6 +249,8 @@ int SHAPE_POLY_SET::Append( int x, int y, int aOutline, int aHole, bool aAllowDu
 
 void SHAPE_POLY_SET::InsertVertex( int aGlobalIndex, VECTOR2I aNewVertex )
 {
+    m_edgeIndexValid = false;
+
     VERTEX_INDEX index;
 
     if( aGlobalIndex < 0 )
@@ -424,6 +436,8 @@ bool SHAPE_POLY_SET::IsSelfIntersecting() const
 
 int SHAPE_POLY_SET::AddOutline( const SHAPE_LINE_CHAIN& aOutline )
 {
+    m_edgeIndexValid = false;
+
     assert( aOutline.IsClosed() );
 
     POLYGON poly;
@@ -438,6 +452,8 @@ int SHAPE_POLY_SET::AddOutline( const SHAPE_LINE_CHAIN& aOutline )
 
 int SHAPE_POLY_SET::AddHole( const SHAPE_LINE_CHAIN& aHole, int aOutline )
 {
+    m_edgeIndexValid = false;
+
     assert( m_polys.size() );
 
     if( aOutline < 0 )
@@ -533,6 +549,247 @@ void SHAPE_POLY_SET::BooleanIntersection( const SHAPE_POLY_SET& a,
 }
 
 
+void SHAPE_POLY_SET::ParallelBooleanAdd( const SHAPE_POLY_SET& b, POLYGON_MODE aFastMode )
+{
+    parallelBooleanOp( ctUnion, b, aFastMode );
+}
+
+
+void SHAPE_POLY_SET::ParallelBooleanSubtract( const SHAPE_POLY_SET& b, POLYGON_MODE aFastMode )
+{
+    parallelBooleanOp( ctDifference, b, aFastMode );
+}
+
+
+void SHAPE_POLY_SET::ParallelBooleanIntersection( const SHAPE_POLY_SET& b,
+                                                  POLYGON_MODE aFastMode )
+{
+    parallelBooleanOp( ctIntersection, b, aFastMode );
+}
+
+
+///> Below this many vertices a single Clipper pass is cheaper than dispatching tasks
+static const int PARALLEL_MIN_VERTICES = 4096;
+
+///> Groups are merged into batches of about this many vertices.  The size must not depend on
+///> the thread count: Clipper may round differently depending on what shares a batch, and the
+///> result has to be the same on every machine.
+static const int PARALLEL_BATCH_VERTICES = 2048;
+
+
+std::vector<std::vector<int>> SHAPE_POLY_SET::parallelBatches( const SHAPE_POLY_SET& aOther,
+                                                               int aMargin, bool aNeedSubject,
+                                                               bool aNeedOther ) const
+{
+    std::vector<std::vector<int>> batches;
+    const int                     subjectCount = OutlineCount();
+    const int                     count = subjectCount + aOther.OutlineCount();
+
+    // Not bailing out on a single thread: the split pays off there as well (see the header)
+    if( count < 2 )
+        return batches;
+
+    std::vector<BOX2I> boxes;
+    std::vector<int>   vertices;
+    int                totalVertices = 0;
+
+    boxes.reserve( count );
+    vertices.reserve( count );
+
+    for( int ii = 0; ii < count; ++ii )
+    {
+        const POLYGON& poly = ii < subjectCount ? m_polys[ii]
+                                                : aOther.m_polys[ii - subjectCount];
+        int            polyVertices = 0;
+
+        for( const SHAPE_LINE_CHAIN& contour : poly )
+            polyVertices += contour.PointCount();
+
+        // Holes lie inside the outline, so its box covers the whole polygon
+        boxes.push_back( poly[0].BBox( aMargin ) );
+        vertices.push_back( polyVertices );
+        totalVertices += polyVertices;
+    }
+
+    if( totalVertices < PARALLEL_MIN_VERTICES )
+        return batches;
+
+    // Union-find the polygons whose boxes touch, sweeping the boxes from left to right
+    std::vector<int> parent( count );
+    std::vector<int> order( count );
+
+    for( int ii = 0; ii < count; ++ii )
+        parent[ii] = order[ii] = ii;
+
+    auto findRoot =
+            [&]( int aIdx )
+            {
+                while( parent[aIdx] != aIdx )
+                {
+                    parent[aIdx] = parent[parent[aIdx]];
+                    aIdx = parent[aIdx];
+                }
+
+                return aIdx;
+            };
+
+    std::sort( order.begin(), order.end(),
+               [&]( int aA, int aB )
+               {
+                   return boxes[aA].GetLeft() < boxes[aB].GetLeft();
+               } );
+
+    std::vector<int> active;
+
+    for( int ii : order )
+    {
+        const BOX2I& box = boxes[ii];
+        size_t       kept = 0;
+
+        for( int other : active )
+        {
+            const BOX2I& otherBox = boxes[other];
+
+            if( otherBox.GetRight() < box.GetLeft() )
+                continue;
+
+            active[kept++] = other;
+
+            if( otherBox.GetTop() <= box.GetBottom() && box.GetTop() <= otherBox.GetBottom() )
+                parent[findRoot( ii )] = findRoot( other );
+        }
+
+        active.resize( kept );
+        active.push_back( ii );
+    }
+
+    struct GROUP
+    {
+        std::vector<int> m_members;
+        int              m_vertices = 0;
+        bool             m_hasSubject = false;
+        bool             m_hasOther = false;
+    };
+
+    std::vector<GROUP> groups;
+    std::vector<int>   groupOfRoot( count, -1 );
+
+    for( int ii = 0; ii < count; ++ii )
+    {
+        int& group = groupOfRoot[findRoot( ii )];
+
+        if( group < 0 )
+        {
+            group = (int) groups.size();
+            groups.emplace_back();
+        }
+
+        groups[group].m_members.push_back( ii );
+        groups[group].m_vertices += vertices[ii];
+
+        if( ii < subjectCount )
+            groups[group].m_hasSubject = true;
+        else
+            groups[group].m_hasOther = true;
+    }
+
+    if( groups.size() < 2 )
+        return batches;
+
+    // Merge the small groups to keep the task overhead down
+    std::vector<int> batchSize;
+
+    for( const GROUP& group : groups )
+    {
+        if( ( aNeedSubject && !group.m_hasSubject ) || ( aNeedOther && !group.m_hasOther ) )
+            continue;
+
+        if( batches.empty() || batchSize.back() >= PARALLEL_BATCH_VERTICES )
+        {
+            batches.emplace_back();
+            batchSize.push_back( 0 );
+        }
+
+        batches.back().insert( batches.back().end(), group.m_members.begin(),
+                               group.m_members.end() );
+        batchSize.back() += group.m_vertices;
+    }
+
+    if( batches.size() < 2 )
+    {
+        batches.clear();
+        return batches;
+    }
+
+    // Start with the largest batches so that the last ones to finish are short
+    std::vector<int> batchOrder( batches.size() );
+
+    for( size_t ii = 0; ii < batches.size(); ++ii )
+        batchOrder[ii] = (int) ii;
+
+    std::stable_sort( batchOrder.begin(), batchOrder.end(),
+                      [&]( int aA, int aB )
+                      {
+                          return batchSize[aA] > batchSize[aB];
+                      } );
+
+    std::vector<std::vector<int>> sorted;
+    sorted.reserve( batches.size() );
+
+    for( int ii : batchOrder )
+        sorted.push_back( std::move( batches[ii] ) );
+
+    return sorted;
+}
+
+
+void SHAPE_POLY_SET::parallelBooleanOp( ClipperLib::ClipType aType,
+                                        const SHAPE_POLY_SET& aOtherShape,
+                                        POLYGON_MODE aFastMode )
+{
+    std::vector<std::vector<int>> batches = parallelBatches( aOtherShape, 0, aType != ctUnion,
+                                                             aType == ctIntersection );
+
+    if( batches.empty() )
+    {
+        booleanOp( aType, aOtherShape, aFastMode );
+        return;
+    }
+
+    const int                   subjectCount = OutlineCount();
+    std::vector<SHAPE_POLY_SET> results( batches.size() );
+    TASK_GROUP                  tasks;
+
+    tasks.ParallelFor( batches.size(),
+            [&]( size_t aBatch )
+            {
+                SHAPE_POLY_SET subject;
+                SHAPE_POLY_SET other;
+
+                for( int ii : batches[aBatch] )
+                {
+                    if( ii < subjectCount )
+                        subject.m_polys.push_back( m_polys[ii] );
+                    else
+                        other.m_polys.push_back( aOtherShape.m_polys[ii - subjectCount] );
+                }
+
+                results[aBatch].booleanOp( aType, subject, other, aFastMode );
+            } );
+
+    tasks.Wait();
+
+    m_edgeIndexValid = false;
+    m_polys.clear();
+
+    for( SHAPE_POLY_SET& result : results )
+    {
+        for( POLYGON& poly : result.m_polys )
+            m_polys.push_back( std::move( poly ) );
+    }
+}
+
+
 void SHAPE_POLY_SET::InflateWithLinkedHoles( int aFactor, int aCircleSegmentsCount,
                                              POLYGON_MODE aFastMode )
 {
@@ -625,8 +882,54 @@ void SHAPE_POLY_SET::Inflate( int aAmount, int aCircleSegmentsCount,
 }
 
 
+void SHAPE_POLY_SET::ParallelInflate( int aAmount, int aCircleSegmentsCount,
+                                      CORNER_STRATEGY aCornerStrategy )
+{
+    // Miter joins can reach out to twice the amount (ten times when acute corners are
+    // allowed) before being squared off
+    int margin = 0;
+
+    if( aAmount > 0 )
+        margin = aAmount * ( aCornerStrategy == ALLOW_ACUTE_CORNERS ? 10 : 2 ) + 1;
+
+    std::vector<std::vector<int>> batches = parallelBatches( SHAPE_POLY_SET(), margin, false,
+                                                             false );
+
+    if( batches.empty() )
+    {
+        Inflate( aAmount, aCircleSegmentsCount, aCornerStrategy );
+        return;
+    }
+
+    std::vector<SHAPE_POLY_SET> results( batches.size() );
+    TASK_GROUP                  tasks;
+
+    tasks.ParallelFor( batches.size(),
+            [&]( size_t aBatch )
+            {
+                for( int ii : batches[aBatch] )
+                    results[aBatch].m_polys.push_back( m_polys[ii] );
+
+                results[aBatch].Inflate( aAmount, aCircleSegmentsCount, aCornerStrategy );
+            } );
+
+    tasks.Wait();
+
+    m_edgeIndexValid = false;
+    m_polys.clear();
+
+    for( SHAPE_POLY_SET& result : results )
+    {
+        for( POLYGON& poly : result.m_polys )
+            m_polys.push_back( std::move( poly ) );
+    }
+}
+
+
 void SHAPE_POLY_SET::importTree( PolyTree* tree )
 {
+    m_edgeIndexValid = false;
+
     m_polys.clear();
 
     for( PolyNode* n = tree->GetFirst(); n; n = n->GetNext() )
@@ -866,6 +1169,30 @@ void SHAPE_POLY_SET::Fracture( POLYGON_MODE aFastMode )
 }
 
 
+void SHAPE_POLY_SET::ParallelFracture( POLYGON_MODE aFastMode )
+{
+    ParallelSimplify( aFastMode );
+
+    if( TotalVertices() < PARALLEL_MIN_VERTICES )
+    {
+        for( POLYGON& paths : m_polys )
+            fractureSingle( paths );
+
+        return;
+    }
+
+    TASK_GROUP tasks;
+
+    tasks.ParallelFor( m_polys.size(),
+            [&]( size_t aPoly )
+            {
+                fractureSingle( m_polys[aPoly] );
+            } );
+
+    tasks.Wait();
+}
+
+
 void SHAPE_POLY_SET::unfractureSingle( SHAPE_POLY_SET::POLYGON& aPoly )
 {
     assert( aPoly.size() == 1 );
@@ -1061,6 +1388,207 @@ void SHAPE_POLY_SET::Simplify( POLYGON_MODE aFastMode )
 }
 
 
+void SHAPE_POLY_SET::ParallelSimplify( POLYGON_MODE aFastMode )
+{
+    SHAPE_POLY_SET empty;
+
+    parallelBooleanOp( ctUnion, empty, aFastMode );
+}
+
+
+///> Number of polygons merged by the first, single Clipper pass of CascadedUnion()
+static const int CASCADE_LEAF_SIZE = 32;
+
+
+/**
+ * Interleave the bits of two 16 bit coordinates into a Z-order curve position.
+ */
+static uint32_t zOrder( uint32_t aX, uint32_t aY )
+{
+    auto spread =
+            []( uint32_t aVal )
+            {
+                aVal = ( aVal | ( aVal << 8 ) ) & 0x00FF00FF;
+                aVal = ( aVal | ( aVal << 4 ) ) & 0x0F0F0F0F;
+                aVal = ( aVal | ( aVal << 2 ) ) & 0x33333333;
+                aVal = ( aVal | ( aVal << 1 ) ) & 0x55555555;
+                return aVal;
+            };
+
+    return spread( aX ) | ( spread( aY ) << 1 );
+}
+
+
+/**
+ * Flag in aTouchingA the polygons of aA whose bounding box touches the one of a polygon of aB,
+ * and the other way round in aTouchingB, sweeping the boxes from left to right.
+ */
+static void markTouching( const std::vector<SHAPE_POLY_SET::POLYGON>& aA,
+                          const std::vector<SHAPE_POLY_SET::POLYGON>& aB,
+                          std::vector<bool>& aTouchingA, std::vector<bool>& aTouchingB )
+{
+    const std::vector<SHAPE_POLY_SET::POLYGON>* lists[2] = { &aA, &aB };
+    std::vector<bool>*                          flags[2] = { &aTouchingA, &aTouchingB };
+    std::vector<BOX2I>                          boxes[2];
+    std::vector<std::pair<int, int>>            order;   // list, index
+
+    for( int list = 0; list < 2; ++list )
+    {
+        flags[list]->assign( lists[list]->size(), false );
+
+        for( const SHAPE_POLY_SET::POLYGON& poly : *lists[list] )
+        {
+            order.emplace_back( list, (int) boxes[list].size() );
+            boxes[list].push_back( poly[0].BBox() );
+        }
+    }
+
+    std::sort( order.begin(), order.end(),
+               [&]( const std::pair<int, int>& aL, const std::pair<int, int>& aR )
+               {
+                   return boxes[aL.first][aL.second].GetLeft()
+                                < boxes[aR.first][aR.second].GetLeft();
+               } );
+
+    std::vector<int> active[2];
+
+    for( const std::pair<int, int>& entry : order )
+    {
+        const int    list = entry.first;
+        const int    other = 1 - list;
+        const BOX2I& box = boxes[list][entry.second];
+        size_t       kept = 0;
+
+        for( int ii : active[other] )
+        {
+            const BOX2I& otherBox = boxes[other][ii];
+
+            if( otherBox.GetRight() < box.GetLeft() )
+                continue;
+
+            active[other][kept++] = ii;
+
+            if( otherBox.GetTop() <= box.GetBottom() && box.GetTop() <= otherBox.GetBottom() )
+            {
+                ( *flags[list] )[entry.second] = true;
+                ( *flags[other] )[ii] = true;
+            }
+        }
+
+        active[other].resize( kept );
+        active[list].push_back( entry.second );
+    }
+}
+
+
+void SHAPE_POLY_SET::CascadedUnion( POLYGON_MODE aFastMode )
+{
+    const int count = OutlineCount();
+
+    if( count <= 2 * CASCADE_LEAF_SIZE )
+    {
+        Simplify( aFastMode );
+        return;
+    }
+
+    const BOX2I bbox = BBox();
+    const int64_t width = std::max<int64_t>( bbox.GetWidth(), 1 );
+    const int64_t height = std::max<int64_t>( bbox.GetHeight(), 1 );
+
+    std::vector<std::pair<uint32_t, int>> order;
+    order.reserve( count );
+
+    for( int ii = 0; ii < count; ++ii )
+    {
+        VECTOR2I center = m_polys[ii][0].BBox().Centre();
+        uint32_t x = ( int64_t( center.x ) - bbox.GetX() ) * 0xFFFF / width;
+        uint32_t y = ( int64_t( center.y ) - bbox.GetY() ) * 0xFFFF / height;
+
+        order.emplace_back( zOrder( x, y ), ii );
+    }
+
+    std::sort( order.begin(), order.end() );
+
+    std::vector<SHAPE_POLY_SET> parts( ( count + CASCADE_LEAF_SIZE - 1 ) / CASCADE_LEAF_SIZE );
+
+    {
+        TASK_GROUP tasks;
+
+        tasks.ParallelFor( parts.size(),
+                [&]( size_t aPart )
+                {
+                    size_t last = std::min<size_t>( ( aPart + 1 ) * CASCADE_LEAF_SIZE, count );
+
+                    for( size_t ii = aPart * CASCADE_LEAF_SIZE; ii < last; ++ii )
+                        parts[aPart].m_polys.push_back( std::move( m_polys[order[ii].second] ) );
+
+                    parts[aPart].Simplify( aFastMode );
+                } );
+
+        tasks.Wait();
+    }
+
+    while( parts.size() > 1 )
+    {
+        std::vector<SHAPE_POLY_SET> merged( ( parts.size() + 1 ) / 2 );
+        TASK_GROUP                  tasks;
+
+        tasks.ParallelFor( merged.size(),
+                [&]( size_t aPart )
+                {
+                    std::vector<POLYGON>& result = merged[aPart].m_polys;
+
+                    // SHAPE_POLY_SET has no move assignment, so hand the polygons over instead
+                    if( 2 * aPart + 1 == parts.size() )
+                    {
+                        result.swap( parts[2 * aPart].m_polys );
+                        return;
+                    }
+
+                    std::vector<POLYGON>* halves[2] = { &parts[2 * aPart].m_polys,
+                                                        &parts[2 * aPart + 1].m_polys };
+
+                    // Both halves are already merged, so only their polygons touching the
+                    // other half need another Clipper pass; the rest is kept as is.
+                    std::vector<bool> nearOther[2];
+
+                    markTouching( *halves[0], *halves[1], nearOther[0], nearOther[1] );
+
+                    SHAPE_POLY_SET nearPolys[2];
+
+                    for( int half = 0; half < 2; ++half )
+                    {
+                        for( size_t ii = 0; ii < halves[half]->size(); ++ii )
+                        {
+                            POLYGON& poly = ( *halves[half] )[ii];
+
+                            if( nearOther[half][ii] )
+                                nearPolys[half].m_polys.push_back( std::move( poly ) );
+                            else
+                                result.push_back( std::move( poly ) );
+                        }
+                    }
+
+                    if( nearPolys[0].OutlineCount() || nearPolys[1].OutlineCount() )
+                    {
+                        SHAPE_POLY_SET joined;
+
+                        joined.booleanOp( ctUnion, nearPolys[0], nearPolys[1], aFastMode );
+
+                        for( POLYGON& poly : joined.m_polys )
+                            result.push_back( std::move( poly ) );
+                    }
+                } );
+
+        tasks.Wait();
+        parts = std::move( merged );
+    }
+
+    m_edgeIndexValid = false;
+    m_polys = std::move( parts[0].m_polys );
+}
+
+
 int SHAPE_POLY_SET::NormalizeAreaOutlines()
 {
     // We are expecting only one main outline, but this main outline can have holes
@@ -1127,6 +1655,8 @@ const std::string SHAPE_POLY_SET::Format() const
 
 bool SHAPE_POLY_SET::Parse( std::stringstream& aStream )
 {
+    m_edgeIndexValid = false;
+
     std::string tmp;
 
     aStream >> tmp;
@@ -1356,12 +1886,16 @@ bool SHAPE_POLY_SET::Collide( const SHAPE* aShape, int aClearance, int* aActual,
 
 void SHAPE_POLY_SET::RemoveAllContours()
 {
+    m_edgeIndexValid = false;
+
     m_polys.clear();
 }
 
 
 void SHAPE_POLY_SET::RemoveContour( int aContourIdx, int aPolygonIdx )
 {
+    m_edgeIndexValid = false;
+
     // Default polygon is the last one
     if( aPolygonIdx < 0 )
         aPolygonIdx += m_polys.size();
@@ -1425,12 +1959,16 @@ int SHAPE_POLY_SET::RemoveNullSegments()
 
 void SHAPE_POLY_SET::DeletePolygon( int aIdx )
 {
+    m_edgeIndexValid = false;
+
     m_polys.erase( m_polys.begin() + aIdx );
 }
 
 
 void SHAPE_POLY_SET::Append( const SHAPE_POLY_SET& aSet )
 {
+    m_edgeIndexValid = false;
+
     m_polys.insert( m_polys.end(), aSet.m_polys.begin(), aSet.m_polys.end() );
 }
 
@@ -1556,6 +2094,8 @@ void SHAPE_POLY_SET::RemoveVertex( int aGlobalIndex )
 
 void SHAPE_POLY_SET::RemoveVertex( VERTEX_INDEX aIndex )
 {
+    m_edgeIndexValid = false;
+
     m_polys[aIndex.m_polygon][aIndex.m_contour].Remove( aIndex.m_vertex );
 }
 
@@ -1573,6 +2113,8 @@ void SHAPE_POLY_SET::SetVertex( int aGlobalIndex, const VECTOR2I& aPos )
 
 void SHAPE_POLY_SET::SetVertex( const VERTEX_INDEX& aIndex, const VECTOR2I& aPos )
 {
+    m_edgeIndexValid = false;
+
     m_polys[aIndex.m_polygon][aIndex.m_contour].SetPoint( aIndex.m_vertex, aPos );
 }
 
@@ -1580,6 +2122,9 @@ void SHAPE_POLY_SET::SetVertex( const VERTEX_INDEX& aIndex, const VECTOR2I& aPos
 bool SHAPE_POLY_SET::containsSingle( const VECTOR2I& aP, int aSubpolyIndex, int aAccuracy,
                                      bool aUseBBoxCaches ) const
 {
+    if( m_edgeIndexValid && m_edgeIndices[aSubpolyIndex] )
+        return m_edgeIndices[aSubpolyIndex]->Contains( m_polys[aSubpolyIndex], aP, aAccuracy );
+
     // Check that the point is inside the outline
     if( m_polys[aSubpolyIndex][0].PointInside( aP, aAccuracy ) )
     {
@@ -1612,12 +2157,20 @@ void SHAPE_POLY_SET::Move( const VECTOR2I& aVector )
     for( auto& tri : m_triangulatedPolys )
         tri->Move( aVector );
 
+    // The partition cells are shared with m_triangulatedPolys, and now hold moved triangles
+    m_triangulationCells.clear();
+
+    // The edge indexes hold absolute coordinates; rebuild rather than move them
+    m_edgeIndexValid = false;
+
     m_hash = checksum();
 }
 
 
 void SHAPE_POLY_SET::Mirror( bool aX, bool aY, const VECTOR2I& aRef )
 {
+    m_edgeIndexValid = false;
+
     for( POLYGON& poly : m_polys )
     {
         for( SHAPE_LINE_CHAIN& path : poly )
@@ -1630,6 +2183,8 @@ void SHAPE_POLY_SET::Mirror( bool aX, bool aY, const VECTOR2I& aRef )
 
 void SHAPE_POLY_SET::Rotate( double aAngle, const VECTOR2I& aCenter )
 {
+    m_edgeIndexValid = false;
+
     for( POLYGON& poly : m_polys )
     {
         for( SHAPE_LINE_CHAIN& path : poly )
@@ -1684,6 +2239,12 @@ SEG::ecoord SHAPE_POLY_SET::SquaredDistanceToPolygon( VECTOR2I aPoint, int aPoly
         return 0;
     }
 
+    if( m_edgeIndexValid && m_edgeIndices[aPolygonIndex] )
+    {
+        return m_edgeIndices[aPolygonIndex]->SquaredEdgeDistance( m_polys[aPolygonIndex], aPoint,
+                                                                  aNearest );
+    }
+
     CONST_SEGMENT_ITERATOR iterator = CIterateSegmentsWithHoles( aPolygonIndex );
 
     SEG::ecoord minDistance = (*iterator).SquaredDistance( aPoint );
@@ -1720,6 +2281,12 @@ SEG::ecoord SHAPE_POLY_SET::SquaredDistanceToPolygon( const SEG& aSegment, int a
         return 0;
     }
 
+    if( m_edgeIndexValid && m_edgeIndices[aPolygonIndex] )
+    {
+        return m_edgeIndices[aPolygonIndex]->SquaredEdgeDistance( m_polys[aPolygonIndex], aSegment,
+                                                                  aNearest );
+    }
+
     CONST_SEGMENT_ITERATOR iterator = CIterateSegmentsWithHoles( aPolygonIndex );
     SEG::ecoord            minDistance = (*iterator).SquaredDistance( aSegment );
 
@@ -1993,12 +2560,18 @@ SHAPE_POLY_SET &SHAPE_POLY_SET::operator=( const SHAPE_POLY_SET& aOther )
     m_polys = aOther.m_polys;
     m_triangulatedPolys.clear();
     m_triangulationValid = false;
+    m_edgeIndices.clear();
+    m_edgeIndexValid = false;
 
+    // The triangulated cells of our previous content stay cached: when a zone is refilled, most
+    // of them can be reused for the new fill.
     if( aOther.IsTriangulationUpToDate() )
     {
+        m_triangulationCells.clear();
+
         for( unsigned i = 0; i < aOther.TriangulatedPolyCount(); i++ )
             m_triangulatedPolys.push_back(
-                    std::make_unique<TRIANGULATED_POLYGON>( *aOther.TriangulatedPolygon( i ) ) );
+                    std::make_shared<TRIANGULATED_POLYGON>( *aOther.TriangulatedPolygon( i ) ) );
 
         m_hash = aOther.GetHash();
         m_triangulationValid = true;
@@ -2030,72 +2603,84 @@ bool SHAPE_POLY_SET::IsTriangulationUpToDate() const
 }
 
 
-static void partitionPolyIntoRegularCellGrid(
-        const SHAPE_POLY_SET& aPoly, int aSize, SHAPE_POLY_SET& aOut )
-{
-    BOX2I bb = aPoly.BBox();
+/// Size of the triangulation partition cells (1cm in pcbnew).
+static const int TRIANGULATION_CELL_SIZE = 10000000;
 
-    double w = bb.GetWidth();
-    double h = bb.GetHeight();
 
-    if( w == 0.0 || h == 0.0 )
-        return;
+/**
+ * @return the index of the triangulation cell containing aCoord, cell k covering
+ *         [ k * TRIANGULATION_CELL_SIZE, ( k + 1 ) * TRIANGULATION_CELL_SIZE ).
+ */
+static int triangulationCell( int64_t aCoord )
+{
+    if( aCoord < 0 )
+        aCoord -= TRIANGULATION_CELL_SIZE - 1;
 
-    int n_cells_x, n_cells_y;
+    return int( aCoord / TRIANGULATION_CELL_SIZE );
+}
 
-    if( w > h )
-    {
-        n_cells_x = w / aSize;
-        n_cells_y = floor( h / w * n_cells_x ) + 1;
-    }
-    else
-    {
-        n_cells_y = h / aSize;
-        n_cells_x = floor( w / h * n_cells_y ) + 1;
-    }
 
-    SHAPE_POLY_SET ps1( aPoly ), ps2( aPoly ), maskSetOdd, maskSetEven;
+static uint64_t mixHash( uint64_t aValue )
+{
+    aValue += 0x9e3779b97f4a7c15ULL;
+    aValue = ( aValue ^ ( aValue >> 30 ) ) * 0xbf58476d1ce4e5b9ULL;
+    aValue = ( aValue ^ ( aValue >> 27 ) ) * 0x94d049bb133111ebULL;
 
-    for( int yy = 0; yy < n_cells_y; yy++ )
-        for( int xx = 0; xx < n_cells_x; xx++ )
-        {
-            VECTOR2I p;
+    return aValue ^ ( aValue >> 31 );
+}
 
-            p.x = bb.GetX() + w * xx / n_cells_x;
-            p.y = bb.GetY() + h * yy / n_cells_y;
 
-            VECTOR2I p2;
+/**
+ * Triangulates the outlines of a fractured polygon set, appending the result to aResult.
+ *
+ * If the tesselation fails, we re-fracture the polygon set, which will first simplify it
+ * before fracturing and removing the holes.  This may result in multiple, disjoint polygons.
+ *
+ * @return false if the set couldn't be triangulated even after re-fracturing.
+ */
+static bool triangulateOutlines( SHAPE_POLY_SET& aSet, bool aParallel,
+        std::vector<std::shared_ptr<SHAPE_POLY_SET::TRIANGULATED_POLYGON>>& aResult )
+{
+    typedef SHAPE_POLY_SET::TRIANGULATED_POLYGON TRIANGULATED_POLYGON;
 
-            p2.x = bb.GetX() + w * ( xx + 1 ) / n_cells_x;
-            p2.y = bb.GetY() + h * ( yy + 1 ) / n_cells_y;
+    for( int attempt = 0; attempt < 2; attempt++ )
+    {
+        std::vector<std::shared_ptr<TRIANGULATED_POLYGON>> polys( aSet.OutlineCount() );
+        std::atomic<bool> failed( false );
 
+        auto triangulate =
+                [&]( size_t aOutline )
+                {
+                    polys[aOutline] = std::make_shared<TRIANGULATED_POLYGON>();
+                    PolygonTriangulation tess( *polys[aOutline] );
 
-            SHAPE_LINE_CHAIN mask;
-            mask.Append( VECTOR2I( p.x, p.y ) );
-            mask.Append( VECTOR2I( p2.x, p.y ) );
-            mask.Append( VECTOR2I( p2.x, p2.y ) );
-            mask.Append( VECTOR2I( p.x, p2.y ) );
-            mask.SetClosed( true );
+                    if( !tess.TesselatePolygon( aSet.COutline( aOutline ) ) )
+                        failed = true;
+                };
 
-            if( ( xx ^ yy ) & 1 )
-                maskSetOdd.AddOutline( mask );
-            else
-                maskSetEven.AddOutline( mask );
+        if( aParallel && polys.size() > 1 && aSet.TotalVertices() >= PARALLEL_MIN_VERTICES )
+        {
+            TASK_GROUP tasks;
+
+            tasks.ParallelFor( polys.size(), triangulate );
+            tasks.Wait();
+        }
+        else
+        {
+            for( size_t ii = 0; ii < polys.size() && !failed; ii++ )
+                triangulate( ii );
         }
 
-    ps1.BooleanIntersection( maskSetOdd, SHAPE_POLY_SET::PM_FAST );
-    ps2.BooleanIntersection( maskSetEven, SHAPE_POLY_SET::PM_FAST );
-    ps1.Fracture( SHAPE_POLY_SET::PM_FAST );
-    ps2.Fracture( SHAPE_POLY_SET::PM_FAST );
+        if( !failed )
+        {
+            aResult.insert( aResult.end(), polys.begin(), polys.end() );
+            return true;
+        }
 
-    aOut = ps1;
-    for( int i = 0; i < ps2.OutlineCount(); i++ )
-    {
-        aOut.AddOutline( ps2.COutline( i ) );
+        aSet.Fracture( SHAPE_POLY_SET::PM_FAST );
     }
 
-    if( !aOut.OutlineCount() )
-        aOut = aPoly;
+    return false;
 }
 
 
@@ -2121,43 +2706,346 @@ void SHAPE_POLY_SET::CacheTriangulation( bool aPartition )
     if( !recalculate )
         return;
 
-    SHAPE_POLY_SET tmpSet;
+    BOX2I bb = BBox();
 
-    if( aPartition )
-        // This partitions into regularly-sized grids (1cm in pcbnew)
-        partitionPolyIntoRegularCellGrid( *this, 1e7, tmpSet );
+    if( aPartition && ( bb.GetWidth() > TRIANGULATION_CELL_SIZE
+                        || bb.GetHeight() > TRIANGULATION_CELL_SIZE ) )
+    {
+        cacheCellTriangulation( bb );
+    }
     else
     {
-        tmpSet = *this;
+        SHAPE_POLY_SET tmpSet;
+
+        tmpSet.m_polys = m_polys;
 
         if( tmpSet.HasHoles() )
             tmpSet.Fracture( PM_FAST );
+
+        m_triangulationCells.clear();
+        m_triangulatedPolys.clear();
+        m_triangulationValid = triangulateOutlines( tmpSet, true, m_triangulatedPolys );
     }
 
-    m_triangulatedPolys.clear();
-    m_triangulationValid = true;
+    if( m_triangulationValid )
+        m_hash = checksum();
+}
+
+
+void SHAPE_POLY_SET::cacheCellTriangulation( const BOX2I& aBBox )
+{
+    const int64_t cellSize = TRIANGULATION_CELL_SIZE;
+
+    const int x0 = triangulationCell( aBBox.GetX() );
+    const int y0 = triangulationCell( aBBox.GetY() );
+    const int columns = triangulationCell( aBBox.GetRight() ) - x0 + 1;
+    const int rows = triangulationCell( aBBox.GetBottom() ) - y0 + 1;
+
+    std::vector<TRIANGULATION_CELL> cells( size_t( columns ) * rows );
+
+    // Crossings of the edges with the horizontal grid line at the top of each row of cells
+    std::vector<std::vector<std::pair<double, int>>> crossings( rows );
+
+    for( const POLYGON& poly : m_polys )
+    {
+        for( const SHAPE_LINE_CHAIN& path : poly )
+        {
+            for( int ii = 0; ii < path.SegmentCount(); ii++ )
+            {
+                const SEG seg = path.CSegment( ii );
+
+                uint64_t a = ( uint64_t( uint32_t( seg.A.x ) ) << 32 ) | uint32_t( seg.A.y );
+                uint64_t b = ( uint64_t( uint32_t( seg.B.x ) ) << 32 ) | uint32_t( seg.B.y );
+                uint64_t h0 = mixHash( a ^ mixHash( b ) );
+                uint64_t h1 = mixHash( b ^ mixHash( a + 1 ) );
+
+                int64_t minX = std::min( seg.A.x, seg.B.x );
+                int64_t minY = std::min( seg.A.y, seg.B.y );
+                int64_t maxX = std::max( seg.A.x, seg.B.x );
+                int64_t maxY = std::max( seg.A.y, seg.B.y );
+
+                // Cells are closed: edges on a grid line change the content of both sides
+                int xmin = std::max( 0, triangulationCell( minX - 1 ) - x0 );
+                int xmax = std::min( columns - 1, triangulationCell( maxX ) - x0 );
+                int ymin = std::max( 0, triangulationCell( minY - 1 ) - y0 );
+                int ymax = std::min( rows - 1, triangulationCell( maxY ) - y0 );
+
+                for( int y = ymin; y <= ymax; y++ )
+                {
+                    for( int x = xmin; x <= xmax; x++ )
+                    {
+                        TRIANGULATION_CELL& cell = cells[size_t( y ) * columns + x];
+
+                        cell.m_edgeHash[0] += h0;
+                        cell.m_edgeHash[1] += h1;
+                        cell.m_edgeCount++;
+                    }
+                }
+
+                if( seg.A.y == seg.B.y )
+                    continue;
+
+                int dir = seg.B.y > seg.A.y ? 1 : -1;
+
+                for( int y = ymin; y <= ymax; y++ )
+                {
+                    int64_t line = ( y0 + y ) * cellSize;
+
+                    if( ( seg.A.y < line ) != ( seg.B.y < line ) )
+                    {
+                        double x = seg.A.x + double( line - seg.A.y ) * ( seg.B.x - seg.A.x )
+                                             / ( seg.B.y - seg.A.y );
+
+                        crossings[y].emplace_back( x, dir );
+                    }
+                }
+            }
+        }
+    }
 
-    while( tmpSet.OutlineCount() > 0 )
+    // The winding number at the top left corner of each cell, together with the edges touching
+    // it, determines the part of the polygon set within the cell.
+    for( int y = 0; y < rows; y++ )
     {
-        m_triangulatedPolys.push_back( std::make_unique<TRIANGULATED_POLYGON>() );
-        PolygonTriangulation tess( *m_triangulatedPolys.back() );
+        std::sort( crossings[y].begin(), crossings[y].end() );
 
-        // If the tesselation fails, we re-fracture the polygon, which will
-        // first simplify the system before fracturing and removing the holes
-        // This may result in multiple, disjoint polygons.
-        if( !tess.TesselatePolygon( tmpSet.Polygon( 0 ).front() ) )
+        size_t next = 0;
+        int    winding = 0;
+
+        for( int x = 0; x < columns; x++ )
         {
-            tmpSet.Fracture( PM_FAST );
-            m_triangulationValid = false;
+            double corner = ( x0 + x ) * cellSize;
+
+            for( ; next < crossings[y].size() && crossings[y][next].first < corner; next++ )
+                winding += crossings[y][next].second;
+
+            cells[size_t( y ) * columns + x].m_winding = winding;
+        }
+    }
+
+    // Reuse the cells whose content hasn't changed, and collect the others
+    std::vector<size_t> dirty;
+    std::vector<SHAPE_POLY_SET> content;
+    SHAPE_POLY_SET maskSetOdd, maskSetEven;
+    BOX2I dirtyBox;
+    bool  dirtyBoxValid = false;
+
+    auto cellOutline =
+            [&]( size_t aCell )
+            {
+                int left = int( ( x0 + int( aCell % columns ) ) * cellSize );
+                int top = int( ( y0 + int( aCell / columns ) ) * cellSize );
+                int size = TRIANGULATION_CELL_SIZE;
+
+                SHAPE_LINE_CHAIN mask;
+                mask.Append( VECTOR2I( left, top ) );
+                mask.Append( VECTOR2I( left + size, top ) );
+                mask.Append( VECTOR2I( left + size, top + size ) );
+                mask.Append( VECTOR2I( left, top + size ) );
+                mask.SetClosed( true );
+
+                return mask;
+            };
+
+    for( size_t ii = 0; ii < cells.size(); ii++ )
+    {
+        TRIANGULATION_CELL& cell = cells[ii];
+
+        if( cell.m_edgeCount == 0 && cell.m_winding == 0 )
+            continue;
+
+        int  x = x0 + int( ii % columns );
+        int  y = y0 + int( ii / columns );
+        auto prev = m_triangulationCells.find( std::make_pair( x, y ) );
+
+        if( prev != m_triangulationCells.end() && prev->second.SameContent( cell ) )
+        {
+            cell.m_polys = std::move( prev->second.m_polys );
             continue;
         }
 
-        tmpSet.DeletePolygon( 0 );
-        m_triangulationValid = true;
+        dirty.push_back( ii );
+        content.emplace_back();
+
+        SHAPE_LINE_CHAIN mask = cellOutline( ii );
+
+        if( cell.m_edgeCount == 0 )
+        {
+            // Entirely inside the polygon set
+            content.back().AddOutline( mask );
+        }
+        else
+        {
+            if( ( x ^ y ) & 1 )
+                maskSetOdd.AddOutline( mask );
+            else
+                maskSetEven.AddOutline( mask );
+
+            if( dirtyBoxValid )
+                dirtyBox.Merge( mask.BBox() );
+            else
+                dirtyBox = mask.BBox();
+
+            dirtyBoxValid = true;
+        }
     }
 
-    if( m_triangulationValid )
-        m_hash = checksum();
+    m_triangulationCells.clear();
+
+    // Cut the changed cells out of the polygon set, in two sets of cells not sharing an edge so
+    // that their parts don't merge
+    if( maskSetOdd.OutlineCount() || maskSetEven.OutlineCount() )
+    {
+        // Contours entirely outside of the changed cells don't change what's inside them
+        SHAPE_POLY_SET subject;
+
+        for( const POLYGON& poly : m_polys )
+        {
+            if( !poly[0].BBox().Intersects( dirtyBox ) )
+                continue;
+
+            subject.m_polys.emplace_back();
+            subject.m_polys.back().push_back( poly[0] );
+
+            for( size_t ii = 1; ii < poly.size(); ii++ )
+            {
+                if( poly[ii].BBox().Intersects( dirtyBox ) )
+                    subject.m_polys.back().push_back( poly[ii] );
+            }
+        }
+
+        SHAPE_POLY_SET ps1( subject ), ps2( subject );
+
+        ps1.BooleanIntersection( maskSetOdd, PM_FAST );
+        ps2.BooleanIntersection( maskSetEven, PM_FAST );
+        ps1.ParallelFracture( PM_FAST );
+        ps2.ParallelFracture( PM_FAST );
+
+        std::vector<int> dirtyIndex( cells.size(), -1 );
+
+        for( size_t ii = 0; ii < dirty.size(); ii++ )
+            dirtyIndex[dirty[ii]] = int( ii );
+
+        auto cellAt =
+                [&]( const VECTOR2I& aPt )
+                {
+                    int x = triangulationCell( aPt.x ) - x0;
+                    int y = triangulationCell( aPt.y ) - y0;
+
+                    if( x < 0 || y < 0 || x >= columns || y >= rows )
+                        return -1;
+
+                    return dirtyIndex[size_t( y ) * columns + x];
+                };
+
+        for( SHAPE_POLY_SET* parts : { &ps1, &ps2 } )
+        {
+            for( POLYGON& poly : parts->m_polys )
+            {
+                BOX2I bbox = poly[0].BBox();
+                int   first = cellAt( bbox.GetOrigin() );
+
+                if( first >= 0 && first == cellAt( bbox.GetEnd() - VECTOR2I( 1, 1 ) )
+                        && cellOutline( dirty[first] ).BBox().Contains( bbox ) )
+                {
+                    content[first].m_polys.push_back( std::move( poly ) );
+                    continue;
+                }
+
+                // Parts of diagonally adjacent cells touching at a corner can be merged
+                for( size_t ii = 0; ii < dirty.size(); ii++ )
+                {
+                    SHAPE_POLY_SET mask( cellOutline( dirty[ii] ) );
+
+                    if( !mask.BBox().Intersects( bbox ) )
+                        continue;
+
+                    SHAPE_POLY_SET piece;
+
+                    piece.m_polys.push_back( poly );
+                    piece.BooleanIntersection( mask, PM_FAST );
+                    piece.Fracture( PM_FAST );
+
+                    for( POLYGON& piecePoly : piece.m_polys )
+                        content[ii].m_polys.push_back( std::move( piecePoly ) );
+                }
+            }
+        }
+    }
+
+    // Triangulate the changed cells
+    std::atomic<bool> failed( false );
+
+    {
+        TASK_GROUP tasks;
+
+        tasks.ParallelFor( dirty.size(),
+                [&]( size_t aIdx )
+                {
+                    TRIANGULATION_CELL& cell = cells[dirty[aIdx]];
+
+                    if( !triangulateOutlines( content[aIdx], false, cell.m_polys ) )
+                    {
+                        // Don't keep a partial triangulation for reuse
+                        cell.m_edgeCount = -1;
+                        failed = true;
+                    }
+                } );
+
+        tasks.Wait();
+    }
+
+    m_triangulatedPolys.clear();
+
+    for( size_t ii = 0; ii < cells.size(); ii++ )
+    {
+        if( cells[ii].m_edgeCount == 0 && cells[ii].m_winding == 0 )
+            continue;
+
+        m_triangulatedPolys.insert( m_triangulatedPolys.end(), cells[ii].m_polys.begin(),
+                                    cells[ii].m_polys.end() );
+
+        std::pair<int, int> key( x0 + int( ii % columns ), y0 + int( ii / columns ) );
+
+        m_triangulationCells[key] = std::move( cells[ii] );
+    }
+
+    m_triangulationValid = !failed;
+}
+
+
+void SHAPE_POLY_SET::CacheEdgeIndex()
+{
+    // Polygons with fewer edges than this are scanned faster than their index
+    const int MIN_INDEXED_EDGES = 64;
+
+    MD5_HASH hash = checksum();
+
+    if( m_edgeIndexHash.IsValid() && m_edgeIndexHash == hash
+            && m_edgeIndices.size() == m_polys.size() )
+    {
+        // Only edited through an accessor which could have (but hasn't) changed the contours
+        m_edgeIndexValid = true;
+        return;
+    }
+
+    m_edgeIndices.clear();
+
+    for( const POLYGON& poly : m_polys )
+    {
+        int edgeCount = 0;
+
+        for( const SHAPE_LINE_CHAIN& chain : poly )
+            edgeCount += chain.SegmentCount();
+
+        if( edgeCount >= MIN_INDEXED_EDGES )
+            m_edgeIndices.push_back( std::make_unique<POLY_EDGE_INDEX>( poly ) );
+        else
+            m_edgeIndices.push_back( nullptr );
+    }
+
+    m_edgeIndexHash = hash;
+    m_edgeIndexValid = true;
 }
 
 
@@ -0,0 +1,227 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class PROGRESS_REPORTER;
+
+/**
+ * A pool of worker threads with one work-stealing task deque per worker.
+ *
+ * Tasks submitted from inside a worker go to that worker's own deque and are popped LIFO,
+ * so nested work stays on the thread that spawned it.  Idle workers steal FIFO from the
+ * other deques.  Tasks submitted from any other thread go through a shared queue.
+ *
+ * Long-running algorithms should use the process-wide instance (see GetInstance()) through
+ * a #TASK_GROUP rather than starting their own threads, so that running several of them at
+ * once does not oversubscribe the machine.
+ *
+ * Never block on a std::future from inside a pool task; use a nested #TASK_GROUP instead,
+ * whose Wait() runs pending tasks while it waits.
+ */
+class THREAD_POOL
+{
+public:
+    /**
+     * @param aThreadCount is the number of worker threads (0 for one per hardware thread).
+     */
+    explicit THREAD_POOL( size_t aThreadCount = 0 );
+    ~THREAD_POOL();
+
+    THREAD_POOL( const THREAD_POOL& ) = delete;
+    THREAD_POOL& operator=( const THREAD_POOL& ) = delete;
+
+    /**
+     * @return the pool shared by all parallel algorithms of the process.
+     *
+     * Every kiface links its own copy of this library, so the program registers its pool in
+     * each of them with SetInstance().  Until then (in the unit tests, or in a kiface loaded
+     * by a script) a pool private to the module is used.
+     */
+    static THREAD_POOL& GetInstance();
+
+    /**
+     * Make \a aPool the pool returned by GetInstance() in this module.  The caller keeps the
+     * ownership; nullptr reverts to the module's own pool.
+     */
+    static void SetInstance( THREAD_POOL* aPool );
+
+    size_t GetThreadCount() const { return m_workers.size(); }
+
+    /**
+     * Queue a callable for execution.
+     *
+     * @return a future for the result of \a aFunc.
+     */
+    template <typename FUNC>
+    auto Submit( FUNC&& aFunc ) -> std::future<decltype( aFunc() )>
+    {
+        using RESULT = decltype( aFunc() );
+
+        auto task = std::make_shared<std::packaged_task<RESULT()>>( std::forward<FUNC>( aFunc ) );
+        std::future<RESULT> result = task->get_future();
+
+        enqueue( [task]()
+                 {
+                     ( *task )();
+                 } );
+
+        return result;
+    }
+
+    /**
+     * Run one queued task on the calling thread.
+     *
+     * @return true if a task was run, false if there was nothing to do.
+     */
+    bool RunPendingTask();
+
+    /**
+     * @return true if the calling thread is one of the workers of this pool.
+     */
+    bool IsWorkerThread() const { return workerIndex() >= 0; }
+
+private:
+    friend class TASK_GROUP;
+
+    typedef std::function<void()> TASK;
+
+    struct TASK_QUEUE
+    {
+        std::mutex       m_mutex;
+        std::deque<TASK> m_tasks;
+    };
+
+    /**
+     * @return the index of the calling thread among the workers, or -1 for any other thread.
+     *
+     * Looked up in the pool rather than kept in a thread_local: each module has its own
+     * thread_locals, and the pool is shared between modules.
+     */
+    int workerIndex() const;
+
+    void enqueue( TASK&& aTask );
+    bool popTask( TASK& aTask );
+    bool takeBack( TASK_QUEUE& aQueue, TASK& aTask );
+    bool takeFront( TASK_QUEUE& aQueue, TASK& aTask );
+    void workerLoop();
+
+    std::vector<std::thread>                 m_workers;
+    std::vector<std::thread::id>             m_workerIds;     ///< Set before any task runs
+    std::vector<std::unique_ptr<TASK_QUEUE>> m_localQueues;   ///< One deque per worker
+    TASK_QUEUE                               m_sharedQueue;   ///< Tasks from non-workers
+
+    std::atomic<size_t>                      m_pending;       ///< Tasks queued, not started
+    bool                                     m_started;       ///< m_workerIds is complete
+    bool                                     m_stop;
+    std::mutex                               m_sleepMutex;
+    std::condition_variable                  m_wakeup;
+};
+
+
+/**
+ * A batch of tasks run on a #THREAD_POOL that can be waited on and cancelled as a whole.
+ *
+ * Tasks may add further tasks to the group they belong to (or to a new group) while they
+ * run.  Once the group is cancelled, tasks that have not started yet are skipped; running
+ * tasks are expected to poll IsCancelled() in their loops.  The first exception thrown by
+ * a task cancels the group and is rethrown by Wait().
+ */
+class TASK_GROUP
+{
+public:
+    explicit TASK_GROUP( THREAD_POOL& aPool = THREAD_POOL::GetInstance() );
+
+    /**
+     * Cancels and waits for any task still outstanding, without rethrowing.
+     */
+    ~TASK_GROUP();
+
+    TASK_GROUP( const TASK_GROUP& ) = delete;
+    TASK_GROUP& operator=( const TASK_GROUP& ) = delete;
+
+    THREAD_POOL& GetPool() const { return m_pool; }
+
+    /**
+     * Queue \a aTask on the pool as part of this group.
+     */
+    void Run( std::function<void()> aTask );
+
+    /**
+     * Queue calls of \a aFunc for every index in [0, \a aCount).  Indices are handed out
+     * dynamically to at most one task per worker, and stop being handed out once the group
+     * is cancelled.
+     */
+    void ParallelFor( size_t aCount, std::function<void( size_t )> aFunc );
+
+    void Cancel() { m_cancelled = true; }
+    bool IsCancelled() const { return m_cancelled; }
+
+    /**
+     * Block until all tasks of the group have finished.  On a worker thread, pending pool
+     * tasks are run in the meantime.
+     */
+    void Wait();
+
+    /**
+     * Wait for all tasks while keeping \a aReporter refreshed.  Cancels the group if the
+     * user cancels the reporter.  When called from a worker thread the reporter is only
+     * polled for cancellation, as the UI may only be refreshed from the main thread.
+     *
+     * Defined in common (next to the reporter), so only code linking common may call it.
+     */
+    void Wait( PROGRESS_REPORTER* aReporter );
+
+private:
+    /**
+     * Wait at most \a aTimeout for the outstanding tasks.
+     *
+     * @return true if all tasks have finished.
+     */
+    bool waitFor( std::chrono::milliseconds aTimeout );
+
+    void finishTask( std::exception_ptr aError );
+    void rethrow();
+
+    THREAD_POOL&            m_pool;
+    std::atomic<bool>       m_cancelled;
+    size_t                  m_outstanding;
+    std::exception_ptr      m_error;
+    std::mutex              m_mutex;
+    std::condition_variable m_done;
+};
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,362 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <thread_pool.h>
+
+
+static std::atomic<THREAD_POOL*> s_instance( nullptr );
+
+
+THREAD_POOL& THREAD_POOL::GetInstance()
+{
+    if( THREAD_POOL* pool = s_instance.load() )
+        return *pool;
+
+    static THREAD_POOL pool;
+    return pool;
+}
+
+
+void THREAD_POOL::SetInstance( THREAD_POOL* aPool )
+{
+    s_instance = aPool;
+}
+
+
+THREAD_POOL::THREAD_POOL( size_t aThreadCount ) :
+        m_pending( 0 ),
+        m_started( false ),
+        m_stop( false )
+{
+    if( aThreadCount == 0 )
+        aThreadCount = std::max<size_t>( std::thread::hardware_concurrency(), 1 );
+
+    for( size_t ii = 0; ii < aThreadCount; ++ii )
+        m_localQueues.emplace_back( new TASK_QUEUE );
+
+    for( size_t ii = 0; ii < aThreadCount; ++ii )
+    {
+        m_workers.emplace_back( &THREAD_POOL::workerLoop, this );
+        m_workerIds.push_back( m_workers.back().get_id() );
+    }
+
+    // The workers wait for the ids to be complete; the mutex also publishes them
+    {
+        std::lock_guard<std::mutex> lock( m_sleepMutex );
+        m_started = true;
+    }
+
+    m_wakeup.notify_all();
+}
+
+
+THREAD_POOL::~THREAD_POOL()
+{
+    {
+        std::lock_guard<std::mutex> lock( m_sleepMutex );
+        m_stop = true;
+    }
+
+    m_wakeup.notify_all();
+
+    for( std::thread& worker : m_workers )
+        worker.join();
+}
+
+
+bool THREAD_POOL::RunPendingTask()
+{
+    TASK task;
+
+    if( !popTask( task ) )
+        return false;
+
+    task();
+    return true;
+}
+
+
+int THREAD_POOL::workerIndex() const
+{
+    std::thread::id self = std::this_thread::get_id();
+
+    for( size_t ii = 0; ii < m_workerIds.size(); ++ii )
+    {
+        if( m_workerIds[ii] == self )
+            return (int) ii;
+    }
+
+    return -1;
+}
+
+
+void THREAD_POOL::enqueue( TASK&& aTask )
+{
+    int         self = workerIndex();
+    TASK_QUEUE& queue = ( self >= 0 ) ? *m_localQueues[self] : m_sharedQueue;
+
+    {
+        std::lock_guard<std::mutex> lock( queue.m_mutex );
+        queue.m_tasks.push_back( std::move( aTask ) );
+    }
+
+    {
+        // Incremented under the sleep mutex so that a worker checking the wakeup
+        // condition cannot miss it
+        std::lock_guard<std::mutex> lock( m_sleepMutex );
+        m_pending++;
+    }
+
+    m_wakeup.notify_one();
+}
+
+
+bool THREAD_POOL::takeBack( TASK_QUEUE& aQueue, TASK& aTask )
+{
+    std::lock_guard<std::mutex> lock( aQueue.m_mutex );
+
+    if( aQueue.m_tasks.empty() )
+        return false;
+
+    aTask = std::move( aQueue.m_tasks.back() );
+    aQueue.m_tasks.pop_back();
+    m_pending--;
+    return true;
+}
+
+
+bool THREAD_POOL::takeFront( TASK_QUEUE& aQueue, TASK& aTask )
+{
+    std::lock_guard<std::mutex> lock( aQueue.m_mutex );
+
+    if( aQueue.m_tasks.empty() )
+        return false;
+
+    aTask = std::move( aQueue.m_tasks.front() );
+    aQueue.m_tasks.pop_front();
+    m_pending--;
+    return true;
+}
+
+
+bool THREAD_POOL::popTask( TASK& aTask )
+{
+    if( m_pending == 0 )
+        return false;
+
+    int  self = workerIndex();
+    bool isWorker = ( self >= 0 );
+
+    // Own work first (newest first), then work from outside the pool, then steal the
+    // oldest work of the other workers
+    if( isWorker && takeBack( *m_localQueues[self], aTask ) )
+        return true;
+
+    if( takeFront( m_sharedQueue, aTask ) )
+        return true;
+
+    size_t count = m_localQueues.size();
+    size_t first = isWorker ? self + 1 : 0;
+
+    for( size_t ii = 0; ii < count; ++ii )
+    {
+        size_t victim = ( first + ii ) % count;
+
+        if( isWorker && victim == (size_t) self )
+            continue;
+
+        if( takeFront( *m_localQueues[victim], aTask ) )
+            return true;
+    }
+
+    return false;
+}
+
+
+void THREAD_POOL::workerLoop()
+{
+    {
+        std::unique_lock<std::mutex> lock( m_sleepMutex );
+
+        m_wakeup.wait( lock, [this]()
+                             {
+                                 return m_started;
+                             } );
+    }
+
+    while( true )
+    {
+        TASK task;
+
+        if( popTask( task ) )
+        {
+            task();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock( m_sleepMutex );
+
+        m_wakeup.wait( lock, [this]()
+                             {
+                                 return m_stop || m_pending > 0;
+                             } );
+
+        if( m_stop && m_pending == 0 )
+            return;
+    }
+}
+
+
+TASK_GROUP::TASK_GROUP( THREAD_POOL& aPool ) :
+        m_pool( aPool ),
+        m_cancelled( false ),
+        m_outstanding( 0 )
+{
+}
+
+
+TASK_GROUP::~TASK_GROUP()
+{
+    Cancel();
+
+    while( !waitFor( std::chrono::milliseconds( 100 ) ) )
+        ;
+}
+
+
+void TASK_GROUP::Run( std::function<void()> aTask )
+{
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        m_outstanding++;
+    }
+
+    m_pool.enqueue( [this, task = std::move( aTask )]()
+                    {
+                        std::exception_ptr error;
+
+                        if( !m_cancelled )
+                        {
+                            try
+                            {
+                                task();
+                            }
+                            catch( ... )
+                            {
+                                error = std::current_exception();
+                            }
+                        }
+
+                        finishTask( error );
+                    } );
+}
+
+
+void TASK_GROUP::ParallelFor( size_t aCount, std::function<void( size_t )> aFunc )
+{
+    size_t taskCount = std::min( aCount, m_pool.GetThreadCount() );
+
+    auto next = std::make_shared<std::atomic<size_t>>( 0 );
+    auto func = std::make_shared<std::function<void( size_t )>>( std::move( aFunc ) );
+
+    for( size_t ii = 0; ii < taskCount; ++ii )
+    {
+        Run( [this, next, func, aCount]()
+             {
+                 for( size_t i = ( *next )++; i < aCount && !m_cancelled; i = ( *next )++ )
+                     ( *func )( i );
+             } );
+    }
+}
+
+
+void TASK_GROUP::Wait()
+{
+    while( !waitFor( std::chrono::milliseconds( 100 ) ) )
+        ;
+
+    rethrow();
+}
+
+
+bool TASK_GROUP::waitFor( std::chrono::milliseconds aTimeout )
+{
+    auto deadline = std::chrono::steady_clock::now() + aTimeout;
+    bool isWorker = m_pool.IsWorkerThread();
+
+    std::unique_lock<std::mutex> lock( m_mutex );
+
+    while( m_outstanding > 0 )
+    {
+        if( std::chrono::steady_clock::now() >= deadline )
+            return false;
+
+        if( isWorker )
+        {
+            // A worker must not go to sleep here: the tasks it waits on may be sitting in
+            // its own deque.
+            lock.unlock();
+            bool ranTask = m_pool.RunPendingTask();
+            lock.lock();
+
+            if( !ranTask && m_outstanding > 0 )
+                m_done.wait_for( lock, std::chrono::milliseconds( 1 ) );
+        }
+        else
+        {
+            m_done.wait_until( lock, deadline );
+        }
+    }
+
+    return true;
+}
+
+
+void TASK_GROUP::finishTask( std::exception_ptr aError )
+{
+    // Notify while holding the lock: the waiter may destroy the group as soon as it can
+    // observe m_outstanding == 0.
+    std::lock_guard<std::mutex> lock( m_mutex );
+
+    if( aError && !m_error )
+    {
+        m_error = aError;
+        m_cancelled = true;
+    }
+
+    if( --m_outstanding == 0 )
+        m_done.notify_all();
+}
+
+
+void TASK_GROUP::rethrow()
+{
+    std::exception_ptr error;
+
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        std::swap( error, m_error );
+    }
+
+    if( error )
+        std::rethrow_exception( error );
+}
@@ -35,6 +35,7 @@
 #include <footprint.h>
 #include <track.h>
 #include <zone.h>
+#include <zone_knockout_cache.h>
 #include <pcb_marker.h>
 #include <pcb_target.h>
 #include <core/kicad_algo.h>
@@ -50,6 +51,7 @@
 #include <ratsnest/ratsnest_viewitem.h>
 #include <tool/selection_conditions.h>
 #include <convert_drawsegment_list_to_polygon.h>
+#include <drc/drc_engine.h>
 
 // This is an odd place for this, but CvPcb won't link if it's in board_item.cpp like I first
 // tried it.
@@ -59,6 +61,9 @@ wxPoint BOARD_ITEM::ZeroOffset( 0, 0 );
 BOARD::BOARD() :
         BOARD_ITEM_CONTAINER( (BOARD_ITEM*) NULL, PCB_T ),
         m_boardUse( BOARD_USE::NORMAL ),
+        m_zoneFillDirtyAreasValid( false ),
+        m_zoneFillChangeTracked( false ),
+        m_zoneKnockoutCache( new ZONE_KNOCKOUT_CACHE() ),
         m_paper( PAGE_INFO::A4 ),
         m_project( nullptr ),
         m_designSettings( new BOARD_DESIGN_SETTINGS( nullptr, "board.design_settings" ) ),
@@ -134,6 +139,62 @@ void BOARD::BuildConnectivity()
 }
 
 
+void BOARD::MarkZoneFillDirtyArea( const EDA_RECT& aArea )
+{
+    if( m_zoneFillDirtyAreasValid )
+        m_zoneFillDirtyAreas.push_back( aArea );
+
+    m_zoneFillChangeTracked = true;
+}
+
+
+void BOARD::MarkZoneFillDirtyZone( const ZONE* aZone )
+{
+    if( m_zoneFillDirtyAreasValid )
+        m_zoneFillDirtyZones.insert( aZone );
+
+    m_zoneFillChangeTracked = true;
+}
+
+
+void BOARD::OnZoneFillsModified()
+{
+    if( !m_zoneFillChangeTracked )
+        InvalidateZoneFillDirtyAreas();
+
+    m_zoneFillChangeTracked = false;
+}
+
+
+void BOARD::InvalidateZoneFillDirtyAreas()
+{
+    m_zoneFillDirtyAreas.clear();
+    m_zoneFillDirtyZones.clear();
+    m_zoneFillDirtyAreasValid = false;
+}
+
+
+void BOARD::ResetZoneFillDirtyAreas()
+{
+    m_zoneFillDirtyAreas.clear();
+    m_zoneFillDirtyZones.clear();
+    m_zoneFillDirtyAreasValid = true;
+    m_zoneFillChangeTracked = false;
+}
+
+
+bool BOARD::GetZoneFillDirtyAreas( std::vector<EDA_RECT>& aAreas,
+                                   std::set<const ZONE*>& aZones ) const
+{
+    if( !m_zoneFillDirtyAreasValid )
+        return false;
+
+    aAreas = m_zoneFillDirtyAreas;
+    aZones = m_zoneFillDirtyZones;
+    return true;
+}
+
+
 void BOARD::SetProject( PROJECT* aProject )
 {
     m_project = aProject;
@@ -1393,6 +1454,13 @@ void BOARD::SynchronizeNetsAndNetClasses()
 
     BOARD_DESIGN_SETTINGS& bds = GetDesignSettings();
 
+    // Rule resolutions are memoized per net
+    if( bds.m_DRCEngine )
+        bds.m_DRCEngine->ClearConstraintCache();
+
+    // Netclass clearances feed into every zone fill
+    InvalidateZoneFillDirtyAreas();
+
     // Set initial values for custom track width & via size to match the default
     // netclass settings
     bds.UseCustomTrackViaSize( false );
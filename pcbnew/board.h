@@ -36,12 +36,15 @@
 #include <title_block.h>
 #include <tools/pcbnew_selection.h>
 
+#include <set>
+
 class BOARD_COMMIT;
 class PCB_BASE_FRAME;
 class PCB_EDIT_FRAME;
 class PICKED_ITEMS_LIST;
 class BOARD;
 class ZONE;
+class ZONE_KNOCKOUT_CACHE;
 class TRACK;
 class PAD;
 class PCB_MARKER;
@@ -209,6 +212,13 @@ private:
     std::map<wxString, wxString>        m_properties;
     std::shared_ptr<CONNECTIVITY_DATA>  m_connectivity;
 
+    std::vector<EDA_RECT>   m_zoneFillDirtyAreas;       // areas modified since the last fill
+    std::set<const ZONE*>   m_zoneFillDirtyZones;       // zones modified since the last fill
+    bool                    m_zoneFillDirtyAreasValid;  // false if a full refill is required
+    bool                    m_zoneFillChangeTracked;    // last change recorded its dirty areas
+
+    std::unique_ptr<ZONE_KNOCKOUT_CACHE> m_zoneKnockoutCache;
+
     PAGE_INFO           m_paper;
     TITLE_BLOCK         m_titles;               // text in lower right of screen and plots
     PCB_PLOT_PARAMS     m_plotOptions;
@@ -387,6 +397,46 @@ public:
      */
     void BuildConnectivity();
 
+    /**
+     * Record an area modified by a BOARD_COMMIT so that zones can later be refilled only
+     * in the neighbourhood of the change.
+     */
+    void MarkZoneFillDirtyArea( const EDA_RECT& aArea );
+
+    /**
+     * Record a zone whose outline or settings were modified by a BOARD_COMMIT.  Such zones
+     * always get a full refill.
+     */
+    void MarkZoneFillDirtyZone( const ZONE* aZone );
+
+    /**
+     * Called whenever the board is flagged as modified.  Changes which didn't record their
+     * dirty areas beforehand invalidate the record so that the next fill is a full one.
+     */
+    void OnZoneFillsModified();
+
+    /**
+     * Forget the dirty area record and require a full refill of all zones.
+     */
+    void InvalidateZoneFillDirtyAreas();
+
+    /**
+     * Start a new, empty dirty area record.  Called after all zones have been filled.
+     */
+    void ResetZoneFillDirtyAreas();
+
+    /**
+     * @return true if the dirty area record is valid, in which case \a aAreas and \a aZones
+     *         are filled with the areas and zones modified since the last full fill.
+     */
+    bool GetZoneFillDirtyAreas( std::vector<EDA_RECT>& aAreas,
+                                std::set<const ZONE*>& aZones ) const;
+
+    /**
+     * @return the cache of pad clearance outlines shared by all zone fills of this board.
+     */
+    ZONE_KNOCKOUT_CACHE* GetZoneKnockoutCache() const { return m_zoneKnockoutCache.get(); }
+
     /**
      * Delete all MARKERS from the board.
      */
@@ -93,6 +93,10 @@ void BOARD_COMMIT::Push( const wxString& aMessage, bool aCreateUndoEntry, bool a
     SELECTION_TOOL*     selTool = m_toolMgr->GetTool<SELECTION_TOOL>();
     bool                itemsDeselected = false;
 
+    // Only changes which will be flagged through OnModify() need recording; undo/redo and
+    // anything else that bypasses BOARD_COMMIT invalidates the record instead.
+    bool                trackZoneFills = aSetDirtyBit && !m_isFootprintEditor;
+
     if( Empty() )
         return;
 
@@ -134,6 +138,9 @@ void BOARD_COMMIT::Push( const wxString& aMessage, bool aCreateUndoEntry, bool a
             }
         }
 
+        if( trackZoneFills )
+            markZoneFillDirty( board, boardItem, ent.m_copy );
+
         switch( changeType )
         {
             case CHT_ADD:
@@ -327,6 +334,9 @@ void BOARD_COMMIT::Push( const wxString& aMessage, bool aCreateUndoEntry, bool a
 
                 auto boardItem = static_cast<BOARD_ITEM*>( ent.m_item );
 
+                if( trackZoneFills )
+                    markZoneFillDirty( board, boardItem, ent.m_copy );
+
                 if( aCreateUndoEntry )
                 {
                     ITEM_PICKER itemWrapper( nullptr, boardItem, UNDO_REDO::CHANGED );
@@ -363,6 +373,59 @@ void BOARD_COMMIT::Push( const wxString& aMessage, bool aCreateUndoEntry, bool a
 }
 
 
+void BOARD_COMMIT::markZoneFillDirty( BOARD* aBoard, BOARD_ITEM* aItem, EDA_ITEM* aCopy ) const
+{
+    switch( aItem->Type() )
+    {
+    case PCB_MARKER_T:
+    case PCB_GROUP_T:
+        // No geometry of their own; grouped items are staged individually
+        return;
+
+    case PCB_NETINFO_T:
+        // Net changes can affect any zone
+        aBoard->InvalidateZoneFillDirtyAreas();
+        return;
+
+    case PCB_ZONE_T:
+    case PCB_FP_ZONE_T:
+        aBoard->MarkZoneFillDirtyZone( static_cast<ZONE*>( aItem ) );
+        break;
+
+    case PCB_FOOTPRINT_T:
+        for( BOARD_ITEM* item : static_cast<FOOTPRINT*>( aItem )->GraphicalItems() )
+        {
+            if( item->IsOnLayer( Edge_Cuts ) )
+            {
+                aBoard->InvalidateZoneFillDirtyAreas();
+                return;
+            }
+        }
+
+        for( ZONE* zone : static_cast<FOOTPRINT*>( aItem )->Zones() )
+            aBoard->MarkZoneFillDirtyZone( zone );
+
+        break;
+
+    default:
+        // The board outline clips every zone
+        if( aItem->IsOnLayer( Edge_Cuts )
+                || ( aCopy && static_cast<BOARD_ITEM*>( aCopy )->IsOnLayer( Edge_Cuts ) ) )
+        {
+            aBoard->InvalidateZoneFillDirtyAreas();
+            return;
+        }
+
+        break;
+    }
+
+    aBoard->MarkZoneFillDirtyArea( aItem->GetBoundingBox() );
+
+    if( aCopy )
+        aBoard->MarkZoneFillDirtyArea( aCopy->GetBoundingBox() );
+}
+
+
 EDA_ITEM* BOARD_COMMIT::parentObject( EDA_ITEM* aItem ) const
 {
     switch( aItem->Type() )
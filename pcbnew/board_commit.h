@@ -27,6 +27,7 @@
 
 #include <commit.h>
 
+class BOARD;
 class BOARD_ITEM;
 class PICKED_ITEMS_LIST;
 class PCB_TOOL_BASE;
@@ -59,6 +60,12 @@ public:
 private:
     virtual EDA_ITEM* parentObject( EDA_ITEM* aItem ) const override;
 
+    /**
+     * Record the areas of \a aItem (and of its pre-change copy, if any) as dirty for zone
+     * filling so that the next fill only has to recompute their neighbourhood.
+     */
+    void markZoneFillDirty( BOARD* aBoard, BOARD_ITEM* aItem, EDA_ITEM* aCopy ) const;
+
 private:
     TOOL_MANAGER* m_toolMgr;
     bool          m_isFootprintEditor;
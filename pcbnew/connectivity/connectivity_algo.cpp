@@ -28,11 +28,10 @@
 #include <widgets/progress_reporter.h>
 #include <geometry/geometry_utils.h>
 #include <board_commit.h>
+#include <thread_pool.h>
 
-#include <thread>
 #include <mutex>
 #include <algorithm>
-#include <future>
 
 #ifdef PROFILE
 #include <profile.h>
@@ -48,6 +47,7 @@ bool CN_CONNECTIVITY_ALGO::Remove( BOARD_ITEM* aItem )
     case PCB_FOOTPRINT_T:
         for( PAD* pad : static_cast<FOOTPRINT*>( aItem )->Pads() )
         {
+            markNeighboursChanged( m_itemMap[pad] );
             m_itemMap[pad].MarkItemsAsInvalid();
             m_itemMap.erase( pad );
         }
@@ -56,6 +56,7 @@ bool CN_CONNECTIVITY_ALGO::Remove( BOARD_ITEM* aItem )
         break;
 
     case PCB_PAD_T:
+        markNeighboursChanged( m_itemMap[aItem] );
         m_itemMap[aItem].MarkItemsAsInvalid();
         m_itemMap.erase( aItem );
         m_itemList.SetDirty( true );
@@ -63,12 +64,14 @@ bool CN_CONNECTIVITY_ALGO::Remove( BOARD_ITEM* aItem )
 
     case PCB_TRACE_T:
     case PCB_ARC_T:
+        markNeighboursChanged( m_itemMap[aItem] );
         m_itemMap[aItem].MarkItemsAsInvalid();
         m_itemMap.erase( aItem );
         m_itemList.SetDirty( true );
         break;
 
     case PCB_VIA_T:
+        markNeighboursChanged( m_itemMap[aItem] );
         m_itemMap[aItem].MarkItemsAsInvalid();
         m_itemMap.erase( aItem );
         m_itemList.SetDirty( true );
@@ -78,6 +81,7 @@ bool CN_CONNECTIVITY_ALGO::Remove( BOARD_ITEM* aItem )
         m_itemMap[aItem].MarkItemsAsInvalid();
         m_itemMap.erase ( aItem );
         m_itemList.SetDirty( true );
+        m_propagateAll = true;
         break;
 
     default:
@@ -91,6 +95,16 @@ bool CN_CONNECTIVITY_ALGO::Remove( BOARD_ITEM* aItem )
 }
 
 
+void CN_CONNECTIVITY_ALGO::markNeighboursChanged( const ITEM_MAP_ENTRY& aEntry )
+{
+    for( CN_ITEM* item : aEntry.m_items )
+    {
+        for( CN_ITEM* connected : item->ConnectedItems() )
+            m_changedItems.insert( connected->Parent() );
+    }
+}
+
+
 void CN_CONNECTIVITY_ALGO::markItemNetAsDirty( const BOARD_ITEM* aItem )
 {
     if( aItem->IsConnected() )
@@ -177,6 +191,8 @@ bool CN_CONNECTIVITY_ALGO::Add( BOARD_ITEM* aItem )
             for( CN_ITEM* zitem : m_itemList.Add( zone, layer ) )
                 m_itemMap[zone].Link( zitem );
         }
+
+        m_propagateAll = true;
     }
         break;
 
@@ -223,56 +239,24 @@ void CN_CONNECTIVITY_ALGO::searchConnections()
 
     if( m_itemList.IsDirty() )
     {
-        size_t parallelThreadCount = std::min<size_t>( std::thread::hardware_concurrency(),
-                                                       ( dirtyItems.size() + 7 ) / 8 );
-
-        std::atomic<size_t> nextItem( 0 );
-        std::vector<std::future<size_t>> returns( parallelThreadCount );
+        TASK_GROUP tasks;
 
-        auto conn_lambda =
-                [&nextItem, &dirtyItems]( CN_LIST* aItemList,
-                                          PROGRESS_REPORTER* aReporter) -> size_t
+        tasks.ParallelFor( dirtyItems.size(),
+                [&]( size_t aIndex )
                 {
-                    for( size_t i = nextItem++; i < dirtyItems.size(); i = nextItem++ )
-                    {
-                        CN_VISITOR visitor( dirtyItems[i] );
-                        aItemList->FindNearby( dirtyItems[i], visitor );
-
-                        if( aReporter )
-                        {
-                            if( aReporter->IsCancelled() )
-                                break;
-                            else
-                                aReporter->AdvanceProgress();
-                        }
-                    }
-
-                    return 1;
-                };
-
-        if( parallelThreadCount <= 1 )
-            conn_lambda( &m_itemList, m_progressReporter );
-        else
-        {
-            for( size_t ii = 0; ii < parallelThreadCount; ++ii )
-            {
-                returns[ii] = std::async( std::launch::async, conn_lambda, &m_itemList,
-                                          m_progressReporter );
-            }
+                    CN_VISITOR visitor( dirtyItems[aIndex] );
+                    m_itemList.FindNearby( dirtyItems[aIndex], visitor );
 
-            for( size_t ii = 0; ii < parallelThreadCount; ++ii )
-            {
-                // Here we balance returns with a 100ms timeout to allow UI updating
-                std::future_status status;
-                do
-                {
                     if( m_progressReporter )
-                        m_progressReporter->KeepRefreshing();
+                    {
+                        if( m_progressReporter->IsCancelled() )
+                            tasks.Cancel();
+                        else
+                            m_progressReporter->AdvanceProgress();
+                    }
+                } );
 
-                    status = returns[ii].wait_for( std::chrono::milliseconds( 100 ) );
-                } while( status != std::future_status::ready );
-            }
-        }
+        tasks.Wait( m_progressReporter );
 
         if( m_progressReporter )
             m_progressReporter->KeepRefreshing();
@@ -300,9 +284,10 @@ const CN_CONNECTIVITY_ALGO::CLUSTERS CN_CONNECTIVITY_ALGO::SearchClusters( CLUST
 }
 
 
-const CN_CONNECTIVITY_ALGO::CLUSTERS CN_CONNECTIVITY_ALGO::SearchClusters( CLUSTER_SEARCH_MODE aMode,
-                                                                           const KICAD_T aTypes[],
-                                                                           int aSingleNet )
+const CN_CONNECTIVITY_ALGO::CLUSTERS
+CN_CONNECTIVITY_ALGO::SearchClusters( CLUSTER_SEARCH_MODE aMode, const KICAD_T aTypes[],
+                                      int aSingleNet,
+                                      const std::function<bool( CN_ITEM* )>& aSeedFilter )
 {
     bool withinAnyNet = ( aMode != CSM_PROPAGATE );
 
@@ -315,7 +300,7 @@ const CN_CONNECTIVITY_ALGO::CLUSTERS CN_CONNECTIVITY_ALGO::SearchClusters( CLUST
         searchConnections();
 
     auto addToSearchList =
-            [&item_set, withinAnyNet, aSingleNet, aTypes]( CN_ITEM *aItem )
+            [&item_set, withinAnyNet, aSingleNet, aTypes, &aSeedFilter]( CN_ITEM *aItem )
             {
                 if( withinAnyNet && aItem->Net() <= 0 )
                     return;
@@ -342,7 +327,10 @@ const CN_CONNECTIVITY_ALGO::CLUSTERS CN_CONNECTIVITY_ALGO::SearchClusters( CLUST
 
                 aItem->SetVisited( false );
 
-                item_set.insert( aItem );
+                // Clusters are only grown from the seeds; other items are merely reset so
+                // that the seeds' clusters can reach them.
+                if( !aSeedFilter || aSeedFilter( aItem ) )
+                    item_set.insert( aItem );
             };
 
     std::for_each( m_itemList.begin(), m_itemList.end(), addToSearchList );
@@ -531,7 +519,30 @@ void CN_CONNECTIVITY_ALGO::propagateConnections( BOARD_COMMIT* aCommit )
 
 void CN_CONNECTIVITY_ALGO::PropagateNets( BOARD_COMMIT* aCommit )
 {
-    m_connClusters = SearchClusters( CSM_PROPAGATE );
+    constexpr KICAD_T no_zones[] = { PCB_TRACE_T, PCB_ARC_T, PCB_PAD_T, PCB_VIA_T,
+                                     PCB_FOOTPRINT_T, EOT };
+
+    if( m_propagateAll )
+    {
+        m_connClusters = SearchClusters( CSM_PROPAGATE );
+    }
+    else if( m_changedItems.empty() )
+    {
+        m_connClusters.clear();
+    }
+    else
+    {
+        // A cluster's net can only change if an item was added to or removed from it
+        m_connClusters = SearchClusters( CSM_PROPAGATE, no_zones, -1,
+                                         [&]( CN_ITEM* aItem )
+                                         {
+                                             return m_changedItems.count( aItem->Parent() ) > 0;
+                                         } );
+    }
+
+    m_changedItems.clear();
+    m_propagateAll = false;
+
     propagateConnections( aCommit );
 }
 
@@ -604,7 +615,16 @@ void CN_CONNECTIVITY_ALGO::FindIsolatedCopperIslands( std::vector<CN_ZONE_ISOLAT
 
 const CN_CONNECTIVITY_ALGO::CLUSTERS& CN_CONNECTIVITY_ALGO::GetClusters()
 {
-    m_ratsnestClusters = SearchClusters( CSM_RATSNEST );
+    constexpr KICAD_T types[] = { PCB_TRACE_T, PCB_ARC_T, PCB_PAD_T, PCB_VIA_T, PCB_ZONE_T,
+                                  PCB_FOOTPRINT_T, EOT };
+
+    // Ratsnest clusters never span nets, so clean nets don't need searching
+    m_ratsnestClusters = SearchClusters( CSM_RATSNEST, types, -1,
+                                         [&]( CN_ITEM* aItem )
+                                         {
+                                             return aItem->Net() < NetCount()
+                                                    && IsNetDirty( aItem->Net() );
+                                         } );
     return m_ratsnestClusters;
 }
 
@@ -803,6 +823,8 @@ void CN_CONNECTIVITY_ALGO::Clear()
     m_connClusters.clear();
     m_itemMap.clear();
     m_itemList.Clear();
+    m_changedItems.clear();
+    m_propagateAll = true;
 
 }
 
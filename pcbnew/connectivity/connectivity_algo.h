@@ -42,6 +42,7 @@
 #include <functional>
 #include <vector>
 #include <deque>
+#include <unordered_set>
 #include <intrusive_list.h>
 
 #include <connectivity/connectivity_rtree.h>
@@ -165,8 +166,20 @@ private:
     std::vector<bool> m_dirtyNets;
     PROGRESS_REPORTER* m_progressReporter = nullptr;
 
+    ///> Items whose cluster may have changed since nets were last propagated
+    std::unordered_set<const BOARD_ITEM*> m_changedItems;
+
+    ///> Set when a change can't be traced to its clusters (zones, rebuilds)
+    bool m_propagateAll = true;
+
     void    searchConnections();
 
+    /**
+     * Record the items connected to \a aEntry as changed, as removing it may split their
+     * cluster.
+     */
+    void    markNeighboursChanged( const ITEM_MAP_ENTRY& aEntry );
+
     void    propagateConnections( BOARD_COMMIT* aCommit = nullptr );
 
     template <class Container, class BItem>
@@ -175,6 +188,7 @@ private:
         auto item = c.Add( brditem );
 
         m_itemMap[ brditem ] = ITEM_MAP_ENTRY( item );
+        m_changedItems.insert( brditem );
     }
 
     void markItemNetAsDirty( const BOARD_ITEM* aItem );
@@ -232,12 +246,20 @@ public:
     bool Remove( BOARD_ITEM* aItem );
     bool Add( BOARD_ITEM* aItem );
 
+    /**
+     * Search for the clusters of connected items.
+     *
+     * @param aSeedFilter if set, only the clusters containing an item accepted by the filter
+     *                    are built; other clusters are left out of the result.
+     */
     const CLUSTERS SearchClusters( CLUSTER_SEARCH_MODE aMode, const KICAD_T aTypes[],
-                                   int aSingleNet );
+                                   int aSingleNet,
+                                   const std::function<bool( CN_ITEM* )>& aSeedFilter = nullptr );
     const CLUSTERS SearchClusters( CLUSTER_SEARCH_MODE aMode );
 
     /**
-     * Propagates nets from pads to other items in clusters
+     * Propagates nets from pads to other items in clusters.  Only the clusters touched by
+     * items added or removed since the last call are searched.
      * @param aCommit is used to store undo information for items modified by the call
      */
     void PropagateNets( BOARD_COMMIT* aCommit = nullptr );
@@ -252,6 +274,9 @@ public:
      */
     void FindIsolatedCopperIslands( std::vector<CN_ZONE_ISOLATED_ISLAND_LIST>& aZones );
 
+    /**
+     * @return the ratsnest clusters of the nets currently marked dirty.
+     */
     const CLUSTERS& GetClusters();
 
     const CN_LIST& ItemList() const
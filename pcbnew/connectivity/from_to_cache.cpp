@@ -229,6 +229,7 @@ int FROM_TO_CACHE::cacheFromToPaths( const wxString& aFrom, const wxString& aTo
 
 bool  FROM_TO_CACHE::IsOnFromToPath( BOARD_CONNECTED_ITEM* aItem, const wxString& aFrom, const wxString& aTo )
 {
+    std::lock_guard<std::mutex> lock( m_mutex );
     int nFromTosFound = 0;
 
     if( !m_board )
@@ -265,6 +266,8 @@ bool  FROM_TO_CACHE::IsOnFromToPath( BOARD_CONNECTED_ITEM* aItem, const wxString
 
 void FROM_TO_CACHE::Rebuild( BOARD* aBoard )
 {
+    std::lock_guard<std::mutex> lock( m_mutex );
+
     m_board = aBoard;
     buildEndpointList();
     m_ftPaths.clear();
@@ -273,6 +276,8 @@ void FROM_TO_CACHE::Rebuild( BOARD* aBoard )
 
 FROM_TO_CACHE::FT_PATH* FROM_TO_CACHE::QueryFromToPath( const std::set<BOARD_CONNECTED_ITEM*>& aItems )
 {
+    std::lock_guard<std::mutex> lock( m_mutex );
+
     for( auto& ftPath : m_ftPaths )
     {
         if ( ftPath.pathItems == aItems )
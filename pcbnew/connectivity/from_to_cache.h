@@ -20,6 +20,8 @@
 #ifndef __FROM_TO_CACHE_H
 #define __FROM_TO_CACHE_H
 
+#include <deque>
+#include <mutex>
 #include <set>
 
 class PAD;
@@ -66,9 +68,15 @@ private:
     void buildEndpointList();
 
     std::vector<FT_ENDPOINT> m_ftEndpoints;
-    std::vector<FT_PATH> m_ftPaths;
+
+    // A deque, so that paths returned by QueryFromToPath() survive paths cached afterwards
+    std::deque<FT_PATH> m_ftPaths;
 
     BOARD* m_board;
+
+    // Rules using fromTo() are evaluated by several DRC providers at once, and the paths are
+    // cached lazily on the first query for each from/to pair
+    std::mutex m_mutex;
 };
 
 #endif
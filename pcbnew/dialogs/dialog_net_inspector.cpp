@@ -35,6 +35,7 @@
 #include <pcb_painter.h>
 #include <connectivity/connectivity_data.h>
 #include <connectivity/connectivity_algo.h>
+#include <drc/drc_engine.h>
 #include <dialogs/dialog_text_entry.h>
 #include <validators.h>
 #include <bitmaps.h>
@@ -1847,6 +1848,9 @@ void DIALOG_NET_INSPECTOR::onRenameNet( wxCommandEvent& aEvent )
         net->SetNetname( fullNetName );
         m_frame->OnModify();
 
+        if( m_brd->GetDesignSettings().m_DRCEngine )
+            m_brd->GetDesignSettings().m_DRCEngine->ClearConstraintCache();
+
         if( netFilterMatches( net ) )
         {
             std::unique_ptr<LIST_ITEM> new_item = std::make_unique<LIST_ITEM>( net );
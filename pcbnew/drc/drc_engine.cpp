@@ -30,7 +30,9 @@
 #include <drc/drc_rule.h>
 #include <drc/drc_rule_condition.h>
 #include <drc/drc_test_provider.h>
+#include <thread_pool.h>
 #include <track.h>
+#include <hash_eda.h>
 
 void drcPrintDebugMessage( int level, const wxString& msg, const char *function, int line )
 {
@@ -58,7 +60,9 @@ DRC_ENGINE::DRC_ENGINE( BOARD* aBoard, BOARD_DESIGN_SETTINGS *aSettings ) :
     m_reportAllTrackErrors( false ),
     m_testFootprints( false ),
     m_reporter( nullptr ),
-    m_progressReporter( nullptr )
+    m_progressReporter( nullptr ),
+    m_deferViolations( false ),
+    m_shapeCacheEnabled( false )
 {
     m_errorLimits.resize( DRCE_LAST + 1 );
 
@@ -566,6 +570,91 @@ void DRC_ENGINE::compileRules()
             }
         }
     }
+
+    // Disallow constraints look at the item types and flags, so are never cached
+    m_cacheableConstraints.clear();
+
+    for( const std::pair<const DRC_CONSTRAINT_TYPE_T,
+                         std::vector<CONSTRAINT_WITH_CONDITIONS*>*>& pair : m_constraintMap )
+    {
+        if( pair.first == DISALLOW_CONSTRAINT )
+            continue;
+
+        bool cacheable = true;
+
+        for( CONSTRAINT_WITH_CONDITIONS* c : *pair.second )
+        {
+            if( c->condition && !c->condition->IsNetDependentOnly() )
+            {
+                cacheable = false;
+                break;
+            }
+        }
+
+        if( cacheable )
+            m_cacheableConstraints.insert( pair.first );
+    }
+
+    ClearConstraintCache();
+}
+
+
+void DRC_ENGINE::ClearConstraintCache()
+{
+    std::unique_lock<std::shared_timed_mutex> lock( m_constraintCacheLock );
+    m_constraintCache.clear();
+}
+
+
+std::size_t DRC_ENGINE::SHAPE_CACHE_KEY_HASH::operator()( const SHAPE_CACHE_KEY& aKey ) const
+{
+    return hash_val( aKey.first, static_cast<int>( aKey.second ) );
+}
+
+
+std::shared_ptr<SHAPE> DRC_ENGINE::GetEffectiveShape( const BOARD_ITEM* aItem,
+                                                      PCB_LAYER_ID aLayer )
+{
+    switch( aItem->Type() )
+    {
+    case PCB_PAD_T:         // Pads keep their own cache
+    case PCB_TRACE_T:       // A single primitive is cheaper to build than to look up
+    case PCB_ARC_T:
+    case PCB_VIA_T:
+        return aItem->GetEffectiveShape( aLayer );
+
+    default:
+        break;
+    }
+
+    if( !m_shapeCacheEnabled )
+        return aItem->GetEffectiveShape( aLayer );
+
+    SHAPE_CACHE_KEY key( aItem, aLayer );
+
+    {
+        std::shared_lock<std::shared_timed_mutex> readLock( m_shapeCacheLock );
+
+        auto it = m_shapeCache.find( key );
+
+        if( it != m_shapeCache.end() )
+            return it->second;
+    }
+
+    // Build outside the lock; if another thread got there first its shape is kept
+    std::shared_ptr<SHAPE> shape = aItem->GetEffectiveShape( aLayer );
+
+    std::unique_lock<std::shared_timed_mutex> writeLock( m_shapeCacheLock );
+
+    return m_shapeCache.emplace( key, shape ).first->second;
+}
+
+
+std::size_t DRC_ENGINE::CONSTRAINT_CACHE_KEY_HASH::operator()(
+        const CONSTRAINT_CACHE_KEY& aKey ) const
+{
+    return hash_val( static_cast<int>( aKey.m_type ), static_cast<int>( aKey.m_layer ),
+                     aKey.m_netA, aKey.m_netB, aKey.m_flags );
 }
 
 
@@ -587,6 +676,8 @@ void DRC_ENGINE::InitEngine( const wxFileName& aRulePath )
 
     m_rules.clear();
     m_rulesValid = false;
+    m_cacheableConstraints.clear();
+    ClearConstraintCache();
 
     for( std::pair< DRC_CONSTRAINT_TYPE_T,
                     std::vector<CONSTRAINT_WITH_CONDITIONS*>* > pair : m_constraintMap )
@@ -656,6 +747,27 @@ void DRC_ENGINE::RunTests( EDA_UNITS aUnits, bool aReportAllTrackErrors, bool aT
             m_errorLimits[ ii ] = INT_MAX;
     }
 
+    // Nets may have changed since the last run
+    ClearConstraintCache();
+
+    m_shapeCache.clear();
+    m_shapeCacheEnabled = true;
+
+    // Back to immediate reporting and uncached shapes however the run ends, as a provider
+    // may throw.  Declared before the task group, so that it outlives the tasks.
+    struct RUN_STATE_GUARD
+    {
+        DRC_ENGINE* m_engine;
+
+        ~RUN_STATE_GUARD()
+        {
+            m_engine->m_deferViolations = false;
+            m_engine->m_deferredViolations.clear();
+            m_engine->m_shapeCacheEnabled = false;
+            m_engine->m_shapeCache.clear();
+        }
+    } runStateGuard{ this };
+
     for( ZONE* zone : m_board->Zones() )
         zone->CacheBoundingBox();
 
@@ -665,18 +777,84 @@ void DRC_ENGINE::RunTests( EDA_UNITS aUnits, bool aReportAllTrackErrors, bool aT
             zone->CacheBoundingBox();
 
         footprint->BuildPolyCourtyards();
+
+        // Pads build their effective shapes on first use.  Do it here so that providers
+        // running on other threads only ever read them.
+        for( PAD* pad : footprint->Pads() )
+        {
+            if( pad->IsDirty() )
+                pad->BuildEffectiveShapes( UNDEFINED_LAYER );
+        }
     }
 
+    std::vector<DRC_TEST_PROVIDER*> providers;
+
     for( DRC_TEST_PROVIDER* provider : m_testProviders )
     {
-        if( !provider->IsEnabled() )
-            continue;
+        if( provider->IsEnabled() )
+            providers.push_back( provider );
+    }
 
-        drc_dbg( 0, "Running test provider: '%s'\n", provider->GetName() );
+    auto runProvider =
+            [&]( DRC_TEST_PROVIDER* aProvider ) -> bool
+            {
+                drc_dbg( 0, "Running test provider: '%s'\n", aProvider->GetName() );
+
+                ReportAux( wxString::Format( "Run DRC provider: '%s'", aProvider->GetName() ) );
+
+                return aProvider->Run();
+            };
+
+    // Providers which modify the board (flags, connectivity caches, etc.) run first on this
+    // thread; the remaining ones then run concurrently.  Violations are queued so they can be
+    // reported in provider order whichever thread found them.
+    //
+    // A failing provider ends the run, so nothing after it is run (or reported).
+    std::vector<char> succeeded( providers.size(), false );
+    size_t            count = providers.size();
+
+    m_deferredViolations.clear();
+    m_deferViolations = true;
 
-        ReportAux( wxString::Format( "Run DRC provider: '%s'", provider->GetName() ) );
+    for( size_t ii = 0; ii < count; ++ii )
+    {
+        if( !providers[ii]->CanRunConcurrently() )
+        {
+            succeeded[ii] = runProvider( providers[ii] );
 
-        if( !provider->Run() )
+            if( !succeeded[ii] )
+                count = ii + 1;
+        }
+    }
+
+    TASK_GROUP tasks;
+
+    for( size_t ii = 0; ii < count; ++ii )
+    {
+        if( providers[ii]->CanRunConcurrently() )
+        {
+            tasks.Run( [&, ii]()
+                       {
+                           succeeded[ii] = runProvider( providers[ii] );
+                       } );
+        }
+    }
+
+    tasks.Wait( m_progressReporter );
+
+    m_deferViolations = false;
+
+    for( size_t ii = 0; ii < count; ++ii )
+    {
+        auto it = m_deferredViolations.find( providers[ii] );
+
+        if( it != m_deferredViolations.end() )
+        {
+            for( const std::pair<std::shared_ptr<DRC_ITEM>, wxPoint>& violation : it->second )
+                dispatchViolation( violation.first, violation.second );
+        }
+
+        if( !succeeded[ii] )
             break;
     }
 }
@@ -710,6 +888,7 @@ DRC_CONSTRAINT DRC_ENGINE::EvalRulesForItems( DRC_CONSTRAINT_TYPE_T aConstraintI
     const BOARD_CONNECTED_ITEM* connectedB = dynamic_cast<const BOARD_CONNECTED_ITEM*>( b );
     const DRC_CONSTRAINT*       constraintRef = nullptr;
     bool                        implicit = false;
+    wxString                    source;
 
     // Local overrides take precedence
     if( aConstraintId == CLEARANCE_CONSTRAINT )
@@ -719,7 +898,7 @@ DRC_CONSTRAINT DRC_ENGINE::EvalRulesForItems( DRC_CONSTRAINT_TYPE_T aConstraintI
 
         if( connectedA && connectedA->GetLocalClearanceOverrides( nullptr ) > 0 )
         {
-            overrideA = connectedA->GetLocalClearanceOverrides( &m_msg );
+            overrideA = connectedA->GetLocalClearanceOverrides( &source );
 
             REPORT( "" )
             REPORT( wxString::Format( _( "Local override on %s; clearance: %s." ),
@@ -729,7 +908,7 @@ DRC_CONSTRAINT DRC_ENGINE::EvalRulesForItems( DRC_CONSTRAINT_TYPE_T aConstraintI
 
         if( connectedB && connectedB->GetLocalClearanceOverrides( nullptr ) > 0 )
         {
-            overrideB = connectedB->GetLocalClearanceOverrides( &m_msg );
+            overrideB = connectedB->GetLocalClearanceOverrides( &source );
 
             REPORT( "" )
             REPORT( wxString::Format( _( "Local override on %s; clearance: %s." ),
@@ -739,7 +918,7 @@ DRC_CONSTRAINT DRC_ENGINE::EvalRulesForItems( DRC_CONSTRAINT_TYPE_T aConstraintI
 
         if( overrideA || overrideB )
         {
-            DRC_CONSTRAINT constraint( CLEARANCE_CONSTRAINT, m_msg );
+            DRC_CONSTRAINT constraint( CLEARANCE_CONSTRAINT, source );
             constraint.m_Value.SetMin( std::max( overrideA, overrideB ) );
             return constraint;
         }
@@ -927,9 +1106,48 @@ DRC_CONSTRAINT DRC_ENGINE::EvalRulesForItems( DRC_CONSTRAINT_TYPE_T aConstraintI
                 }
             };
 
-    if( m_constraintMap.count( aConstraintId ) )
+    // The interactive (reporting) path always walks the rules so it can explain them
+    bool                 useCache = !aReporter && m_cacheableConstraints.count( aConstraintId );
+    bool                 cacheHit = false;
+    CONSTRAINT_CACHE_KEY cacheKey;
+
+    if( useCache )
+    {
+        cacheKey.m_type = aConstraintId;
+        cacheKey.m_layer = aLayer;
+        cacheKey.m_netA = connectedA ? connectedA->GetNet() : nullptr;
+        cacheKey.m_netB = connectedB ? connectedB->GetNet() : nullptr;
+        cacheKey.m_flags = 0;
+
+        if( connectedA )
+            cacheKey.m_flags |= CONNECTED_A;
+
+        if( connectedB )
+            cacheKey.m_flags |= CONNECTED_B;
+
+        if( isKeepoutZone( a ) )
+            cacheKey.m_flags |= KEEPOUT_A;
+
+        if( isKeepoutZone( b ) )
+            cacheKey.m_flags |= KEEPOUT_B;
+
+        if( b )
+            cacheKey.m_flags |= HAS_B;
+
+        std::shared_lock<std::shared_timed_mutex> lock( m_constraintCacheLock );
+        auto it = m_constraintCache.find( cacheKey );
+
+        if( it != m_constraintCache.end() )
+        {
+            constraintRef = it->second.m_constraint;
+            implicit = it->second.m_implicit;
+            cacheHit = true;
+        }
+    }
+
+    if( !cacheHit && m_constraintMap.count( aConstraintId ) )
     {
-        std::vector<CONSTRAINT_WITH_CONDITIONS*>* ruleset = m_constraintMap[ aConstraintId ];
+        std::vector<CONSTRAINT_WITH_CONDITIONS*>* ruleset = m_constraintMap.at( aConstraintId );
 
         if( aReporter )
         {
@@ -948,6 +1166,12 @@ DRC_CONSTRAINT DRC_ENGINE::EvalRulesForItems( DRC_CONSTRAINT_TYPE_T aConstraintI
                     break;
             }
         }
+
+        if( useCache )
+        {
+            std::unique_lock<std::shared_timed_mutex> lock( m_constraintCacheLock );
+            m_constraintCache.emplace( cacheKey, CONSTRAINT_CACHE_ENTRY{ constraintRef, implicit } );
+        }
     }
 
     // Unfortunately implicit rules don't work for local clearances (such as zones) because
@@ -968,7 +1192,7 @@ DRC_CONSTRAINT DRC_ENGINE::EvalRulesForItems( DRC_CONSTRAINT_TYPE_T aConstraintI
                                       MessageTextFromValue( UNITS, localA ) ) )
 
             if( localA > clearance )
-                clearance = connectedA->GetLocalClearance( &m_msg );
+                clearance = connectedA->GetLocalClearance( &source );
         }
 
         if( localB > 0 )
@@ -979,21 +1203,25 @@ DRC_CONSTRAINT DRC_ENGINE::EvalRulesForItems( DRC_CONSTRAINT_TYPE_T aConstraintI
                                       MessageTextFromValue( UNITS, localB ) ) )
 
             if( localB > clearance )
-                clearance = connectedB->GetLocalClearance( &m_msg );
+                clearance = connectedB->GetLocalClearance( &source );
         }
 
         if( localA > global || localB > global )
         {
-            DRC_CONSTRAINT constraint( CLEARANCE_CONSTRAINT, m_msg );
+            DRC_CONSTRAINT constraint( CLEARANCE_CONSTRAINT, source );
             constraint.m_Value.SetMin( clearance );
             return constraint;
         }
     }
 
-    static DRC_CONSTRAINT nullConstraint( NULL_CONSTRAINT );
+    // May be called concurrently, so the null constraint must not be shared
+    if( constraintRef )
+        return *constraintRef;
+
+    DRC_CONSTRAINT nullConstraint( NULL_CONSTRAINT );
     nullConstraint.m_DisallowFlags = 0;
 
-    return constraintRef ? *constraintRef : nullConstraint;
+    return nullConstraint;
 
 #undef REPORT
 #undef UNITS
@@ -1008,6 +1236,19 @@ bool DRC_ENGINE::IsErrorLimitExceeded( int error_code )
 
 
 void DRC_ENGINE::ReportViolation( const std::shared_ptr<DRC_ITEM>& aItem, wxPoint aPos )
+{
+    if( m_deferViolations )
+    {
+        std::lock_guard<std::mutex> lock( m_reportLock );
+        m_deferredViolations[ aItem->GetViolatingTest() ].emplace_back( aItem, aPos );
+        return;
+    }
+
+    dispatchViolation( aItem, aPos );
+}
+
+
+void DRC_ENGINE::dispatchViolation( const std::shared_ptr<DRC_ITEM>& aItem, wxPoint aPos )
 {
     m_errorLimits[ aItem->GetErrorCode() ] -= 1;
 
@@ -1041,6 +1282,7 @@ void DRC_ENGINE::ReportAux ( const wxString& aStr )
     if( !m_reporter )
         return;
 
+    std::lock_guard<std::mutex> lock( m_reportLock );
     m_reporter->Report( aStr, RPT_SEVERITY_INFO );
 }
 
@@ -1051,6 +1293,10 @@ bool DRC_ENGINE::ReportProgress( double aProgress )
         return true;
 
     m_progressReporter->SetCurrentProgress( aProgress );
+
+    if( THREAD_POOL::GetInstance().IsWorkerThread() )
+        return !m_progressReporter->IsCancelled();
+
     return m_progressReporter->KeepRefreshing( false );
 }
 
@@ -1061,6 +1307,10 @@ bool DRC_ENGINE::ReportPhase( const wxString& aMessage )
         return true;
 
     m_progressReporter->AdvancePhase( aMessage );
+
+    if( THREAD_POOL::GetInstance().IsWorkerThread() )
+        return !m_progressReporter->IsCancelled();
+
     return m_progressReporter->KeepRefreshing( false );
 }
 
@@ -25,6 +25,9 @@
 #define DRC_ENGINE_H
 
 #include <memory>
+#include <mutex>
+#include <set>
+#include <shared_mutex>
 #include <vector>
 #include <unordered_map>
 
@@ -42,6 +45,7 @@ class NETLIST;
 class NETINFO_ITEM;
 class PROGRESS_REPORTER;
 class REPORTER;
+class SHAPE;
 class wxFileName;
 
 namespace KIGFX
@@ -64,6 +68,11 @@ class DRC_CONSTRAINT;
 typedef
 std::function<void( const std::shared_ptr<DRC_ITEM>& aItem, wxPoint aPos )> DRC_VIOLATION_HANDLER;
 
+/**
+ * Violations held back for reporting once a group of concurrent tests has finished.
+ */
+typedef std::vector<std::pair<std::shared_ptr<DRC_ITEM>, wxPoint>> DRC_VIOLATION_LIST;
+
 
 /**
  * Design Rule Checker object that performs all the DRC tests.
@@ -134,6 +143,9 @@ public:
 
     /**
      * Runs the DRC tests.
+     *
+     * Providers which report CanRunConcurrently() are run on the thread pool once the others
+     * have finished.  Violations are reported in provider order regardless.
      */
     void RunTests( EDA_UNITS aUnits,  bool aReportAllTrackErrors, bool aTestFootprints );
 
@@ -145,6 +157,22 @@ public:
                                       PCB_LAYER_ID aLayer = UNDEFINED_LAYER,
                                       REPORTER* aReporter = nullptr );
 
+    /**
+     * Forget all memoized rule resolutions.  Must be called when nets are renamed or moved
+     * between netclasses; rule changes go through InitEngine() which takes care of it.
+     */
+    void ClearConstraintCache();
+
+    /**
+     * Return the effective shape of \a aItem on \a aLayer.
+     *
+     * While RunTests() is in progress the board can't change, so the shapes which are
+     * expensive to build (graphics, text, zones, etc.) are built once and shared by all the
+     * providers.  May be called from any thread.
+     */
+    std::shared_ptr<SHAPE> GetEffectiveShape( const BOARD_ITEM* aItem,
+                                              PCB_LAYER_ID aLayer = UNDEFINED_LAYER );
+
     std::vector<DRC_CONSTRAINT> QueryConstraintsById( DRC_CONSTRAINT_TYPE_T ruleID );
 
     bool HasRulesForConstraintType( DRC_CONSTRAINT_TYPE_T constraintID );
@@ -155,7 +183,17 @@ public:
 
     bool RulesValid() { return m_rulesValid; }
 
+    /**
+     * Report a violation to the violation handler.  May be called from any thread; while
+     * RunTests() is in progress the violation is queued against its provider and reported
+     * once all the providers have finished.
+     */
     void ReportViolation( const std::shared_ptr<DRC_ITEM>& aItem, wxPoint aPos );
+
+    /**
+     * Progress reporting.  These may be called from pool threads, in which case they only
+     * update the progress and check for cancellation (the UI is refreshed by the main thread).
+     */
     bool ReportProgress( double aProgress );
     bool ReportPhase( const wxString& aMessage );
     void ReportAux( const wxString& aStr );
@@ -169,6 +207,55 @@ public:
     static int IsNetADiffPair( BOARD* aBoard, NETINFO_ITEM* aNet, int& aNetP, int& aNetN );
 
 private:
+    /**
+     * Rule resolutions for constraint types whose rule conditions only look at nets are
+     * memoized on the item nets (plus the few item properties the resolution itself looks at).
+     */
+    struct CONSTRAINT_CACHE_KEY
+    {
+        DRC_CONSTRAINT_TYPE_T m_type;
+        PCB_LAYER_ID          m_layer;
+        const NETINFO_ITEM*   m_netA;           // nullptr for unconnected items
+        const NETINFO_ITEM*   m_netB;
+        int                   m_flags;          // CACHE_KEY_FLAGS
+
+        bool operator==( const CONSTRAINT_CACHE_KEY& aOther ) const
+        {
+            return m_type == aOther.m_type && m_layer == aOther.m_layer
+                    && m_netA == aOther.m_netA && m_netB == aOther.m_netB
+                    && m_flags == aOther.m_flags;
+        }
+    };
+
+    enum CACHE_KEY_FLAGS
+    {
+        CONNECTED_A = 0x01,
+        CONNECTED_B = 0x02,
+        KEEPOUT_A   = 0x04,
+        KEEPOUT_B   = 0x08,
+        HAS_B       = 0x10
+    };
+
+    struct CONSTRAINT_CACHE_KEY_HASH
+    {
+        std::size_t operator()( const CONSTRAINT_CACHE_KEY& aKey ) const;
+    };
+
+    struct CONSTRAINT_CACHE_ENTRY
+    {
+        const DRC_CONSTRAINT* m_constraint;     // nullptr if no rule matched
+        bool                  m_implicit;
+    };
+
+    typedef std::pair<const BOARD_ITEM*, PCB_LAYER_ID> SHAPE_CACHE_KEY;
+
+    struct SHAPE_CACHE_KEY_HASH
+    {
+        std::size_t operator()( const SHAPE_CACHE_KEY& aKey ) const;
+    };
+
+    void dispatchViolation( const std::shared_ptr<DRC_ITEM>& aItem, wxPoint aPos );
+
     void addRule( DRC_RULE* rule )
     {
         m_rules.push_back(rule);
@@ -218,7 +305,20 @@ protected:
     REPORTER*                        m_reporter;
     PROGRESS_REPORTER*               m_progressReporter;
 
-    wxString m_msg;  // Allocating strings gets expensive enough to want to avoid it
+    std::mutex                       m_reportLock;
+    bool                             m_deferViolations;
+    std::unordered_map<const DRC_TEST_PROVIDER*, DRC_VIOLATION_LIST> m_deferredViolations;
+
+    std::set<DRC_CONSTRAINT_TYPE_T>  m_cacheableConstraints;
+    std::shared_timed_mutex          m_constraintCacheLock;
+    std::unordered_map<CONSTRAINT_CACHE_KEY, CONSTRAINT_CACHE_ENTRY,
+                       CONSTRAINT_CACHE_KEY_HASH> m_constraintCache;
+
+    bool                             m_shapeCacheEnabled;
+    std::shared_timed_mutex          m_shapeCacheLock;
+    std::unordered_map<SHAPE_CACHE_KEY, std::shared_ptr<SHAPE>,
+                       SHAPE_CACHE_KEY_HASH> m_shapeCache;
+
     std::shared_ptr<KIGFX::VIEW_OVERLAY> m_debugOverlay;
 };
 
@@ -28,6 +28,7 @@
 #include <eda_rect.h>
 #include <board_item.h>
 #include <track.h>
+#include <algorithm>
 #include <unordered_set>
 #include <set>
 #include <vector>
@@ -175,18 +176,23 @@ public:
      * This is a fast test which essentially does bounding-box overlap given a worst-case
      * clearance.  It's used when looking up the specific item-to-item clearance might be
      * expensive and should be deferred till we know we have a possible hit.
+     *
+     * @param aRefShape is the effective shape of \a aRefItem on \a aRefLayer, if the caller
+     *                  already has it.
      */
     int QueryColliding( BOARD_ITEM* aRefItem,
                         PCB_LAYER_ID aRefLayer,
                         PCB_LAYER_ID aTargetLayer,
                         std::function<bool( BOARD_ITEM* )> aFilter = nullptr,
                         std::function<bool( BOARD_ITEM* )> aVisitor = nullptr,
-                        int aClearance = 0 ) const
+                        int aClearance = 0,
+                        SHAPE* aRefShape = nullptr ) const
     {
         // keep track of BOARD_ITEMs that have been already found to collide (some items
         // might be build of COMPOUND/triangulated shapes and a single subshape collision
-        // means we have a hit)
-        std::unordered_set<BOARD_ITEM*> collidingCompounds;
+        // means we have a hit).  There are rarely more than a handful, so a vector is much
+        // cheaper than a hash set here.
+        std::vector<BOARD_ITEM*> collidingCompounds;
 
         EDA_RECT box = aRefItem->GetBoundingBox();
         box.Inflate( aClearance );
@@ -194,7 +200,14 @@ public:
         int min[2] = { box.GetX(),         box.GetY() };
         int max[2] = { box.GetRight(),     box.GetBottom() };
 
-        std::shared_ptr<SHAPE> refShape = aRefItem->GetEffectiveShape( aRefLayer );
+        std::shared_ptr<SHAPE> ownedRefShape;
+        SHAPE*                 refShape = aRefShape;
+
+        if( !refShape )
+        {
+            ownedRefShape = aRefItem->GetEffectiveShape( aRefLayer );
+            refShape = ownedRefShape.get();
+        }
 
         int count = 0;
 
@@ -204,14 +217,17 @@ public:
                     if( aItem->parent == aRefItem )
                         return true;
 
-                    if( collidingCompounds.find( aItem->parent ) != collidingCompounds.end() )
+                    if( std::find( collidingCompounds.begin(), collidingCompounds.end(),
+                                   aItem->parent ) != collidingCompounds.end() )
+                    {
                         return true;
+                    }
 
                     if( !aFilter || aFilter( aItem->parent ) )
                     {
                         if( refShape->Collide( aItem->shape, aClearance ) )
                         {
-                            collidingCompounds.insert( aItem->parent );
+                            collidingCompounds.push_back( aItem->parent );
                             count++;
 
                             if( aVisitor )
@@ -295,6 +311,13 @@ public:
         ITEM_WITH_SHAPE* testItem;
     };
 
+    /**
+     * Visits all pairs of items of \a aRefTree and this tree, on each of \a aLayerPairs, whose
+     * bounding boxes come within \a aMaxClearance of each other.
+     *
+     * The candidate pairs of each layer pair are found with a single sort-and-sweep join of the
+     * two layers rather than a tree search per reference item.
+     */
     int QueryCollidingPairs( DRC_RTREE* aRefTree,
                              std::vector<LAYER_PAIR> aLayerPairs,
                              std::function<bool( const LAYER_PAIR&,
@@ -303,34 +326,22 @@ public:
                              int aMaxClearance,
                              std::function<bool(int, int )> aProgressReporter ) const
     {
-        std::vector<PAIR_INFO> pairsToVisit;
+        std::vector<PAIR_INFO>  pairsToVisit;
+        std::vector<SWEEP_ITEM> refItems;
+        std::vector<SWEEP_ITEM> testItems;
 
         for( LAYER_PAIR& layerPair : aLayerPairs )
         {
-            const PCB_LAYER_ID refLayer = layerPair.first;
-            const PCB_LAYER_ID targetLayer = layerPair.second;
-
-            for( ITEM_WITH_SHAPE* refItem : aRefTree->OnLayer( refLayer ) )
-            {
-                BOX2I box = refItem->shape->BBox();
-                box.Inflate( aMaxClearance );
+            collectSweepItems( aRefTree->m_tree[layerPair.first], aMaxClearance, refItems );
+            collectSweepItems( m_tree[layerPair.second], 0, testItems );
 
-                int min[2] = { box.GetX(),     box.GetY() };
-                int max[2] = { box.GetRight(), box.GetBottom() };
-
-                auto visit =
-                        [&]( ITEM_WITH_SHAPE* aItemToTest ) -> bool
-                        {
-                            // don't collide items against themselves
-                            if( aItemToTest->parent == refItem->parent )
-                                return true;
-
-                            pairsToVisit.emplace_back( layerPair, refItem, aItemToTest );
-                            return true;
-                        };
-
-                this->m_tree[targetLayer]->Search( min, max, visit );
-            };
+            sweepJoin( refItems, testItems,
+                    [&]( ITEM_WITH_SHAPE* aRefItem, ITEM_WITH_SHAPE* aItemToTest )
+                    {
+                        // don't collide items against themselves
+                        if( aItemToTest->parent != aRefItem->parent )
+                            pairsToVisit.emplace_back( layerPair, aRefItem, aItemToTest );
+                    } );
         }
 
         // keep track of BOARD_ITEMs pairs that have been already found to collide (some items
@@ -439,6 +450,80 @@ public:
 
 
 private:
+    struct SWEEP_ITEM
+    {
+        BOX2I            bbox;
+        ITEM_WITH_SHAPE* item;
+    };
+
+    /**
+     * Fill \a aItems with the items of \a aTree and their bounding boxes inflated by
+     * \a aInflate, sorted by left edge.  \a aItems is cleared first so it can be reused.
+     */
+    static void collectSweepItems( drc_rtree* aTree, int aInflate, std::vector<SWEEP_ITEM>& aItems )
+    {
+        aItems.clear();
+
+        for( ITEM_WITH_SHAPE* item : DRC_LAYER( aTree ) )
+        {
+            BOX2I bbox = item->shape->BBox();
+            bbox.Inflate( aInflate );
+            aItems.push_back( { bbox, item } );
+        }
+
+        std::sort( aItems.begin(), aItems.end(),
+                   []( const SWEEP_ITEM& aA, const SWEEP_ITEM& aB )
+                   {
+                       return aA.bbox.GetX() < aB.bbox.GetX();
+                   } );
+    }
+
+    /**
+     * Call \a aVisitor once for every pair of items of \a aRefItems and \a aTestItems with
+     * overlapping bounding boxes.  Both lists must be sorted by left edge.
+     */
+    template <class VISITOR>
+    static void sweepJoin( const std::vector<SWEEP_ITEM>& aRefItems,
+                           const std::vector<SWEEP_ITEM>& aTestItems, VISITOR aVisitor )
+    {
+        auto overlapsY =
+                []( const BOX2I& aA, const BOX2I& aB )
+                {
+                    return aA.GetY() <= aB.GetBottom() && aB.GetY() <= aA.GetBottom();
+                };
+
+        size_t ii = 0;
+        size_t jj = 0;
+
+        // Whichever of the two next items starts first is tested against the items of the
+        // other list starting before it ends; every overlapping pair is reported exactly once.
+        while( ii < aRefItems.size() && jj < aTestItems.size() )
+        {
+            if( aRefItems[ii].bbox.GetX() <= aTestItems[jj].bbox.GetX() )
+            {
+                const SWEEP_ITEM& ref = aRefItems[ii++];
+
+                for( size_t kk = jj; kk < aTestItems.size()
+                                     && aTestItems[kk].bbox.GetX() <= ref.bbox.GetRight(); ++kk )
+                {
+                    if( overlapsY( ref.bbox, aTestItems[kk].bbox ) )
+                        aVisitor( ref.item, aTestItems[kk].item );
+                }
+            }
+            else
+            {
+                const SWEEP_ITEM& test = aTestItems[jj++];
+
+                for( size_t kk = ii; kk < aRefItems.size()
+                                     && aRefItems[kk].bbox.GetX() <= test.bbox.GetRight(); ++kk )
+                {
+                    if( overlapsY( aRefItems[kk].bbox, test.bbox ) )
+                        aVisitor( aRefItems[kk].item, test.item );
+                }
+            }
+        }
+    }
+
     drc_rtree*  m_tree[PCB_LAYER_ID_COUNT];
     size_t      m_count;
 };
@@ -54,7 +54,13 @@ bool DRC_RULE_CONDITION::EvaluateFor( const BOARD_ITEM* aItemA, const BOARD_ITEM
         return false;
     }
 
-    PCB_EXPR_CONTEXT ctx( aLayer );
+    // Conditions are evaluated for nearly every item pair, so each thread recycles a single
+    // context (and the values it allocates) rather than building one per evaluation.
+    // Conditions never evaluate other conditions, so it can't be in use already.
+    static thread_local PCB_EXPR_CONTEXT ctx;
+
+    ctx.Reset();
+    ctx.SetLayer( aLayer );
     ctx.SetErrorCallback(
             [&]( const wxString& aMessage, int aOffset )
             {
@@ -73,6 +79,7 @@ bool DRC_RULE_CONDITION::EvaluateFor( const BOARD_ITEM* aItemA, const BOARD_ITEM
     }
     else if( aItemB )   // Conditions are commutative
     {
+        ctx.Reset();
         ctx.SetItems( b, a );
 
         if( m_ucode->Run( &ctx )->AsDouble() != 0.0 )
@@ -83,6 +90,16 @@ bool DRC_RULE_CONDITION::EvaluateFor( const BOARD_ITEM* aItemA, const BOARD_ITEM
 }
 
 
+bool DRC_RULE_CONDITION::IsNetDependentOnly() const
+{
+    // An empty expression is always true, and a failed compile is always false
+    if( GetExpression().IsEmpty() || !m_ucode )
+        return true;
+
+    return m_ucode->IsNetDependentOnly();
+}
+
+
 bool DRC_RULE_CONDITION::Compile( REPORTER* aReporter, int aSourceLine, int aSourceOffset )
 {
     PCB_EXPR_COMPILER compiler;
@@ -43,6 +43,12 @@ public:
 
     bool Compile( REPORTER* aReporter, int aSourceLine = 0, int aSourceOffset = 0 );
 
+    /**
+     * @return true if the (compiled) condition depends only on the nets of the items it's
+     *         evaluated for, so its result may be shared between items on the same nets.
+     */
+    bool IsNetDependentOnly() const;
+
     void SetExpression( const wxString& aExpression ) { m_expression = aExpression; }
     wxString GetExpression() const { return m_expression; }
 
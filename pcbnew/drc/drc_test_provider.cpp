@@ -53,6 +53,15 @@ void DRC_TEST_PROVIDER::reportViolation( std::shared_ptr<DRC_ITEM>& item, wxPoin
 }
 
 
+void DRC_TEST_PROVIDER::reportViolations( DRC_VIOLATION_LIST& aViolations )
+{
+    for( std::pair<std::shared_ptr<DRC_ITEM>, wxPoint>& violation : aViolations )
+        reportViolation( violation.first, violation.second );
+
+    aViolations.clear();
+}
+
+
 bool DRC_TEST_PROVIDER::reportProgress( int aCount, int aSize, int aDelta )
 {
     if( ( aCount % aDelta ) == 0 || aCount == aSize -  1 )
@@ -91,6 +100,8 @@ EDA_UNITS DRC_TEST_PROVIDER::userUnits() const
 
 void DRC_TEST_PROVIDER::accountCheck( const DRC_RULE* ruleToTest )
 {
+    std::lock_guard<std::mutex> lock( m_statsLock );
+
     auto it = m_stats.find( ruleToTest );
 
     if( it == m_stats.end() )
@@ -27,8 +27,10 @@
 
 #include <board.h>
 #include <pcb_marker.h>
+#include <drc/drc_engine.h>
 
 #include <functional>
+#include <mutex>
 #include <set>
 
 class DRC_ENGINE;
@@ -97,6 +99,15 @@ public:
         return m_isRuleDriven;
     }
 
+    /**
+     * Providers which neither modify the board nor depend on caches built by other providers
+     * may be run concurrently with each other.
+     */
+    virtual bool CanRunConcurrently() const
+    {
+        return false;
+    }
+
     bool IsEnabled() const
     {
         return m_enabled;
@@ -113,6 +124,11 @@ protected:
 
     virtual void reportAux( wxString fmt, ... );
     virtual void reportViolation( std::shared_ptr<DRC_ITEM>& item, wxPoint aMarkerPos );
+
+    /**
+     * Report violations collected by worker threads, in list order.
+     */
+    void reportViolations( DRC_VIOLATION_LIST& aViolations );
     virtual bool reportProgress( int aCount, int aSize, int aDelta );
     virtual bool reportPhase( const wxString& aStageName );
 
@@ -129,6 +145,7 @@ protected:
     EDA_UNITS   userUnits() const;
     DRC_ENGINE* m_drcEngine;
     std::unordered_map<const DRC_RULE*, int> m_stats;
+    std::mutex  m_statsLock;
     bool        m_isRuleDriven = true;
     bool        m_enabled = true;
 
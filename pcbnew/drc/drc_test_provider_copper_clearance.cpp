@@ -39,6 +39,9 @@
 #include <drc/drc_rule.h>
 #include <drc/drc_test_provider_clearance_base.h>
 #include <dimension.h>
+#include <thread_pool.h>
+
+#include <atomic>
 
 /*
     Copper clearance test. Checks all copper items (pads, vias, tracks, drawings, zones) for their electrical clearance.
@@ -47,6 +50,9 @@
     - DRCE_TRACKS_CROSSING
     - DRCE_ZONES_INTERSECT
     - DRCE_SHORTING_ITEMS
+
+    Tracks and pads are tested in parallel.  Each worker collects its violations per item and
+    they're reported in board order afterwards, so the results don't depend on scheduling.
 */
 
 class DRC_TEST_PROVIDER_COPPER_CLEARANCE : public DRC_TEST_PROVIDER_CLEARANCE_BASE
@@ -78,19 +84,34 @@ public:
 
     int GetNumPhases() const override;
 
+    bool CanRunConcurrently() const override
+    {
+        return true;
+    }
+
 private:
+    /**
+     * Each track is tested against the tracks after it and all pads; each pad against the
+     * pads after it.  Other items are never skipped.
+     *
+     * @return true if the pair \a aItem, \a aOther is (or will be) tested from \a aOther.
+     */
+    bool isTestedFromOther( const BOARD_ITEM* aItem, const BOARD_ITEM* aOther ) const;
+
     bool testTrackAgainstItem( TRACK* track, SHAPE* trackShape, PCB_LAYER_ID layer,
-                               BOARD_ITEM* other );
+                               BOARD_ITEM* other, DRC_VIOLATION_LIST& aViolations );
 
     void testTrackClearances();
 
-    bool testPadAgainstItem( PAD* pad, SHAPE* padShape, PCB_LAYER_ID layer, BOARD_ITEM* other );
+    bool testPadAgainstItem( PAD* pad, SHAPE* padShape, PCB_LAYER_ID layer, BOARD_ITEM* other,
+                             DRC_VIOLATION_LIST& aViolations );
 
     void testPadClearances();
 
     void testZones();
 
-    void testItemAgainstZones( BOARD_ITEM* aItem, PCB_LAYER_ID aLayer );
+    void testItemAgainstZones( BOARD_ITEM* aItem, PCB_LAYER_ID aLayer,
+                               DRC_VIOLATION_LIST& aViolations );
 
 private:
     DRC_RTREE m_copperTree;
@@ -99,6 +120,9 @@ private:
     std::vector<ZONE*>                          m_zones;
     std::map<ZONE*, std::unique_ptr<DRC_RTREE>> m_zoneTrees;
 
+    std::vector<TRACK*>                         m_tracks;
+    std::vector<PAD*>                           m_pads;
+    std::unordered_map<const BOARD_ITEM*, size_t> m_testOrder;
 };
 
 
@@ -158,8 +182,6 @@ bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::Run()
                 if( !reportProgress( ii++, count, delta ) )
                     return false;
 
-                item->ClearFlags( SKIP_STRUCT );
-
                 if( item->Type() == PCB_FP_TEXT_T && !static_cast<FP_TEXT*>( item )->IsVisible() )
                     return true;
 
@@ -202,6 +224,19 @@ bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::Run()
 
     }
 
+    m_tracks.assign( m_board->Tracks().begin(), m_board->Tracks().end() );
+    m_pads.clear();
+    m_testOrder.clear();
+
+    for( FOOTPRINT* footprint : m_board->Footprints() )
+        m_pads.insert( m_pads.end(), footprint->Pads().begin(), footprint->Pads().end() );
+
+    for( TRACK* track : m_tracks )
+        m_testOrder.emplace( track, m_testOrder.size() );
+
+    for( PAD* pad : m_pads )
+        m_testOrder.emplace( pad, m_testOrder.size() );
+
     reportAux( "Testing %d copper items and %d zones...", count, m_zones.size() );
 
     if( !reportPhase( _( "Checking track & via clearances..." ) ) )
@@ -224,7 +259,8 @@ bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::Run()
     return true;
 }
 
-static std::shared_ptr<SHAPE> getShape( BOARD_ITEM* aItem, PCB_LAYER_ID aLayer )
+static std::shared_ptr<SHAPE> getShape( DRC_ENGINE* aEngine, BOARD_ITEM* aItem,
+                                        PCB_LAYER_ID aLayer )
 {
     if( aItem->Type() == PCB_PAD_T && !static_cast<PAD*>( aItem )->FlashLayer( aLayer ) )
     {
@@ -244,13 +280,26 @@ static std::shared_ptr<SHAPE> getShape( BOARD_ITEM* aItem, PCB_LAYER_ID aLayer )
         return std::make_shared<SHAPE_NULL>();
     }
 
-    return aItem->GetEffectiveShape( aLayer );
+    return aEngine->GetEffectiveShape( aItem, aLayer );
+}
+
+
+bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::isTestedFromOther( const BOARD_ITEM* aItem,
+                                                            const BOARD_ITEM* aOther ) const
+{
+    auto otherIt = m_testOrder.find( aOther );
+
+    if( otherIt == m_testOrder.end() )
+        return false;
+
+    return otherIt->second < m_testOrder.at( aItem );
 }
 
 
 bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::testTrackAgainstItem( TRACK* track, SHAPE* trackShape,
                                                                PCB_LAYER_ID layer,
-                                                               BOARD_ITEM* other )
+                                                               BOARD_ITEM* other,
+                                                               DRC_VIOLATION_LIST& aViolations )
 {
     if( m_drcEngine->IsErrorLimitExceeded( DRCE_CLEARANCE ) )
         return false;
@@ -275,27 +324,28 @@ bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::testTrackAgainstItem( TRACK* track, SHA
             drcItem->SetItems( track, other );
             drcItem->SetViolatingRule( constraint.GetParentRule() );
 
-            reportViolation( drcItem, (wxPoint) intersection.get() );
+            aViolations.emplace_back( drcItem, (wxPoint) intersection.get() );
             return true;
         }
     }
 
-    std::shared_ptr<SHAPE> otherShape = getShape( other, layer );
+    std::shared_ptr<SHAPE> otherShape = getShape( m_drcEngine, other, layer );
 
     if( trackShape->Collide( otherShape.get(), minClearance - m_drcEpsilon, &actual, &pos ) )
     {
         std::shared_ptr<DRC_ITEM> drce = DRC_ITEM::Create( DRCE_CLEARANCE );
+        wxString                  msg;
 
-        m_msg.Printf( _( "(%s clearance %s; actual %s)" ),
-                      constraint.GetName(),
-                      MessageTextFromValue( userUnits(), minClearance ),
-                      MessageTextFromValue( userUnits(), actual ) );
+        msg.Printf( _( "(%s clearance %s; actual %s)" ),
+                    constraint.GetName(),
+                    MessageTextFromValue( userUnits(), minClearance ),
+                    MessageTextFromValue( userUnits(), actual ) );
 
-        drce->SetErrorMessage( drce->GetErrorText() + wxS( " " ) + m_msg );
+        drce->SetErrorMessage( drce->GetErrorText() + wxS( " " ) + msg );
         drce->SetItems( track, other );
         drce->SetViolatingRule( constraint.GetParentRule() );
 
-        reportViolation( drce, (wxPoint) pos );
+        aViolations.emplace_back( drce, (wxPoint) pos );
 
         if( !m_drcEngine->GetReportAllTrackErrors() )
             return false;
@@ -306,7 +356,8 @@ bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::testTrackAgainstItem( TRACK* track, SHA
 
 
 void DRC_TEST_PROVIDER_COPPER_CLEARANCE::testItemAgainstZones( BOARD_ITEM* aItem,
-                                                               PCB_LAYER_ID aLayer )
+                                                               PCB_LAYER_ID aLayer,
+                                                               DRC_VIOLATION_LIST& aViolations )
 {
     for( ZONE* zone : m_zones )
     {
@@ -329,22 +380,23 @@ void DRC_TEST_PROVIDER_COPPER_CLEARANCE::testItemAgainstZones( BOARD_ITEM* aItem
             int        clearance = constraint.GetValue().Min();
             int        actual;
             VECTOR2I   pos;
-            DRC_RTREE* zoneTree = m_zoneTrees[ zone ].get();
+            DRC_RTREE* zoneTree = m_zoneTrees.at( zone ).get();
 
             if( zoneTree->QueryColliding( aItem, aLayer, clearance - m_drcEpsilon, &actual, &pos ) )
             {
                 std::shared_ptr<DRC_ITEM> drce = DRC_ITEM::Create( DRCE_CLEARANCE );
+                wxString                  msg;
 
-                m_msg.Printf( _( "(%s clearance %s; actual %s)" ),
-                              constraint.GetName(),
-                              MessageTextFromValue( userUnits(), clearance ),
-                              MessageTextFromValue( userUnits(), actual ) );
+                msg.Printf( _( "(%s clearance %s; actual %s)" ),
+                            constraint.GetName(),
+                            MessageTextFromValue( userUnits(), clearance ),
+                            MessageTextFromValue( userUnits(), actual ) );
 
-                drce->SetErrorMessage( drce->GetErrorText() + wxS( " " ) + m_msg );
+                drce->SetErrorMessage( drce->GetErrorText() + wxS( " " ) + msg );
                 drce->SetItems( aItem, zone );
                 drce->SetViolatingRule( constraint.GetParentRule() );
 
-                reportViolation( drce, (wxPoint) pos );
+                aViolations.emplace_back( drce, (wxPoint) pos );
             }
         }
     }
@@ -355,51 +407,65 @@ void DRC_TEST_PROVIDER_COPPER_CLEARANCE::testTrackClearances()
 {
     // This is the number of tests between 2 calls to the progress bar
     const int delta = 25;
-    int       ii = 0;
 
-    reportAux( "Testing %d tracks & vias...", m_board->Tracks().size() );
+    std::vector<DRC_VIOLATION_LIST> violations( m_tracks.size() );
+    std::atomic<size_t>             done( 0 );
+    TASK_GROUP                      tasks;
 
-    for( TRACK* track : m_board->Tracks() )
-    {
-        if( !reportProgress( ii++, m_board->Tracks().size(), delta ) )
-            break;
-
-        for( PCB_LAYER_ID layer : track->GetLayerSet().Seq() )
-        {
-            std::shared_ptr<SHAPE> trackShape = track->GetEffectiveShape( layer );
+    reportAux( "Testing %d tracks & vias...", m_tracks.size() );
 
-            m_copperTree.QueryColliding( track, layer, layer,
-                    // Filter:
-                    [&]( BOARD_ITEM* other ) -> bool
-                    {
-                        if( other->HasFlag( SKIP_STRUCT ) )
-                            return false;
-
-                        auto otherCItem = dynamic_cast<BOARD_CONNECTED_ITEM*>( other );
+    tasks.ParallelFor( m_tracks.size(),
+            [&]( size_t aIndex )
+            {
+                if( !reportProgress( done++, m_tracks.size(), delta ) )
+                {
+                    tasks.Cancel();
+                    return;
+                }
 
-                        if( otherCItem && otherCItem->GetNetCode() == track->GetNetCode() )
-                            return false;
+                TRACK* track = m_tracks[ aIndex ];
 
-                        return true;
-                    },
-                    // Visitor:
-                    [&]( BOARD_ITEM* other ) -> bool
-                    {
-                        return testTrackAgainstItem( track, trackShape.get(), layer, other );
-                    },
-                    m_largestClearance );
+                for( PCB_LAYER_ID layer : track->GetLayerSet().Seq() )
+                {
+                    std::shared_ptr<SHAPE> trackShape = track->GetEffectiveShape( layer );
+
+                    m_copperTree.QueryColliding( track, layer, layer,
+                            // Filter:
+                            [&]( BOARD_ITEM* other ) -> bool
+                            {
+                                if( isTestedFromOther( track, other ) )
+                                    return false;
+
+                                auto otherCItem = dynamic_cast<BOARD_CONNECTED_ITEM*>( other );
+
+                                if( otherCItem && otherCItem->GetNetCode() == track->GetNetCode() )
+                                    return false;
+
+                                return true;
+                            },
+                            // Visitor:
+                            [&]( BOARD_ITEM* other ) -> bool
+                            {
+                                return testTrackAgainstItem( track, trackShape.get(), layer, other,
+                                                             violations[ aIndex ] );
+                            },
+                            m_largestClearance, trackShape.get() );
+
+                    testItemAgainstZones( track, layer, violations[ aIndex ] );
+                }
+            } );
 
-            testItemAgainstZones( track, layer );
-        }
+    tasks.Wait( m_drcEngine->GetProgressReporter() );
 
-        track->SetFlags( SKIP_STRUCT );
-    }
+    for( DRC_VIOLATION_LIST& trackViolations : violations )
+        reportViolations( trackViolations );
 }
 
 
 bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::testPadAgainstItem( PAD* pad, SHAPE* padShape,
                                                              PCB_LAYER_ID layer,
-                                                             BOARD_ITEM* other )
+                                                             BOARD_ITEM* other,
+                                                             DRC_VIOLATION_LIST& aViolations )
 {
     bool testClearance = !m_drcEngine->IsErrorLimitExceeded( DRCE_CLEARANCE );
     bool testShorting = !m_drcEngine->IsErrorLimitExceeded( DRCE_SHORTING_ITEMS );
@@ -412,7 +478,7 @@ bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::testPadAgainstItem( PAD* pad, SHAPE* pa
     if( !testClearance && !testShorting && !testHoles )
         return false;
 
-    std::shared_ptr<SHAPE> otherShape = getShape( other, layer );
+    std::shared_ptr<SHAPE> otherShape = getShape( m_drcEngine, other, layer );
     DRC_CONSTRAINT         constraint;
     int                    clearance;
     int                    actual;
@@ -431,15 +497,16 @@ bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::testPadAgainstItem( PAD* pad, SHAPE* pa
                     && testShorting )
             {
                 std::shared_ptr<DRC_ITEM> drce = DRC_ITEM::Create( DRCE_SHORTING_ITEMS );
+                wxString                  msg;
 
-                m_msg.Printf( _( "(nets %s and %s)" ),
-                              pad->GetNetname(),
-                              otherPad->GetNetname() );
+                msg.Printf( _( "(nets %s and %s)" ),
+                            pad->GetNetname(),
+                            otherPad->GetNetname() );
 
-                drce->SetErrorMessage( drce->GetErrorText() + wxS( " " ) + m_msg );
+                drce->SetErrorMessage( drce->GetErrorText() + wxS( " " ) + msg );
                 drce->SetItems( pad, otherPad );
 
-                reportViolation( drce, otherPad->GetPosition());
+                aViolations.emplace_back( drce, otherPad->GetPosition() );
             }
 
             return true;
@@ -459,17 +526,18 @@ bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::testPadAgainstItem( PAD* pad, SHAPE* pa
                 if( padShape->Collide( otherShape.get(), clearance - m_drcEpsilon, &actual, &pos ) )
                 {
                     std::shared_ptr<DRC_ITEM> drce = DRC_ITEM::Create( DRCE_HOLE_CLEARANCE );
+                    wxString                  msg;
 
-                    m_msg.Printf( _( "(%s clearance %s; actual %s)" ),
-                                  constraint.GetName(),
-                                  MessageTextFromValue( userUnits(), clearance ),
-                                  MessageTextFromValue( userUnits(), actual ) );
+                    msg.Printf( _( "(%s clearance %s; actual %s)" ),
+                                constraint.GetName(),
+                                MessageTextFromValue( userUnits(), clearance ),
+                                MessageTextFromValue( userUnits(), actual ) );
 
-                    drce->SetErrorMessage( drce->GetErrorText() + wxS( " " ) + m_msg );
+                    drce->SetErrorMessage( drce->GetErrorText() + wxS( " " ) + msg );
                     drce->SetItems( pad, other );
                     drce->SetViolatingRule( constraint.GetParentRule() );
 
-                    reportViolation( drce, (wxPoint) pos );
+                    aViolations.emplace_back( drce, (wxPoint) pos );
                 }
             }
         }
@@ -489,17 +557,18 @@ bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::testPadAgainstItem( PAD* pad, SHAPE* pa
         if( padShape->Collide( otherShape.get(), clearance - m_drcEpsilon, &actual, &pos ) )
         {
             std::shared_ptr<DRC_ITEM> drce = DRC_ITEM::Create( DRCE_CLEARANCE );
+            wxString                  msg;
 
-            m_msg.Printf( _( "(%s clearance %s; actual %s)" ),
-                          constraint.GetName(),
-                          MessageTextFromValue( userUnits(), clearance ),
-                          MessageTextFromValue( userUnits(), actual ) );
+            msg.Printf( _( "(%s clearance %s; actual %s)" ),
+                        constraint.GetName(),
+                        MessageTextFromValue( userUnits(), clearance ),
+                        MessageTextFromValue( userUnits(), actual ) );
 
-            drce->SetErrorMessage( drce->GetErrorText() + wxS( " " ) + m_msg );
+            drce->SetErrorMessage( drce->GetErrorText() + wxS( " " ) + msg );
             drce->SetItems( pad, other );
             drce->SetViolatingRule( constraint.GetParentRule() );
 
-            reportViolation( drce, (wxPoint) pos );
+            aViolations.emplace_back( drce, (wxPoint) pos );
         }
     }
 
@@ -511,48 +580,49 @@ void DRC_TEST_PROVIDER_COPPER_CLEARANCE::testPadClearances( )
 {
     const int delta = 25;  // This is the number of tests between 2 calls to the progress bar
 
-    size_t count = 0;
-
-    for( FOOTPRINT* footprint : m_board->Footprints() )
-        count += footprint->Pads().size();
+    std::vector<DRC_VIOLATION_LIST> violations( m_pads.size() );
+    std::atomic<size_t>             done( 0 );
+    TASK_GROUP                      tasks;
 
-    reportAux( "Testing %d pads...", count );
+    reportAux( "Testing %d pads...", m_pads.size() );
 
-    int ii = 0;
-
-    for( FOOTPRINT* footprint : m_board->Footprints() )
-    {
-        for( PAD* pad : footprint->Pads() )
-        {
-            if( !reportProgress( ii++, count, delta ) )
-                break;
-
-            for( PCB_LAYER_ID layer : pad->GetLayerSet().Seq() )
+    tasks.ParallelFor( m_pads.size(),
+            [&]( size_t aIndex )
             {
-                std::shared_ptr<SHAPE> padShape = getShape( pad, layer );
+                if( !reportProgress( done++, m_pads.size(), delta ) )
+                {
+                    tasks.Cancel();
+                    return;
+                }
 
-                m_copperTree.QueryColliding( pad, layer, layer,
-                        // Filter:
-                        [&]( BOARD_ITEM* other ) -> bool
-                        {
-                            if( other->HasFlag( SKIP_STRUCT ) )
-                                return false;
+                PAD* pad = m_pads[ aIndex ];
 
-                            return true;
-                        },
-                        // Visitor
-                        [&]( BOARD_ITEM* other ) -> bool
-                        {
-                            return testPadAgainstItem( pad, padShape.get(), layer, other );
-                        },
-                        m_largestClearance );
+                for( PCB_LAYER_ID layer : pad->GetLayerSet().Seq() )
+                {
+                    std::shared_ptr<SHAPE> padShape = getShape( m_drcEngine, pad, layer );
+
+                    m_copperTree.QueryColliding( pad, layer, layer,
+                            // Filter:
+                            [&]( BOARD_ITEM* other ) -> bool
+                            {
+                                return !isTestedFromOther( pad, other );
+                            },
+                            // Visitor
+                            [&]( BOARD_ITEM* other ) -> bool
+                            {
+                                return testPadAgainstItem( pad, padShape.get(), layer, other,
+                                                           violations[ aIndex ] );
+                            },
+                            m_largestClearance );
+
+                    testItemAgainstZones( pad, layer, violations[ aIndex ] );
+                }
+            } );
 
-                testItemAgainstZones( pad, layer );
-            }
+    tasks.Wait( m_drcEngine->GetProgressReporter() );
 
-            pad->SetFlags( SKIP_STRUCT );
-        }
-    }
+    for( DRC_VIOLATION_LIST& padViolations : violations )
+        reportViolations( padViolations );
 }
 
 
@@ -72,6 +72,11 @@ public:
 
     int GetNumPhases() const override;
 
+    bool CanRunConcurrently() const override
+    {
+        return true;
+    }
+
 private:
     bool testAgainstEdge( BOARD_ITEM* item, SHAPE* itemShape, BOARD_ITEM* other,
                           DRC_CONSTRAINT_TYPE_T aConstraintType, PCB_DRC_CODE aErrorCode );
@@ -83,7 +88,7 @@ bool DRC_TEST_PROVIDER_EDGE_CLEARANCE::testAgainstEdge( BOARD_ITEM* item, SHAPE*
                                                         DRC_CONSTRAINT_TYPE_T aConstraintType,
                                                         PCB_DRC_CODE aErrorCode )
 {
-    const std::shared_ptr<SHAPE>& edgeShape = edge->GetEffectiveShape( Edge_Cuts );
+    std::shared_ptr<SHAPE> edgeShape = m_drcEngine->GetEffectiveShape( edge, Edge_Cuts );
 
     auto constraint = m_drcEngine->EvalRulesForItems( aConstraintType, edge, item );
 
@@ -215,7 +220,7 @@ bool DRC_TEST_PROVIDER_EDGE_CLEARANCE::Run()
         if( !reportProgress( ii++, boardItems.size(), delta ) )
             break;
 
-        const std::shared_ptr<SHAPE>& itemShape = item->GetEffectiveShape();
+        std::shared_ptr<SHAPE> itemShape = m_drcEngine->GetEffectiveShape( item );
 
         if( testCopper && item->IsOnCopperLayer() )
         {
@@ -226,7 +231,7 @@ bool DRC_TEST_PROVIDER_EDGE_CLEARANCE::Run()
                                                 EDGE_CLEARANCE_CONSTRAINT,
                                                 DRCE_COPPER_EDGE_CLEARANCE );
                     },
-                    m_largestClearance );
+                    m_largestClearance, itemShape.get() );
         }
 
         if( testSilk && ( item->GetLayer() == F_SilkS || item->GetLayer() == B_SilkS ) )
@@ -238,7 +243,7 @@ bool DRC_TEST_PROVIDER_EDGE_CLEARANCE::Run()
                                                 SILK_CLEARANCE_CONSTRAINT,
                                                 DRCE_SILK_MASK_CLEARANCE );
                     },
-                    m_largestClearance );
+                    m_largestClearance, itemShape.get() );
         }
     }
 
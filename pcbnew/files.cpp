@@ -51,6 +51,7 @@
 #include <project/project_local_settings.h>
 #include <plugins/cadstar/cadstar_pcb_archive_plugin.h>
 #include <plugins/eagle/eagle_plugin.h>
+#include <plugins/kicad/zone_fill_cache.h>
 #include <dialogs/dialog_imported_layers.h>
 
 
@@ -816,6 +817,9 @@ bool PCB_EDIT_FRAME::SavePcbFile( const wxString& aFileName, bool addToHistory,
         // In case we started a file but didn't fully write it, clean up
         wxRemoveFile( tempFile.GetFullPath() );
 
+        if( wxFileExists( ZONE_FILL_CACHE::GetFileName( tempFile.GetFullPath() ) ) )
+            wxRemoveFile( ZONE_FILL_CACHE::GetFileName( tempFile.GetFullPath() ) );
+
         return false;
     }
 
@@ -835,6 +839,23 @@ bool PCB_EDIT_FRAME::SavePcbFile( const wxString& aFileName, bool addToHistory,
         return false;
     }
 
+    // The zone fill cache, if the board was saved with one, goes along with the board file
+    wxString tempFillCache = ZONE_FILL_CACHE::GetFileName( tempFile.GetFullPath() );
+    wxString fillCache = ZONE_FILL_CACHE::GetFileName( pcbFileName.GetFullPath() );
+
+    if( wxFileExists( tempFillCache ) )
+    {
+        if( !wxRenameFile( tempFillCache, fillCache ) )
+        {
+            DisplayError( this, wxString::Format( _( "Failed to rename temporary file \"%s\"" ),
+                                                  tempFillCache ) );
+        }
+    }
+    else if( wxFileExists( fillCache ) )
+    {
+        wxRemoveFile( fillCache );
+    }
+
     if( !Kiface().IsSingle() )
     {
         WX_STRING_REPORTER backupReporter( &upperTxt );
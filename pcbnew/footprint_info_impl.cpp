@@ -36,7 +36,6 @@
 #include <wildcards_and_files_ext.h>
 #include <widgets/progress_reporter.h>
 
-#include <thread>
 #include <mutex>
 
 
@@ -184,7 +183,7 @@ void FOOTPRINT_LIST_IMPL::StartWorkers( FP_LIB_TABLE* aTable, wxString const* aN
     m_count_finished.store( 0 );
     m_errors.clear();
     m_list.clear();
-    m_threads.clear();
+    m_loader_tasks.reset( new TASK_GROUP );
     m_queue_in.clear();
     m_queue_out.clear();
 
@@ -200,7 +199,10 @@ void FOOTPRINT_LIST_IMPL::StartWorkers( FP_LIB_TABLE* aTable, wxString const* aN
 
     for( unsigned i = 0; i < aNThreads; ++i )
     {
-        m_threads.emplace_back( &FOOTPRINT_LIST_IMPL::loader_job, this );
+        m_loader_tasks->Run( [this]()
+                             {
+                                 loader_job();
+                             } );
     }
 }
 
@@ -210,12 +212,12 @@ void FOOTPRINT_LIST_IMPL::StopWorkers()
 
     // To safely stop our workers, we set the cancellation flag (they will each
     // exit on their next safe loop location when this is set).  Then we need to wait
-    // for all threads to finish as closing the implementation will free the queues
-    // that the threads write to.
-    for( auto& i : m_threads )
-        i.join();
+    // for all tasks to finish as closing the implementation will free the queues
+    // that the tasks write to.
+    if( m_loader_tasks )
+        m_loader_tasks->Wait();
 
-    m_threads.clear();
+    m_loader_tasks.reset();
     m_queue_in.clear();
     m_count_finished.store( 0 );
 
@@ -229,34 +231,32 @@ bool FOOTPRINT_LIST_IMPL::JoinWorkers()
     {
         std::lock_guard<std::mutex> lock1( m_join );
 
-        for( auto& i : m_threads )
-            i.join();
+        if( m_loader_tasks )
+            m_loader_tasks->Wait();
 
-        m_threads.clear();
+        m_loader_tasks.reset();
         m_queue_in.clear();
         m_count_finished.store( 0 );
     }
 
-    size_t total_count = m_queue_out.size();
-
     LOCALE_IO toggle_locale;
 
     // Parse the footprints in parallel. WARNING! This requires changing the locale, which is
-    // GLOBAL. It is only threadsafe to construct the LOCALE_IO before the threads are created,
+    // GLOBAL. It is only threadsafe to construct the LOCALE_IO before the tasks are queued,
     // destroy it after they finish, and block the main (GUI) thread while they work. Any deviation
     // from this will cause nasal demons.
     //
     // TODO: blast LOCALE_IO into the sun
 
     SYNC_QUEUE<std::unique_ptr<FOOTPRINT_INFO>> queue_parsed;
-    std::vector<std::thread>                    threads;
+    TASK_GROUP                                  tasks;
 
-    for( size_t ii = 0; ii < std::thread::hardware_concurrency() + 1; ++ii )
+    for( size_t ii = 0; ii < tasks.GetPool().GetThreadCount(); ++ii )
     {
-        threads.emplace_back( [this, &queue_parsed]() {
+        tasks.Run( [this, &queue_parsed, &tasks]() {
             wxString nickname;
 
-            while( this->m_queue_out.pop( nickname ) && !m_cancelled )
+            while( !tasks.IsCancelled() && this->m_queue_out.pop( nickname ) && !m_cancelled )
             {
                 wxArrayString fpnames;
 
@@ -297,16 +297,10 @@ bool FOOTPRINT_LIST_IMPL::JoinWorkers()
         } );
     }
 
-    while( !m_cancelled && (size_t)m_count_finished.load() < total_count )
-    {
-        if( m_progress_reporter && !m_progress_reporter->KeepRefreshing() )
-            m_cancelled = true;
-
-        wxMilliSleep( 30 );
-    }
+    tasks.Wait( m_progress_reporter );
 
-    for( auto& thr : threads )
-        thr.join();
+    if( m_progress_reporter && m_progress_reporter->IsCancelled() )
+        m_cancelled = true;
 
     std::unique_ptr<FOOTPRINT_INFO> fpi;
 
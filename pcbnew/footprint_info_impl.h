@@ -23,11 +23,12 @@
 #include <atomic>
 #include <functional>
 #include <memory>
-#include <thread>
+#include <mutex>
 #include <vector>
 
 #include <footprint_info.h>
 #include <sync_queue.h>
+#include <thread_pool.h>
 
 class LOCALE_IO;
 
@@ -83,15 +84,15 @@ protected:
 
 class FOOTPRINT_LIST_IMPL : public FOOTPRINT_LIST
 {
-    FOOTPRINT_ASYNC_LOADER*  m_loader;
-    std::vector<std::thread> m_threads;
-    SYNC_QUEUE<wxString>     m_queue_in;
-    SYNC_QUEUE<wxString>     m_queue_out;
-    std::atomic_size_t       m_count_finished;
-    long long                m_list_timestamp;
-    PROGRESS_REPORTER*       m_progress_reporter;
-    std::atomic_bool         m_cancelled;
-    std::mutex               m_join;
+    FOOTPRINT_ASYNC_LOADER*     m_loader;
+    std::unique_ptr<TASK_GROUP> m_loader_tasks;
+    SYNC_QUEUE<wxString>        m_queue_in;
+    SYNC_QUEUE<wxString>        m_queue_out;
+    std::atomic_size_t          m_count_finished;
+    long long                   m_list_timestamp;
+    PROGRESS_REPORTER*          m_progress_reporter;
+    std::atomic_bool            m_cancelled;
+    std::mutex                  m_join;
 
     /**
      * Call aFunc, pushing any IO_ERRORs and std::exceptions it throws onto m_errors.
@@ -1148,6 +1148,7 @@ void PCB_EDIT_FRAME::OnModify( )
     Update3DView( false );
 
     m_ZoneFillsDirty = true;
+    GetBoard()->OnZoneFillsModified();
 }
 
 
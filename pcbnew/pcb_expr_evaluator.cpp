@@ -574,6 +574,8 @@ LIBEVAL::FUNC_CALL_REF PCB_EXPR_UCODE::CreateFuncCall( const wxString& aName )
 {
     PCB_EXPR_BUILTIN_FUNCTIONS& registry = PCB_EXPR_BUILTIN_FUNCTIONS::Instance();
 
+    m_netDependentOnly = false;
+
     return registry.Get( aName.Lower() );
 }
 
@@ -595,12 +597,20 @@ std::unique_ptr<LIBEVAL::VAR_REF> PCB_EXPR_UCODE::CreateVarRef( const wxString&
 
     if( aField.length() == 0 ) // return reference to base object
     {
+        m_netDependentOnly = false;
         return std::move( vref );
     }
 
     wxString field( aField );
     field.Replace( "_",  " " );
 
+    if( aVar == "L" || (    field.CmpNoCase( "Net" )
+                         && field.CmpNoCase( "NetName" )
+                         && field.CmpNoCase( "NetClass" ) ) )
+    {
+        m_netDependentOnly = false;
+    }
+
     for( const PROPERTY_MANAGER::CLASS_INFO& cls : propMgr.GetAllClasses() )
     {
         if( propMgr.IsOfType( cls.type, TYPE_HASH( BOARD_ITEM ) ) )
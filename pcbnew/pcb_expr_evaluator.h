@@ -40,11 +40,23 @@ class PCB_EXPR_VAR_REF;
 class PCB_EXPR_UCODE final : public LIBEVAL::UCODE
 {
 public:
-    PCB_EXPR_UCODE() {};
+    PCB_EXPR_UCODE() :
+            m_netDependentOnly( true )
+    {};
+
     virtual ~PCB_EXPR_UCODE() {};
 
     virtual std::unique_ptr<LIBEVAL::VAR_REF> CreateVarRef( const wxString& aVar, const wxString& aField ) override;
     virtual LIBEVAL::FUNC_CALL_REF CreateFuncCall( const wxString& aName ) override;
+
+    /**
+     * @return true if the expression reads nothing but the net properties (Net, NetName and
+     *         NetClass) of its items, and so evaluates the same for any items on the same nets.
+     */
+    bool IsNetDependentOnly() const { return m_netDependentOnly; }
+
+private:
+    bool m_netDependentOnly;
 };
 
 
@@ -69,6 +81,11 @@ public:
         return m_items[index];
     }
 
+    void SetLayer( PCB_LAYER_ID aLayer )
+    {
+        m_layer = aLayer;
+    }
+
     PCB_LAYER_ID GetLayer() const
     {
         return m_layer;
@@ -824,7 +824,7 @@ void PlotSolderMaskLayer( BOARD *aBoard, PLOTTER* aPlotter, LSET aLayerMask,
 
         // Merge all polygons: After deflating, not merged (not overlapping) polygons
         // will have the initial shape (with perhaps small changes due to deflating transform)
-        areas.Simplify( SHAPE_POLY_SET::PM_STRICTLY_SIMPLE );
+        areas.CascadedUnion( SHAPE_POLY_SET::PM_STRICTLY_SIMPLE );
         areas.Deflate( inflate, numSegs );
     }
 
@@ -41,6 +41,7 @@
 #include <zones.h>
 #include <plugins/kicad/kicad_plugin.h>
 #include <plugins/kicad/pcb_parser.h>
+#include <plugins/kicad/zone_fill_cache.h>
 #include <pcbnew_settings.h>
 #include <boost/ptr_container/ptr_map.hpp>
 #include <convert_basic_shapes_to_polygon.h>    // for enum RECT_CHAMFER_POSITIONS definition
@@ -255,7 +256,7 @@ void FP_CACHE::Load()
             // Queue I/O errors so only files that fail to parse don't get loaded.
             try
             {
-                FILE_LINE_READER    reader( fn.GetFullPath() );
+                MAPPED_FILE_LINE_READER reader( fn.GetFullPath() );
 
                 m_owner->m_parser->SetLineReader( &reader );
 
@@ -349,15 +350,38 @@ void PCB_IO::Save( const wxString& aFileName, BOARD* aBoard, const PROPERTIES* a
     // Prepare net mapping that assures that net codes saved in a file are consecutive integers
     m_mapping->SetBoard( aBoard );
 
-    FILE_OUTPUTFORMATTER    formatter( aFileName );
+    bool     useFillCache = ADVANCED_CFG::GetCfg().m_ZoneFillCache;
+    wxString fillCacheFile = ZONE_FILL_CACHE::GetFileName( aFileName );
+    int      ctl = m_ctl;
 
-    m_out = &formatter;     // no ownership
+    if( useFillCache )
+        m_ctl |= CTL_OMIT_FILLS;
 
-    m_out->Print( 0, "(kicad_pcb (version %d) (generator pcbnew)\n", SEXPR_BOARD_FILE_VERSION );
+    try
+    {
+        FILE_OUTPUTFORMATTER    formatter( aFileName );
 
-    Format( aBoard, 1 );
+        m_out = &formatter;     // no ownership
 
-    m_out->Print( 0, ")\n" );
+        m_out->Print( 0, "(kicad_pcb (version %d) (generator pcbnew)\n",
+                      SEXPR_BOARD_FILE_VERSION );
+
+        Format( aBoard, 1 );
+
+        m_out->Print( 0, ")\n" );
+    }
+    catch( ... )
+    {
+        m_ctl = ctl;
+        throw;
+    }
+
+    m_ctl = ctl;
+
+    if( useFillCache )
+        ZONE_FILL_CACHE( aBoard ).Save( fillCacheFile );
+    else if( wxFileExists( fillCacheFile ) )
+        wxRemoveFile( fillCacheFile );     // the fills in the board file supersede it
 }
 
 
@@ -495,6 +519,11 @@ void PCB_IO::formatGeneral( BOARD* aBoard, int aNestLevel ) const
     m_out->Print( aNestLevel+1, "(thickness %s)\n",
                   FormatInternalUnits( dsnSettings.GetBoardThickness() ).c_str() );
 
+    // Tells the parser that the zone fills are in the fill cache.  Older versions skip it,
+    // like anything else in this section but the thickness.
+    if( m_ctl & CTL_OMIT_FILLS )
+        m_out->Print( aNestLevel+1, "(zone_fill_cache yes)\n" );
+
     m_out->Print( aNestLevel, ")\n\n" );
 
     aBoard->GetPageSettings().Format( m_out, aNestLevel, m_ctl );
@@ -1960,7 +1989,7 @@ void PCB_IO::format( ZONE* aZone, int aNestLevel ) const
         const SHAPE_POLY_SET& fv = aZone->GetFilledPolysList( layer );
         newLine                  = 0;
 
-        if( !fv.IsEmpty() )
+        if( !fv.IsEmpty() && !( m_ctl & CTL_OMIT_FILLS ) )
         {
             int  poly_index  = 0;
             bool new_polygon = true;
@@ -2064,10 +2093,15 @@ PCB_IO::~PCB_IO()
 
 BOARD* PCB_IO::Load( const wxString& aFileName, BOARD* aAppendToMe, const PROPERTIES* aProperties )
 {
-    FILE_LINE_READER reader( aFileName );
+    MAPPED_FILE_LINE_READER reader( aFileName );
 
     BOARD* board = DoLoad( reader, aAppendToMe, aProperties );
 
+    // Restore the zone fills left out of the board file, if it was saved with a fill cache.
+    // A board saved with its fills keeps them as they are: an empty fill is a valid one.
+    if( m_parser->ZoneFillsInCache() )
+        ZONE_FILL_CACHE( board ).Load( ZONE_FILL_CACHE::GetFileName( aFileName ) );
+
     // Give the filename to the board if it's new
     if( !aAppendToMe )
         board->SetFileName( aFileName );
@@ -102,6 +102,7 @@ class PCB_TEXT;
                                                 // (always saved with potion 0,0 and rotation = 0 in library)
 //#define CTL_OMIT_HIDE             (1 << 6)    // found and defined in eda_text.h
 #define CTL_OMIT_LIBNAME            (1 << 7)    ///< Omit lib alias when saving (used for board/not library)
+#define CTL_OMIT_FILLS              (1 << 8)    ///< Omit zone fills (saved in the zone fill cache)
 
 
 // common combinations of the above:
@@ -54,6 +54,7 @@
 #include <plugins/kicad/pcb_parser.h>
 #include <convert_basic_shapes_to_polygon.h>    // for RECT_CHAMFER_POSITIONS definition
 #include <template_fieldnames.h>
+#include <thread_pool.h>
 
 using namespace PCB_KEYS_T;
 
@@ -61,6 +62,10 @@ using namespace PCB_KEYS_T;
 void PCB_PARSER::init()
 {
     m_showLegacyZoneWarning = true;
+    m_zoneFillsInCache = false;
+    m_isWorker = false;
+    m_sawLegacyZoneFill = false;
+    m_zoneNetnames.clear();
     m_tooRecent = false;
     m_requiredVersion = 0;
     m_layerIndices.clear();
@@ -545,6 +550,7 @@ BOARD* PCB_PARSER::parseBOARD_unchecked()
 {
     T token;
     std::map<wxString, wxString> properties;
+    std::vector<DEFERRED_ITEM>   deferredItems;
 
     parseHeader();
 
@@ -615,29 +621,20 @@ BOARD* PCB_PARSER::parseBOARD_unchecked()
             break;
 
         case T_module:
-            m_board->Add( parseFOOTPRINT(), ADD_MODE::APPEND );
-            break;
-
         case T_segment:
-            m_board->Add( parseTRACK(), ADD_MODE::APPEND );
-            break;
-
         case T_arc:
-            m_board->Add( parseARC(), ADD_MODE::APPEND );
+        case T_via:
+        case T_zone:
+            // Copied now, parsed on several threads once the nets and layers are all known
+            deferredItems.emplace_back();
+            deferredItems.back().token = token;
+            deferredItems.back().lineNumber = CopyList( deferredItems.back().text );
             break;
 
         case T_group:
             parseGROUP( m_board );
             break;
 
-        case T_via:
-            m_board->Add( parseVIA(), ADD_MODE::APPEND );
-            break;
-
-        case T_zone:
-            m_board->Add( parseZONE( m_board ), ADD_MODE::APPEND );
-            break;
-
         case T_target:
             m_board->Add( parsePCB_TARGET(), ADD_MODE::APPEND );
             break;
@@ -649,6 +646,8 @@ BOARD* PCB_PARSER::parseBOARD_unchecked()
         }
     }
 
+    parseDeferredItems( deferredItems );
+
     m_board->SetProperties( properties );
 
     if( m_undefinedLayers.size() > 0 )
@@ -734,6 +733,135 @@ BOARD* PCB_PARSER::parseBOARD_unchecked()
 }
 
 
+void PCB_PARSER::parseDeferredItems( std::vector<DEFERRED_ITEM>& aItems )
+{
+    // Each chunk is a run of consecutive items, parsed by its own PCB_PARSER, so that the
+    // results and side effects of the chunks can be merged back in file order.
+    struct CHUNK
+    {
+        size_t                                   first;
+        size_t                                   last;
+        std::unique_ptr<PCB_PARSER>              parser;
+        std::vector<std::unique_ptr<BOARD_ITEM>> items;
+        std::exception_ptr                       error;
+    };
+
+    TASK_GROUP         tasks;
+    std::vector<CHUNK> chunks;
+    size_t             totalSize = 0;
+
+    for( const DEFERRED_ITEM& item : aItems )
+        totalSize += item.text.size();
+
+    // A few chunks per thread, to even out the load
+    size_t chunkSize = totalSize / ( 4 * tasks.GetPool().GetThreadCount() ) + 1;
+
+    for( size_t ii = 0; ii < aItems.size(); )
+    {
+        size_t size = 0;
+
+        chunks.emplace_back();
+        chunks.back().first = ii;
+
+        while( ii < aItems.size() && size < chunkSize )
+            size += aItems[ii++].text.size();
+
+        chunks.back().last = ii;
+    }
+
+    const wxString source = CurSource();
+
+    tasks.ParallelFor( chunks.size(),
+            [&]( size_t aIndex )
+            {
+                CHUNK& chunk = chunks[aIndex];
+
+                chunk.parser = std::make_unique<PCB_PARSER>();
+
+                PCB_PARSER& parser = *chunk.parser;
+
+                parser.m_board = m_board;
+                parser.m_layerIndices = m_layerIndices;
+                parser.m_layerMasks = m_layerMasks;
+                parser.m_netCodes = m_netCodes;
+                parser.m_tooRecent = m_tooRecent;
+                parser.m_requiredVersion = m_requiredVersion;
+                parser.m_resetKIIDs = m_resetKIIDs;
+                parser.m_isWorker = true;
+
+                try
+                {
+                    for( size_t ii = chunk.first; ii < chunk.last; ++ii )
+                    {
+                        DEFERRED_ITEM&     deferred = aItems[ii];
+                        STRING_LINE_READER reader( deferred.text, source, deferred.lineNumber );
+
+                        std::string().swap( deferred.text );
+
+                        parser.PushReader( &reader );
+                        parser.NeedLEFT();
+                        parser.NextTok();
+
+                        switch( deferred.token )
+                        {
+                        case T_module:  chunk.items.emplace_back( parser.parseFOOTPRINT() ); break;
+                        case T_segment: chunk.items.emplace_back( parser.parseTRACK() );     break;
+                        case T_arc:     chunk.items.emplace_back( parser.parseARC() );       break;
+                        case T_via:     chunk.items.emplace_back( parser.parseVIA() );       break;
+                        default:        chunk.items.emplace_back( parser.parseZONE( m_board ) );
+                        }
+
+                        parser.PopReader();
+                    }
+                }
+                catch( ... )
+                {
+                    chunk.error = std::current_exception();
+                }
+            } );
+
+    tasks.Wait();
+
+    // Report the first error of the file, as parsing it in order would have
+    for( CHUNK& chunk : chunks )
+    {
+        if( chunk.error )
+            std::rethrow_exception( chunk.error );
+    }
+
+    for( CHUNK& chunk : chunks )
+    {
+        if( chunk.parser->m_sawLegacyZoneFill )
+        {
+            confirmLegacyZoneFill();
+            m_board->SetModified();
+            break;
+        }
+    }
+
+    for( CHUNK& chunk : chunks )
+    {
+        PCB_PARSER& parser = *chunk.parser;
+
+        for( const std::pair<ZONE*, wxString>& zoneNetname : parser.m_zoneNetnames )
+            fixZoneNet( zoneNetname.first, zoneNetname.second );
+
+        for( std::unique_ptr<BOARD_ITEM>& item : chunk.items )
+            m_board->Add( item.release(), ADD_MODE::APPEND );
+
+        m_groupInfos.insert( m_groupInfos.end(), parser.m_groupInfos.begin(),
+                             parser.m_groupInfos.end() );
+        m_undefinedLayers.insert( parser.m_undefinedLayers.begin(),
+                                  parser.m_undefinedLayers.end() );
+        m_resetKIIDMap.insert( parser.m_resetKIIDMap.begin(), parser.m_resetKIIDMap.end() );
+
+        // A footprint may declare its own (greater) version
+        m_requiredVersion = std::max( m_requiredVersion, parser.m_requiredVersion );
+        m_tooRecent       = m_tooRecent || parser.m_tooRecent;
+    }
+}
+
+
 void PCB_PARSER::resolveGroups( BOARD_ITEM* aParent )
 {
     auto getItem = [&]( const KIID& aId )
@@ -869,7 +997,12 @@ void PCB_PARSER::parseGeneralSection()
             NeedRIGHT();
             break;
 
-        default:              // Skip everything but the board thickness.
+        case T_zone_fill_cache:
+            m_zoneFillsInCache = parseBool();
+            NeedRIGHT();
+            break;
+
+        default:              // Skip everything else.
             while( ( token = NextTok() ) != T_RIGHT )
             {
                 if( !IsSymbol( token ) && token != T_NUMBER )
@@ -4486,24 +4619,18 @@ ZONE* PCB_PARSER::parseZONE( BOARD_ITEM_CONTAINER* aParent )
                     if( token == T_segment )    // deprecated
                     {
                         // SEGMENT fill mode no longer supported.  Make sure user is OK with converting them.
-                        if( m_showLegacyZoneWarning )
+                        if( m_isWorker )
                         {
-                            KIDIALOG dlg( nullptr,
-                                          _( "The legacy segment fill mode is no longer supported.\n"
-                                             "Convert zones to polygon fills?"),
-                                          _( "Legacy Zone Warning" ),
-                                          wxYES_NO | wxICON_WARNING );
-
-                            dlg.DoNotShowCheckbox( __FILE__, __LINE__ );
-
-                            if( dlg.ShowModal() == wxID_NO )
-                                THROW_IO_ERROR( wxT( "CANCEL" ) );
-
-                            m_showLegacyZoneWarning = false;
+                            // No dialogs off the main thread; parseDeferredItems() asks.
+                            m_sawLegacyZoneFill = true;
+                        }
+                        else
+                        {
+                            confirmLegacyZoneFill();
+                            m_board->SetModified();
                         }
 
                         zone->SetFillMode( ZONE_FILL_MODE::POLYGONS );
-                        m_board->SetModified();
                     }
                     else if( token == T_hatch )
                         zone->SetFillMode( ZONE_FILL_MODE::HATCH_PATTERN );
@@ -4851,24 +4978,11 @@ ZONE* PCB_PARSER::parseZONE( BOARD_ITEM_CONTAINER* aParent )
     // Ensure the zone net name is valid, and matches the net code, for copper zones
     if( zone_has_net && ( zone->GetNet()->GetNetname() != netnameFromfile ) )
     {
-        // Can happens which old boards, with nonexistent nets ...
-        // or after being edited by hand
-        // We try to fix the mismatch.
-        NETINFO_ITEM* net = m_board->FindNet( netnameFromfile );
-
-        if( net )   // An existing net has the same net name. use it for the zone
-            zone->SetNetCode( net->GetNet() );
-        else    // Not existing net: add a new net to keep trace of the zone netname
-        {
-            int newnetcode = m_board->GetNetCount();
-            net = new NETINFO_ITEM( m_board, netnameFromfile, newnetcode );
-            m_board->Add( net );
-
-            // Store the new code mapping
-            pushValueIntoMap( newnetcode, net->GetNet() );
-            // and update the zone netcode
-            zone->SetNetCode( net->GetNet() );
-        }
+        // The fix may add a net to the board, so workers leave it to parseDeferredItems()
+        if( m_isWorker )
+            m_zoneNetnames.emplace_back( zone.get(), netnameFromfile );
+        else
+            fixZoneNet( zone.get(), netnameFromfile );
     }
 
     // Clear flags used in zone edition:
@@ -4878,6 +4992,49 @@ ZONE* PCB_PARSER::parseZONE( BOARD_ITEM_CONTAINER* aParent )
 }
 
 
+void PCB_PARSER::fixZoneNet( ZONE* aZone, const wxString& aNetname )
+{
+    // Can happens which old boards, with nonexistent nets ...
+    // or after being edited by hand
+    // We try to fix the mismatch.
+    NETINFO_ITEM* net = m_board->FindNet( aNetname );
+
+    if( net )   // An existing net has the same net name. use it for the zone
+        aZone->SetNetCode( net->GetNet() );
+    else    // Not existing net: add a new net to keep trace of the zone netname
+    {
+        int newnetcode = m_board->GetNetCount();
+        net = new NETINFO_ITEM( m_board, aNetname, newnetcode );
+        m_board->Add( net );
+
+        // Store the new code mapping
+        pushValueIntoMap( newnetcode, net->GetNet() );
+        // and update the zone netcode
+        aZone->SetNetCode( net->GetNet() );
+    }
+}
+
+
+void PCB_PARSER::confirmLegacyZoneFill()
+{
+    if( !m_showLegacyZoneWarning )
+        return;
+
+    KIDIALOG dlg( nullptr,
+                  _( "The legacy segment fill mode is no longer supported.\n"
+                     "Convert zones to polygon fills?"),
+                  _( "Legacy Zone Warning" ),
+                  wxYES_NO | wxICON_WARNING );
+
+    dlg.DoNotShowCheckbox( __FILE__, __LINE__ );
+
+    if( dlg.ShowModal() == wxID_NO )
+        THROW_IO_ERROR( wxT( "CANCEL" ) );
+
+    m_showLegacyZoneWarning = false;
+}
+
+
 PCB_TARGET* PCB_PARSER::parsePCB_TARGET()
 {
     wxCHECK_MSG( CurTok() == T_target, NULL,
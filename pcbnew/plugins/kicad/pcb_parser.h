@@ -84,6 +84,22 @@ class PCB_PARSER : public PCB_LEXER
     KIID_MAP            m_resetKIIDMap;     ///< if resetting UUIDs, record new ones to update groups with
 
     bool                m_showLegacyZoneWarning;
+    bool                m_zoneFillsInCache; ///< the zone fills were saved in the fill cache
+
+    bool                m_isWorker;           ///< parsing deferred items on a worker thread
+    bool                m_sawLegacyZoneFill;  ///< a worker found a legacy segment zone fill
+
+    ///< zones whose net name did not match their net code, fixed up on the main thread
+    std::vector<std::pair<ZONE*, wxString>> m_zoneNetnames;
+
+    // Footprints, tracks and zones of a board are only copied during the first pass over the
+    // file, then parsed concurrently once the nets and layers they refer to are all known.
+    struct DEFERRED_ITEM
+    {
+        PCB_KEYS_T::T token;
+        std::string   text;
+        int           lineNumber;
+    };
 
     // Group membership info refers to other Uuids in the file.
     // We don't want to rely on group declarations being last in the file, so
@@ -134,6 +150,26 @@ class PCB_PARSER : public PCB_LEXER
      */
     void createOldLayerMapping( std::unordered_map< std::string, std::string >& aMap );
 
+    /**
+     * Parse the items deferred by parseBOARD_unchecked() on the thread pool and add them to
+     * the board in their file order.
+     *
+     * @param aItems the deferred items; their text is released as they are parsed.
+     */
+    void parseDeferredItems( std::vector<DEFERRED_ITEM>& aItems );
+
+    /**
+     * Give \a aZone the net named \a aNetname, adding that net to the board if needed.
+     */
+    void fixZoneNet( ZONE* aZone, const wxString& aNetname );
+
+    /**
+     * Ask once whether legacy segment zone fills may be converted to polygon fills.
+     *
+     * @throw IO_ERROR if the user declines.
+     */
+    void confirmLegacyZoneFill();
+
     /**
      * Function skipCurrent
      * Skip the current token level, i.e
@@ -393,6 +429,15 @@ public:
         return m_tooRecent;
     }
 
+    /**
+     * Return whether the board was saved with its zone fills left out, in the zone fill
+     * cache next to the board file.
+     */
+    bool ZoneFillsInCache() const
+    {
+        return m_zoneFillsInCache;
+    }
+
     /**
      * Return a string representing the version of kicad required to open this
      * file. Not particularly meaningful if IsTooRecent() returns false.
@@ -0,0 +1,538 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <cstring>
+#include <limits>
+#include <map>
+
+#include <wx/filename.h>
+#include <wx/log.h>
+#include <wx/wfstream.h>
+#include <wx/zstream.h>
+
+#include <board.h>
+#include <board_design_settings.h>
+#include <footprint.h>
+#include <ki_exception.h>
+#include <macros.h>
+#include <md5_hash.h>
+#include <wildcards_and_files_ext.h>
+#include <zone.h>
+#include <plugins/kicad/zone_fill_cache.h>
+
+
+/**
+ * Flag to enable zone fill cache debugging output.
+ *
+ * @ingroup trace_env_vars
+ */
+static const wxChar traceZoneFillCache[] = wxT( "KICAD_ZONE_FILL_CACHE" );
+
+static const char ZONE_FILL_CACHE_MAGIC[4] = { 'K', 'Z', 'F', 'C' };
+
+static const uint8_t ZONE_FILL_CACHE_VERSION = 1;
+
+static const unsigned FILLED_POLY_ISLAND = 1 << 0;
+
+
+static void writeVarint( std::string& aBuffer, uint64_t aValue )
+{
+    while( aValue >= 0x80 )
+    {
+        aBuffer += static_cast<char>( ( aValue & 0x7F ) | 0x80 );
+        aValue >>= 7;
+    }
+
+    aBuffer += static_cast<char>( aValue );
+}
+
+
+static void writeDelta( std::string& aBuffer, int64_t aDelta )
+{
+    // zigzag encoding, so that small negative deltas stay small
+    writeVarint( aBuffer, ( static_cast<uint64_t>( aDelta ) << 1 ) ^ ( aDelta >> 63 ) );
+}
+
+
+static void writeString( std::string& aBuffer, const std::string& aString )
+{
+    writeVarint( aBuffer, aString.size() );
+    aBuffer += aString;
+}
+
+
+/**
+ * Bounds checked reading of the decompressed cache.  Once anything is out of bounds all reads
+ * return 0 and IsOk() is false.
+ */
+class CACHE_READER
+{
+public:
+    CACHE_READER( const std::string& aBuffer ) :
+            m_next( aBuffer.data() ),
+            m_end( aBuffer.data() + aBuffer.size() ),
+            m_ok( true )
+    {
+    }
+
+    bool IsOk() const { return m_ok; }
+    bool AtEnd() const { return m_next == m_end; }
+
+    uint64_t ReadVarint()
+    {
+        uint64_t value = 0;
+
+        for( int shift = 0; shift < 64; shift += 7 )
+        {
+            if( m_next == m_end )
+                break;
+
+            uint8_t byte = static_cast<uint8_t>( *m_next++ );
+
+            value |= static_cast<uint64_t>( byte & 0x7F ) << shift;
+
+            if( !( byte & 0x80 ) )
+                return value;
+        }
+
+        m_ok = false;
+        m_next = m_end;
+        return 0;
+    }
+
+    int64_t ReadDelta()
+    {
+        uint64_t value = ReadVarint();
+
+        return static_cast<int64_t>( value >> 1 ) ^ -static_cast<int64_t>( value & 1 );
+    }
+
+    /**
+     * Read a count of items that each take at least one byte.
+     */
+    size_t ReadCount()
+    {
+        uint64_t count = ReadVarint();
+
+        if( count > static_cast<uint64_t>( m_end - m_next ) )
+        {
+            m_ok = false;
+            m_next = m_end;
+            return 0;
+        }
+
+        return static_cast<size_t>( count );
+    }
+
+    std::string ReadString()
+    {
+        size_t size = ReadCount();
+        std::string ret( m_next, size );
+
+        m_next += size;
+        return ret;
+    }
+
+private:
+    const char* m_next;
+    const char* m_end;
+    bool        m_ok;
+};
+
+
+wxString ZONE_FILL_CACHE::GetFileName( const wxString& aBoardFileName )
+{
+    wxFileName fn( aBoardFileName );
+
+    fn.SetExt( ZoneFillCacheFileExtension );
+
+    return fn.GetFullPath();
+}
+
+
+std::vector<ZONE*> ZONE_FILL_CACHE::allZones() const
+{
+    std::vector<ZONE*> zones( m_board->Zones().begin(), m_board->Zones().end() );
+
+    for( FOOTPRINT* footprint : m_board->Footprints() )
+        zones.insert( zones.end(), footprint->Zones().begin(), footprint->Zones().end() );
+
+    return zones;
+}
+
+
+std::string ZONE_FILL_CACHE::inputsHash( ZONE* aZone ) const
+{
+    MD5_HASH hash;
+
+    auto hashDouble =
+            [&]( double aValue )
+            {
+                hash.Hash( reinterpret_cast<uint8_t*>( &aValue ), sizeof( aValue ) );
+            };
+
+    std::string netname = TO_UTF8( aZone->GetNetname() );
+
+    hash.Hash( reinterpret_cast<uint8_t*>( &netname[0] ), netname.size() );
+    hash.Hash( m_board->GetDesignSettings().m_MaxError );
+
+    for( PCB_LAYER_ID layer : aZone->GetLayerSet().Seq() )
+        hash.Hash( layer );
+
+    const SHAPE_POLY_SET* outline = aZone->Outline();
+
+    for( int ii = 0; ii < outline->OutlineCount(); ++ii )
+    {
+        hash.Hash( outline->HoleCount( ii ) );
+
+        for( int jj = -1; jj < outline->HoleCount( ii ); ++jj )
+        {
+            const SHAPE_LINE_CHAIN& chain = jj < 0 ? outline->COutline( ii )
+                                                   : outline->CHole( ii, jj );
+
+            hash.Hash( chain.PointCount() );
+
+            for( int kk = 0; kk < chain.PointCount(); ++kk )
+            {
+                hash.Hash( chain.CPoint( kk ).x );
+                hash.Hash( chain.CPoint( kk ).y );
+            }
+        }
+    }
+
+    hash.Hash( aZone->GetPriority() );
+    hash.Hash( aZone->GetLocalClearance() );
+    hash.Hash( aZone->GetMinThickness() );
+    hash.Hash( static_cast<int>( aZone->GetPadConnection() ) );
+    hash.Hash( aZone->GetThermalReliefGap() );
+    hash.Hash( aZone->GetThermalReliefSpokeWidth() );
+    hash.Hash( static_cast<int>( aZone->GetFillMode() ) );
+    hash.Hash( aZone->GetHatchThickness() );
+    hash.Hash( aZone->GetHatchGap() );
+    hashDouble( aZone->GetHatchOrientation() );
+    hash.Hash( aZone->GetHatchSmoothingLevel() );
+    hashDouble( aZone->GetHatchSmoothingValue() );
+    hashDouble( aZone->GetHatchHoleMinArea() );
+    hash.Hash( aZone->GetHatchBorderAlgorithm() );
+    hash.Hash( static_cast<int>( aZone->GetIslandRemovalMode() ) );
+    hashDouble( static_cast<double>( aZone->GetMinIslandArea() ) );
+    hash.Hash( aZone->GetCornerSmoothingType() );
+    hash.Hash( static_cast<int>( aZone->GetCornerRadius() ) );
+    hash.Hash( aZone->GetFillVersion() );
+    hash.Hash( aZone->GetIsRuleArea() );
+    hash.Hash( aZone->GetDoNotAllowCopperPour() );
+
+    hash.Finalize();
+
+    return hash.Format();
+}
+
+
+void ZONE_FILL_CACHE::Save( const wxString& aFileName )
+{
+    std::string payload;
+    std::vector<ZONE*> zones = allZones();
+
+    writeVarint( payload, zones.size() );
+
+    for( ZONE* zone : zones )
+    {
+        writeString( payload, zone->m_Uuid.AsString().ToStdString() );
+        writeString( payload, inputsHash( zone ) );
+
+        LSEQ filledLayers;
+
+        for( PCB_LAYER_ID layer : zone->GetLayerSet().Seq() )
+        {
+            if( zone->HasFilledPolysForLayer( layer )
+                    && !zone->GetFilledPolysList( layer ).IsEmpty() )
+            {
+                filledLayers.push_back( layer );
+            }
+        }
+
+        writeVarint( payload, filledLayers.size() );
+
+        for( PCB_LAYER_ID layer : filledLayers )
+        {
+            const SHAPE_POLY_SET& fill = zone->GetFilledPolysList( layer );
+            VECTOR2I              prev;
+
+            writeVarint( payload, layer );
+            writeVarint( payload, fill.OutlineCount() );
+
+            for( int ii = 0; ii < fill.OutlineCount(); ++ii )
+            {
+                writeVarint( payload, zone->IsIsland( layer, ii ) ? FILLED_POLY_ISLAND : 0 );
+                writeVarint( payload, fill.HoleCount( ii ) );
+
+                for( int jj = -1; jj < fill.HoleCount( ii ); ++jj )
+                {
+                    const SHAPE_LINE_CHAIN& chain = jj < 0 ? fill.COutline( ii )
+                                                           : fill.CHole( ii, jj );
+
+                    writeVarint( payload, chain.PointCount() );
+
+                    for( int kk = 0; kk < chain.PointCount(); ++kk )
+                    {
+                        const VECTOR2I& pt = chain.CPoint( kk );
+
+                        writeDelta( payload, static_cast<int64_t>( pt.x ) - prev.x );
+                        writeDelta( payload, static_cast<int64_t>( pt.y ) - prev.y );
+                        prev = pt;
+                    }
+                }
+            }
+        }
+    }
+
+    wxFFileOutputStream file( aFileName );
+
+    if( !file.IsOk() )
+        THROW_IO_ERROR( wxString::Format( _( "Cannot create zone fill cache \"%s\"" ),
+                                          aFileName ) );
+
+    file.Write( ZONE_FILL_CACHE_MAGIC, sizeof( ZONE_FILL_CACHE_MAGIC ) );
+    file.Write( &ZONE_FILL_CACHE_VERSION, sizeof( ZONE_FILL_CACHE_VERSION ) );
+
+    wxZlibOutputStream zlib( file, wxZ_DEFAULT_COMPRESSION, wxZLIB_ZLIB );
+
+    zlib.Write( payload.data(), payload.size() );
+
+    if( !zlib.Close() || !file.Close() )
+        THROW_IO_ERROR( wxString::Format( _( "Error writing zone fill cache \"%s\"" ),
+                                          aFileName ) );
+}
+
+
+/**
+ * The fill of one zone as read from the cache.
+ */
+struct CACHED_FILL
+{
+    std::string                              inputsHash;
+    std::map<PCB_LAYER_ID, SHAPE_POLY_SET>   layers;
+    std::map<PCB_LAYER_ID, std::vector<int>> islands;
+};
+
+
+/**
+ * @return true if \a aDelta can be the difference between two coordinates.
+ */
+static bool isValidDelta( int64_t aDelta )
+{
+    const int64_t maxDelta = static_cast<int64_t>( std::numeric_limits<int>::max() )
+                             - std::numeric_limits<int>::min();
+
+    return aDelta >= -maxDelta && aDelta <= maxDelta;
+}
+
+
+static bool isValidCoord( int64_t aCoord )
+{
+    return aCoord >= std::numeric_limits<int>::min() && aCoord <= std::numeric_limits<int>::max();
+}
+
+
+/**
+ * Decode the whole of the cache file \a aFileName into \a aFills.
+ *
+ * @return false if the file is not a valid fill cache.
+ */
+static bool readCache( const wxString& aFileName, std::map<wxString, CACHED_FILL>& aFills )
+{
+    wxFFileInputStream file( aFileName );
+    char               magic[sizeof( ZONE_FILL_CACHE_MAGIC )] = {};
+    uint8_t            version = 0;
+
+    if( !file.IsOk() )
+        return false;
+
+    file.Read( magic, sizeof( magic ) );
+    file.Read( &version, sizeof( version ) );
+
+    if( memcmp( magic, ZONE_FILL_CACHE_MAGIC, sizeof( magic ) ) != 0
+            || version != ZONE_FILL_CACHE_VERSION )
+    {
+        wxLogTrace( traceZoneFillCache, "%s is not a version %d zone fill cache", aFileName,
+                    ZONE_FILL_CACHE_VERSION );
+        return false;
+    }
+
+    // The zlib stream checks its own checksum, which catches corrupt or truncated files
+    wxZlibInputStream zlib( file, wxZLIB_ZLIB );
+    std::string       payload;
+    char              chunk[65536];
+
+    while( zlib.Read( chunk, sizeof( chunk ) ).LastRead() > 0 )
+        payload.append( chunk, zlib.LastRead() );
+
+    if( zlib.GetLastError() != wxSTREAM_EOF )
+    {
+        wxLogTrace( traceZoneFillCache, "%s is corrupt", aFileName );
+        return false;
+    }
+
+    CACHE_READER reader( payload );
+    size_t       zoneCount = reader.ReadCount();
+
+    for( size_t zz = 0; zz < zoneCount && reader.IsOk(); ++zz )
+    {
+        wxString     uuid = wxString::FromUTF8( reader.ReadString().c_str() );
+        CACHED_FILL& fill = aFills[uuid];
+
+        fill.inputsHash = reader.ReadString();
+
+        size_t layerCount = reader.ReadCount();
+
+        for( size_t ll = 0; ll < layerCount && reader.IsOk(); ++ll )
+        {
+            uint64_t layer = reader.ReadVarint();
+
+            if( layer >= PCB_LAYER_ID_COUNT )
+                return false;
+
+            SHAPE_POLY_SET& poly = fill.layers[ToLAYER_ID( static_cast<int>( layer ) )];
+            int64_t         prevX = 0;
+            int64_t         prevY = 0;
+            size_t          outlineCount = reader.ReadCount();
+
+            for( size_t ii = 0; ii < outlineCount && reader.IsOk(); ++ii )
+            {
+                if( reader.ReadVarint() & FILLED_POLY_ISLAND )
+                    fill.islands[ToLAYER_ID( static_cast<int>( layer ) )].push_back( ii );
+
+                size_t holeCount = reader.ReadCount();
+
+                for( size_t jj = 0; jj <= holeCount && reader.IsOk(); ++jj )
+                {
+                    SHAPE_LINE_CHAIN chain;
+                    size_t           pointCount = reader.ReadCount();
+
+                    for( size_t kk = 0; kk < pointCount && reader.IsOk(); ++kk )
+                    {
+                        int64_t dx = reader.ReadDelta();
+                        int64_t dy = reader.ReadDelta();
+
+                        // A valid delta can't overflow the sum, and must land inside an int
+                        bool valid = isValidDelta( dx ) && isValidDelta( dy );
+
+                        if( valid )
+                        {
+                            prevX += dx;
+                            prevY += dy;
+                            valid = isValidCoord( prevX ) && isValidCoord( prevY );
+                        }
+
+                        if( !valid )
+                        {
+                            wxLogTrace( traceZoneFillCache, "%s has coordinates out of range",
+                                        aFileName );
+                            return false;
+                        }
+
+                        chain.Append( static_cast<int>( prevX ), static_cast<int>( prevY ),
+                                      true );
+                    }
+
+                    chain.SetClosed( true );
+
+                    if( jj == 0 )
+                        poly.AddOutline( chain );
+                    else
+                        poly.AddHole( chain );
+                }
+            }
+        }
+    }
+
+    if( !reader.IsOk() || !reader.AtEnd() )
+    {
+        wxLogTrace( traceZoneFillCache, "%s is corrupt", aFileName );
+        return false;
+    }
+
+    return true;
+}
+
+
+bool ZONE_FILL_CACHE::Load( const wxString& aFileName )
+{
+    // Decode everything before touching the board, so that a bad file restores nothing
+    std::map<wxString, CACHED_FILL> fills;
+    bool                            valid = false;
+
+    if( wxFileExists( aFileName ) )
+        valid = readCache( aFileName, fills );
+
+    if( !valid )
+        fills.clear();
+
+    int restored = 0;
+    int stale = 0;
+
+    for( ZONE* zone : allZones() )
+    {
+        if( zone->GetIsRuleArea() )
+            continue;
+
+        // A fill read from the board file itself takes precedence
+        bool hasFill = false;
+
+        for( PCB_LAYER_ID layer : zone->GetLayerSet().Seq() )
+        {
+            if( zone->HasFilledPolysForLayer( layer ) )
+                hasFill |= !zone->GetFilledPolysList( layer ).IsEmpty();
+        }
+
+        if( hasFill || !zone->IsFilled() )
+            continue;
+
+        auto it = fills.find( zone->m_Uuid.AsString() );
+
+        if( it == fills.end() || it->second.inputsHash != inputsHash( zone ) )
+        {
+            // The zone was saved as filled without a fill we can restore; it must be refilled
+            zone->SetIsFilled( false );
+            zone->SetNeedRefill( true );
+            stale++;
+            continue;
+        }
+
+        for( std::pair<const PCB_LAYER_ID, SHAPE_POLY_SET>& layer : it->second.layers )
+        {
+            zone->SetFilledPolysList( layer.first, layer.second );
+
+            for( int idx : it->second.islands[layer.first] )
+                zone->SetIsIsland( layer.first, idx );
+        }
+
+        zone->CalculateFilledArea();
+        restored++;
+    }
+
+    wxLogTrace( traceZoneFillCache, "%s: restored %d zone fills, %d stale", aFileName, restored,
+                stale );
+
+    return valid;
+}
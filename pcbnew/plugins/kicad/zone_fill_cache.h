@@ -0,0 +1,89 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef ZONE_FILL_CACHE_H
+#define ZONE_FILL_CACHE_H
+
+#include <string>
+#include <vector>
+
+#include <wx/string.h>
+
+class BOARD;
+class ZONE;
+
+
+/**
+ * Binary store for the zone fills of a board, kept next to the board file.
+ *
+ * The filled polygons usually make up most of a .kicad_pcb file.  When the ZoneFillCache
+ * advanced setting is on, PCB_IO leaves them out of the board file and writes them here:
+ * delta and varint encoded, then zlib compressed.  Each zone's fill is stored under its
+ * KIID with a hash of the zone's own fill inputs (outline, layers, net and fill settings),
+ * and is only restored on load if that hash still matches.  The board file notes that its
+ * fills were left out, so that only such boards get their zones checked against the cache.
+ */
+class ZONE_FILL_CACHE
+{
+public:
+    ZONE_FILL_CACHE( BOARD* aBoard ) :
+            m_board( aBoard )
+    {
+    }
+
+    /**
+     * @return the name of the fill cache file of the board file \a aBoardFileName.
+     */
+    static wxString GetFileName( const wxString& aBoardFileName );
+
+    /**
+     * Write the fills of all the zones of the board to \a aFileName.
+     *
+     * @throw IO_ERROR if the file cannot be written.
+     */
+    void Save( const wxString& aFileName );
+
+    /**
+     * Restore the fills stored in \a aFileName into the zones of the board which have none.
+     * Only meant for boards whose file was saved with the fills left out.
+     *
+     * Zones saved as filled that end up without a fill, because the cache is missing, invalid
+     * or stale for them, are flagged as unfilled and needing a refill.
+     *
+     * @return false if the file is missing or not a valid fill cache, in which case no fill
+     *         is restored.
+     */
+    bool Load( const wxString& aFileName );
+
+private:
+    std::vector<ZONE*> allZones() const;
+
+    /**
+     * Hash of everything about \a aZone itself that its fill depends on.
+     */
+    std::string inputsHash( ZONE* aZone ) const;
+
+    BOARD* m_board;
+};
+
+#endif // ZONE_FILL_CACHE_H
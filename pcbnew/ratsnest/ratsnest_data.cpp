@@ -40,6 +40,7 @@ using namespace std::placeholders;
 
 #include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <limits>
 
 #include <delaunator.hpp>
@@ -106,9 +107,10 @@ private:
     std::vector<int> m_depth;
 };
 
-void RN_NET::kruskalMST( const std::vector<CN_EDGE> &aEdges )
+bool RN_NET::kruskalMST( const std::vector<CN_EDGE> &aEdges )
 {
     disjoint_set dset( m_nodes.size() );
+    size_t       unions = 0;
 
     m_rnEdges.clear();
 
@@ -124,18 +126,48 @@ void RN_NET::kruskalMST( const std::vector<CN_EDGE> &aEdges )
 
         if( dset.unite( u, v ) )
         {
+            unions++;
+
             if( tmp.GetWeight() > 0 )
                 m_rnEdges.push_back( tmp );
         }
     }
+
+    return unions + 1 == m_nodes.size();
 }
 
 
 class RN_NET::TRIANGULATOR_STATE
 {
 private:
+    using ANCHOR_LIST = std::vector<CN_ANCHOR_PTR>;
+
+    ///> Nets with fewer unique node positions are always triangulated from scratch.
+    static const size_t MIN_LOCAL_UPDATE_POINTS = 1000;
+
+    ///> A local update is attempted only if at most 1/MAX_CHANGED_RATIO of the positions changed.
+    static const size_t MAX_CHANGED_RATIO = 8;
+
+    ///> Number of local updates after which the net is triangulated from scratch again.
+    static const int MAX_LOCAL_UPDATES = 32;
+
+    ///> The corners of the square enclosing a locally updatable triangulation.
+    static const size_t SENTINEL_COUNT = 4;
+
     std::multiset<CN_ANCHOR_PTR, CN_PTR_CMP> m_allNodes;
 
+    // The previous triangulation of a large net, kept so that it can be updated locally when
+    // only a few of its nodes change.  Triangle indices of m_prevPoints.size() and above refer
+    // to m_sentinels, which enclose the net so that added points never fall outside the hull.
+    // m_prevCircles holds the center and radius of the circumcircle of each triangle.
+    std::vector<VECTOR2I> m_prevPoints;
+    std::vector<size_t>   m_prevTriangles;
+    std::vector<double>   m_prevCircles;
+    std::vector<double>   m_sentinels;
+    VECTOR2D              m_safeMin;
+    VECTOR2D              m_safeMax;
+    int                   m_localUpdates = 0;
+
 
     // Checks if all nodes in aNodes lie on a single line. Requires the nodes to
     // have unique coordinates!
@@ -158,6 +190,328 @@ private:
         return true;
     }
 
+    static bool lessXY( const VECTOR2I& aA, const VECTOR2I& aB )
+    {
+        return aA.x == aB.x ? aA.y < aB.y : aA.x < aB.x;
+    }
+
+    static bool pointInTriangle( const VECTOR2D& aP, const VECTOR2D& aA, const VECTOR2D& aB,
+                                 const VECTOR2D& aC )
+    {
+        double d1 = ( aB - aA ).Cross( aP - aA );
+        double d2 = ( aC - aB ).Cross( aP - aB );
+        double d3 = ( aA - aC ).Cross( aP - aC );
+
+        return ( d1 >= 0 && d2 >= 0 && d3 >= 0 ) || ( d1 <= 0 && d2 <= 0 && d3 <= 0 );
+    }
+
+    /**
+     * Append the center and radius of the circumcircle of \a aA, \a aB, \a aC to \a aCircles.
+     * The radius is slightly enlarged so that points on or near the circle count as inside.
+     */
+    static void addCircumcircle( const VECTOR2D& aA, const VECTOR2D& aB, const VECTOR2D& aC,
+                                 std::vector<double>& aCircles )
+    {
+        VECTOR2D d = aB - aA;
+        VECTOR2D e = aC - aA;
+        double   det = d.Cross( e );
+
+        if( det == 0.0 )
+        {
+            // Degenerate triangle; rebuilding it is always safe
+            aCircles.insert( aCircles.end(), { aA.x, aA.y, std::numeric_limits<double>::max() } );
+            return;
+        }
+
+        double   bl = d.x * d.x + d.y * d.y;
+        double   cl = e.x * e.x + e.y * e.y;
+        VECTOR2D r( ( e.y * bl - d.y * cl ) * 0.5 / det, ( d.x * cl - e.x * bl ) * 0.5 / det );
+        double   radius = std::sqrt( r.x * r.x + r.y * r.y ) * ( 1.0 + 1e-9 );
+
+        aCircles.insert( aCircles.end(), { aA.x + r.x, aA.y + r.y, radius } );
+    }
+
+    void storeTriangulation( const ANCHOR_LIST& aAnchors, std::vector<size_t> aTriangles,
+                             std::vector<double> aCircles )
+    {
+        m_prevPoints.clear();
+        m_prevPoints.reserve( aAnchors.size() );
+
+        for( const CN_ANCHOR_PTR& anchor : aAnchors )
+            m_prevPoints.push_back( anchor->Pos() );
+
+        m_prevTriangles = std::move( aTriangles );
+        m_prevCircles = std::move( aCircles );
+    }
+
+    /**
+     * Triangulate the unique node positions together with the corners of a square enclosing
+     * them, and remember the result for later local updates.
+     *
+     * The corners are far enough away to lie outside the diametral circle of any two points
+     * in the safe area around the net, so every Gabriel edge of the net (and thus every edge
+     * of its minimum spanning tree) is still part of the triangulation.
+     */
+    void triangulateWithSentinels( const ANCHOR_LIST& aAnchors, const std::vector<double>& aCoords,
+                                   std::vector<size_t>& aTriangles )
+    {
+        VECTOR2D bboxMin( aCoords[0], aCoords[1] );
+        VECTOR2D bboxMax( bboxMin );
+
+        for( size_t i = 2; i < aCoords.size(); i += 2 )
+        {
+            bboxMin.x = std::min( bboxMin.x, aCoords[i] );
+            bboxMin.y = std::min( bboxMin.y, aCoords[i + 1] );
+            bboxMax.x = std::max( bboxMax.x, aCoords[i] );
+            bboxMax.y = std::max( bboxMax.y, aCoords[i + 1] );
+        }
+
+        double   size = std::max( bboxMax.x - bboxMin.x, bboxMax.y - bboxMin.y ) + 1.0;
+        VECTOR2D center = ( bboxMin + bboxMax ) / 2.0;
+        double   dist = 5.0 * size;
+
+        m_safeMin = bboxMin - VECTOR2D( size, size );
+        m_safeMax = bboxMax + VECTOR2D( size, size );
+        m_sentinels = { center.x - dist, center.y - dist, center.x + dist, center.y - dist,
+                        center.x + dist, center.y + dist, center.x - dist, center.y + dist };
+
+        std::vector<double> coords( aCoords );
+        coords.insert( coords.end(), m_sentinels.begin(), m_sentinels.end() );
+
+        delaunator::Delaunator delaunator( coords );
+        std::vector<double>    circles;
+
+        aTriangles = delaunator.triangles;
+        circles.reserve( aTriangles.size() );
+
+        for( size_t t = 0; t < aTriangles.size(); t += 3 )
+        {
+            const size_t* tri = &aTriangles[t];
+
+            addCircumcircle( VECTOR2D( coords[2 * tri[0]], coords[2 * tri[0] + 1] ),
+                             VECTOR2D( coords[2 * tri[1]], coords[2 * tri[1] + 1] ),
+                             VECTOR2D( coords[2 * tri[2]], coords[2 * tri[2] + 1] ), circles );
+        }
+
+        storeTriangulation( aAnchors, std::move( delaunator.triangles ), std::move( circles ) );
+        m_localUpdates = 0;
+    }
+
+    /**
+     * Update the previous triangulation for the positions added and removed since.
+     *
+     * The triangles incident to a removed point or whose circumcircle contains an added point
+     * form a cavity; only the corners of the cavity and the added points are triangulated
+     * again and the result is patched into the cavity.
+     *
+     * @return false if there is no usable previous triangulation or too much has changed.
+     */
+    bool updateTriangulation( const ANCHOR_LIST& aAnchors, const std::vector<double>& aCoords,
+                              std::vector<size_t>& aTriangles )
+    {
+        if( m_prevTriangles.empty() || m_localUpdates >= MAX_LOCAL_UPDATES )
+            return false;
+
+        const size_t oldCount = m_prevPoints.size();
+        const size_t newCount = aAnchors.size();
+
+        // Both point lists are sorted, so they can be matched in a single pass
+        std::vector<size_t> oldToNew( oldCount + SENTINEL_COUNT, delaunator::INVALID_INDEX );
+        std::vector<size_t> added;
+        size_t              removed = 0;
+        size_t              i = 0;
+        size_t              j = 0;
+
+        while( i < oldCount || j < newCount )
+        {
+            if( j == newCount || ( i < oldCount && lessXY( m_prevPoints[i], aAnchors[j]->Pos() ) ) )
+            {
+                removed++;
+                i++;
+            }
+            else if( i == oldCount || lessXY( aAnchors[j]->Pos(), m_prevPoints[i] ) )
+            {
+                added.push_back( j++ );
+            }
+            else
+            {
+                oldToNew[i++] = j++;
+            }
+        }
+
+        for( size_t k = 0; k < SENTINEL_COUNT; k++ )
+            oldToNew[oldCount + k] = newCount + k;
+
+        if( ( added.size() + removed ) * MAX_CHANGED_RATIO > newCount )
+            return false;
+
+        auto oldPoint =
+                [&]( size_t aIdx ) -> VECTOR2D
+                {
+                    if( aIdx < oldCount )
+                        return VECTOR2D( m_prevPoints[aIdx] );
+
+                    aIdx -= oldCount;
+                    return VECTOR2D( m_sentinels[2 * aIdx], m_sentinels[2 * aIdx + 1] );
+                };
+
+        auto newPoint =
+                [&]( size_t aIdx ) -> VECTOR2D
+                {
+                    if( aIdx < newCount )
+                        return VECTOR2D( aCoords[2 * aIdx], aCoords[2 * aIdx + 1] );
+
+                    aIdx -= newCount;
+                    return VECTOR2D( m_sentinels[2 * aIdx], m_sentinels[2 * aIdx + 1] );
+                };
+
+        VECTOR2D addedMin( m_safeMax );
+        VECTOR2D addedMax( m_safeMin );
+
+        for( size_t idx : added )
+        {
+            VECTOR2D p = newPoint( idx );
+
+            if( p.x < m_safeMin.x || p.y < m_safeMin.y || p.x > m_safeMax.x || p.y > m_safeMax.y )
+                return false;
+
+            addedMin.x = std::min( addedMin.x, p.x );
+            addedMin.y = std::min( addedMin.y, p.y );
+            addedMax.x = std::max( addedMax.x, p.x );
+            addedMax.y = std::max( addedMax.y, p.y );
+        }
+
+        std::vector<size_t> cavity;
+        std::vector<size_t> kept;
+
+        for( size_t t = 0; t < m_prevTriangles.size(); t += 3 )
+        {
+            const size_t* tri = &m_prevTriangles[t];
+            bool          conflict = oldToNew[tri[0]] == delaunator::INVALID_INDEX
+                                     || oldToNew[tri[1]] == delaunator::INVALID_INDEX
+                                     || oldToNew[tri[2]] == delaunator::INVALID_INDEX;
+
+            if( !conflict && !added.empty() )
+            {
+                const double* circle = &m_prevCircles[t];
+                VECTOR2D      center( circle[0], circle[1] );
+                double        radius = circle[2];
+
+                if( center.x + radius >= addedMin.x && center.x - radius <= addedMax.x
+                        && center.y + radius >= addedMin.y && center.y - radius <= addedMax.y )
+                {
+                    for( size_t idx : added )
+                    {
+                        VECTOR2D p = newPoint( idx ) - center;
+
+                        if( p.x * p.x + p.y * p.y <= radius * radius )
+                        {
+                            conflict = true;
+                            break;
+                        }
+                    }
+                }
+            }
+
+            ( conflict ? cavity : kept ).push_back( t );
+        }
+
+        std::vector<double> circles;
+
+        aTriangles.clear();
+        aTriangles.reserve( m_prevTriangles.size() + 6 * added.size() );
+        circles.reserve( m_prevCircles.size() + 6 * added.size() );
+
+        for( size_t t : kept )
+        {
+            for( size_t k = 0; k < 3; k++ )
+                aTriangles.push_back( oldToNew[m_prevTriangles[t + k]] );
+
+            circles.insert( circles.end(), &m_prevCircles[t], &m_prevCircles[t] + 3 );
+        }
+
+        if( !cavity.empty() )
+        {
+            std::vector<size_t> subset;
+            std::vector<bool>   inSubset( newCount + SENTINEL_COUNT, false );
+
+            for( size_t t : cavity )
+            {
+                for( size_t k = 0; k < 3; k++ )
+                {
+                    size_t idx = oldToNew[m_prevTriangles[t + k]];
+
+                    if( idx != delaunator::INVALID_INDEX && !inSubset[idx] )
+                    {
+                        inSubset[idx] = true;
+                        subset.push_back( idx );
+                    }
+                }
+            }
+
+            for( size_t idx : added )
+            {
+                if( !inSubset[idx] )
+                {
+                    inSubset[idx] = true;
+                    subset.push_back( idx );
+                }
+            }
+
+            std::vector<double> subsetCoords;
+            subsetCoords.reserve( 2 * subset.size() );
+
+            for( size_t idx : subset )
+            {
+                VECTOR2D p = newPoint( idx );
+                subsetCoords.push_back( p.x );
+                subsetCoords.push_back( p.y );
+            }
+
+            if( subset.size() < 3 )
+                return false;
+
+            delaunator::Delaunator local( subsetCoords );
+            size_t                 patched = 0;
+
+            // The triangulation of the subset may extend past the cavity; only the triangles
+            // filling the cavity belong to the updated triangulation.
+            for( size_t t = 0; t < local.triangles.size(); t += 3 )
+            {
+                size_t   a = subset[local.triangles[t]];
+                size_t   b = subset[local.triangles[t + 1]];
+                size_t   c = subset[local.triangles[t + 2]];
+                VECTOR2D centroid = ( newPoint( a ) + newPoint( b ) + newPoint( c ) ) / 3.0;
+
+                for( size_t ct : cavity )
+                {
+                    if( pointInTriangle( centroid, oldPoint( m_prevTriangles[ct] ),
+                                         oldPoint( m_prevTriangles[ct + 1] ),
+                                         oldPoint( m_prevTriangles[ct + 2] ) ) )
+                    {
+                        aTriangles.push_back( a );
+                        aTriangles.push_back( b );
+                        aTriangles.push_back( c );
+                        addCircumcircle( newPoint( a ), newPoint( b ), newPoint( c ), circles );
+                        patched++;
+                        break;
+                    }
+                }
+            }
+
+            if( patched == 0 )
+                return false;
+        }
+        else if( !added.empty() )
+        {
+            return false;
+        }
+
+        storeTriangulation( aAnchors, aTriangles, std::move( circles ) );
+        m_localUpdates++;
+        return true;
+    }
+
 public:
 
     void Clear()
@@ -170,14 +524,28 @@ public:
         m_allNodes.insert( aNode );
     }
 
-    void Triangulate( std::vector<CN_EDGE>& mstEdges)
+    /**
+     * Drop the triangulation kept for local updates.
+     */
+    void ForgetTriangulation()
     {
-        std::vector<double>          node_pts;
-
-        using ANCHOR_LIST = std::vector<CN_ANCHOR_PTR>;
+        m_prevPoints.clear();
+        m_prevTriangles.clear();
+        m_prevCircles.clear();
+    }
 
+    /**
+     * Append the edges of a triangulation of the nodes, and of the nodes sharing a position,
+     * to \a mstEdges.
+     *
+     * @return true if the triangulation was a local update of the previous one.
+     */
+    bool Triangulate( std::vector<CN_EDGE>& mstEdges )
+    {
+        std::vector<double>      node_pts;
         ANCHOR_LIST              anchors;
         std::vector<ANCHOR_LIST> anchorChains( m_allNodes.size() );
+        bool                     localUpdate = false;
 
         node_pts.reserve( 2 * m_allNodes.size() );
         anchors.reserve( m_allNodes.size() );
@@ -199,10 +567,13 @@ public:
 
         if( anchors.size() < 2 )
         {
-            return;
+            ForgetTriangulation();
+            return false;
         }
         else if( areNodesColinear( anchors ) )
         {
+            ForgetTriangulation();
+
             // special case: all nodes are on the same line - there's no
             // triangulation for such set. In this case, we sort along any coordinate
             // and chain the nodes together.
@@ -215,32 +586,52 @@ public:
         }
         else
         {
-            delaunator::Delaunator delaunator( node_pts );
-            auto& triangles = delaunator.triangles;
-
-            for( size_t i = 0; i < triangles.size(); i += 3 )
+            auto addEdge =
+                    [&]( size_t aSrc, size_t aDst )
+                    {
+                        auto src = anchors[aSrc];
+                        auto dst = anchors[aDst];
+                        mstEdges.emplace_back( src, dst, src->Dist( *dst ) );
+                    };
+
+            if( anchors.size() < MIN_LOCAL_UPDATE_POINTS )
             {
-                auto src = anchors[triangles[i]];
-                auto dst = anchors[triangles[i + 1]];
-                mstEdges.emplace_back( src, dst, src->Dist( *dst ) );
+                ForgetTriangulation();
 
-                src = anchors[triangles[i + 1]];
-                dst = anchors[triangles[i + 2]];
-                mstEdges.emplace_back( src, dst, src->Dist( *dst ) );
+                delaunator::Delaunator delaunator( node_pts );
+                auto& triangles = delaunator.triangles;
+                auto& halfedges = delaunator.halfedges;
 
-                src = anchors[triangles[i + 2]];
-                dst = anchors[triangles[i]];
-                mstEdges.emplace_back( src, dst, src->Dist( *dst ) );
+                // Add each edge once: from the lower half-edge of an interior pair, or from
+                // the only half-edge of a hull edge
+                for( size_t i = 0; i < triangles.size(); i++ )
+                {
+                    if( halfedges[i] == delaunator::INVALID_INDEX || i < halfedges[i] )
+                        addEdge( triangles[i], triangles[i % 3 == 2 ? i - 2 : i + 1] );
+                }
             }
-
-            for( size_t i = 0; i < delaunator.halfedges.size(); i++ )
+            else
             {
-                if( delaunator.halfedges[i] == delaunator::INVALID_INDEX )
-                    continue;
+                std::vector<size_t> triangles;
 
-                auto src = anchors[triangles[i]];
-                auto dst = anchors[triangles[delaunator.halfedges[i]]];
-                mstEdges.emplace_back( src, dst, src->Dist( *dst ) );
+                localUpdate = updateTriangulation( anchors, node_pts, triangles );
+
+                if( !localUpdate )
+                    triangulateWithSentinels( anchors, node_pts, triangles );
+
+                // The sentinels form the hull, so every edge between two nodes is shared by two
+                // consistently oriented triangles and is added from the one where it ascends.
+                for( size_t i = 0; i < triangles.size(); i += 3 )
+                {
+                    for( size_t k = 0; k < 3; k++ )
+                    {
+                        size_t a = triangles[i + k];
+                        size_t b = triangles[i + ( k + 1 ) % 3];
+
+                        if( a < b && b < anchors.size() )
+                            addEdge( a, b );
+                    }
+                }
             }
         }
 
@@ -264,6 +655,8 @@ public:
                 mstEdges.emplace_back( prevNode, curNode, weight );
             }
         }
+
+        return localUpdate;
     }
 };
 
@@ -315,27 +708,43 @@ void RN_NET::compute()
     std::vector<CN_EDGE> triangEdges;
     triangEdges.reserve( m_nodes.size() + m_boardEdges.size() );
 
-    #ifdef PROFILE
-    PROF_COUNTER cnt("triangulate");
-    #endif
-    m_triangulator->Triangulate( triangEdges );
-    #ifdef PROFILE
-    cnt.Show();
-    #endif
-
-    for( const auto& e : m_boardEdges )
-        triangEdges.emplace_back( e );
-
-    std::sort( triangEdges.begin(), triangEdges.end() );
-
-// Get the minimal spanning tree
-#ifdef PROFILE
-    PROF_COUNTER cnt2("mst");
-#endif
-    kruskalMST( triangEdges );
-#ifdef PROFILE
-    cnt2.Show();
-#endif
+    auto computeMST =
+            [&]() -> bool
+            {
+                triangEdges.clear();
+
+                #ifdef PROFILE
+                PROF_COUNTER cnt("triangulate");
+                #endif
+                bool localUpdate = m_triangulator->Triangulate( triangEdges );
+                #ifdef PROFILE
+                cnt.Show();
+                #endif
+
+                for( const auto& e : m_boardEdges )
+                    triangEdges.emplace_back( e );
+
+                std::sort( triangEdges.begin(), triangEdges.end() );
+
+                // Get the minimal spanning tree
+                #ifdef PROFILE
+                PROF_COUNTER cnt2("mst");
+                #endif
+                bool spanning = kruskalMST( triangEdges );
+                #ifdef PROFILE
+                cnt2.Show();
+                #endif
+
+                return spanning || !localUpdate;
+            };
+
+    // A locally updated triangulation that fails to span the net (which can only happen with
+    // degenerate point sets) is replaced by a full one rather than dropping connections.
+    if( !computeMST() )
+    {
+        m_triangulator->ForgetTriangulation();
+        computeMST();
+    }
 }
 
 
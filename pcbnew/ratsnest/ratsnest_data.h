@@ -147,11 +147,12 @@ public:
     bool NearestBicoloredPair( const RN_NET& aOtherNet, CN_ANCHOR_PTR& aNode1, CN_ANCHOR_PTR& aNode2 ) const;
 
 protected:
-    ///> Recomputes ratsnest from scratch.
+    ///> Recomputes ratsnest, updating the previous triangulation of large nets where possible.
     void compute();
 
-    ///> Compute the minimum spanning tree using Kruskal's algorithm
-    void kruskalMST( const std::vector<CN_EDGE> &aEdges );
+    ///> Compute the minimum spanning tree using Kruskal's algorithm.  Returns false if the
+    ///> edges do not connect all the nodes.
+    bool kruskalMST( const std::vector<CN_EDGE> &aEdges );
 
     ///> Vector of nodes
     std::multiset<CN_ANCHOR_PTR, CN_PTR_CMP> m_nodes;
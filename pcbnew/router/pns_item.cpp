@@ -19,6 +19,8 @@
  * with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <new>
+
 #include "pns_node.h"
 #include "pns_item.h"
 #include "pns_line.h"
@@ -55,7 +57,6 @@ bool ITEM::collideSimple( const ITEM* aOther, int aClearance, bool aNeedMTV, VEC
         else
         {
             shapeA = AlternateShape();
-            Mark( MK_ALT_SHAPE );
         }
     }
 
@@ -71,7 +72,6 @@ bool ITEM::collideSimple( const ITEM* aOther, int aClearance, bool aNeedMTV, VEC
         else
         {
             shapeB = aOther->AlternateShape();
-            aOther->Mark( MK_ALT_SHAPE );
         }
     }
 
@@ -125,4 +125,99 @@ ITEM::~ITEM()
 {
 }
 
+
+namespace
+{
+
+/**
+ * Per-thread cache of freed item blocks, one singly linked list per 16 byte size class.
+ *
+ * The lists are plain data so that items freed while the thread is shutting down (after
+ * the cache has been drained) can still be released safely: they go straight to the heap.
+ */
+struct ITEM_FREE_LISTS
+{
+    static constexpr std::size_t GRANULE = 16;
+    static constexpr std::size_t CLASSES = 32;        ///< blocks up to 512 bytes are cached
+    static constexpr int         MAX_CACHED = 1024;   ///< per size class
+
+    void* heads[CLASSES];
+    int   counts[CLASSES];
+    bool  disabled;
+};
+
+thread_local ITEM_FREE_LISTS s_freeLists = {};
+
+
+struct ITEM_FREE_LISTS_DRAINER
+{
+    ~ITEM_FREE_LISTS_DRAINER()
+    {
+        for( std::size_t i = 0; i < ITEM_FREE_LISTS::CLASSES; i++ )
+        {
+            while( s_freeLists.heads[i] )
+            {
+                void* block = s_freeLists.heads[i];
+                s_freeLists.heads[i] = *static_cast<void**>( block );
+                ::operator delete( block );
+            }
+
+            s_freeLists.counts[i] = 0;
+        }
+
+        s_freeLists.disabled = true;
+    }
+};
+
+thread_local ITEM_FREE_LISTS_DRAINER s_freeListsDrainer;
+
+
+std::size_t sizeClass( std::size_t aSize )
+{
+    return ( aSize + ITEM_FREE_LISTS::GRANULE - 1 ) / ITEM_FREE_LISTS::GRANULE - 1;
+}
+
+}
+
+
+void* ITEM::operator new( std::size_t aSize )
+{
+    std::size_t cls = sizeClass( aSize );
+
+    if( cls >= ITEM_FREE_LISTS::CLASSES || s_freeLists.disabled )
+        return ::operator new( aSize );
+
+    // Touch the drainer so that it is constructed (and later destroyed) on this thread.
+    (void) &s_freeListsDrainer;
+
+    if( void* block = s_freeLists.heads[cls] )
+    {
+        s_freeLists.heads[cls] = *static_cast<void**>( block );
+        s_freeLists.counts[cls]--;
+        return block;
+    }
+
+    return ::operator new( ( cls + 1 ) * ITEM_FREE_LISTS::GRANULE );
+}
+
+
+void ITEM::operator delete( void* aPtr, std::size_t aSize )
+{
+    if( !aPtr )
+        return;
+
+    std::size_t cls = sizeClass( aSize );
+
+    if( cls >= ITEM_FREE_LISTS::CLASSES || s_freeLists.disabled
+            || s_freeLists.counts[cls] >= ITEM_FREE_LISTS::MAX_CACHED )
+    {
+        ::operator delete( aPtr );
+        return;
+    }
+
+    *static_cast<void**>( aPtr ) = s_freeLists.heads[cls];
+    s_freeLists.heads[cls] = aPtr;
+    s_freeLists.counts[cls]++;
+}
+
 }
@@ -96,6 +96,14 @@ public:
 
     virtual ~ITEM();
 
+    /**
+     * Router items are cloned and thrown away by the thousand while shoving, so their
+     * storage is recycled through small per-thread free lists instead of going back to
+     * the heap each time.
+     */
+    static void* operator new( std::size_t aSize );
+    static void operator delete( void* aPtr, std::size_t aSize );
+
     /**
      * Function Clone()
      *
@@ -0,0 +1,158 @@
+/*
+ * KiRouter - a push-and-(sometimes-)shove PCB router
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <algorithm>
+#include <cstdint>
+
+#include "pns_joint_map.h"
+
+namespace PNS {
+
+std::size_t JOINT_MAP::hashTag( const JOINT::HASH_TAG& aTag )
+{
+    // JOINT_TAG_HASH is too weak to pick trie slots from its bits, so mix the tag fully.
+    uint64_t h = (uint64_t) (uint32_t) aTag.pos.x * 0x9E3779B97F4A7C15ULL;
+    h ^= (uint64_t) (uint32_t) aTag.pos.y * 0xC2B2AE3D27D4EB4FULL;
+    h ^= (uint64_t) (uint32_t) aTag.net * 0x165667B19E3779F9ULL;
+
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+
+    return (std::size_t) h;
+}
+
+
+const JOINT_MAP::LEAF* JOINT_MAP::findLeaf( std::size_t aHash ) const
+{
+    if( !m_top )
+        return nullptr;
+
+    const std::shared_ptr<INNER>& inner = ( *m_top )[aHash & ( FANOUT - 1 )];
+
+    if( !inner )
+        return nullptr;
+
+    return ( *inner )[( aHash >> BITS ) & ( FANOUT - 1 )].get();
+}
+
+
+JOINT_MAP::LEAF& JOINT_MAP::mutableLeaf( std::size_t aHash )
+{
+    // A node referenced by this map only may be modified in place.  Copies of the map are
+    // made from a single thread (NODE::Branch()), so once the count has dropped to one it
+    // cannot grow behind our back.
+    if( !m_top )
+        m_top = std::make_shared<TOP>();
+    else if( m_top.use_count() > 1 )
+        m_top = std::make_shared<TOP>( *m_top );
+
+    std::shared_ptr<INNER>& inner = ( *m_top )[aHash & ( FANOUT - 1 )];
+
+    if( !inner )
+        inner = std::make_shared<INNER>();
+    else if( inner.use_count() > 1 )
+        inner = std::make_shared<INNER>( *inner );
+
+    std::shared_ptr<LEAF>& leaf = ( *inner )[( aHash >> BITS ) & ( FANOUT - 1 )];
+
+    if( !leaf )
+        leaf = std::make_shared<LEAF>();
+    else if( leaf.use_count() > 1 )
+        leaf = std::make_shared<LEAF>( *leaf );
+
+    return *leaf;
+}
+
+
+bool JOINT_MAP::Contains( const JOINT::HASH_TAG& aTag ) const
+{
+    std::size_t hash = hashTag( aTag );
+    const LEAF* leaf = findLeaf( hash );
+
+    if( !leaf )
+        return false;
+
+    for( const ENTRY& entry : *leaf )
+    {
+        if( entry.hash == hash && entry.joint->Tag() == aTag )
+            return true;
+    }
+
+    return false;
+}
+
+
+JOINT* JOINT_MAP::Find( const JOINT::HASH_TAG& aTag, const LAYER_RANGE& aLayers ) const
+{
+    std::size_t hash = hashTag( aTag );
+    const LEAF* leaf = findLeaf( hash );
+
+    if( !leaf )
+        return nullptr;
+
+    for( const ENTRY& entry : *leaf )
+    {
+        if( entry.hash == hash && entry.joint->Tag() == aTag
+                && entry.joint->Layers().Overlaps( aLayers ) )
+        {
+            return entry.joint;
+        }
+    }
+
+    return nullptr;
+}
+
+
+void JOINT_MAP::Insert( JOINT* aJoint )
+{
+    std::size_t hash = hashTag( aJoint->Tag() );
+
+    mutableLeaf( hash ).push_back( { hash, aJoint } );
+    m_size++;
+}
+
+
+void JOINT_MAP::Erase( JOINT* aJoint )
+{
+    std::size_t hash = hashTag( aJoint->Tag() );
+    const LEAF* leaf = findLeaf( hash );
+
+    // Check before unsharing anything, erasing a joint that is not there must stay cheap.
+    if( !leaf )
+        return;
+
+    auto matches = [aJoint]( const ENTRY& aEntry )
+                   {
+                       return aEntry.joint == aJoint;
+                   };
+
+    if( std::find_if( leaf->begin(), leaf->end(), matches ) == leaf->end() )
+        return;
+
+    LEAF& entries = mutableLeaf( hash );
+    entries.erase( std::find_if( entries.begin(), entries.end(), matches ) );
+    m_size--;
+}
+
+}
@@ -0,0 +1,144 @@
+/*
+ * KiRouter - a push-and-(sometimes-)shove PCB router
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef __PNS_JOINT_MAP_H
+#define __PNS_JOINT_MAP_H
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "pns_joint.h"
+
+namespace PNS {
+
+/**
+ * JOINT_MAP
+ *
+ * Multimap of joints, keyed by their hash tag, with structural sharing between copies.
+ *
+ * The map is a fixed-depth trie of shared nodes: copying it only copies the root pointer,
+ * and a modification copies just the path (two small arrays and one leaf) leading to the
+ * changed entry, when that path is still shared with another copy.  This makes branching
+ * a NODE cheap no matter how many joints its parent holds.
+ *
+ * The map only stores pointers.  The joints themselves are owned by the NODE that created
+ * them, which must outlive every map referencing them.
+ */
+class JOINT_MAP
+{
+public:
+    JOINT_MAP() :
+        m_size( 0 )
+    {}
+
+    int Size() const
+    {
+        return m_size;
+    }
+
+    void Clear()
+    {
+        m_top.reset();
+        m_size = 0;
+    }
+
+    ///> Returns true if the map contains at least one joint with the tag aTag
+    bool Contains( const JOINT::HASH_TAG& aTag ) const;
+
+    ///> Returns the first joint with the tag aTag overlapping aLayers, or NULL
+    JOINT* Find( const JOINT::HASH_TAG& aTag, const LAYER_RANGE& aLayers ) const;
+
+    void Insert( JOINT* aJoint );
+
+    ///> Removes aJoint (not the joints equal to it) from the map
+    void Erase( JOINT* aJoint );
+
+    ///> Calls aFunc( JOINT* ) for each joint with the tag aTag
+    template <typename FUNC>
+    void ForEach( const JOINT::HASH_TAG& aTag, FUNC aFunc ) const
+    {
+        std::size_t hash = hashTag( aTag );
+        const LEAF* leaf = findLeaf( hash );
+
+        if( !leaf )
+            return;
+
+        for( const ENTRY& entry : *leaf )
+        {
+            if( entry.hash == hash && entry.joint->Tag() == aTag )
+                aFunc( entry.joint );
+        }
+    }
+
+    ///> Calls aFunc( JOINT* ) for each joint in the map
+    template <typename FUNC>
+    void ForEach( FUNC aFunc ) const
+    {
+        if( !m_top )
+            return;
+
+        for( const std::shared_ptr<INNER>& inner : *m_top )
+        {
+            if( !inner )
+                continue;
+
+            for( const std::shared_ptr<LEAF>& leaf : *inner )
+            {
+                if( !leaf )
+                    continue;
+
+                for( const ENTRY& entry : *leaf )
+                    aFunc( entry.joint );
+            }
+        }
+    }
+
+private:
+    static constexpr int         BITS = 7;
+    static constexpr std::size_t FANOUT = 1 << BITS;
+
+    struct ENTRY
+    {
+        std::size_t hash;
+        JOINT*      joint;
+    };
+
+    typedef std::vector<ENTRY>                       LEAF;
+    typedef std::array<std::shared_ptr<LEAF>, FANOUT> INNER;
+    typedef std::array<std::shared_ptr<INNER>, FANOUT> TOP;
+
+    static std::size_t hashTag( const JOINT::HASH_TAG& aTag );
+
+    const LEAF* findLeaf( std::size_t aHash ) const;
+
+    ///> Returns the leaf for aHash, creating it or unsharing it (and its path) as needed
+    LEAF& mutableLeaf( std::size_t aHash );
+
+    std::shared_ptr<TOP> m_top;
+    int                  m_size;
+};
+
+}
+
+#endif    // __PNS_JOINT_MAP_H
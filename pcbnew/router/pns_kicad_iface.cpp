@@ -47,8 +47,11 @@
 #include <drc/drc_engine.h>
 
 #include <memory>
+#include <mutex>
+#include <unordered_map>
 
 #include <advanced_config.h>
+#include <hash_eda.h>
 
 #include "tools/pcb_tool_base.h"
 
@@ -89,6 +92,9 @@ private:
     int holeRadius( const PNS::ITEM* aItem ) const;
     int matchDpSuffix( const wxString& aNetName, wxString& aComplementNet, wxString& aBaseDpName );
 
+    bool queryConstraint( PNS::CONSTRAINT_TYPE aType, const PNS::ITEM* aItemA,
+                          const PNS::ITEM* aItemB, int aLayer, PNS::CONSTRAINT* aConstraint );
+
 private:
     PNS::ROUTER_IFACE* m_routerIface;
     BOARD*             m_board;
@@ -96,7 +102,43 @@ private:
     ARC                m_dummyArc;
     VIA                m_dummyVia;
 
-    std::map<std::pair<const PNS::ITEM*, const PNS::ITEM*>, int> m_clearanceCache;
+    /**
+     * Clearance cache key.  Items without a parent are resolved through the dummy board items
+     * above, so their clearance depends only on their kind, net and layer: the key of a track
+     * being routed is in effect its net, and all its segments share a single cache entry.
+     * Items with a parent are keyed by it, which stays valid across branches and clones.
+     */
+    struct CLEARANCE_CACHE_KEY
+    {
+        CLEARANCE_CACHE_KEY( const PNS::ITEM* aA, const PNS::ITEM* aB );
+
+        bool operator==( const CLEARANCE_CACHE_KEY& aOther ) const
+        {
+            return m_parentA == aOther.m_parentA && m_parentB == aOther.m_parentB
+                    && m_kindA == aOther.m_kindA && m_kindB == aOther.m_kindB
+                    && m_netA == aOther.m_netA && m_netB == aOther.m_netB
+                    && m_layer == aOther.m_layer;
+        }
+
+        const BOARD_ITEM* m_parentA;
+        const BOARD_ITEM* m_parentB;
+        int               m_kindA;
+        int               m_kindB;
+        int               m_netA;
+        int               m_netB;
+        int               m_layer;
+    };
+
+    struct CLEARANCE_CACHE_KEY_HASH
+    {
+        std::size_t operator()( const CLEARANCE_CACHE_KEY& aKey ) const;
+    };
+
+    std::unordered_map<CLEARANCE_CACHE_KEY, int, CLEARANCE_CACHE_KEY_HASH> m_clearanceCache;
+
+    ///> The router may evaluate candidate paths on several threads at once; the clearance
+    ///> cache and the dummy items above are shared between them.
+    std::mutex         m_mutex;
 };
 
 
@@ -116,6 +158,27 @@ PNS_PCBNEW_RULE_RESOLVER::~PNS_PCBNEW_RULE_RESOLVER()
 }
 
 
+PNS_PCBNEW_RULE_RESOLVER::CLEARANCE_CACHE_KEY::CLEARANCE_CACHE_KEY( const PNS::ITEM* aA,
+                                                                   const PNS::ITEM* aB ) :
+    m_parentA( aA->Parent() ),
+    m_parentB( aB ? aB->Parent() : nullptr ),
+    m_kindA( aA->Kind() ),
+    m_kindB( aB ? aB->Kind() : 0 ),
+    m_netA( aA->Net() ),
+    m_netB( aB ? aB->Net() : 0 ),
+    m_layer( aA->Layer() )
+{
+}
+
+
+std::size_t PNS_PCBNEW_RULE_RESOLVER::CLEARANCE_CACHE_KEY_HASH::operator()(
+        const CLEARANCE_CACHE_KEY& aKey ) const
+{
+    return hash_val( aKey.m_parentA, aKey.m_parentB, aKey.m_kindA, aKey.m_kindB, aKey.m_netA,
+                     aKey.m_netB, aKey.m_layer );
+}
+
+
 int PNS_PCBNEW_RULE_RESOLVER::holeRadius( const PNS::ITEM* aItem ) const
 {
     if( aItem->Kind() == PNS::ITEM::SOLID_T )
@@ -195,6 +258,16 @@ bool PNS_PCBNEW_RULE_RESOLVER::IsDiffPair( const PNS::ITEM* aA, const PNS::ITEM*
 bool PNS_PCBNEW_RULE_RESOLVER::QueryConstraint( PNS::CONSTRAINT_TYPE aType,
                                                 const PNS::ITEM* aItemA, const PNS::ITEM* aItemB,
                                                 int aLayer, PNS::CONSTRAINT* aConstraint )
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+
+    return queryConstraint( aType, aItemA, aItemB, aLayer, aConstraint );
+}
+
+
+bool PNS_PCBNEW_RULE_RESOLVER::queryConstraint( PNS::CONSTRAINT_TYPE aType,
+                                                const PNS::ITEM* aItemA, const PNS::ITEM* aItemB,
+                                                int aLayer, PNS::CONSTRAINT* aConstraint )
 {
     std::shared_ptr<DRC_ENGINE> drcEngine = m_board->GetDesignSettings().m_DRCEngine;
 
@@ -284,7 +357,9 @@ bool PNS_PCBNEW_RULE_RESOLVER::QueryConstraint( PNS::CONSTRAINT_TYPE aType,
 
 int PNS_PCBNEW_RULE_RESOLVER::Clearance( const PNS::ITEM* aA, const PNS::ITEM* aB )
 {
-    std::pair<const PNS::ITEM*, const PNS::ITEM*> key( aA, aB );
+    std::lock_guard<std::mutex> lock( m_mutex );
+
+    CLEARANCE_CACHE_KEY key( aA, aB );
     auto it = m_clearanceCache.find( key );
 
     if( it != m_clearanceCache.end() )
@@ -297,7 +372,7 @@ int PNS_PCBNEW_RULE_RESOLVER::Clearance( const PNS::ITEM* aA, const PNS::ITEM* a
     if( aB && IsDiffPair( aA, aB ) )
     {
         // for diff pairs, we use the gap value for shoving/dragging
-        if( QueryConstraint( PNS::CONSTRAINT_TYPE::CT_DIFF_PAIR_GAP, aA, aB, aA->Layer(),
+        if( queryConstraint( PNS::CONSTRAINT_TYPE::CT_DIFF_PAIR_GAP, aA, aB, aA->Layer(),
                              &constraint ) )
         {
             rv = constraint.m_Value.Opt();
@@ -307,7 +382,7 @@ int PNS_PCBNEW_RULE_RESOLVER::Clearance( const PNS::ITEM* aA, const PNS::ITEM* a
 
     if( !ok )
     {
-        if( QueryConstraint( PNS::CONSTRAINT_TYPE::CT_CLEARANCE, aA, aB, aA->Layer(),
+        if( queryConstraint( PNS::CONSTRAINT_TYPE::CT_CLEARANCE, aA, aB, aA->Layer(),
                              &constraint ) )
         {
             rv = constraint.m_Value.Min();
@@ -26,6 +26,10 @@
 #include "pns_segment.h"
 #include "pns_solid.h"
 
+#include <cstring>
+
+#include <board_item.h>
+
 #include <geometry/shape.h>
 #include <geometry/shape_line_chain.h>
 #include <geometry/shape_rect.h>
@@ -36,6 +40,7 @@ namespace PNS {
 
 LOGGER::LOGGER( )
 {
+    ResetCounters();
 }
 
 
@@ -50,36 +55,105 @@ void LOGGER::Clear()
 }
 
 
+void LOGGER::ResetCounters()
+{
+    for( std::atomic<int>& counter : m_counters )
+        counter = 0;
+}
+
+
 void LOGGER::Save( const std::string& aFilename )
 {
     FILE* f = fopen( aFilename.c_str(), "wb" );
 
     wxLogTrace( "PNS", "Saving to '%s' [%p]", aFilename.c_str(), f );
 
-    for( const auto evt : m_events )
+    if( !f )
+        return;
+
+    for( const EVENT_ENTRY& evt : m_events )
+    {
+        wxString id = "null";
+
+        if( evt.uuid != niluuid )
+            id = evt.uuid.AsString();
+
+        fprintf( f, "event %d %d %d %s %d %d %d\n", evt.type, evt.p.x, evt.p.y,
+                 (const char*) id.c_str(), evt.layer, evt.mode, evt.routingMode );
+    }
+
+    fclose( f );
+}
+
+
+bool LOGGER::Load( const std::string& aFilename )
+{
+    FILE* f = fopen( aFilename.c_str(), "rb" );
+
+    if( !f )
+        return false;
+
+    m_events.clear();
+
+    char line[256];
+
+    while( fgets( line, sizeof( line ), f ) )
     {
-        uint64_t id = 0;
-        if( evt.item && evt.item->Parent() )
+        EVENT_ENTRY evt;
+        char        id[64];
+        int         type;
+
+        evt.item = nullptr;
+        evt.layer = -1;
+        evt.mode = 0;
+        evt.routingMode = 0;
+
+        int fields = sscanf( line, "event %d %d %d %63s %d %d %d", &type, &evt.p.x, &evt.p.y, id,
+                             &evt.layer, &evt.mode, &evt.routingMode );
+
+        if( fields < 4 )
+            continue;
+
+        // The dumps of the router tool had no start event details, and the type after the
+        // position: "event x y type uuid".
+        if( fields == 4 )
         {
-            const char* idString = evt.item->Parent()->m_Uuid.AsString().c_str();
-            fprintf( f, "event %d %d %d %s\n", evt.type, evt.p.x, evt.p.y, idString );
+            int x = type;
+
+            type = evt.p.y;
+            evt.p.y = evt.p.x;
+            evt.p.x = x;
         }
+
+        if( type < EVT_START_ROUTE || type > EVT_ABORT )
+            continue;
+
+        evt.type = static_cast<EVENT_TYPE>( type );
+        evt.uuid = strcmp( id, "null" ) ? KIID( wxString( id ) ) : niluuid;
+
+        m_events.push_back( evt );
     }
 
     fclose( f );
+
+    return true;
 }
 
 
-void LOGGER::Log( LOGGER::EVENT_TYPE evt, VECTOR2I pos, const ITEM* item )
+void LOGGER::Log( LOGGER::EVENT_TYPE evt, VECTOR2I pos, const ITEM* item, int aLayer, int aMode,
+                  int aRoutingMode )
 {
     LOGGER::EVENT_ENTRY ent;
 
     ent.type = evt;
     ent.p = pos;
     ent.item = item;
+    ent.uuid = ( item && item->Parent() ) ? item->Parent()->m_Uuid : niluuid;
+    ent.layer = aLayer;
+    ent.mode = aMode;
+    ent.routingMode = aRoutingMode;
 
     m_events.push_back( ent );
-
 }
 
 }
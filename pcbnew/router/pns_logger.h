@@ -22,12 +22,14 @@
 #ifndef __PNS_LOGGER_H
 #define __PNS_LOGGER_H
 
+#include <atomic>
 #include <cstdio>
 #include <vector>
 #include <string>
 #include <sstream>
 
 #include <math/vector2d.h>
+#include <kiid.h>
 
 class SHAPE_LINE_CHAIN;
 class SHAPE;
@@ -48,26 +50,62 @@ public:
         EVT_ABORT
     };
 
+    ///> Iteration counters of the routing algorithms
+    enum COUNTER {
+        CNT_SHOVE = 0,
+        CNT_WALKAROUND,
+        CNT_LAST
+    };
+
     struct EVENT_ENTRY {
         VECTOR2I p;
         EVENT_TYPE type;
         const ITEM* item;
+        KIID uuid;          ///< of the board item behind item, niluuid if there is none
+        int layer;          ///< start events only
+        int mode;           ///< ROUTER_MODE of EVT_START_ROUTE, drag mode of EVT_START_DRAG
+        int routingMode;    ///< PNS_MODE at start events
     };
 
     LOGGER();
     ~LOGGER();
 
     void Save( const std::string& aFilename );
+
+    /**
+     * Reads back the events written by Save(), or by the older event dumps of the router
+     * tool.  The items of the loaded events are NULL, they are to be looked up by uuid in the
+     * board the log was recorded on.
+     *
+     * @return false if the file could not be read.
+     */
+    bool Load( const std::string& aFilename );
+
     void Clear();
-    void Log( EVENT_TYPE evt, VECTOR2I pos, const ITEM* item = nullptr );
+    void Log( EVENT_TYPE evt, VECTOR2I pos, const ITEM* item = nullptr, int aLayer = -1,
+              int aMode = 0, int aRoutingMode = 0 );
 
     const std::vector<EVENT_ENTRY>& GetEvents()
     {
         return m_events;
     }
 
+    ///> Adds aIterations to aCounter. May be called from the router's worker threads.
+    void CountIterations( COUNTER aCounter, int aIterations )
+    {
+        m_counters[aCounter] += aIterations;
+    }
+
+    int GetIterations( COUNTER aCounter ) const
+    {
+        return m_counters[aCounter];
+    }
+
+    void ResetCounters();
+
 private:
     std::vector<EVENT_ENTRY> m_events;
+    std::atomic<int>         m_counters[CNT_LAST];
 };
 
 }
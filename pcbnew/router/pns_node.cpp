@@ -80,7 +80,10 @@ NODE::~NODE()
     allocNodes.erase( this );
 #endif
 
-    m_joints.clear();
+    if( isRoot() )
+        m_joints.ForEach( []( JOINT* aJoint ) { delete aJoint; } );
+
+    m_joints.Clear();
 
     for( ITEM* item : *m_index )
     {
@@ -117,12 +120,11 @@ NODE* NODE::Branch()
     child->m_root = isRoot() ? this : m_root;
     child->m_maxClearance = m_maxClearance;
 
-    // Immmediate offspring of the root branch needs not copy anything. For the rest, deep-copy
-    // joints, overridden item maps and pointers to stored items.
+    // Immmediate offspring of the root branch needs not copy anything. For the rest, copy
+    // overridden item maps and pointers to stored items. The joint map is shared with this
+    // node and only copied piecewise when the child modifies it.
     if( !isRoot() )
     {
-        JOINT_MAP::iterator j;
-
         for( ITEM* item : *m_index )
             child->m_index->Add( item );
 
@@ -131,7 +133,7 @@ NODE* NODE::Branch()
     }
 
     wxLogTrace( "PNS", "%d items, %d joints, %d overrides",
-            child->m_index->Size(), (int) child->m_joints.size(), (int) child->m_override.size() );
+            child->m_index->Size(), child->m_joints.Size(), (int) child->m_override.size() );
 
     return child;
 }
@@ -196,6 +198,12 @@ struct NODE::DEFAULT_OBSTACLE_VISITOR : public OBSTACLE_VISITOR
 
     int m_forceClearance;
 
+    ///> net of the queried item, or -1 if items of its net may collide with it
+    int m_excludedNet;
+
+    ///> bounding box of the queried item, empty if the item has no shape
+    OPT<BOX2I> m_itemBBox;
+
     DEFAULT_OBSTACLE_VISITOR( NODE::OBSTACLES& aTab, const ITEM* aItem, int aKindMask, bool aDifferentNetsOnly ) :
         OBSTACLE_VISITOR( aItem ),
         m_tab( aTab ),
@@ -204,12 +212,27 @@ struct NODE::DEFAULT_OBSTACLE_VISITOR : public OBSTACLE_VISITOR
         m_matchCount( 0 ),
         m_extraClearance( 0 ),
         m_differentNetsOnly( aDifferentNetsOnly ),
-        m_forceClearance( -1 )
+        m_forceClearance( -1 ),
+        m_excludedNet( -1 )
     {
         if( aItem && aItem->Kind() == ITEM::LINE_T )
         {
              m_extraClearance += static_cast<const LINE*>( aItem )->Width() / 2;
         }
+
+        // Same rule as in ITEM::collideSimple(), checked before anything else so that the
+        // items of our own net never get as far as a clearance lookup.
+        if( aItem && aDifferentNetsOnly && aItem->Net() >= 0 )
+            m_excludedNet = aItem->Net();
+
+        if( aItem && aItem->Shape() )
+        {
+            m_itemBBox = aItem->Shape()->BBox();
+
+            // ITEM::Collide() also checks the via at the end of a head line
+            if( aItem->Kind() == ITEM::LINE_T && static_cast<const LINE*>( aItem )->EndsWithVia() )
+                m_itemBBox->Merge( static_cast<const LINE*>( aItem )->Via().Shape()->BBox() );
+        }
     }
 
     virtual ~DEFAULT_OBSTACLE_VISITOR()
@@ -226,19 +249,35 @@ struct NODE::DEFAULT_OBSTACLE_VISITOR : public OBSTACLE_VISITOR
         if( !aCandidate->OfKind( m_kindMask ) )
             return true;
 
+        if( m_excludedNet >= 0 && aCandidate->Net() == m_excludedNet )
+            return true;
+
         if( visit( aCandidate ) )
             return true;
 
-        int clearance = m_extraClearance + m_node->GetClearance( aCandidate, m_item );
+        int clearance = m_forceClearance;
 
-        if( aCandidate->Kind() == ITEM::LINE_T ) // this should never happen.
+        if( clearance < 0 )
         {
-            assert( false );
-            clearance += static_cast<LINE*>( aCandidate )->Width() / 2;
+            clearance = m_extraClearance + m_node->GetClearance( aCandidate, m_item );
+
+            if( aCandidate->Kind() == ITEM::LINE_T ) // this should never happen.
+            {
+                assert( false );
+                clearance += static_cast<LINE*>( aCandidate )->Width() / 2;
+            }
         }
 
-        if( m_forceClearance >= 0 )
-            clearance = m_forceClearance;
+        // The index is searched with the worst case clearance of the whole board, most of
+        // the candidates it returns are too far away for their actual clearance.  Reject
+        // them by bounding box before running the exact test.
+        if( m_itemBBox && aCandidate->Shape() )
+        {
+            BOX2I bbox = aCandidate->Shape()->BBox( clearance );
+
+            if( !bbox.Intersects( *m_itemBBox ) )
+                return true;
+        }
 
         if( !aCandidate->Collide( m_item, clearance, false, nullptr, m_node, m_differentNetsOnly ) )
             return true;
@@ -716,27 +755,12 @@ void NODE::rebuildJoint( JOINT* aJoint, ITEM* aItem )
     tag.net = net;
     tag.pos = aJoint->Pos();
 
-    bool split;
-    do
+    // find and remove all joints containing the via to be removed
+    while( JOINT* f = m_joints.Find( tag, aItem->Layers() ) )
     {
-        split = false;
-        auto range = m_joints.equal_range( tag );
-
-        if( range.first == m_joints.end() )
-            break;
-
-        // find and remove all joints containing the via to be removed
-
-        for( auto f = range.first; f != range.second; ++f )
-        {
-            if( aItem->LayersOverlap( &f->second ) )
-            {
-                m_joints.erase( f );
-                split = true;
-                break;
-            }
-        }
-    } while( split );
+        m_joints.Erase( f );
+        freeJoint( f );
+    }
 
     // and re-link them, using the former via's link list
     for(ITEM* link : links)
@@ -1035,26 +1059,10 @@ JOINT* NODE::FindJoint( const VECTOR2I& aPos, int aLayer, int aNet )
     tag.net = aNet;
     tag.pos = aPos;
 
-    JOINT_MAP::iterator f = m_joints.find( tag ), end = m_joints.end();
-
-    if( f == end && !isRoot() )
-    {
-        end = m_root->m_joints.end();
-        f = m_root->m_joints.find( tag );    // m_root->FindJoint(aPos, aLayer, aNet);
-    }
-
-    if( f == end )
-        return NULL;
-
-    while( f != end )
-    {
-        if( f->second.Layers().Overlaps( aLayer ) )
-            return &f->second;
-
-        ++f;
-    }
+    if( !isRoot() && !m_joints.Contains( tag ) )
+        return m_root->m_joints.Find( tag, LAYER_RANGE( aLayer ) );
 
-    return NULL;
+    return m_joints.Find( tag, LAYER_RANGE( aLayer ) );
 }
 
 
@@ -1072,47 +1080,49 @@ JOINT& NODE::touchJoint( const VECTOR2I& aPos, const LAYER_RANGE& aLayers, int a
     tag.pos = aPos;
     tag.net = aNet;
 
-    // try to find the joint in this node.
-    JOINT_MAP::iterator f = m_joints.find( tag );
-
-    std::pair<JOINT_MAP::iterator, JOINT_MAP::iterator> range;
-
-    // not found and we are not root? find in the root and copy results here.
-    if( f == m_joints.end() && !isRoot() )
+    // not found in this node and we are not root? find in the root and copy results here.
+    if( !isRoot() && !m_joints.Contains( tag ) )
     {
-        range = m_root->m_joints.equal_range( tag );
-
-        for( f = range.first; f != range.second; ++f )
-            m_joints.insert( *f );
+        m_root->m_joints.ForEach( tag,
+                [&]( JOINT* aJoint )
+                {
+                    m_joints.Insert( allocJoint( *aJoint ) );
+                } );
     }
 
     // now insert and combine overlapping joints
     JOINT jt( aPos, aLayers, aNet );
 
-    bool merged;
-
-    do
+    while( JOINT* f = m_joints.Find( tag, aLayers ) )
     {
-        merged  = false;
-        range   = m_joints.equal_range( tag );
+        jt.Merge( *f );
+        m_joints.Erase( f );
+        freeJoint( f );
+    }
 
-        if( range.first == m_joints.end() )
-            break;
+    JOINT* joint = allocJoint( jt );
+    m_joints.Insert( joint );
 
-        for( f = range.first; f != range.second; ++f )
-        {
-            if( aLayers.Overlaps( f->second.Layers() ) )
-            {
-                jt.Merge( f->second );
-                m_joints.erase( f );
-                merged = true;
-                break;
-            }
-        }
-    }
-    while( merged );
+    return *joint;
+}
+
+
+JOINT* NODE::allocJoint( const JOINT& aJoint )
+{
+    if( isRoot() )
+        return new JOINT( aJoint );
 
-    return m_joints.insert( TagJointPair( tag, jt ) )->second;
+    m_jointArena.emplace_back( aJoint );
+    return &m_jointArena.back();
+}
+
+
+void NODE::freeJoint( JOINT* aJoint )
+{
+    // Joints of a branch may still be referenced by the joint maps of its own branches, they
+    // are kept in the arena until the branch goes away.
+    if( isRoot() )
+        delete aJoint;
 }
 
 
@@ -1415,33 +1425,28 @@ int NODE::QueryJoints( const BOX2I& aBox,
 
     aJoints.clear();
 
-    for( auto j = m_joints.begin(); j != m_joints.end(); ++j )
-    {
-        if ( aBox.Contains(j->second.Pos()) && j->second.LinkCount ( aKindMask ) )
-        {
-            aJoints.push_back( &j->second );
-            n++;
+    auto visit = [&]( JOINT* aJoint )
+                 {
+                     if( aBox.Contains( aJoint->Pos() ) && aJoint->LinkCount( aKindMask ) )
+                     {
+                         aJoints.push_back( aJoint );
+                         n++;
+                     }
+                 };
 
-        }
-    }
+    m_joints.ForEach( visit );
 
     if ( isRoot() )
         return n;
 
-    for( auto j = m_root->m_joints.begin(); j != m_root->m_joints.end(); ++j )
-    {
-        if( ! Overrides( &j->second) )
-        {   if ( aBox.Contains(j->second.Pos()) && j->second.LinkCount ( aKindMask ) )
+    m_root->m_joints.ForEach(
+            [&]( JOINT* aJoint )
             {
-                aJoints.push_back( &j->second );
-                n++;
-            }
-        }
-    }
+                if( !Overrides( aJoint ) )
+                    visit( aJoint );
+            } );
 
     return n;
-
-
 }
 
 
@@ -22,6 +22,7 @@
 #ifndef __PNS_NODE_H
 #define __PNS_NODE_H
 
+#include <deque>
 #include <vector>
 #include <list>
 #include <unordered_set>
@@ -36,6 +37,7 @@
 
 #include "pns_item.h"
 #include "pns_joint.h"
+#include "pns_joint_map.h"
 #include "pns_itemset.h"
 
 namespace PNS {
@@ -205,7 +207,7 @@ public:
     ///> Returns the number of joints
     int JointCount() const
     {
-        return m_joints.size();
+        return m_joints.Size();
     }
 
     ///> Returns the number of nodes in the inheritance chain (wrs to the root node)
@@ -462,8 +464,6 @@ public:
 
 private:
     struct DEFAULT_OBSTACLE_VISITOR;
-    typedef std::unordered_multimap<JOINT::HASH_TAG, JOINT, JOINT::JOINT_TAG_HASH> JOINT_MAP;
-    typedef JOINT_MAP::value_type TagJointPair;
 
     /// nodes are not copyable
     NODE( const NODE& aB );
@@ -498,6 +498,12 @@ private:
     void releaseGarbage();
     void rebuildJoint( JOINT* aJoint, ITEM* aItem );
 
+    ///> allocates a copy of aJoint owned by this node
+    JOINT* allocJoint( const JOINT& aJoint );
+
+    ///> releases a joint allocated by allocJoint() of this node
+    void freeJoint( JOINT* aJoint );
+
     bool isRoot() const
     {
         return m_parent == NULL;
@@ -516,9 +522,13 @@ private:
             LINKED_ITEM** aSegments, bool& aGuardHit, bool aStopAtLockedJoints );
 
     ///> hash table with the joints, linking the items. Joints are hashed by
-    ///> their position, layer set and net.
+    ///> their position, layer set and net. Shared with the parent branch until modified.
     JOINT_MAP m_joints;
 
+    ///> storage of the joints created by a branch, released in one go with the branch.
+    ///> The root node allocates its joints individually, as it lives for the whole session.
+    std::deque<JOINT> m_jointArena;
+
     ///> node this node was branched from
     NODE* m_parent;
 
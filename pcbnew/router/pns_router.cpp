@@ -156,6 +156,12 @@ bool ROUTER::StartDragging( const VECTOR2I& aP, ITEM_SET aStartItems, int aDragM
     m_dragger->SetLogger( m_logger );
     m_dragger->SetDebugDecorator ( m_iface->GetDebugDecorator () );
 
+    if( m_logger )
+    {
+        m_logger->Log( LOGGER::EVT_START_DRAG, aP, aStartItems[0], aStartItems[0]->Layer(),
+                       aDragMode, Settings().Mode() );
+    }
+
     if( m_dragger->Start ( aP, aStartItems ) )
     {
         m_state = DRAG_SEGMENT;
@@ -240,7 +246,10 @@ bool ROUTER::StartRouting( const VECTOR2I& aP, ITEM* aStartItem, int aLayer )
     m_placer->SetLogger( m_logger );
 
     if( m_logger )
-        m_logger->Log( LOGGER::EVT_START_ROUTE, aP, aStartItem );
+    {
+        m_logger->Log( LOGGER::EVT_START_ROUTE, aP, aStartItem, aLayer, m_mode,
+                       Settings().Mode() );
+    }
 
     bool rv = m_placer->Start( aP, aStartItem );
 
@@ -310,7 +319,17 @@ void ROUTER::markViolations( NODE* aNode, ITEM_SET& aCurrent, NODE::ITEM_VECTOR&
         {
             int clearance = aNode->GetClearance( item, obs.m_item );
             std::unique_ptr<ITEM> tmp( obs.m_item->Clone() );
-            tmp->Mark( tmp->Marker() | MK_VIOLATION );
+            int marker = tmp->Marker() | MK_VIOLATION;
+
+            // Collision checks don't mark the (shared) obstacles, so work out here whether the
+            // obstacle collided through its alternate shape and should be drawn as such.
+            if( tmp->AlternateShape() && !item->Layers().IsMultilayer()
+                    && !m_iface->IsOnLayer( obs.m_item, item->Layer() ) )
+            {
+                marker |= MK_ALT_SHAPE;
+            }
+
+            tmp->Mark( marker );
             m_iface->DisplayItem( tmp.get(), -1, clearance );
             aRemoved.push_back( obs.m_item );
         }
@@ -463,6 +482,9 @@ void ROUTER::StopRouting()
     if( !RoutingInProgress() )
         return;
 
+    if( m_logger )
+        m_logger->Log( LOGGER::EVT_ABORT, m_currentEnd );
+
     m_placer.reset();
     m_dragger.reset();
 
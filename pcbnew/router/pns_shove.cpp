@@ -1243,6 +1243,9 @@ SHOVE::SHOVE_STATUS SHOVE::shoveMainLoop()
         }
     }
 
+    if( Router()->Logger() )
+        Router()->Logger()->CountIterations( LOGGER::CNT_SHOVE, m_iter );
+
     return st;
 }
 
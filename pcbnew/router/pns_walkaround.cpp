@@ -20,6 +20,7 @@
  */
 
 #include <core/optional.h>
+#include <thread_pool.h>
 
 #include <geometry/shape_line_chain.h>
 
@@ -157,7 +158,7 @@ WALKAROUND::WALKAROUND_STATUS WALKAROUND::singleStep( LINE& aPath,
 
 
 
-bool clipToLoopStart( SHAPE_LINE_CHAIN& l )
+static bool clipToLoopStart( SHAPE_LINE_CHAIN& l, DEBUG_DECORATOR* aDbg )
 {
     auto ip = l.SelfIntersecting();
 
@@ -170,8 +171,8 @@ bool clipToLoopStart( SHAPE_LINE_CHAIN& l )
 
         int pidx2 = tail.Split( ip->p );
 
-        auto dbg = ROUTER::GetInstance()->GetInterface()->GetDebugDecorator();
-        dbg->AddPoint( ip->p, 5 );
+        if( aDbg )
+            aDbg->AddPoint( ip->p, 5 );
 
         l = lead;
         l.Append( tail.Slice( 0, pidx2 ) );
@@ -200,6 +201,11 @@ const WALKAROUND::RESULT WALKAROUND::Route( const LINE& aInitialPath )
         return RESULT( DONE, DONE, aInitialPath, aInitialPath );
     }
 
+    // Each winding direction gets a walker of its own, whether or not they run in parallel,
+    // so that the result never depends on the number of threads
+    if( !m_forceWinding )
+        return routeBothDirections( aInitialPath );
+
     start( aInitialPath );
 
     m_currentObstacle[0] = m_currentObstacle[1] = nearestObstacle( aInitialPath );
@@ -227,12 +233,12 @@ const WALKAROUND::RESULT WALKAROUND::Route( const LINE& aInitialPath )
 
         auto old = path_cw.CLine();
 
-        if( clipToLoopStart( path_cw.Line() ))
+        if( clipToLoopStart( path_cw.Line(), Dbg() ))
         {
             s_cw = ALMOST_DONE;
         }
 
-        if( clipToLoopStart( path_ccw.Line() ))
+        if( clipToLoopStart( path_ccw.Line(), Dbg() ))
         {
             s_ccw = ALMOST_DONE;
         }
@@ -256,6 +262,8 @@ const WALKAROUND::RESULT WALKAROUND::Route( const LINE& aInitialPath )
         m_iteration++;
     }
 
+    countIterations();
+
     if( s_cw == IN_PROGRESS )
     {
         result.lineCw = path_cw;
@@ -296,6 +304,61 @@ const WALKAROUND::RESULT WALKAROUND::Route( const LINE& aInitialPath )
 
 
 
+void WALKAROUND::countIterations()
+{
+    if( m_countIterations && Router() && Router()->Logger() )
+        Router()->Logger()->CountIterations( LOGGER::CNT_WALKAROUND, m_iteration );
+}
+
+
+const WALKAROUND::RESULT WALKAROUND::routeBothDirections( const LINE& aInitialPath )
+{
+    WALKAROUND walkCw( *this );
+    WALKAROUND walkCcw( *this );
+    RESULT     resultCw, resultCcw;
+
+    walkCw.SetForceWinding( true, true );
+    walkCcw.SetForceWinding( true, false );
+
+    // The copies run side by side, so count their iterations once here as a single walk would
+    walkCw.m_countIterations = walkCcw.m_countIterations = false;
+
+    // Both directions only read the world, so they can be walked at the same time.  Debug
+    // graphics are drawn in a fixed order, so keep to this thread when they are on.
+    if( Dbg() || THREAD_POOL::GetInstance().GetThreadCount() < 2 )
+    {
+        resultCw = walkCw.Route( aInitialPath );
+        resultCcw = walkCcw.Route( aInitialPath );
+    }
+    else
+    {
+        // Whoever gets here first walks clockwise: a worker, or this thread once it is done
+        // with the counter-clockwise walk.  That way a busy pool never stalls the router; a
+        // task that loses the race returns without touching this stack frame.
+        auto cwClaimed = std::make_shared<std::atomic<bool>>( false );
+
+        std::future<void> cwDone = THREAD_POOL::GetInstance().Submit(
+                [cwClaimed, &walkCw, &resultCw, &aInitialPath]()
+                {
+                    if( !cwClaimed->exchange( true ) )
+                        resultCw = walkCw.Route( aInitialPath );
+                } );
+
+        resultCcw = walkCcw.Route( aInitialPath );
+
+        if( !cwClaimed->exchange( true ) )
+            resultCw = walkCw.Route( aInitialPath );
+        else
+            cwDone.get();
+    }
+
+    m_iteration = std::max( walkCw.m_iteration, walkCcw.m_iteration );
+    countIterations();
+
+    return RESULT( resultCw.statusCw, resultCcw.statusCcw, resultCw.lineCw, resultCcw.lineCcw );
+}
+
+
 WALKAROUND::WALKAROUND_STATUS WALKAROUND::Route( const LINE& aInitialPath,
         LINE& aWalkPath, bool aOptimize )
 {
@@ -363,6 +426,8 @@ WALKAROUND::WALKAROUND_STATUS WALKAROUND::Route( const LINE& aInitialPath,
         m_iteration++;
     }
 
+    countIterations();
+
     if( m_iteration == m_iterationLimit )
     {
         int len_cw  = path_cw.CLine().Length();
@@ -54,6 +54,7 @@ public:
         m_iteration = 0;
         m_forceCw = false;
         m_forceUniqueWindingDirection = false;
+        m_countIterations = true;
     }
 
     ~WALKAROUND() {};
@@ -143,6 +144,13 @@ private:
     void start( const LINE& aInitialPath );
 
     WALKAROUND_STATUS singleStep( LINE& aPath, bool aWindingDirection );
+
+    ///> walks the two winding directions each in its own copy of this walker, concurrently
+    ///> when the thread pool allows it
+    const RESULT routeBothDirections( const LINE& aInitialPath );
+
+    ///> adds the iterations of the last walk to the router's logger counters
+    void countIterations();
     NODE::OPT_OBSTACLE nearestObstacle( const LINE& aPath );
 
     NODE* m_world;
@@ -156,6 +164,7 @@ private:
     bool m_forceWinding;
     bool m_forceCw;
     bool m_forceUniqueWindingDirection;
+    bool m_countIterations;     ///< false in the per-direction copies of routeBothDirections()
     VECTOR2I m_cursorPos;
     NODE::OPT_OBSTACLE m_currentObstacle[2];
     bool m_recursiveCollision[2];
@@ -76,6 +76,7 @@ void ZONE_FILLER_TOOL::CheckAllZones( wxWindow* aCaller, PROGRESS_REPORTER* aRep
     {
         commit.Push( _( "Fill Zone(s)" ), false );
         getEditFrame<PCB_EDIT_FRAME>()->m_ZoneFillsDirty = false;
+        board()->ResetZoneFillDirtyAreas();
     }
     else
     {
@@ -104,6 +105,9 @@ void ZONE_FILLER_TOOL::FillAllZones( wxWindow* aCaller, PROGRESS_REPORTER* aRepo
 
     ZONE_FILLER filler( board(), &commit );
 
+    // Only refill the areas changed since the last fill where possible
+    filler.SetIncremental( true );
+
     if( !board()->GetDesignSettings().m_DRCEngine->RulesValid() )
     {
         WX_INFOBAR* infobar = frame()->GetInfoBar();
@@ -132,6 +136,7 @@ void ZONE_FILLER_TOOL::FillAllZones( wxWindow* aCaller, PROGRESS_REPORTER* aRepo
     {
         commit.Push( _( "Fill Zone(s)" ), false );
         getEditFrame<PCB_EDIT_FRAME>()->m_ZoneFillsDirty = false;
+        board()->ResetZoneFillDirtyAreas();
     }
     else
     {
@@ -1107,12 +1107,18 @@ void ZONE::CacheTriangulation( PCB_LAYER_ID aLayer )
     if( aLayer == UNDEFINED_LAYER )
     {
         for( std::pair<const PCB_LAYER_ID, SHAPE_POLY_SET>& pair : m_FilledPolysList )
+        {
             pair.second.CacheTriangulation();
+            pair.second.CacheEdgeIndex();
+        }
     }
     else
     {
         if( m_FilledPolysList.count( aLayer ) )
+        {
             m_FilledPolysList[ aLayer ].CacheTriangulation();
+            m_FilledPolysList[ aLayer ].CacheEdgeIndex();
+        }
     }
 }
 
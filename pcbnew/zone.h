@@ -629,6 +629,7 @@ public:
 
     /** (re)create a list of triangles that "fill" the solid areas.
      * used for instance to draw these solid areas on opengl
+     * Also indexes the edges of the solid areas for collision and distance queries.
      */
     void CacheTriangulation( PCB_LAYER_ID aLayer = UNDEFINED_LAYER );
 
@@ -650,6 +651,11 @@ public:
         m_RawPolysList[aLayer] = aPolysList;
     }
 
+    bool HasRawPolysForLayer( PCB_LAYER_ID aLayer ) const
+    {
+        return m_RawPolysList.count( aLayer ) > 0;
+    }
+
     /**
      * Checks if a given filled polygon is an insulated island
      * @param aLayer is the layer to test
@@ -23,13 +23,12 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
 
-#include <thread>
 #include <algorithm>
-#include <future>
 
 #include <advanced_config.h>
 #include <board.h>
 #include <zone.h>
+#include <zone_knockout_cache.h>
 #include <footprint.h>
 #include <fp_shape.h>
 #include <pcb_shape.h>
@@ -46,6 +45,7 @@
 #include <confirm.h>
 #include <convert_to_biu.h>
 #include <math/util.h>      // for KiROUND
+#include <thread_pool.h>
 #include "zone_filler.h"
 
 static const double s_RoundPadThermalSpokeAngle = 450;      // in deci-degrees
@@ -57,7 +57,9 @@ ZONE_FILLER::ZONE_FILLER(  BOARD* aBoard, COMMIT* aCommit ) :
         m_commit( aCommit ),
         m_progressReporter( nullptr ),
         m_maxError( ARC_HIGH_DEF ),
-        m_worstClearance( 0 )
+        m_worstClearance( 0 ),
+        m_incremental( false ),
+        m_refillMargin( 0 )
 {
     // To enable add "DebugZoneFiller=1" to kicad_advanced settings file.
     m_debugZoneFiller = ADVANCED_CFG::GetCfg().m_DebugZoneFiller;
@@ -88,6 +90,9 @@ bool ZONE_FILLER::Fill( std::vector<ZONE*>& aZones, bool aCheck, wxWindow* aPare
 {
     std::vector<std::pair<ZONE*, PCB_LAYER_ID>> toFill;
     std::vector<CN_ZONE_ISOLATED_ISLAND_LIST> islandsList;
+    std::vector<EDA_RECT>                     dirtyAreas;
+    std::set<const ZONE*>                     dirtyZones;
+    std::map<ZONE*, SHAPE_POLY_SET>           refillRegions;
 
     std::shared_ptr<CONNECTIVITY_DATA> connectivity = m_board->GetConnectivity();
     std::unique_lock<std::mutex> lock( connectivity->GetLock(), std::try_to_lock );
@@ -111,29 +116,49 @@ bool ZONE_FILLER::Fill( std::vector<ZONE*>& aZones, bool aCheck, wxWindow* aPare
     m_boardOutline.RemoveAllContours();
     m_brdOutlinesValid = m_board->GetBoardPolygonOutlines( m_boardOutline );
 
+    // Incremental refills need a valid record of what changed since the last fill
+    bool incremental = m_incremental && !aCheck && !m_debugZoneFiller
+                            && m_board->GetZoneFillDirtyAreas( dirtyAreas, dirtyZones );
+    int  maxThermalGap = 0;
+    int  maxMinThickness = 0;
+
     // Update and cache zone bounding boxes and pad effective shapes so that we don't have to
     // make them thread-safe.
     for( ZONE* zone : m_board->Zones() )
     {
         zone->CacheBoundingBox();
         m_worstClearance = std::max( m_worstClearance, zone->GetLocalClearance() );
+        maxThermalGap = std::max( maxThermalGap, zone->GetThermalReliefGap() );
+        maxMinThickness = std::max( maxMinThickness, zone->GetMinThickness() );
     }
 
+    // Pad knockouts are kept across fills; forget those of pads which have gone away
+    m_board->GetZoneKnockoutCache()->Prune( m_board );
+
     for( FOOTPRINT* footprint : m_board->Footprints() )
     {
         for( PAD* pad : footprint->Pads() )
         {
             if( pad->IsDirty() )
                 pad->BuildEffectiveShapes( UNDEFINED_LAYER );
+
+            maxThermalGap = std::max( maxThermalGap, pad->GetEffectiveThermalGap() );
         }
 
         for( ZONE* zone : footprint->Zones() )
         {
             zone->CacheBoundingBox();
             m_worstClearance = std::max( m_worstClearance, zone->GetLocalClearance() );
+            maxThermalGap = std::max( maxThermalGap, zone->GetThermalReliefGap() );
+            maxMinThickness = std::max( maxMinThickness, zone->GetMinThickness() );
         }
     }
 
+    // A change can alter the fill out to its clearance (or thermal gap) plus the width of
+    // the min-thickness pruning on either side.
+    m_refillMargin = m_worstClearance + maxThermalGap + 2 * maxMinThickness + bds.m_MaxError
+                        + Millimeter2iu( ADVANCED_CFG::GetCfg().m_ExtraClearance );
+
     // Sort by priority to reduce deferrals waiting on higher priority zones.
     std::sort( aZones.begin(), aZones.end(),
                []( const ZONE* lhs, const ZONE* rhs )
@@ -150,6 +175,27 @@ bool ZONE_FILLER::Fill( std::vector<ZONE*>& aZones, bool aCheck, wxWindow* aPare
         if( m_commit )
             m_commit->Modify( zone );
 
+        // Zones whose own outline or settings changed, or which don't have a usable previous
+        // fill, are always filled in full.
+        bool refill = incremental
+                        && !dirtyZones.count( zone )
+                        && zone->IsFilled()
+                        && !zone->NeedRefill()
+                        && zone->IsOnCopperLayer()
+                        && zone->GetFillMode() != ZONE_FILL_MODE::HATCH_PATTERN
+                        && zone->GetFillVersion() == bds.m_ZoneFillVersion;
+
+        for( PCB_LAYER_ID layer : zone->GetLayerSet().Seq() )
+            refill &= zone->HasRawPolysForLayer( layer );
+
+        if( refill )
+        {
+            SHAPE_POLY_SET region;
+
+            if( buildRefillRegion( zone, dirtyAreas, region ) )
+                refillRegions[ zone ] = region;
+        }
+
         // calculate the hash value for filled areas. it will be used later
         // to know if the current filled areas are up to date
         for( PCB_LAYER_ID layer : zone->GetLayerSet().Seq() )
@@ -169,9 +215,6 @@ bool ZONE_FILLER::Fill( std::vector<ZONE*>& aZones, bool aCheck, wxWindow* aPare
         zone->SetFillVersion( bds.m_ZoneFillVersion );
     }
 
-    size_t cores = std::thread::hardware_concurrency();
-    std::atomic<size_t> nextItem;
-
     auto check_fill_dependency =
             [&]( ZONE* aZone, PCB_LAYER_ID aLayer, ZONE* aOtherZone ) -> bool
             {
@@ -207,82 +250,50 @@ bool ZONE_FILLER::Fill( std::vector<ZONE*>& aZones, bool aCheck, wxWindow* aPare
             };
 
     auto fill_lambda =
-            [&]( PROGRESS_REPORTER* aReporter )
+            [&]( size_t aIndex )
             {
-                size_t num = 0;
+                PCB_LAYER_ID layer = toFill[aIndex].second;
+                ZONE*        zone = toFill[aIndex].first;
 
-                for( size_t i = nextItem++; i < toFill.size(); i = nextItem++ )
+                // Check for any fill dependencies.  If our zone needs to be clipped by
+                // another zone then we can't fill until that zone is filled.
+                for( ZONE* otherZone : aZones )
                 {
-                    PCB_LAYER_ID layer = toFill[i].second;
-                    ZONE*        zone = toFill[i].first;
-                    bool         canFill = true;
-
-                    // Check for any fill dependencies.  If our zone needs to be clipped by
-                    // another zone then we can't fill until that zone is filled.
-                    for( ZONE* otherZone : aZones )
-                    {
-                        if( otherZone == zone )
-                            continue;
+                    if( otherZone == zone )
+                        continue;
 
-                        if( check_fill_dependency( zone, layer, otherZone ) )
-                        {
-                            canFill = false;
-                            break;
-                        }
-                    }
+                    if( check_fill_dependency( zone, layer, otherZone ) )
+                        return;
+                }
 
-                    if( m_progressReporter && m_progressReporter->IsCancelled() )
-                        break;
+                if( m_progressReporter && m_progressReporter->IsCancelled() )
+                    return;
 
-                    if( !canFill )
-                        continue;
+                // Now we're ready to fill.
+                SHAPE_POLY_SET rawPolys, finalPolys;
+                auto           region = refillRegions.find( zone );
 
-                    // Now we're ready to fill.
-                    SHAPE_POLY_SET rawPolys, finalPolys;
+                if( region != refillRegions.end() )
+                    refillZoneRegion( zone, layer, region->second, rawPolys, finalPolys );
+                else
                     fillSingleZone( zone, layer, rawPolys, finalPolys );
 
-                    std::unique_lock<std::mutex> zoneLock( zone->GetLock() );
+                std::unique_lock<std::mutex> zoneLock( zone->GetLock() );
 
-                    zone->SetRawPolysList( layer, rawPolys );
-                    zone->SetFilledPolysList( layer, finalPolys );
-                    zone->SetFillFlag( layer, true );
+                zone->SetRawPolysList( layer, rawPolys );
+                zone->SetFilledPolysList( layer, finalPolys );
+                zone->SetFillFlag( layer, true );
 
-                    if( m_progressReporter )
-                        m_progressReporter->AdvanceProgress();
-
-                    num++;
-                }
-
-                return num;
+                if( m_progressReporter )
+                    m_progressReporter->AdvanceProgress();
             };
 
     while( !toFill.empty() )
     {
-        size_t parallelThreadCount = std::min( cores, toFill.size() );
-        std::vector<std::future<size_t>> returns( parallelThreadCount );
-
-        nextItem = 0;
-
-        if( parallelThreadCount <= 1 )
-            fill_lambda( m_progressReporter );
-        else
-        {
-            for( size_t ii = 0; ii < parallelThreadCount; ++ii )
-                returns[ii] = std::async( std::launch::async, fill_lambda, m_progressReporter );
-
-            for( size_t ii = 0; ii < parallelThreadCount; ++ii )
-            {
-                // Here we balance returns with a 100ms timeout to allow UI updating
-                std::future_status status;
-                do
-                {
-                    if( m_progressReporter )
-                        m_progressReporter->KeepRefreshing();
+        TASK_GROUP tasks;
 
-                    status = returns[ii].wait_for( std::chrono::milliseconds( 100 ) );
-                } while( status != std::future_status::ready );
-            }
-        }
+        tasks.ParallelFor( toFill.size(), fill_lambda );
+        tasks.Wait( m_progressReporter );
 
         toFill.erase( std::remove_if( toFill.begin(), toFill.end(),
                       [&] ( const std::pair<ZONE*, PCB_LAYER_ID> pair ) -> bool
@@ -432,58 +443,23 @@ bool ZONE_FILLER::Fill( std::vector<ZONE*>& aZones, bool aCheck, wxWindow* aPare
         m_progressReporter->SetMaxProgress( islandsList.size() );
     }
 
-    nextItem = 0;
+    TASK_GROUP triangulation;
 
-    auto tri_lambda =
-            [&]( PROGRESS_REPORTER* aReporter ) -> size_t
+    triangulation.ParallelFor( islandsList.size(),
+            [&]( size_t aIndex )
             {
-                size_t num = 0;
-
-                for( size_t i = nextItem++; i < islandsList.size(); i = nextItem++ )
-                {
-                    islandsList[i].m_zone->CacheTriangulation();
-                    num++;
-
-                    if( m_progressReporter )
-                    {
-                        m_progressReporter->AdvanceProgress();
+                islandsList[aIndex].m_zone->CacheTriangulation();
 
-                        if( m_progressReporter->IsCancelled() )
-                            break;
-                    }
-                }
-
-                return num;
-            };
-
-    size_t parallelThreadCount = std::min( cores, islandsList.size() );
-    std::vector<std::future<size_t>> returns( parallelThreadCount );
-
-    if( parallelThreadCount <= 1 )
-        tri_lambda( m_progressReporter );
-    else
-    {
-        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
-            returns[ii] = std::async( std::launch::async, tri_lambda, m_progressReporter );
-
-        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
-        {
-            // Here we balance returns with a 100ms timeout to allow UI updating
-            std::future_status status;
-            do
-            {
                 if( m_progressReporter )
                 {
-                    m_progressReporter->KeepRefreshing();
+                    m_progressReporter->AdvanceProgress();
 
                     if( m_progressReporter->IsCancelled() )
-                        break;
+                        triangulation.Cancel();
                 }
+            } );
 
-                status = returns[ii].wait_for( std::chrono::milliseconds( 100 ) );
-            } while( status != std::future_status::ready );
-        }
-    }
+    triangulation.Wait( m_progressReporter );
 
     if( m_progressReporter )
     {
@@ -530,10 +506,18 @@ bool hasThermalConnection( PAD* pad, const ZONE* aZone )
 
 /**
  * Add a knockout for a pad.  The knockout is 'aGap' larger than the pad (which might be
- * either the thermal clearance or the electrical clearance).
+ * either the thermal clearance or the electrical clearance).  Knockouts are cached on the
+ * board as every zone overlapping the pad, and every refill, needs the same one.
  */
 void ZONE_FILLER::addKnockout( PAD* aPad, PCB_LAYER_ID aLayer, int aGap, SHAPE_POLY_SET& aHoles )
 {
+    ZONE_KNOCKOUT_CACHE* cache = m_board->GetZoneKnockoutCache();
+
+    if( cache->Lookup( aPad, aLayer, aGap, m_maxError, aHoles ) )
+        return;
+
+    SHAPE_POLY_SET knockout;
+
     if( aPad->GetShape() == PAD_SHAPE_CUSTOM )
     {
         SHAPE_POLY_SET poly;
@@ -546,19 +530,22 @@ void ZONE_FILLER::addKnockout( PAD* aPad, PCB_LAYER_ID aLayer, int aGap, SHAPE_P
             std::vector<wxPoint> convex_hull;
             BuildConvexHull( convex_hull, poly );
 
-            aHoles.NewOutline();
+            knockout.NewOutline();
 
             for( const wxPoint& pt : convex_hull )
-                aHoles.Append( pt );
+                knockout.Append( pt );
         }
         else
-            aHoles.Append( poly );
+            knockout = poly;
     }
     else
     {
-        aPad->TransformShapeWithClearanceToPolygon( aHoles, aLayer, aGap, m_maxError,
+        aPad->TransformShapeWithClearanceToPolygon( knockout, aLayer, aGap, m_maxError,
                                                     ERROR_OUTSIDE );
     }
+
+    cache->Store( aPad, aLayer, aGap, m_maxError, knockout );
+    aHoles.Append( knockout );
 }
 
 
@@ -654,7 +641,7 @@ void ZONE_FILLER::knockoutThermalReliefs( const ZONE* aZone, PCB_LAYER_ID aLayer
  * not connected to it.
  */
 void ZONE_FILLER::buildCopperItemClearances( const ZONE* aZone, PCB_LAYER_ID aLayer,
-                                             SHAPE_POLY_SET& aHoles )
+                                             const EDA_RECT& aFillBox, SHAPE_POLY_SET& aHoles )
 {
     long ticker = 0;
 
@@ -675,7 +662,7 @@ void ZONE_FILLER::buildCopperItemClearances( const ZONE* aZone, PCB_LAYER_ID aLa
 
     BOARD_DESIGN_SETTINGS& bds = m_board->GetDesignSettings();
     int                    zone_clearance = aZone->GetLocalClearance();
-    EDA_RECT               zone_boundingbox = aZone->GetCachedBoundingBox();
+    EDA_RECT               zone_boundingbox = aFillBox;
 
     // Items outside the zone bounding box are skipped, so it needs to be inflated by the
     // largest clearance value found in the netclasses and rules
@@ -914,7 +901,7 @@ void ZONE_FILLER::buildCopperItemClearances( const ZONE* aZone, PCB_LAYER_ID aLa
         }
     }
 
-    aHoles.Simplify( SHAPE_POLY_SET::PM_FAST );
+    aHoles.CascadedUnion( SHAPE_POLY_SET::PM_FAST );
 }
 
 
@@ -989,6 +976,7 @@ bool ZONE_FILLER::computeRawFilledArea( const ZONE* aZone,
                                         PCB_LAYER_ID aLayer, PCB_LAYER_ID aDebugLayer,
                                         const SHAPE_POLY_SET& aSmoothedOutline,
                                         const SHAPE_POLY_SET& aMaxExtents,
+                                        const EDA_RECT& aFillBox,
                                         SHAPE_POLY_SET& aRawPolys )
 {
     m_maxError = m_board->GetDesignSettings().m_MaxError;
@@ -1028,13 +1016,13 @@ bool ZONE_FILLER::computeRawFilledArea( const ZONE* aZone,
     if( m_progressReporter && m_progressReporter->IsCancelled() )
         return false;
 
-    buildCopperItemClearances( aZone, aLayer, clearanceHoles );
+    buildCopperItemClearances( aZone, aLayer, aFillBox, clearanceHoles );
     DUMP_POLYS_TO_COPPER_LAYER( clearanceHoles, In3_Cu, "clearance-holes" );
 
     if( m_progressReporter && m_progressReporter->IsCancelled() )
         return false;
 
-    buildThermalSpokes( aZone, aLayer, thermalSpokes );
+    buildThermalSpokes( aZone, aLayer, aFillBox, thermalSpokes );
 
     if( m_progressReporter && m_progressReporter->IsCancelled() )
         return false;
@@ -1153,7 +1141,7 @@ bool ZONE_FILLER::computeRawFilledArea( const ZONE* aZone,
     subtractHigherPriorityZones( aZone, aLayer, aRawPolys );
     DUMP_POLYS_TO_COPPER_LAYER( aRawPolys, In18_Cu, "minus-higher-priority-zones" );
 
-    aRawPolys.Fracture( SHAPE_POLY_SET::PM_FAST );
+    aRawPolys.ParallelFracture( SHAPE_POLY_SET::PM_FAST );
     return true;
 }
 
@@ -1190,8 +1178,11 @@ bool ZONE_FILLER::fillSingleZone( ZONE* aZone, PCB_LAYER_ID aLayer, SHAPE_POLY_S
 
     if( aZone->IsOnCopperLayer() )
     {
-        if( computeRawFilledArea( aZone, aLayer, debugLayer, smoothedPoly, maxExtents, aRawPolys ) )
+        if( computeRawFilledArea( aZone, aLayer, debugLayer, smoothedPoly, maxExtents,
+                                  aZone->GetCachedBoundingBox(), aRawPolys ) )
+        {
             aZone->SetNeedRefill( false );
+        }
 
         aFinalPolys = aRawPolys;
     }
@@ -1232,13 +1223,139 @@ bool ZONE_FILLER::fillSingleZone( ZONE* aZone, PCB_LAYER_ID aLayer, SHAPE_POLY_S
 }
 
 
+static void addRectOutline( SHAPE_POLY_SET& aPolys, const EDA_RECT& aRect )
+{
+    SHAPE_LINE_CHAIN rect;
+
+    rect.Append( aRect.GetLeft(), aRect.GetTop() );
+    rect.Append( aRect.GetRight(), aRect.GetTop() );
+    rect.Append( aRect.GetRight(), aRect.GetBottom() );
+    rect.Append( aRect.GetLeft(), aRect.GetBottom() );
+    rect.SetClosed( true );
+
+    aPolys.AddOutline( rect );
+}
+
+
+bool ZONE_FILLER::buildRefillRegion( const ZONE* aZone, const std::vector<EDA_RECT>& aDirtyAreas,
+                                     SHAPE_POLY_SET& aRegion ) const
+{
+    EDA_RECT zoneBox = aZone->GetCachedBoundingBox();
+    double   dirtyArea = 0.0;
+
+    for( EDA_RECT area : aDirtyAreas )
+    {
+        // A change can also reach a lower-priority zone through the fill of a higher-priority
+        // zone, so allow for one level of zone-to-zone interaction.
+        area.Normalize();
+        area.Inflate( 2 * m_refillMargin );
+
+        if( !area.Intersects( zoneBox ) )
+            continue;
+
+        area = area.Common( zoneBox );
+        dirtyArea += area.GetArea();
+
+        addRectOutline( aRegion, area );
+    }
+
+    // Past this point windowing and splicing costs more than it saves
+    if( dirtyArea > zoneBox.GetArea() / 2 )
+        return false;
+
+    aRegion.Simplify( SHAPE_POLY_SET::PM_FAST );
+    return true;
+}
+
+
+bool ZONE_FILLER::refillZoneRegion( ZONE* aZone, PCB_LAYER_ID aLayer,
+                                    const SHAPE_POLY_SET& aRegion, SHAPE_POLY_SET& aRawPolys,
+                                    SHAPE_POLY_SET& aFinalPolys )
+{
+    {
+        std::unique_lock<std::mutex> zoneLock( aZone->GetLock() );
+        aRawPolys = aZone->RawPolysList( aLayer );
+    }
+
+    // Nothing near this zone changed: the previous fill stands
+    if( aRegion.IsEmpty() )
+    {
+        aFinalPolys = aRawPolys;
+        aZone->SetNeedRefill( false );
+        return true;
+    }
+
+    SHAPE_POLY_SET* boardOutline = m_brdOutlinesValid ? &m_boardOutline : nullptr;
+    SHAPE_POLY_SET  maxExtents;
+    SHAPE_POLY_SET  smoothedPoly;
+    SHAPE_POLY_SET  window = aRegion;
+    SHAPE_POLY_SET  regionFill;
+
+    if( !aZone->BuildSmoothedPoly( maxExtents, aLayer, boardOutline, &smoothedPoly ) )
+        return false;
+
+    if( m_progressReporter && m_progressReporter->IsCancelled() )
+        return false;
+
+    window.Inflate( m_refillMargin, 8, SHAPE_POLY_SET::CHAMFER_ALL_CORNERS );
+
+    // Thermal spokes are kept or dropped by testing their ends against the fill, so pads
+    // straddling the window are taken in whole.
+    BOX2I    bbox = window.BBox();
+    EDA_RECT windowBox( (wxPoint) bbox.GetPosition(),
+                        wxSize( bbox.GetWidth(), bbox.GetHeight() ) );
+
+    for( FOOTPRINT* footprint : m_board->Footprints() )
+    {
+        for( PAD* pad : footprint->Pads() )
+        {
+            if( !pad->IsOnLayer( aLayer ) || !hasThermalConnection( pad, aZone ) )
+                continue;
+
+            EDA_RECT padBox = pad->GetBoundingBox();
+
+            if( padBox.Intersects( windowBox ) && !windowBox.Contains( padBox ) )
+            {
+                padBox.Inflate( m_refillMargin );
+                addRectOutline( window, padBox );
+            }
+        }
+    }
+
+    window.Simplify( SHAPE_POLY_SET::PM_FAST );
+    bbox = window.BBox();
+    windowBox.SetOrigin( (wxPoint) bbox.GetPosition() );
+    windowBox.SetSize( bbox.GetWidth(), bbox.GetHeight() );
+
+    smoothedPoly.BooleanIntersection( window, SHAPE_POLY_SET::PM_FAST );
+    maxExtents.BooleanIntersection( window, SHAPE_POLY_SET::PM_FAST );
+
+    if( !computeRawFilledArea( aZone, aLayer, UNDEFINED_LAYER, smoothedPoly, maxExtents,
+                               windowBox, regionFill ) )
+    {
+        return false;
+    }
+
+    // Replace the region in the previous fill with the freshly computed one
+    regionFill.BooleanIntersection( aRegion, SHAPE_POLY_SET::PM_FAST );
+    aRawPolys.BooleanSubtract( aRegion, SHAPE_POLY_SET::PM_FAST );
+    aRawPolys.BooleanAdd( regionFill, SHAPE_POLY_SET::PM_FAST );
+    aRawPolys.Fracture( SHAPE_POLY_SET::PM_FAST );
+
+    aFinalPolys = aRawPolys;
+    aZone->SetNeedRefill( false );
+    return true;
+}
+
+
 /**
  * Function buildThermalSpokes
  */
 void ZONE_FILLER::buildThermalSpokes( const ZONE* aZone, PCB_LAYER_ID aLayer,
+                                      const EDA_RECT& aFillBox,
                                       std::deque<SHAPE_LINE_CHAIN>& aSpokesList )
 {
-    auto zoneBB = aZone->GetCachedBoundingBox();
+    auto zoneBB = aFillBox;
     int  zone_clearance = aZone->GetLocalClearance();
     int  biggest_clearance = m_board->GetDesignSettings().GetBiggestClearanceValue();
     biggest_clearance = std::max( biggest_clearance, zone_clearance );
@@ -46,6 +46,13 @@ public:
     void InstallNewProgressReporter( wxWindow* aParent, const wxString& aTitle, int aNumPhases );
     bool Fill( std::vector<ZONE*>& aZones, bool aCheck = false, wxWindow* aParent = nullptr );
 
+    /**
+     * Allow zones to be refilled only around the areas recorded as dirty by the board since
+     * the last fill (see BOARD::GetZoneFillDirtyAreas()).  Zones which can't be refilled
+     * that way, or when the record is invalid, are still filled in full.
+     */
+    void SetIncremental( bool aIncremental ) { m_incremental = aIncremental; }
+
     bool IsDebug() const { return m_debugZoneFiller; }
 
 private:
@@ -58,7 +65,7 @@ private:
     void knockoutThermalReliefs( const ZONE* aZone, PCB_LAYER_ID aLayer, SHAPE_POLY_SET& aFill );
 
     void buildCopperItemClearances( const ZONE* aZone, PCB_LAYER_ID aLayer,
-                                    SHAPE_POLY_SET& aHoles );
+                                    const EDA_RECT& aFillBox, SHAPE_POLY_SET& aHoles );
 
     void subtractHigherPriorityZones( const ZONE* aZone, PCB_LAYER_ID aLayer,
                                       SHAPE_POLY_SET& aRawFill );
@@ -73,16 +80,18 @@ private:
      * BuildFilledSolidAreasPolygons() call this function just after creating the
      *  filled copper area polygon (without clearance areas
      * @param aPcb: the current board
+     * @param aFillBox: items outside this box (plus clearance) are ignored
      */
     bool computeRawFilledArea( const ZONE* aZone, PCB_LAYER_ID aLayer, PCB_LAYER_ID aDebugLayer,
                                const SHAPE_POLY_SET& aSmoothedOutline,
-                               const SHAPE_POLY_SET& aMaxExtents, SHAPE_POLY_SET& aRawPolys );
+                               const SHAPE_POLY_SET& aMaxExtents, const EDA_RECT& aFillBox,
+                               SHAPE_POLY_SET& aRawPolys );
 
     /**
      * Function buildThermalSpokes
      * Constructs a list of all thermal spokes for the given zone.
      */
-    void buildThermalSpokes( const ZONE* aZone, PCB_LAYER_ID aLayer,
+    void buildThermalSpokes( const ZONE* aZone, PCB_LAYER_ID aLayer, const EDA_RECT& aFillBox,
                              std::deque<SHAPE_LINE_CHAIN>& aSpokes );
 
     /**
@@ -102,6 +111,21 @@ private:
     bool fillSingleZone( ZONE* aZone, PCB_LAYER_ID aLayer, SHAPE_POLY_SET& aRawPolys,
                          SHAPE_POLY_SET& aFinalPolys );
 
+    /**
+     * Collect the parts of a zone which may be affected by the given dirty areas.
+     * @return false if so much of the zone is affected that it should be filled in full.
+     */
+    bool buildRefillRegion( const ZONE* aZone, const std::vector<EDA_RECT>& aDirtyAreas,
+                            SHAPE_POLY_SET& aRegion ) const;
+
+    /**
+     * Recompute the fill of a copper zone inside \a aRegion only, and splice it into the
+     * zone's previous raw fill.  The fill is computed over a window somewhat larger than
+     * the region so that the window's edges don't show up in the result.
+     */
+    bool refillZoneRegion( ZONE* aZone, PCB_LAYER_ID aLayer, const SHAPE_POLY_SET& aRegion,
+                           SHAPE_POLY_SET& aRawPolys, SHAPE_POLY_SET& aFinalPolys );
+
     /**
      * for zones having the ZONE_FILL_MODE::ZONE_FILL_MODE::HATCH_PATTERN, create a grid pattern
      * in filled areas of aZone, giving to the filled polygons a fill style like a grid
@@ -123,6 +147,9 @@ private:
     int                   m_maxError;
     int                   m_worstClearance;
 
+    bool                  m_incremental;
+    int                   m_refillMargin;       // reach of a change into the surrounding fill
+
     bool                  m_debugZoneFiller;
 };
 
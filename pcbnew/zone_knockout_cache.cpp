@@ -0,0 +1,118 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <mutex>
+#include <unordered_set>
+
+#include <board.h>
+#include <footprint.h>
+#include <pad.h>
+#include <hash_eda.h>
+#include <zone_knockout_cache.h>
+
+
+std::size_t ZONE_KNOCKOUT_CACHE::KEY_HASH::operator()( const KEY& aKey ) const
+{
+    return hash_val( aKey.m_pad, static_cast<int>( aKey.m_layer ), aKey.m_gap, aKey.m_maxError );
+}
+
+
+size_t ZONE_KNOCKOUT_CACHE::geometryHash( const PAD* aPad )
+{
+    // The effective polygon already reflects the pad's shape, size, position, orientation,
+    // corner settings and custom primitives; the remaining fields cover what it doesn't.
+    size_t ret = hash_fp_item( aPad, HASH_POS | HASH_ROT | HASH_LAYER );
+
+    hash_combine( ret, static_cast<int>( aPad->GetCustomShapeInZoneOpt() ) );
+
+    const SHAPE_POLY_SET& poly = *aPad->GetEffectivePolygon();
+
+    for( int ii = 0; ii < poly.OutlineCount(); ++ii )
+    {
+        const SHAPE_LINE_CHAIN& outline = poly.COutline( ii );
+
+        for( int jj = 0; jj < outline.PointCount(); ++jj )
+            hash_combine( ret, outline.CPoint( jj ).x, outline.CPoint( jj ).y );
+    }
+
+    return ret;
+}
+
+
+bool ZONE_KNOCKOUT_CACHE::Lookup( const PAD* aPad, PCB_LAYER_ID aLayer, int aGap, int aMaxError,
+                                  SHAPE_POLY_SET& aHoles ) const
+{
+    KEY key = { aPad, aLayer, aGap, aMaxError };
+
+    std::shared_lock<std::shared_timed_mutex> readLock( m_lock );
+
+    auto it = m_entries.find( key );
+
+    if( it == m_entries.end() || it->second.m_geometryHash != geometryHash( aPad ) )
+        return false;
+
+    aHoles.Append( it->second.m_knockout );
+    return true;
+}
+
+
+void ZONE_KNOCKOUT_CACHE::Store( const PAD* aPad, PCB_LAYER_ID aLayer, int aGap, int aMaxError,
+                                 const SHAPE_POLY_SET& aKnockout )
+{
+    KEY   key = { aPad, aLayer, aGap, aMaxError };
+    ENTRY entry = { geometryHash( aPad ), aKnockout };
+
+    std::unique_lock<std::shared_timed_mutex> writeLock( m_lock );
+
+    m_entries[ key ] = std::move( entry );
+}
+
+
+void ZONE_KNOCKOUT_CACHE::Prune( const BOARD* aBoard )
+{
+    std::unordered_set<const PAD*> pads;
+
+    for( FOOTPRINT* footprint : aBoard->Footprints() )
+    {
+        for( PAD* pad : footprint->Pads() )
+            pads.insert( pad );
+    }
+
+    std::unique_lock<std::shared_timed_mutex> writeLock( m_lock );
+
+    for( auto it = m_entries.begin(); it != m_entries.end(); )
+    {
+        if( pads.count( it->first.m_pad ) )
+            ++it;
+        else
+            it = m_entries.erase( it );
+    }
+}
+
+
+void ZONE_KNOCKOUT_CACHE::Clear()
+{
+    std::unique_lock<std::shared_timed_mutex> writeLock( m_lock );
+
+    m_entries.clear();
+}
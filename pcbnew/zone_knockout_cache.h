@@ -0,0 +1,104 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef ZONE_KNOCKOUT_CACHE_H
+#define ZONE_KNOCKOUT_CACHE_H
+
+#include <shared_mutex>
+#include <unordered_map>
+
+#include <geometry/shape_poly_set.h>
+#include <layers_id_colors_and_visibility.h>
+
+class BOARD;
+class PAD;
+
+
+/**
+ * Cache of the clearance outlines knocked out of zone fills around pads.
+ *
+ * Every zone overlapping a pad knocks out the same inflated pad shape, and does so again on
+ * every refill.  Entries are keyed by pad, layer, clearance and max error, and remember a hash
+ * of the pad's geometry so that a moved or reshaped pad is regenerated rather than reused.
+ * The cache belongs to the board and is shared by all zone fills; it is thread-safe.
+ */
+class ZONE_KNOCKOUT_CACHE
+{
+public:
+    ZONE_KNOCKOUT_CACHE() = default;
+
+    /**
+     * Append the cached knockout for \a aPad to \a aHoles.
+     *
+     * @return false if there is no up-to-date knockout in the cache.
+     */
+    bool Lookup( const PAD* aPad, PCB_LAYER_ID aLayer, int aGap, int aMaxError,
+                 SHAPE_POLY_SET& aHoles ) const;
+
+    void Store( const PAD* aPad, PCB_LAYER_ID aLayer, int aGap, int aMaxError,
+                const SHAPE_POLY_SET& aKnockout );
+
+    /**
+     * Drop the entries of pads no longer on \a aBoard.  Not thread-safe with respect to
+     * Lookup() and Store().
+     */
+    void Prune( const BOARD* aBoard );
+
+    void Clear();
+
+private:
+    /**
+     * Hash of the pad's effective shape.  The pad's effective shapes must be up to date.
+     */
+    static size_t geometryHash( const PAD* aPad );
+
+    struct KEY
+    {
+        const PAD*   m_pad;
+        PCB_LAYER_ID m_layer;
+        int          m_gap;
+        int          m_maxError;
+
+        bool operator==( const KEY& aOther ) const
+        {
+            return m_pad == aOther.m_pad && m_layer == aOther.m_layer && m_gap == aOther.m_gap
+                   && m_maxError == aOther.m_maxError;
+        }
+    };
+
+    struct KEY_HASH
+    {
+        std::size_t operator()( const KEY& aKey ) const;
+    };
+
+    struct ENTRY
+    {
+        size_t         m_geometryHash;
+        SHAPE_POLY_SET m_knockout;
+    };
+
+    mutable std::shared_timed_mutex          m_lock;
+    std::unordered_map<KEY, ENTRY, KEY_HASH> m_entries;
+};
+
+#endif // ZONE_KNOCKOUT_CACHE_H
@@ -0,0 +1,441 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Test suite for DSNLEXER
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+// Code under test
+#include <dsnlexer.h>
+
+// A generated lexer, to test the keyword hashes generated by TokenList2DsnLexer.cmake
+#include <drc_rules_lexer.h>
+
+#include <cctype>
+#include <ostream>
+
+
+/**
+ * Gives access to the keyword table and perfect hash of the generated DRC_RULES_LEXER.
+ */
+class DRC_RULES_KEYWORDS : public DRC_RULES_LEXER
+{
+public:
+    DRC_RULES_KEYWORDS() :
+            DRC_RULES_LEXER( std::string() )
+    {
+    }
+
+    const KEYWORD*      Keywords() const { return keywords; }
+    unsigned            KeywordCount() const { return keywordCount; }
+    const KEYWORD_HASH* PerfectHash() const { return keywordPerfectHash; }
+};
+
+
+/**
+ * Looks keywords up in a keyword table, with or without a perfect hash.
+ */
+class KEYWORD_LOOKUP : public DSNLEXER
+{
+public:
+    KEYWORD_LOOKUP( const DRC_RULES_KEYWORDS& aTables, bool aUsePerfectHash ) :
+            DSNLEXER( aTables.Keywords(), aTables.KeywordCount(), (LINE_READER*) nullptr,
+                      aUsePerfectHash ? aTables.PerfectHash() : nullptr )
+    {
+    }
+
+    int Find( const std::string& aText ) { return findToken( aText ); }
+};
+
+
+/**
+ * The slot of the perfect hash that \a aText would be found in, computed the same way as
+ * DSNLEXER::findToken(), or -1 if \a aText holds a character keywords cannot contain.
+ */
+static int hashSlot( const KEYWORD_HASH& aHash, const std::string& aText )
+{
+    static const std::string alphabet = "_0123456789abcdefghijklmnopqrstuvwxyz";
+
+    unsigned h1 = 0;
+    unsigned h2 = 0;
+
+    for( char c : aText )
+    {
+        size_t pos = alphabet.find( c );
+
+        if( pos == std::string::npos )
+            return -1;
+
+        h1 = ( ( h1 ^ ( h1 >> 12 ) ) * 31 + pos + 1 ) & 0x1FFFFFF;
+        h2 = ( ( h2 ^ ( h2 >> 12 ) ) * 37 + pos + 1 ) & 0x1FFFFFF;
+    }
+
+    unsigned bucket = h1 & ( aHash.bucketCount - 1 );
+
+    return ( h2 + aHash.displacements[bucket] ) & ( aHash.slotCount - 1 );
+}
+
+
+BOOST_AUTO_TEST_SUITE( DsnLexer )
+
+
+/**
+ * Every keyword is found in the slot it hashes to.
+ */
+BOOST_AUTO_TEST_CASE( PerfectHashKeywords )
+{
+    DRC_RULES_KEYWORDS tables;
+    KEYWORD_LOOKUP     lookup( tables, true );
+
+    BOOST_REQUIRE( tables.PerfectHash() );
+    BOOST_REQUIRE_GT( tables.KeywordCount(), 0 );
+
+    const KEYWORD_HASH& hash = *tables.PerfectHash();
+
+    for( unsigned ii = 0; ii < tables.KeywordCount(); ++ii )
+    {
+        const KEYWORD& keyword = tables.Keywords()[ii];
+
+        BOOST_TEST_CONTEXT( keyword.name )
+        {
+            BOOST_CHECK_EQUAL( lookup.Find( keyword.name ), keyword.token );
+
+            int slot = hashSlot( hash, keyword.name );
+
+            BOOST_REQUIRE_GE( slot, 0 );
+            BOOST_CHECK_EQUAL( hash.slots[slot], keyword.token );
+        }
+    }
+}
+
+
+/**
+ * The generated lexer returns the keyword tokens through NextTok().
+ */
+BOOST_AUTO_TEST_CASE( PerfectHashNextTok )
+{
+    DRC_RULES_KEYWORDS tables;
+    std::string        text;
+
+    for( unsigned ii = 0; ii < tables.KeywordCount(); ++ii )
+        text += std::string( "(" ) + tables.Keywords()[ii].name + " x)\n";
+
+    DRC_RULES_LEXER lexer( text );
+
+    for( unsigned ii = 0; ii < tables.KeywordCount(); ++ii )
+    {
+        BOOST_CHECK_EQUAL( lexer.NextTok(), DSN_LEFT );
+        BOOST_CHECK_EQUAL( lexer.NextTok(), tables.Keywords()[ii].token );
+        BOOST_CHECK_EQUAL( lexer.NextTok(), DSN_SYMBOL );
+        BOOST_CHECK_EQUAL( lexer.NextTok(), DSN_RIGHT );
+    }
+
+    BOOST_CHECK_EQUAL( lexer.NextTok(), DSN_EOF );
+}
+
+
+/**
+ * Text that is not a keyword is a symbol, including text that hashes to the slot of a
+ * keyword.  The lookup without a perfect hash serves as reference.
+ */
+BOOST_AUTO_TEST_CASE( PerfectHashNonKeywords )
+{
+    DRC_RULES_KEYWORDS tables;
+    KEYWORD_LOOKUP     hashed( tables, true );
+    KEYWORD_LOOKUP     reference( tables, false );
+
+    const KEYWORD_HASH&      hash = *tables.PerfectHash();
+    static const std::string alphabet = "_0123456789abcdefghijklmnopqrstuvwxyz";
+    std::vector<std::string> candidates = { "", "(", "a b", "-", "+1" };
+
+    // Every string of up to three characters keywords may hold
+    for( char c1 : alphabet )
+    {
+        candidates.emplace_back( 1, c1 );
+
+        for( char c2 : alphabet )
+        {
+            candidates.push_back( std::string( 1, c1 ) + c2 );
+
+            for( char c3 : alphabet )
+                candidates.push_back( std::string( 1, c1 ) + c2 + c3 );
+        }
+    }
+
+    // Near misses of the keywords
+    for( unsigned ii = 0; ii < tables.KeywordCount(); ++ii )
+    {
+        std::string name = tables.Keywords()[ii].name;
+        std::string upper = name;
+
+        for( char& c : upper )
+            c = toupper( (unsigned char) c );
+
+        candidates.push_back( upper );
+        candidates.push_back( name + "_" );
+        candidates.push_back( "_" + name );
+        candidates.push_back( name.substr( 0, name.size() - 1 ) );
+    }
+
+    int collisions = 0;
+
+    for( const std::string& candidate : candidates )
+    {
+        int expected = reference.Find( candidate );
+
+        BOOST_TEST_CONTEXT( "'" << candidate << "'" )
+        {
+            BOOST_CHECK_EQUAL( hashed.Find( candidate ), expected );
+        }
+
+        int slot = hashSlot( hash, candidate );
+
+        if( expected == DSN_SYMBOL && slot >= 0 && hash.slots[slot] >= 0 )
+            collisions++;
+    }
+
+    // Make sure the final string compare was exercised
+    BOOST_CHECK_GT( collisions, 0 );
+}
+
+
+/**
+ * A token as read by a lexer, with its position.
+ */
+struct LEXED_TOKEN
+{
+    int         tok;
+    std::string text;
+    int         line;
+    int         offset;
+
+    bool operator==( const LEXED_TOKEN& aOther ) const
+    {
+        return tok == aOther.tok && text == aOther.text && line == aOther.line
+               && offset == aOther.offset;
+    }
+};
+
+
+std::ostream& operator<<( std::ostream& os, const LEXED_TOKEN& aToken )
+{
+    os << aToken.tok << " '" << aToken.text << "' at " << aToken.line << ":" << aToken.offset;
+    return os;
+}
+
+
+static LEXED_TOKEN lexedToken( DSNLEXER& aLexer )
+{
+    return { aLexer.CurTok(), aLexer.CurStr(), aLexer.CurLineNumber(), aLexer.CurOffset() };
+}
+
+
+/**
+ * Source text with a list to copy: "(zone" on the second line, with a quoted string holding
+ * parentheses and an escaped quote, a comment line holding parentheses, nested lists and a
+ * list that spans lines.
+ */
+static const std::string copy_list_source =
+        "(kicad_pcb (version 1)\n"
+        "  (zone (name \"a ) \\\" (\") (tag x)\n"
+        "    # comment ( (\n"
+        "    (poly (pts (xy 1 2)\n"
+        "      (xy 3 4))))\n"
+        "  (after \"x\")\n"
+        ")\n";
+
+
+BOOST_AUTO_TEST_CASE( CopyList )
+{
+    // The tokens of the zone list, as read in place
+    std::vector<LEXED_TOKEN> expected;
+
+    {
+        DSNLEXER lexer( copy_list_source, "test" );
+        int      depth = 0;
+
+        while( lexer.NextTok() != DSN_EOF && lexer.CurLineNumber() < 2 )
+            ;
+
+        do
+        {
+            expected.push_back( lexedToken( lexer ) );
+
+            if( lexer.CurTok() == DSN_LEFT )
+                depth++;
+            else if( lexer.CurTok() == DSN_RIGHT )
+                depth--;
+        } while( depth > 0 && lexer.NextTok() != DSN_EOF );
+    }
+
+    BOOST_REQUIRE_GT( expected.size(), 2 );
+    BOOST_CHECK_EQUAL( expected[1].text, "zone" );
+    BOOST_CHECK_EQUAL( expected[3].text, "name" );
+    BOOST_CHECK_EQUAL( expected[4].text, "a ) \" (" );
+
+    DSNLEXER    lexer( copy_list_source, "test" );
+    std::string copy;
+
+    for( int ii = 0; ii < 7; ++ii )     // ( kicad_pcb ( version 1 ) (
+        lexer.NextTok();
+
+    BOOST_REQUIRE_EQUAL( lexer.NextTok(), DSN_SYMBOL );
+    BOOST_REQUIRE_EQUAL( lexer.CurStr(), "zone" );
+
+    int lineNumber = lexer.CopyList( copy );
+
+    BOOST_CHECK_EQUAL( lineNumber, 1 );
+    BOOST_CHECK_EQUAL( copy, "  (zone (name \"a ) \\\" (\") (tag x)\n"
+                             "    # comment ( (\n"
+                             "    (poly (pts (xy 1 2)\n"
+                             "      (xy 3 4))))" );
+
+    // The closing parenthesis of the list is the current token
+    BOOST_CHECK_EQUAL( lexedToken( lexer ), expected.back() );
+
+    // Lexing goes on after the list
+    BOOST_CHECK_EQUAL( lexer.NextTok(), DSN_LEFT );
+    BOOST_CHECK_EQUAL( lexer.NextTok(), DSN_SYMBOL );
+    BOOST_CHECK_EQUAL( lexer.CurStr(), "after" );
+    BOOST_CHECK_EQUAL( lexer.CurLineNumber(), 6 );
+    BOOST_CHECK_EQUAL( lexer.NextTok(), DSN_STRING );
+    BOOST_CHECK_EQUAL( lexer.NextTok(), DSN_RIGHT );
+    BOOST_CHECK_EQUAL( lexer.NextTok(), DSN_RIGHT );
+    BOOST_CHECK_EQUAL( lexer.NextTok(), DSN_EOF );
+
+    // The copy lexes to the same tokens, at the same lines and offsets
+    STRING_LINE_READER       reader( copy, "copy", lineNumber );
+    DSNLEXER                 copyLexer( nullptr, 0, &reader );
+    std::vector<LEXED_TOKEN> copied;
+
+    while( copyLexer.NextTok() != DSN_EOF )
+        copied.push_back( lexedToken( copyLexer ) );
+
+    BOOST_CHECK_EQUAL_COLLECTIONS( copied.begin(), copied.end(), expected.begin(),
+                                   expected.end() );
+}
+
+
+BOOST_AUTO_TEST_CASE( CopyListOnOneLine )
+{
+    DSNLEXER    lexer( std::string( "(a (b (c \"(\")) (d))" ), "test" );
+    std::string copy;
+
+    lexer.NextTok();
+    lexer.NextTok();
+    lexer.NextTok();
+    lexer.NextTok();
+
+    BOOST_REQUIRE_EQUAL( lexer.CurStr(), "b" );
+    BOOST_CHECK_EQUAL( lexer.CopyList( copy ), 0 );
+    BOOST_CHECK_EQUAL( copy, "   (b (c \"(\"))" );
+    BOOST_CHECK_EQUAL( lexer.CurTok(), DSN_RIGHT );
+    BOOST_CHECK_EQUAL( lexer.CurOffset(), 14 );
+
+    BOOST_CHECK_EQUAL( lexer.NextTok(), DSN_LEFT );
+    BOOST_CHECK_EQUAL( lexer.NextTok(), DSN_SYMBOL );
+    BOOST_CHECK_EQUAL( lexer.CurStr(), "d" );
+    BOOST_CHECK_EQUAL( lexer.NextTok(), DSN_RIGHT );
+    BOOST_CHECK_EQUAL( lexer.NextTok(), DSN_RIGHT );
+    BOOST_CHECK_EQUAL( lexer.NextTok(), DSN_EOF );
+}
+
+
+/**
+ * The opening '(' of the list may be lines before its first token
+ */
+BOOST_AUTO_TEST_CASE( CopyListParenOnEarlierLine )
+{
+    const std::string source = "(a\n"
+                               "  (\n"
+                               "    # comment (\n"
+                               "\n"
+                               "   b (c d))\n"
+                               "  (e))\n";
+
+    // The tokens of the b list, as read in place
+    std::vector<LEXED_TOKEN> expected;
+
+    {
+        DSNLEXER lexer( source, "test" );
+
+        lexer.NextTok();
+        lexer.NextTok();
+
+        for( int ii = 0; ii < 7; ++ii )     // ( b ( c d ) )
+        {
+            lexer.NextTok();
+            expected.push_back( lexedToken( lexer ) );
+        }
+    }
+
+    DSNLEXER    lexer( source, "test" );
+    std::string copy;
+
+    lexer.NextTok();
+    lexer.NextTok();
+    lexer.NextTok();
+
+    BOOST_REQUIRE_EQUAL( lexer.NextTok(), DSN_SYMBOL );
+    BOOST_REQUIRE_EQUAL( lexer.CurStr(), "b" );
+
+    int lineNumber = lexer.CopyList( copy );
+
+    BOOST_CHECK_EQUAL( lineNumber, 1 );
+    BOOST_CHECK_EQUAL( copy, "  (\n\n\n   b (c d))" );
+    BOOST_CHECK_EQUAL( lexedToken( lexer ), expected.back() );
+
+    BOOST_CHECK_EQUAL( lexer.NextTok(), DSN_LEFT );
+    BOOST_CHECK_EQUAL( lexer.NextTok(), DSN_SYMBOL );
+    BOOST_CHECK_EQUAL( lexer.CurStr(), "e" );
+
+    STRING_LINE_READER       reader( copy, "copy", lineNumber );
+    DSNLEXER                 copyLexer( nullptr, 0, &reader );
+    std::vector<LEXED_TOKEN> copied;
+
+    while( copyLexer.NextTok() != DSN_EOF )
+        copied.push_back( lexedToken( copyLexer ) );
+
+    BOOST_CHECK_EQUAL_COLLECTIONS( copied.begin(), copied.end(), expected.begin(),
+                                   expected.end() );
+}
+
+
+BOOST_AUTO_TEST_CASE( CopyListUnterminated )
+{
+    DSNLEXER    lexer( std::string( "(a (b (c d)\n(e" ), "test" );
+    std::string copy;
+
+    lexer.NextTok();
+    lexer.NextTok();
+    lexer.NextTok();
+    lexer.NextTok();
+
+    BOOST_CHECK_THROW( lexer.CopyList( copy ), IO_ERROR );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
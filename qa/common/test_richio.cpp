@@ -0,0 +1,171 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <richio.h>
+
+#include <boost/filesystem.hpp>
+
+#include <fstream>
+
+
+struct MAPPED_READER_FIXTURE
+{
+    MAPPED_READER_FIXTURE() :
+            m_path( boost::filesystem::temp_directory_path() / "mapped_reader_tst.txt" )
+    {
+    }
+
+    ~MAPPED_READER_FIXTURE()
+    {
+        boost::filesystem::remove( m_path );
+    }
+
+    /**
+     * Write \a aContents to the test file, byte for byte.
+     */
+    wxString writeFile( const std::string& aContents ) const
+    {
+        std::ofstream out( m_path.string(), std::ios::binary | std::ios::trunc );
+
+        out.write( aContents.data(), aContents.size() );
+
+        return wxString( m_path.string() );
+    }
+
+    /**
+     * Read all the lines of \a aReader, checking the line number reported for each.
+     */
+    std::vector<std::string> readLines( LINE_READER& aReader, unsigned aFirstLineNumber )
+    {
+        std::vector<std::string> lines;
+
+        while( aReader.ReadLine() )
+        {
+            lines.emplace_back( aReader.Line(), aReader.Length() );
+            BOOST_CHECK_EQUAL( aReader.LineNumber(), aFirstLineNumber + lines.size() - 1 );
+        }
+
+        // The line number still moves on at the end of the file, for error reporting
+        BOOST_CHECK_EQUAL( aReader.LineNumber(), aFirstLineNumber + lines.size() );
+        BOOST_CHECK_EQUAL( aReader.Length(), 0 );
+        BOOST_CHECK_EQUAL( aReader.Line()[0], 0 );
+
+        return lines;
+    }
+
+    boost::filesystem::path m_path;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( MappedFileLineReader, MAPPED_READER_FIXTURE )
+
+
+struct MAPPED_READER_CASE
+{
+    std::string              m_name;
+    std::string              m_contents;
+    std::vector<std::string> m_lines;
+};
+
+
+static const std::vector<MAPPED_READER_CASE> mapped_reader_cases = {
+    { "Empty", "", {} },
+    { "Newline only", "\n", { "\n" } },
+    { "Trailing newline", "(a)\n(b c)\n", { "(a)\n", "(b c)\n" } },
+    { "No trailing newline", "(a)\n(b c)", { "(a)\n", "(b c)" } },
+    { "Empty lines", "\n\n(a)\n\n", { "\n", "\n", "(a)\n", "\n" } },
+    // CRLF line endings are handed out unchanged
+    { "CRLF", "(a)\r\n(b)\r\n", { "(a)\r\n", "(b)\r\n" } },
+    { "CRLF without trailing newline", "(a)\r\n(b)", { "(a)\r\n", "(b)" } },
+    { "Embedded nul", std::string( "a\0b\nc", 5 ), { std::string( "a\0b\n", 4 ), "c" } },
+};
+
+
+BOOST_AUTO_TEST_CASE( Lines )
+{
+    for( const MAPPED_READER_CASE& c : mapped_reader_cases )
+    {
+        BOOST_TEST_CONTEXT( c.m_name )
+        {
+            MAPPED_FILE_LINE_READER reader( writeFile( c.m_contents ) );
+
+            std::vector<std::string> lines = readLines( reader, 1 );
+
+            BOOST_CHECK_EQUAL_COLLECTIONS( lines.begin(), lines.end(), c.m_lines.begin(),
+                                           c.m_lines.end() );
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE( StartingLineNumber )
+{
+    MAPPED_FILE_LINE_READER reader( writeFile( "(a)\n(b)\n(c)" ), 41 );
+
+    BOOST_CHECK_EQUAL( readLines( reader, 42 ).size(), 3 );
+}
+
+
+BOOST_AUTO_TEST_CASE( Source )
+{
+    wxString                fileName = writeFile( "(a)\n" );
+    MAPPED_FILE_LINE_READER reader( fileName );
+
+    BOOST_CHECK_EQUAL( reader.GetSource(), fileName );
+}
+
+
+BOOST_AUTO_TEST_CASE( LongLine )
+{
+    std::string line( 100000, 'x' );
+
+    MAPPED_FILE_LINE_READER reader( writeFile( "(a)\n" + line + "\n(b)\n" ) );
+
+    std::vector<std::string> lines = readLines( reader, 1 );
+
+    BOOST_REQUIRE_EQUAL( lines.size(), 3 );
+    BOOST_CHECK( lines[1] == line + "\n" );
+    BOOST_CHECK_EQUAL( lines[2], "(b)\n" );
+}
+
+
+BOOST_AUTO_TEST_CASE( MaxLineLength )
+{
+    MAPPED_FILE_LINE_READER reader( writeFile( "(a)\n(0123456789)\n" ), 0, 8 );
+
+    BOOST_CHECK( reader.ReadLine() );
+    BOOST_CHECK_THROW( reader.ReadLine(), IO_ERROR );
+}
+
+
+BOOST_AUTO_TEST_CASE( MissingFile )
+{
+    boost::filesystem::remove( m_path );
+
+    BOOST_CHECK_THROW( MAPPED_FILE_LINE_READER( wxString( m_path.string() ) ), IO_ERROR );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
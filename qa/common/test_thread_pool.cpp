@@ -0,0 +1,169 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Test suite for THREAD_POOL and TASK_GROUP
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+// Code under test
+#include <thread_pool.h>
+
+#include <stdexcept>
+
+
+BOOST_AUTO_TEST_SUITE( ThreadPool )
+
+
+/**
+ * Every index of a ParallelFor must be visited exactly once
+ */
+BOOST_AUTO_TEST_CASE( ParallelForVisitsAll )
+{
+    THREAD_POOL                   pool( 4 );
+    TASK_GROUP                    tasks( pool );
+    std::vector<std::atomic<int>> visits( 10000 );
+
+    for( std::atomic<int>& count : visits )
+        count = 0;
+
+    tasks.ParallelFor( visits.size(),
+            [&]( size_t aIndex )
+            {
+                visits[aIndex]++;
+            } );
+
+    tasks.Wait();
+
+    for( const std::atomic<int>& count : visits )
+        BOOST_CHECK_EQUAL( count.load(), 1 );
+}
+
+
+/**
+ * Tasks waiting on nested groups must not deadlock, even with a single worker
+ */
+BOOST_AUTO_TEST_CASE( NestedGroups )
+{
+    for( size_t threads : { 1, 4 } )
+    {
+        BOOST_TEST_CONTEXT( "Threads: " << threads )
+        {
+            THREAD_POOL      pool( threads );
+            TASK_GROUP       outer( pool );
+            std::atomic<int> count( 0 );
+
+            for( int ii = 0; ii < 16; ++ii )
+            {
+                outer.Run( [&]()
+                           {
+                               TASK_GROUP inner( pool );
+
+                               for( int jj = 0; jj < 16; ++jj )
+                                   inner.Run( [&]() { count++; } );
+
+                               inner.Wait();
+                           } );
+            }
+
+            outer.Wait();
+
+            BOOST_CHECK_EQUAL( count.load(), 16 * 16 );
+        }
+    }
+}
+
+
+/**
+ * Exceptions thrown by a task are rethrown by Wait()
+ */
+BOOST_AUTO_TEST_CASE( ExceptionPropagation )
+{
+    THREAD_POOL pool( 2 );
+    TASK_GROUP  tasks( pool );
+
+    tasks.Run( []()
+               {
+                   throw std::runtime_error( "task failure" );
+               } );
+
+    BOOST_CHECK_THROW( tasks.Wait(), std::runtime_error );
+}
+
+
+/**
+ * Tasks which have not started when the group is cancelled are skipped
+ */
+BOOST_AUTO_TEST_CASE( Cancellation )
+{
+    THREAD_POOL      pool( 1 );
+    TASK_GROUP       tasks( pool );
+    std::atomic<int> count( 0 );
+
+    tasks.Run( [&]()
+               {
+                   count++;
+                   tasks.Cancel();
+               } );
+
+    for( int ii = 0; ii < 10; ++ii )
+        tasks.Run( [&]() { count++; } );
+
+    tasks.Wait();
+
+    BOOST_CHECK( tasks.IsCancelled() );
+    BOOST_CHECK_EQUAL( count.load(), 1 );
+}
+
+
+BOOST_AUTO_TEST_CASE( Submit )
+{
+    THREAD_POOL pool( 2 );
+
+    std::future<int> result = pool.Submit( []() { return 42; } );
+
+    BOOST_CHECK_EQUAL( result.get(), 42 );
+}
+
+
+/**
+ * A registered pool replaces the module's own one, and only its workers count as such
+ */
+BOOST_AUTO_TEST_CASE( SetInstance )
+{
+    THREAD_POOL  pool( 2 );
+    THREAD_POOL& fallback = THREAD_POOL::GetInstance();
+
+    THREAD_POOL::SetInstance( &pool );
+    BOOST_CHECK_EQUAL( &THREAD_POOL::GetInstance(), &pool );
+
+    BOOST_CHECK( !pool.IsWorkerThread() );
+    BOOST_CHECK( pool.Submit( [&]() { return pool.IsWorkerThread(); } ).get() );
+    BOOST_CHECK( !pool.Submit( [&]() { return fallback.IsWorkerThread(); } ).get() );
+
+    THREAD_POOL::SetInstance( nullptr );
+    BOOST_CHECK_EQUAL( &THREAD_POOL::GetInstance(), &fallback );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,201 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Benchmark of the ways to merge many small polygons into one SHAPE_POLY_SET, on a synthetic
+ * set of pad and track clearances.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <random>
+
+#include <wx/wx.h>
+
+#include <convert_basic_shapes_to_polygon.h>
+#include <geometry/shape_poly_set.h>
+#include <profile.h>
+
+#include <qa_utils/utility_registry.h>
+
+
+/**
+ * Rows of pads (rounded rectangles on a 1.27mm pitch) laid out on a grid, with a track leaving
+ * each pad, all grown by a 0.2mm clearance so that neighbours overlap like real zone knockouts
+ * do.
+ */
+static SHAPE_POLY_SET buildClearances( int aPadCount, unsigned aSeed )
+{
+    const int mm = 1000000;
+    const int pitch = 1270000;
+    const int clearance = 200000;
+    const int maxError = 5000;
+    const int padsPerRow = 50;
+
+    std::mt19937                       rng( aSeed );
+    std::uniform_int_distribution<int> jitter( -100000, 100000 );
+    std::uniform_int_distribution<int> trackLength( 1 * mm, 6 * mm );
+
+    const int rowCount = ( aPadCount + padsPerRow - 1 ) / padsPerRow;
+    const int columns = std::max( 1, (int) std::sqrt( rowCount * 8.0 / 70.0 ) );
+
+    SHAPE_POLY_SET clearances;
+
+    for( int ii = 0; ii < aPadCount; ++ii )
+    {
+        int     row = ii / padsPerRow;
+        wxPoint pos( ( row % columns ) * 70 * mm + ( ii % padsPerRow ) * pitch,
+                     ( row / columns ) * 8 * mm );
+
+        // Every other row is offset so that the rows don't form a regular grid
+        pos.x += ( ( row / columns ) % 2 ) * pitch / 2;
+
+        TransformRoundChamferedRectToPolygon( clearances, pos,
+                                              wxSize( 600000 + 2 * clearance,
+                                                      1500000 + 2 * clearance ),
+                                              0.0, 150000 + clearance, 0.0, 0, maxError,
+                                              ERROR_OUTSIDE );
+
+        wxPoint end = pos + wxPoint( jitter( rng ), ( ii % 2 ? 1 : -1 ) * trackLength( rng ) );
+
+        TransformOvalToPolygon( clearances, pos, end, 250000 + 2 * clearance, maxError,
+                                ERROR_OUTSIDE );
+    }
+
+    return clearances;
+}
+
+
+static double netArea( const SHAPE_POLY_SET& aSet )
+{
+    double area = 0.0;
+
+    for( int ii = 0; ii < aSet.OutlineCount(); ++ii )
+    {
+        area += std::abs( aSet.COutline( ii ).Area() );
+
+        for( int jj = 0; jj < aSet.HoleCount( ii ); ++jj )
+            area -= std::abs( aSet.CHole( ii, jj ).Area() );
+    }
+
+    return area;
+}
+
+
+struct UNION_METHOD
+{
+    const char*                                  m_name;
+    std::function<void( SHAPE_POLY_SET&, bool )> m_func;
+};
+
+
+static const std::vector<UNION_METHOD> unionMethods = {
+    { "Simplify",
+      []( SHAPE_POLY_SET& aSet, bool aStrict )
+      {
+          aSet.Simplify( aStrict ? SHAPE_POLY_SET::PM_STRICTLY_SIMPLE : SHAPE_POLY_SET::PM_FAST );
+      } },
+    { "ParallelSimplify",
+      []( SHAPE_POLY_SET& aSet, bool aStrict )
+      {
+          aSet.ParallelSimplify( aStrict ? SHAPE_POLY_SET::PM_STRICTLY_SIMPLE
+                                         : SHAPE_POLY_SET::PM_FAST );
+      } },
+    { "CascadedUnion",
+      []( SHAPE_POLY_SET& aSet, bool aStrict )
+      {
+          aSet.CascadedUnion( aStrict ? SHAPE_POLY_SET::PM_STRICTLY_SIMPLE
+                                      : SHAPE_POLY_SET::PM_FAST );
+      } },
+};
+
+
+int poly_union_benchmark_func( int argc, char* argv[] )
+{
+    auto& os = std::cout;
+
+    long padCount = 10000;
+    long reps = 3;
+
+    if( argc > 1 && !wxString( argv[1] ).ToLong( &padCount ) )
+    {
+        os << "Usage: " << argv[0] << " [PAD_COUNT] [REPS]" << std::endl;
+        return KI_TEST::RET_CODES::BAD_CMDLINE;
+    }
+
+    if( argc > 2 )
+        wxString( argv[2] ).ToLong( &reps );
+
+    const SHAPE_POLY_SET clearances = buildClearances( padCount, 1 );
+
+    os << "Merging " << clearances.OutlineCount() << " polygons, "
+       << clearances.TotalVertices() << " vertices" << std::endl;
+
+    for( bool strict : { false, true } )
+    {
+        double reference = 0.0;
+
+        os << ( strict ? "PM_STRICTLY_SIMPLE" : "PM_FAST" ) << std::endl;
+
+        for( const UNION_METHOD& method : unionMethods )
+        {
+            SHAPE_POLY_SET result;
+            PROF_COUNTER   counter( method.m_name, false );
+            double         best = 0.0;
+
+            for( long ii = 0; ii < reps; ++ii )
+            {
+                result = clearances;
+
+                counter.Start();
+                method.m_func( result, strict );
+                counter.Stop();
+
+                double ms = counter.msecs();
+
+                if( ii == 0 || ms < best )
+                    best = ms;
+            }
+
+            if( reference == 0.0 )
+                reference = netArea( result );
+
+            os << wxString::Format( "  %-20s %8.1f ms, %d polygons, area diff %g",
+                                    method.m_name, best, result.OutlineCount(),
+                                    std::abs( netArea( result ) - reference ) / reference )
+               << std::endl;
+        }
+    }
+
+    return KI_TEST::RET_CODES::OK;
+}
+
+
+static bool registered = UTILITY_REGISTRY::Register( {
+        "poly_union_benchmark",
+        "Benchmark merging many small polygons into a SHAPE_POLY_SET",
+        poly_union_benchmark_func,
+} );
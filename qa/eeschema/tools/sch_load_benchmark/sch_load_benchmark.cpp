@@ -0,0 +1,342 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Benchmark of the phases of loading schematics, reporting throughput in MB/s and items/s.
+ * The schematic counterpart of the load_benchmark of qa_pcbnew_tools, with the same output.
+ */
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+
+#include <wx/cmdline.h>
+#include <wx/dir.h>
+#include <wx/filename.h>
+
+#include <connection_graph.h>
+#include <locale_io.h>
+#include <profile.h>
+#include <richio.h>
+#include <sch_io_mgr.h>
+#include <sch_screen.h>
+#include <sch_sheet.h>
+#include <schematic.h>
+#include <wildcards_and_files_ext.h>
+#include <sch_plugins/kicad/sch_sexpr_parser.h>
+
+#include <qa_utils/utility_registry.h>
+
+
+#ifndef QA_DEMOS_LOCATION
+    #define QA_DEMOS_LOCATION "???"
+#endif
+
+
+struct PHASE_RESULT
+{
+    wxString    m_file;
+    std::string m_phase;
+    double      m_msecs;     ///< fastest of the repetitions
+    size_t      m_bytes;     ///< input size, or 0 if the phase does not read the file
+    size_t      m_items;     ///< tokens or schematic items handled by the phase
+};
+
+
+class SCH_LOAD_BENCHMARK
+{
+public:
+    SCH_LOAD_BENCHMARK( long aReps ) :
+            m_reps( aReps ),
+            m_failed( false )
+    {
+    }
+
+    /**
+     * Tokenize and parse a schematic file on its own, then load its whole hierarchy and
+     * build the connectivity.
+     */
+    void Schematic( const wxString& aFile );
+
+    const std::vector<PHASE_RESULT>& GetResults() const { return m_results; }
+    bool Failed() const { return m_failed; }
+
+private:
+    /**
+     * Run \a aPhase m_reps times and record the fastest run.  \a aPhase returns the number of
+     * items it handled.
+     */
+    void run( const wxString& aFile, const std::string& aPhaseName, size_t aBytes,
+              const std::function<size_t()>& aPhase );
+
+    long                      m_reps;
+    bool                      m_failed;
+    std::vector<PHASE_RESULT> m_results;
+};
+
+
+void SCH_LOAD_BENCHMARK::run( const wxString& aFile, const std::string& aPhaseName,
+                              size_t aBytes, const std::function<size_t()>& aPhase )
+{
+    PHASE_RESULT result = { aFile, aPhaseName, 0.0, aBytes, 0 };
+
+    for( long ii = 0; ii < m_reps; ++ii )
+    {
+        PROF_COUNTER counter( aPhaseName, false );
+
+        counter.Start();
+        result.m_items = aPhase();
+        counter.Stop();
+
+        if( ii == 0 || counter.msecs() < result.m_msecs )
+            result.m_msecs = counter.msecs();
+    }
+
+    m_results.push_back( result );
+}
+
+
+/**
+ * @return the number of items on all the screens of \a aSchematic.
+ */
+static size_t countItems( SCHEMATIC& aSchematic )
+{
+    SCH_SCREENS screens( aSchematic.Root() );
+    size_t      items = 0;
+
+    for( SCH_SCREEN* screen = screens.GetFirst(); screen; screen = screens.GetNext() )
+        items += screen->Items().size();
+
+    return items;
+}
+
+
+void SCH_LOAD_BENCHMARK::Schematic( const wxString& aFile )
+{
+    size_t    bytes = wxFileName::GetSize( aFile ).GetValue();
+    SCHEMATIC schematic( nullptr );
+    LOCALE_IO toggle;
+
+    try
+    {
+        run( aFile, "tokenize", bytes,
+             [&]()
+             {
+                 MAPPED_FILE_LINE_READER reader( aFile );
+                 SCHEMATIC_LEXER         lexer( &reader );
+                 size_t                  tokens = 0;
+
+                 while( lexer.NextTok() != TSCHEMATIC_T::T_EOF )
+                     ++tokens;
+
+                 return tokens;
+             } );
+
+        run( aFile, "parse", bytes,
+             [&]()
+             {
+                 SCHEMATIC               owner( nullptr );
+                 SCH_SHEET               sheet( &owner );
+                 MAPPED_FILE_LINE_READER reader( aFile );
+                 SCH_SEXPR_PARSER        parser( &reader );
+
+                 sheet.SetScreen( new SCH_SCREEN( &owner ) );
+                 parser.ParseSchematic( &sheet );
+
+                 return sheet.GetScreen()->Items().size();
+             } );
+
+        // The whole hierarchy, through the plugin, as eeschema loads it
+        run( aFile, "load", 0,
+             [&]()
+             {
+                 SCH_PLUGIN::SCH_PLUGIN_RELEASER pi( SCH_IO_MGR::FindPlugin(
+                         SCH_IO_MGR::SCH_KICAD ) );
+
+                 // Also deletes the hierarchy of the previous run
+                 schematic.Reset();
+                 schematic.SetRoot( pi->Load( aFile, &schematic ) );
+                 schematic.CurrentSheet().push_back( &schematic.Root() );
+
+                 return countItems( schematic );
+             } );
+
+        run( aFile, "connectivity", 0,
+             [&]()
+             {
+                 schematic.ConnectionGraph()->Recalculate( schematic.GetSheets(), true );
+
+                 return countItems( schematic );
+             } );
+    }
+    catch( const IO_ERROR& ioe )
+    {
+        std::cerr << "Error loading " << aFile << ": " << ioe.What() << std::endl;
+        m_failed = true;
+    }
+
+    // The schematic doesn't own its root sheet
+    schematic.Reset();
+}
+
+
+/**
+ * Collect the schematics below a directory.
+ */
+class DEMO_TRAVERSER : public wxDirTraverser
+{
+public:
+    DEMO_TRAVERSER( wxArrayString& aFiles ) :
+            m_files( aFiles )
+    {
+    }
+
+    wxDirTraverseResult OnFile( const wxString& aFile ) override
+    {
+        if( wxFileName( aFile ).GetExt() == KiCadSchematicFileExtension )
+            m_files.Add( aFile );
+
+        return wxDIR_CONTINUE;
+    }
+
+    wxDirTraverseResult OnDir( const wxString& aDir ) override
+    {
+        return wxDIR_CONTINUE;
+    }
+
+private:
+    wxArrayString& m_files;
+};
+
+
+static void printResults( const std::vector<PHASE_RESULT>& aResults, bool aCsv )
+{
+    auto& os = std::cout;
+
+    if( aCsv )
+        os << "file,phase,msecs,bytes,items,mb_per_sec,items_per_sec" << std::endl;
+
+    for( const PHASE_RESULT& result : aResults )
+    {
+        double secs = result.m_msecs / 1000.0;
+        double mbPerSec = secs > 0.0 ? result.m_bytes / 1e6 / secs : 0.0;
+        double itemsPerSec = secs > 0.0 ? result.m_items / secs : 0.0;
+
+        if( aCsv )
+        {
+            os << wxString::Format( "\"%s\",%s,%.3f,%zu,%zu,%.2f,%.0f", result.m_file,
+                                    result.m_phase, result.m_msecs, result.m_bytes,
+                                    result.m_items, mbPerSec, itemsPerSec )
+               << std::endl;
+        }
+        else
+        {
+            wxString throughput = result.m_bytes ? wxString::Format( "%8.1f MB/s", mbPerSec )
+                                                 : wxString( ' ', 13 );
+
+            os << wxString::Format( "%-40s %-12s %9.2f ms %s %12.0f items/s",
+                                    wxFileName( result.m_file ).GetFullName(), result.m_phase,
+                                    result.m_msecs, throughput, itemsPerSec )
+               << std::endl;
+        }
+    }
+}
+
+
+static const wxCmdLineEntryDesc g_cmdLineDesc[] = {
+    { wxCMD_LINE_SWITCH, "h", "help", _( "displays help on the command line parameters" ).mb_str(),
+            wxCMD_LINE_VAL_NONE, wxCMD_LINE_OPTION_HELP },
+    { wxCMD_LINE_OPTION, "r", "reps", _( "repetitions of each phase, of which the fastest is "
+                                         "reported (default 3)" ).mb_str(),
+            wxCMD_LINE_VAL_NUMBER },
+    { wxCMD_LINE_SWITCH, "c", "csv", _( "print the results as CSV" ).mb_str() },
+    { wxCMD_LINE_PARAM, nullptr, nullptr, _( "schematic files" ).mb_str(),
+            wxCMD_LINE_VAL_STRING, wxCMD_LINE_PARAM_OPTIONAL | wxCMD_LINE_PARAM_MULTIPLE },
+    { wxCMD_LINE_NONE }
+};
+
+
+enum SCH_LOAD_BENCHMARK_RET_CODES
+{
+    LOAD_FAILED = KI_TEST::RET_CODES::TOOL_SPECIFIC,
+};
+
+
+int sch_load_benchmark_main_func( int argc, char** argv )
+{
+    wxMessageOutput::Set( new wxMessageOutputStderr );
+    wxCmdLineParser cl_parser( argc, argv );
+    cl_parser.SetDesc( g_cmdLineDesc );
+    cl_parser.AddUsageText(
+            _( "This program times the tokenizing and parsing of schematic files, and the "
+               "loading and connectivity building of their hierarchies.  Without files, it "
+               "benchmarks all the schematics of the demos." ) );
+
+    int cmd_parsed_ok = cl_parser.Parse();
+
+    if( cmd_parsed_ok != 0 )
+    {
+        // Help and invalid input both stop here
+        return ( cmd_parsed_ok == -1 ) ? KI_TEST::RET_CODES::OK : KI_TEST::RET_CODES::BAD_CMDLINE;
+    }
+
+    long reps = 3;
+
+    cl_parser.Found( "reps", &reps );
+
+    wxArrayString files;
+
+    for( unsigned i = 0; i < cl_parser.GetParamCount(); i++ )
+        files.Add( cl_parser.GetParam( i ) );
+
+    if( files.empty() )
+    {
+        wxDir          demos( QA_DEMOS_LOCATION );
+        DEMO_TRAVERSER traverser( files );
+
+        if( demos.IsOpened() )
+            demos.Traverse( traverser );
+
+        files.Sort();
+    }
+
+    SCH_LOAD_BENCHMARK benchmark( std::max( reps, 1L ) );
+
+    for( const wxString& file : files )
+        benchmark.Schematic( file );
+
+    printResults( benchmark.GetResults(), cl_parser.Found( "csv" ) );
+
+    if( benchmark.Failed() )
+        return SCH_LOAD_BENCHMARK_RET_CODES::LOAD_FAILED;
+
+    return KI_TEST::RET_CODES::OK;
+}
+
+
+static bool registered = UTILITY_REGISTRY::Register( {
+        "sch_load_benchmark",
+        "Benchmark the loading of schematics",
+        sch_load_benchmark_main_func,
+} );
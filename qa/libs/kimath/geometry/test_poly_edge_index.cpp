@@ -0,0 +1,126 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <cmath>
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <geometry/shape_line_chain.h>
+#include <geometry/shape_poly_set.h>
+#include <math/util.h>
+
+
+/**
+ * A wavy outline with a few holes, large enough to be indexed, plus a copy of it without the
+ * index to compare against.
+ */
+struct EdgeIndexFixture
+{
+    SHAPE_POLY_SET indexed;
+    SHAPE_POLY_SET linear;
+
+    EdgeIndexFixture()
+    {
+        const int outlinePts = 500;
+        const int holePts = 40;
+
+        SHAPE_LINE_CHAIN outline;
+
+        for( int ii = 0; ii < outlinePts; ii++ )
+        {
+            double angle = 2 * M_PI * ii / outlinePts;
+            double radius = 1000000 + 200000 * sin( 17 * angle );
+
+            outline.Append( KiROUND( radius * cos( angle ) ), KiROUND( radius * sin( angle ) ) );
+        }
+
+        outline.SetClosed( true );
+        indexed.AddOutline( outline );
+
+        for( int hole = 0; hole < 3; hole++ )
+        {
+            SHAPE_LINE_CHAIN chain;
+
+            for( int ii = 0; ii < holePts; ii++ )
+            {
+                double angle = 2 * M_PI * ii / holePts;
+
+                chain.Append( ( hole - 1 ) * 400000 + KiROUND( 100000 * cos( angle ) ),
+                              KiROUND( 100000 * sin( angle ) ) );
+            }
+
+            chain.SetClosed( true );
+            indexed.AddHole( chain );
+        }
+
+        linear = indexed;
+        indexed.CacheEdgeIndex();
+    }
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( PolyEdgeIndex, EdgeIndexFixture )
+
+
+BOOST_AUTO_TEST_CASE( MatchesLinearScan )
+{
+    for( int x = -1300000; x <= 1300000; x += 37000 )
+    {
+        for( int y = -1300000; y <= 1300000; y += 41000 )
+        {
+            VECTOR2I p( x, y );
+            SEG      seg( p, p + VECTOR2I( 60000, -25000 ) );
+
+            BOOST_CHECK_EQUAL( indexed.Contains( p ), linear.Contains( p ) );
+            BOOST_CHECK_EQUAL( indexed.Contains( p, -1, 5000 ), linear.Contains( p, -1, 5000 ) );
+            BOOST_CHECK_EQUAL( indexed.SquaredDistance( p ), linear.SquaredDistance( p ) );
+            BOOST_CHECK_EQUAL( indexed.SquaredDistance( seg ), linear.SquaredDistance( seg ) );
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE( InvalidatedByEdits )
+{
+    VECTOR2I p( 0, 0 );     // inside the middle hole
+
+    BOOST_CHECK( !indexed.Contains( p ) );
+
+    indexed.DeletePolygon( 0 );
+    indexed.NewOutline();
+    indexed.Append( -10, -10 );
+    indexed.Append( 10, -10 );
+    indexed.Append( 10, 10 );
+    indexed.Append( -10, 10 );
+
+    BOOST_CHECK( indexed.Contains( p ) );
+
+    indexed.CacheEdgeIndex();
+    BOOST_CHECK( indexed.Contains( p ) );
+
+    indexed.Move( VECTOR2I( 100, 0 ) );
+    BOOST_CHECK( !indexed.Contains( p ) );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
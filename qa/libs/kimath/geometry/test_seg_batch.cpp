@@ -0,0 +1,221 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <random>
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <geometry/seg_batch.h>
+#include <geometry/shape_circle.h>
+
+
+/**
+ * A batch mixing random segments of every scale with the awkward cases of board geometry:
+ * axis-aligned and collinear segments on a grid, zero length segments, shared ends and a few
+ * segments too far out for the estimates.
+ */
+struct SegBatchFixture
+{
+    std::mt19937      rng;
+    std::vector<SEG>  segs;
+    std::vector<int>  extras;
+    SEG_BATCH         batch;
+
+    SegBatchFixture() : rng( 1234 )
+    {
+        for( int ii = 0; ii < 3000; ii++ )
+            add( randomSeg(), randomExtra() );
+
+        for( int x = 0; x < 20; x++ )
+        {
+            for( int y = 0; y < 20; y++ )
+            {
+                VECTOR2I p( x * 1000, y * 1000 );
+
+                add( SEG( p, p + VECTOR2I( 1000, 0 ) ), 0 );
+                add( SEG( p, p + VECTOR2I( 0, 1000 ) ), 250 );
+                add( SEG( p, p + VECTOR2I( 1000, 1000 ) ), 100 );
+                add( SEG( p, p ), 0 );
+            }
+        }
+
+        add( SEG( VECTOR2I( 1100000000, 0 ), VECTOR2I( 1000000000, 7 ) ), 0 );
+        add( SEG( VECTOR2I( 1200000000, 1200000000 ), VECTOR2I( 1200000000, 1200000000 ) ), 3 );
+    }
+
+    void add( const SEG& aSeg, int aExtra )
+    {
+        segs.push_back( aSeg );
+        extras.push_back( aExtra );
+        batch.Add( aSeg, aExtra );
+    }
+
+    VECTOR2I randomPoint( int aRange )
+    {
+        std::uniform_int_distribution<int> dist( -aRange, aRange );
+
+        return VECTOR2I( dist( rng ), dist( rng ) );
+    }
+
+    SEG randomSeg()
+    {
+        static const int ranges[] = { 10, 1000, 100000, 10000000, 500000000 };
+
+        int      range = ranges[rng() % 5];
+        VECTOR2I a = randomPoint( range );
+
+        return SEG( a, a + randomPoint( ranges[rng() % 5] / 2 ) );
+    }
+
+    int randomExtra()
+    {
+        return rng() % 3 ? 0 : (int) ( rng() % 100000 );
+    }
+
+    std::vector<SEG> queries()
+    {
+        std::vector<SEG> result;
+
+        for( int ii = 0; ii < 300; ii++ )
+            result.push_back( randomSeg() );
+
+        // Grid-aligned queries hitting the collinear and touching cases.
+        for( int ii = 0; ii < 100; ii++ )
+        {
+            VECTOR2I p( ( rng() % 22 ) * 500, ( rng() % 22 ) * 500 );
+
+            result.push_back( SEG( p, p + VECTOR2I( ( rng() % 5 ) * 500, ( rng() % 3 ) * 500 ) ) );
+        }
+
+        // Copies of batch members.
+        for( int ii = 0; ii < 50; ii++ )
+            result.push_back( segs[rng() % segs.size()] );
+
+        result.push_back( SEG( VECTOR2I( 1090000000, 5 ), VECTOR2I( 1080000000, -5 ) ) );
+
+        return result;
+    }
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( SegBatch, SegBatchFixture )
+
+
+BOOST_AUTO_TEST_CASE( CollideSegment )
+{
+    static const int clearances[] = { 0, 1, 2, 5, 499, 500, 501, 100000, -3 };
+
+    for( const SEG& query : queries() )
+    {
+        for( int clearance : clearances )
+        {
+            std::vector<int> expected;
+            std::vector<int> hits;
+
+            for( size_t ii = 0; ii < segs.size(); ii++ )
+            {
+                if( query.Collide( segs[ii], clearance + extras[ii] ) )
+                    expected.push_back( (int) ii );
+            }
+
+            BOOST_CHECK_EQUAL( batch.Collide( query, clearance, &hits ), !expected.empty() );
+            BOOST_CHECK_EQUAL( batch.Collide( query, clearance ), !expected.empty() );
+            BOOST_CHECK( hits == expected );
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE( CollideCircle )
+{
+    static const int radii[] = { 0, 1, 250, 1000, 1000000 };
+
+    for( const SEG& query : queries() )
+    {
+        for( int radius : radii )
+        {
+            SHAPE_CIRCLE     circle( query.A, radius );
+            std::vector<int> expected;
+            std::vector<int> hits;
+
+            for( size_t ii = 0; ii < segs.size(); ii++ )
+            {
+                if( circle.Collide( segs[ii], 100 + extras[ii] ) )
+                    expected.push_back( (int) ii );
+            }
+
+            BOOST_CHECK_EQUAL( batch.Collide( query.A, radius, 100, &hits ), !expected.empty() );
+            BOOST_CHECK( hits == expected );
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE( SquaredDistance )
+{
+    for( const SEG& query : queries() )
+    {
+        SEG::ecoord segDist = VECTOR2I::ECOORD_MAX;
+        SEG::ecoord ptDist = VECTOR2I::ECOORD_MAX;
+        int         segIdx = -1;
+        int         ptIdx = -1;
+
+        for( size_t ii = 0; ii < segs.size(); ii++ )
+        {
+            if( segs[ii].SquaredDistance( query ) < segDist )
+            {
+                segDist = segs[ii].SquaredDistance( query );
+                segIdx = (int) ii;
+            }
+
+            if( segs[ii].SquaredDistance( query.B ) < ptDist )
+            {
+                ptDist = segs[ii].SquaredDistance( query.B );
+                ptIdx = (int) ii;
+            }
+        }
+
+        int idx;
+
+        BOOST_CHECK_EQUAL( batch.SquaredDistance( query, &idx ), segDist );
+        BOOST_CHECK_EQUAL( idx, segIdx );
+        BOOST_CHECK_EQUAL( batch.SquaredDistance( query.B, &idx ), ptDist );
+        BOOST_CHECK_EQUAL( idx, ptIdx );
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE( Empty )
+{
+    const SEG::ecoord maxDist = VECTOR2I::ECOORD_MAX;
+    SEG_BATCH         empty;
+    int               idx = 0;
+
+    BOOST_CHECK( !empty.Collide( SEG( VECTOR2I( 0, 0 ), VECTOR2I( 10, 0 ) ), 100 ) );
+    BOOST_CHECK( !empty.Collide( VECTOR2I( 0, 0 ), 10, 100 ) );
+    BOOST_CHECK_EQUAL( empty.SquaredDistance( VECTOR2I( 0, 0 ), &idx ), maxDist );
+    BOOST_CHECK_EQUAL( idx, -1 );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
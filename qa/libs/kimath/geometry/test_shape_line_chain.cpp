@@ -59,4 +59,35 @@ BOOST_AUTO_TEST_CASE( ArcToPolyline )
 }
 
 
+BOOST_AUTO_TEST_CASE( ArcMembership )
+{
+    SHAPE_LINE_CHAIN chain( { VECTOR2I( 0, 0 ), VECTOR2I( 0, 1000 ) } );
+
+    chain.Append( SHAPE_ARC( VECTOR2I( 0, 2000 ), VECTOR2I( 0, 1000 ), 90 ) );
+    chain.Append( VECTOR2I( 5000, 5000 ) );
+
+    BOOST_CHECK_EQUAL( chain.CShapes().size(), chain.CPoints().size() );
+    BOOST_CHECK( !chain.isArc( 0 ) );
+    BOOST_CHECK( chain.isArc( 2 ) );
+    BOOST_CHECK( !chain.isArc( chain.PointCount() - 1 ) );
+
+    SHAPE_LINE_CHAIN appended( { VECTOR2I( -1000, 0 ), VECTOR2I( 0, 0 ) } );
+    appended.Append( chain );
+
+    BOOST_CHECK_EQUAL( appended.CShapes().size(), appended.CPoints().size() );
+    BOOST_CHECK_EQUAL( appended.ArcCount(), 1 );
+    BOOST_CHECK( appended.isArc( 3 ) );
+
+    // Moving an arc point turns the arc back into plain points
+    chain.SetPoint( 2, VECTOR2I( 100, 100 ) );
+
+    BOOST_CHECK_EQUAL( chain.ArcCount(), 0 );
+    BOOST_CHECK( !chain.isArc( 2 ) );
+    BOOST_CHECK_EQUAL( chain.CShapes().size(), chain.CPoints().size() );
+
+    chain.Append( VECTOR2I( 6000, 6000 ) );
+    BOOST_CHECK_EQUAL( chain.CShapes().size(), chain.CPoints().size() );
+}
+
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,215 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <algorithm>
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <geometry/shape_line_chain.h>
+#include <geometry/shape_poly_set.h>
+
+
+/**
+ * A grid of islands made of overlapping squares, with square knockouts on top.  Only
+ * axis-aligned edges are used, so that every intersection point is exact and the results of
+ * the different merge strategies can be compared exactly.
+ */
+struct ParallelBooleanFixture
+{
+    SHAPE_POLY_SET islands;
+    SHAPE_POLY_SET knockouts;
+
+    static void addSquare( SHAPE_POLY_SET& aSet, int aX, int aY, int aSize )
+    {
+        SHAPE_LINE_CHAIN square;
+
+        square.Append( aX, aY );
+        square.Append( aX + aSize, aY );
+        square.Append( aX + aSize, aY + aSize );
+        square.Append( aX, aY + aSize );
+        square.SetClosed( true );
+
+        aSet.AddOutline( square );
+    }
+
+    ParallelBooleanFixture()
+    {
+        for( int x = 0; x < 40; x++ )
+        {
+            for( int y = 0; y < 40; y++ )
+            {
+                int ox = x * 10000;
+                int oy = y * 10000;
+
+                addSquare( islands, ox, oy, 5000 );
+                addSquare( islands, ox + 2500, oy + 1000, 5000 );
+
+                // One knockout inside each island, one straddling its edge
+                addSquare( knockouts, ox + 1000, oy + 1000, 1000 );
+                addSquare( knockouts, ox + 7000, oy + 3000, 1000 + 100 * ( x % 7 ) );
+            }
+        }
+    }
+};
+
+
+/**
+ * Sorts the polygons (and the holes of each polygon) so that sets built in a different order
+ * compare equal.
+ */
+static std::vector<SHAPE_POLY_SET::POLYGON> sortedPolygons( const SHAPE_POLY_SET& aSet )
+{
+    // VECTOR2's operator< compares lengths, which isn't enough to order the vertices
+    auto pointLess =
+            []( const VECTOR2I& aA, const VECTOR2I& aB )
+            {
+                return aA.x < aB.x || ( aA.x == aB.x && aA.y < aB.y );
+            };
+
+    auto chainLess =
+            [&]( const SHAPE_LINE_CHAIN& aA, const SHAPE_LINE_CHAIN& aB )
+            {
+                return std::lexicographical_compare( aA.CPoints().begin(), aA.CPoints().end(),
+                                                     aB.CPoints().begin(), aB.CPoints().end(),
+                                                     pointLess );
+            };
+
+    std::vector<SHAPE_POLY_SET::POLYGON> polys;
+
+    for( int ii = 0; ii < aSet.OutlineCount(); ii++ )
+    {
+        SHAPE_POLY_SET::POLYGON poly = aSet.CPolygon( ii );
+
+        std::sort( poly.begin() + 1, poly.end(), chainLess );
+        polys.push_back( poly );
+    }
+
+    std::sort( polys.begin(), polys.end(),
+               [&]( const SHAPE_POLY_SET::POLYGON& aA, const SHAPE_POLY_SET::POLYGON& aB )
+               {
+                   return std::lexicographical_compare( aA.begin(), aA.end(), aB.begin(),
+                                                        aB.end(), chainLess );
+               } );
+
+    return polys;
+}
+
+
+static void checkSamePolygons( const SHAPE_POLY_SET& aSerial, const SHAPE_POLY_SET& aParallel )
+{
+    BOOST_REQUIRE_EQUAL( aSerial.OutlineCount(), aParallel.OutlineCount() );
+
+    std::vector<SHAPE_POLY_SET::POLYGON> serial = sortedPolygons( aSerial );
+    std::vector<SHAPE_POLY_SET::POLYGON> parallel = sortedPolygons( aParallel );
+
+    for( size_t ii = 0; ii < serial.size(); ii++ )
+    {
+        BOOST_REQUIRE_EQUAL( serial[ii].size(), parallel[ii].size() );
+
+        for( size_t jj = 0; jj < serial[ii].size(); jj++ )
+            BOOST_CHECK( serial[ii][jj].CPoints() == parallel[ii][jj].CPoints() );
+    }
+}
+
+
+BOOST_FIXTURE_TEST_SUITE( ShapePolySetParallel, ParallelBooleanFixture )
+
+
+BOOST_AUTO_TEST_CASE( Simplify )
+{
+    SHAPE_POLY_SET serial = islands;
+    SHAPE_POLY_SET parallel = islands;
+
+    serial.Simplify( SHAPE_POLY_SET::PM_FAST );
+    parallel.ParallelSimplify( SHAPE_POLY_SET::PM_FAST );
+
+    BOOST_CHECK_EQUAL( serial.OutlineCount(), 1600 );
+    checkSamePolygons( serial, parallel );
+}
+
+
+BOOST_AUTO_TEST_CASE( Booleans )
+{
+    SHAPE_POLY_SET serial = islands;
+    SHAPE_POLY_SET parallel = islands;
+
+    serial.BooleanSubtract( knockouts, SHAPE_POLY_SET::PM_STRICTLY_SIMPLE );
+    parallel.ParallelBooleanSubtract( knockouts, SHAPE_POLY_SET::PM_STRICTLY_SIMPLE );
+    checkSamePolygons( serial, parallel );
+
+    serial = islands;
+    parallel = islands;
+    serial.BooleanIntersection( knockouts, SHAPE_POLY_SET::PM_FAST );
+    parallel.ParallelBooleanIntersection( knockouts, SHAPE_POLY_SET::PM_FAST );
+    checkSamePolygons( serial, parallel );
+
+    serial = islands;
+    parallel = islands;
+    serial.BooleanAdd( knockouts, SHAPE_POLY_SET::PM_FAST );
+    parallel.ParallelBooleanAdd( knockouts, SHAPE_POLY_SET::PM_FAST );
+    checkSamePolygons( serial, parallel );
+}
+
+
+BOOST_AUTO_TEST_CASE( Fracture )
+{
+    SHAPE_POLY_SET serial = islands;
+
+    serial.BooleanSubtract( knockouts, SHAPE_POLY_SET::PM_FAST );
+
+    SHAPE_POLY_SET parallel = serial;
+
+    serial.Fracture( SHAPE_POLY_SET::PM_FAST );
+    parallel.ParallelFracture( SHAPE_POLY_SET::PM_FAST );
+
+    BOOST_CHECK( !parallel.HasHoles() );
+    checkSamePolygons( serial, parallel );
+}
+
+
+BOOST_AUTO_TEST_CASE( CascadedUnion )
+{
+    SHAPE_POLY_SET serial = islands;
+    SHAPE_POLY_SET cascaded = islands;
+
+    serial.Append( knockouts );
+    cascaded.Append( knockouts );
+
+    serial.Simplify( SHAPE_POLY_SET::PM_FAST );
+    cascaded.CascadedUnion( SHAPE_POLY_SET::PM_FAST );
+
+    BOOST_CHECK_EQUAL( serial.OutlineCount(), cascaded.OutlineCount() );
+
+    // The merge order differs, so compare the areas covered rather than the vertices
+    SHAPE_POLY_SET missing = serial;
+    SHAPE_POLY_SET extra = cascaded;
+
+    missing.BooleanSubtract( cascaded, SHAPE_POLY_SET::PM_FAST );
+    extra.BooleanSubtract( serial, SHAPE_POLY_SET::PM_FAST );
+
+    BOOST_CHECK_EQUAL( missing.OutlineCount(), 0 );
+    BOOST_CHECK_EQUAL( extra.OutlineCount(), 0 );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,190 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <cmath>
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <geometry/shape_poly_set.h>
+#include <math/util.h>
+
+
+/**
+ * A pour spanning several partition cells: a large square with a grid of round knockouts, as
+ * left by the pads of a footprint array.
+ */
+struct TriangulationFixture
+{
+    SHAPE_POLY_SET pour;
+
+    TriangulationFixture()
+    {
+        pour = knockouts( 0 );
+    }
+
+    /**
+     * @param aExtra number of knockouts added to the bottom right corner.
+     */
+    static SHAPE_POLY_SET knockouts( int aExtra )
+    {
+        const int size = 60000000;
+        const int pitch = 2500000;
+
+        SHAPE_POLY_SET result;
+
+        result.NewOutline();
+        result.Append( 0, 0 );
+        result.Append( size, 0 );
+        result.Append( size, size );
+        result.Append( 0, size );
+
+        SHAPE_POLY_SET holes;
+
+        for( int x = pitch; x < size; x += pitch )
+        {
+            for( int y = pitch; y < size; y += pitch )
+                holes.AddOutline( circle( VECTOR2I( x, y ), 600000 ) );
+        }
+
+        for( int ii = 0; ii < aExtra; ii++ )
+        {
+            VECTOR2I center( size - 1000000 * ( ii + 1 ), size - 300000 );
+
+            holes.AddOutline( circle( center, 200000 ) );
+        }
+
+        result.BooleanSubtract( holes, SHAPE_POLY_SET::PM_FAST );
+
+        return result;
+    }
+
+    static SHAPE_LINE_CHAIN circle( const VECTOR2I& aCenter, int aRadius )
+    {
+        SHAPE_LINE_CHAIN chain;
+
+        for( int ii = 0; ii < 32; ii++ )
+        {
+            double angle = 2 * M_PI * ii / 32;
+
+            chain.Append( aCenter.x + KiROUND( aRadius * cos( angle ) ),
+                          aCenter.y + KiROUND( aRadius * sin( angle ) ) );
+        }
+
+        chain.SetClosed( true );
+        return chain;
+    }
+
+    static double area( const SHAPE_POLY_SET& aSet )
+    {
+        double area = 0.0;
+
+        for( int ii = 0; ii < aSet.OutlineCount(); ii++ )
+        {
+            area += std::abs( aSet.COutline( ii ).Area() );
+
+            for( int jj = 0; jj < aSet.HoleCount( ii ); jj++ )
+                area -= std::abs( aSet.CHole( ii, jj ).Area() );
+        }
+
+        return area;
+    }
+
+    static double triangulatedArea( const SHAPE_POLY_SET& aSet )
+    {
+        double area = 0.0;
+
+        for( unsigned ii = 0; ii < aSet.TriangulatedPolyCount(); ii++ )
+        {
+            const SHAPE_POLY_SET::TRIANGULATED_POLYGON* tri = aSet.TriangulatedPolygon( ii );
+
+            for( size_t jj = 0; jj < tri->GetTriangleCount(); jj++ )
+            {
+                VECTOR2I a, b, c;
+                tri->GetTriangle( jj, a, b, c );
+
+                area += std::abs( double( b.x - a.x ) * ( c.y - a.y )
+                                  - double( c.x - a.x ) * ( b.y - a.y ) ) / 2;
+            }
+        }
+
+        return area;
+    }
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( ShapePolySetTriangulation, TriangulationFixture )
+
+
+BOOST_AUTO_TEST_CASE( CoversPolygon )
+{
+    pour.CacheTriangulation();
+
+    BOOST_CHECK( pour.IsTriangulationUpToDate() );
+    BOOST_CHECK_GT( pour.TriangulatedPolyCount(), 30 );
+    BOOST_CHECK_CLOSE( triangulatedArea( pour ), area( pour ), 1e-6 );
+
+    SHAPE_POLY_SET whole = pour;
+
+    whole.CacheTriangulation( false );
+
+    BOOST_CHECK( whole.IsTriangulationUpToDate() );
+    BOOST_CHECK_CLOSE( triangulatedArea( whole ), area( pour ), 1e-6 );
+}
+
+
+BOOST_AUTO_TEST_CASE( Refill )
+{
+    pour.CacheTriangulation();
+
+    SHAPE_POLY_SET refill = knockouts( 3 );
+    SHAPE_POLY_SET fresh = refill;
+
+    // Assigning keeps the cells of the previous content, of which all but the bottom right one
+    // are reused
+    pour = refill;
+
+    BOOST_CHECK( !pour.IsTriangulationUpToDate() );
+
+    pour.CacheTriangulation();
+    fresh.CacheTriangulation();
+
+    BOOST_CHECK( pour.IsTriangulationUpToDate() );
+    BOOST_CHECK_EQUAL( pour.TriangulatedPolyCount(), fresh.TriangulatedPolyCount() );
+    BOOST_CHECK_CLOSE( triangulatedArea( pour ), area( refill ), 1e-6 );
+
+    for( unsigned ii = 0; ii < pour.TriangulatedPolyCount(); ii++ )
+    {
+        BOOST_CHECK_EQUAL( pour.TriangulatedPolygon( ii )->GetTriangleCount(),
+                           fresh.TriangulatedPolygon( ii )->GetTriangleCount() );
+    }
+
+    // Moving the set drops the cells
+    pour.Move( VECTOR2I( 1000, 0 ) );
+    pour = refill;
+    pour.CacheTriangulation();
+
+    BOOST_CHECK_CLOSE( triangulatedArea( pour ), area( refill ), 1e-6 );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -68,7 +68,14 @@ const static std::vector<EXPR_TO_TEST> simpleExpressions = {
     // Parens affect precedence
     { "-(1 + (2 - 4)) * 20.8 / 2", false, VAL(10.4) },
     // Unary addition is a sign, not a leading operator
-    { "+2 - 1", false, VAL(1) }
+    { "+2 - 1", false, VAL(1) },
+
+    { "0 && 1", false, VAL(0) },
+    { "1 || 0", false, VAL(1) },
+    { "1 && 2 && 3", false, VAL(1) },
+    { "0 || 0 || 5", false, VAL(1) },
+    { "!(1 && 0)", false, VAL(1) },
+    { "(1 + 2) * 3 == 9", false, VAL(1) }
 };
 
 
@@ -81,7 +88,11 @@ const static std::vector<EXPR_TO_TEST> introspectionExpressions = {
     { "A.Netclass + 1.0", false, VAL( 1.0 ) },
     { "A.type == 'Track' && B.type == 'Track' && A.layer == 'F.Cu'", false, VAL( 1.0 ) },
     { "(A.type == 'Track') && (B.type == 'Track') && (A.layer == 'F.Cu')", false, VAL( 1.0 ) },
-    { "A.type == 'Via' && A.isMicroVia()", false, VAL(0.0) }
+    { "A.type == 'Via' && A.isMicroVia()", false, VAL(0.0) },
+    { "A.Width < B.Width || A.Netclass == 'otherClass'", false, VAL( 1.0 ) },
+    { "A.Width > B.Width || A.Netclass == 'HV'", false, VAL( 1.0 ) },
+    { "A.Width > B.Width && A.Netclass == 'HV'", false, VAL( 0.0 ) },
+    { "A.Width + 2 * 5mil == B.Width", false, VAL( 1.0 ) }
 };
 
 
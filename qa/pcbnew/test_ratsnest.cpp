@@ -0,0 +1,250 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Test suite for the ratsnest of large nets, which is updated locally when only a few of its
+ * anchors move.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <limits>
+#include <random>
+#include <set>
+
+#include <board.h>
+#include <footprint.h>
+#include <pad.h>
+#include <connectivity/connectivity_data.h>
+#include <ratsnest/ratsnest_data.h>
+
+
+/**
+ * @return the length of the Euclidean minimum spanning tree of \a aPoints, by Prim's algorithm
+ *         on the complete graph.
+ */
+static double bruteForceMST( const std::vector<VECTOR2I>& aPoints )
+{
+    std::vector<double> dist( aPoints.size(), std::numeric_limits<double>::max() );
+    std::vector<bool>   inTree( aPoints.size(), false );
+    double              length = 0.0;
+    size_t              next = 0;
+
+    dist[0] = 0.0;
+
+    for( size_t ii = 0; ii < aPoints.size(); ++ii )
+    {
+        size_t current = next;
+
+        inTree[current] = true;
+        length += dist[current];
+        next = aPoints.size();
+
+        for( size_t jj = 0; jj < aPoints.size(); ++jj )
+        {
+            if( inTree[jj] )
+                continue;
+
+            dist[jj] = std::min( dist[jj], ( aPoints[jj] - aPoints[current] ).EuclideanNorm() );
+
+            if( next == aPoints.size() || dist[jj] < dist[next] )
+                next = jj;
+        }
+    }
+
+    return length;
+}
+
+
+/**
+ * A single net of unconnected SMD pads, on a grid of free cells.
+ */
+struct RATSNEST_FIXTURE
+{
+    static const int PAD_COUNT = 1500;
+    static const int GRID_CELLS = 200;
+
+    RATSNEST_FIXTURE() :
+            m_board( std::make_unique<BOARD>() ),
+            m_rng( 42 )
+    {
+        NETINFO_ITEM* net = new NETINFO_ITEM( m_board.get(), "GND", 1 );
+        m_board->Add( net );
+
+        m_footprint = new FOOTPRINT( m_board.get() );
+        m_board->Add( m_footprint );
+
+        for( int ii = 0; ii < PAD_COUNT; ++ii )
+        {
+            PAD* pad = new PAD( m_footprint );
+
+            pad->SetAttribute( PAD_ATTRIB_SMD );
+            pad->SetLayerSet( PAD::SMDMask() );
+            pad->SetShape( PAD_SHAPE_RECT );
+            pad->SetSize( wxSize( Millimeter2iu( 0.2 ), Millimeter2iu( 0.2 ) ) );
+            pad->SetNet( net );
+            m_footprint->Add( pad );
+            m_pads.push_back( pad );
+            m_padCells.emplace_back( -1, -1 );
+
+            movePad( ii, freeCell( 0 ) );
+        }
+
+        m_board->BuildConnectivity();
+    }
+
+    /**
+     * @return a random grid cell, offset by \a aShift cells, which no pad occupies.
+     */
+    wxPoint freeCell( int aShift )
+    {
+        std::uniform_int_distribution<int> coord( 0, GRID_CELLS - 1 );
+        wxPoint                            cell;
+
+        do
+        {
+            cell = wxPoint( coord( m_rng ) + aShift, coord( m_rng ) );
+        } while( m_cells.count( std::make_pair( cell.x, cell.y ) ) );
+
+        return cell;
+    }
+
+    void movePad( size_t aIndex, const wxPoint& aCell )
+    {
+        PAD*    pad = m_pads[aIndex];
+        wxPoint pos( aCell.x * Millimeter2iu( 0.5 ), aCell.y * Millimeter2iu( 0.5 ) );
+
+        m_cells.erase( std::make_pair( m_padCells[aIndex].x, m_padCells[aIndex].y ) );
+        m_cells.insert( std::make_pair( aCell.x, aCell.y ) );
+        m_padCells[aIndex] = aCell;
+
+        pad->SetPos0( pos );
+        pad->SetPosition( pos );
+    }
+
+    /**
+     * Move \a aCount random pads, \a aShift cells further to the right, and update the ratsnest.
+     */
+    void moveRandomPads( int aCount, int aShift )
+    {
+        std::shared_ptr<CONNECTIVITY_DATA> connectivity = m_board->GetConnectivity();
+        std::uniform_int_distribution<int> index( 0, PAD_COUNT - 1 );
+
+        for( int ii = 0; ii < aCount; ++ii )
+        {
+            int padIndex = index( m_rng );
+
+            movePad( padIndex, freeCell( aShift ) );
+            connectivity->Update( m_pads[padIndex] );
+        }
+
+        connectivity->RecalculateRatsnest();
+    }
+
+    void checkRatsnest()
+    {
+        RN_NET*               net = m_board->GetConnectivity()->GetRatsnestForNet( 1 );
+        std::vector<VECTOR2I> points;
+        double                length = 0.0;
+
+        for( PAD* pad : m_pads )
+            points.push_back( pad->GetPosition() );
+
+        BOOST_REQUIRE( net );
+        BOOST_REQUIRE_EQUAL( net->GetEdges().size(), points.size() - 1 );
+
+        for( const CN_EDGE& edge : net->GetEdges() )
+            length += ( edge.GetTargetPos() - edge.GetSourcePos() ).EuclideanNorm();
+
+        double expected = bruteForceMST( points );
+
+        // Edges are sorted by their rounded lengths, so the tree may be longer by up to 1 IU
+        // per edge.
+        BOOST_CHECK_CLOSE_FRACTION( length, expected, points.size() / expected );
+    }
+
+    std::unique_ptr<BOARD>        m_board;
+    FOOTPRINT*                    m_footprint;
+    std::vector<PAD*>             m_pads;
+    std::vector<wxPoint>          m_padCells;   ///< grid cell of each pad
+    std::set<std::pair<int, int>> m_cells;      ///< cells occupied by a pad
+    std::mt19937                  m_rng;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( Ratsnest, RATSNEST_FIXTURE )
+
+
+BOOST_AUTO_TEST_CASE( FullTriangulation )
+{
+    checkRatsnest();
+}
+
+
+/**
+ * More updates than are made locally before the net is triangulated from scratch again.
+ */
+BOOST_AUTO_TEST_CASE( LocalUpdates )
+{
+    for( int ii = 0; ii < 40; ++ii )
+    {
+        BOOST_TEST_CONTEXT( "Update " << ii )
+        {
+            moveRandomPads( 20, 0 );
+            checkRatsnest();
+        }
+    }
+}
+
+
+/**
+ * Pads moved outside the area the previous triangulation was built for.
+ */
+BOOST_AUTO_TEST_CASE( UpdatesOutsideNet )
+{
+    for( int shift : { GRID_CELLS / 2, 2 * GRID_CELLS, 8 * GRID_CELLS } )
+    {
+        BOOST_TEST_CONTEXT( "Shift " << shift )
+        {
+            moveRandomPads( 5, shift );
+            checkRatsnest();
+        }
+    }
+}
+
+
+/**
+ * Too many changes for a local update.
+ */
+BOOST_AUTO_TEST_CASE( LargeUpdate )
+{
+    moveRandomPads( PAD_COUNT / 4, 0 );
+    checkRatsnest();
+
+    moveRandomPads( 10, 0 );
+    checkRatsnest();
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
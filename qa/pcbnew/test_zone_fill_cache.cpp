@@ -0,0 +1,349 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <fstream>
+#include <iterator>
+#include <limits>
+
+#include <boost/filesystem.hpp>
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <wx/mstream.h>
+#include <wx/zstream.h>
+
+#include <board.h>
+#include <zone.h>
+#include <plugins/kicad/kicad_plugin.h>
+#include <plugins/kicad/zone_fill_cache.h>
+
+
+static SHAPE_LINE_CHAIN closedChain( const std::vector<VECTOR2I>& aPoints )
+{
+    return SHAPE_LINE_CHAIN( aPoints, true );
+}
+
+
+struct ZONE_FILL_CACHE_FIXTURE
+{
+    ZONE_FILL_CACHE_FIXTURE() :
+            m_board( std::make_unique<BOARD>() )
+    {
+        m_path = ( boost::filesystem::temp_directory_path() / "zone_fill_cache_tst.kicad_fill" )
+                         .string();
+        m_boardPath = ( boost::filesystem::temp_directory_path() / "zone_fill_cache_tst.kicad_pcb" )
+                              .string();
+
+        m_zone = new ZONE( m_board.get() );
+        m_zone->SetLayer( F_Cu );
+        m_zone->Outline()->NewOutline();
+        m_zone->Outline()->Append( -1000000, -1000000 );
+        m_zone->Outline()->Append( 1000000, -1000000 );
+        m_zone->Outline()->Append( 1000000, 1000000 );
+        m_zone->Outline()->Append( -1000000, 1000000 );
+        m_board->Add( m_zone );
+
+        // Points far apart in both directions, so that the deltas need the full width of the
+        // zigzag varints, as well as small steps of either sign
+        m_fill.AddOutline( closedChain( { VECTOR2I( -2000000000, -2000000000 ),
+                                          VECTOR2I( 2000000000, -2000000000 ),
+                                          VECTOR2I( 2000000000, 2000000000 ),
+                                          VECTOR2I( -2000000000, 2000000000 ) } ) );
+        m_fill.AddHole( closedChain( { VECTOR2I( -1, -1 ), VECTOR2I( 1, -1 ), VECTOR2I( 1, 1 ),
+                                       VECTOR2I( -64, 64 ) } ) );
+
+        // An island
+        m_fill.AddOutline( closedChain( { VECTOR2I( 5000, 5000 ), VECTOR2I( 5127, 5000 ),
+                                          VECTOR2I( 5127, 4873 ) } ) );
+
+        m_zone->SetFilledPolysList( F_Cu, m_fill );
+        m_zone->SetIsIsland( F_Cu, 1 );
+        m_zone->SetIsFilled( true );
+        m_zone->SetNeedRefill( false );
+    }
+
+    ~ZONE_FILL_CACHE_FIXTURE()
+    {
+        boost::filesystem::remove( m_path );
+        boost::filesystem::remove( m_boardPath );
+    }
+
+    /**
+     * Drop the fill of the zone, as when it was loaded from a board file saved without fills.
+     */
+    void clearFill()
+    {
+        m_zone->ClearFilledPolysList();
+    }
+
+    std::string readFile() const
+    {
+        std::ifstream in( m_path, std::ios::binary );
+
+        return std::string( std::istreambuf_iterator<char>( in ),
+                            std::istreambuf_iterator<char>() );
+    }
+
+    void writeFile( const std::string& aContents ) const
+    {
+        std::ofstream out( m_path, std::ios::binary | std::ios::trunc );
+
+        out.write( aContents.data(), aContents.size() );
+    }
+
+    /**
+     * Write a cache file holding \a aPayload, as it is before compression.
+     */
+    void writePayload( const std::string& aPayload ) const
+    {
+        wxMemoryOutputStream mem;
+
+        mem.Write( "KZFC\x01", 5 );    // magic and version
+
+        {
+            wxZlibOutputStream zlib( mem, -1, wxZLIB_ZLIB );
+            zlib.Write( aPayload.data(), aPayload.size() );
+        }
+
+        std::string contents( mem.GetLength(), '\0' );
+        mem.CopyTo( &contents[0], contents.size() );
+        writeFile( contents );
+    }
+
+    static void appendVarint( std::string& aBuffer, uint64_t aValue )
+    {
+        for( ; aValue >= 0x80; aValue >>= 7 )
+            aBuffer += static_cast<char>( ( aValue & 0x7F ) | 0x80 );
+
+        aBuffer += static_cast<char>( aValue );
+    }
+
+    static void appendString( std::string& aBuffer, const std::string& aString )
+    {
+        appendVarint( aBuffer, aString.size() );
+        aBuffer += aString;
+    }
+
+    /**
+     * Save the board through PCB_IO and load it back.
+     */
+    std::unique_ptr<BOARD> saveAndLoad( int aCtl )
+    {
+        PCB_IO( aCtl ).Save( m_boardPath, m_board.get() );
+
+        return std::unique_ptr<BOARD>( PCB_IO().Load( m_boardPath, nullptr ) );
+    }
+
+    void checkFlaggedForRefill( ZONE* aZone )
+    {
+        BOOST_CHECK( !aZone->IsFilled() );
+        BOOST_CHECK( aZone->NeedRefill() );
+        BOOST_CHECK( aZone->GetFilledPolysList( F_Cu ).IsEmpty() );
+    }
+
+    void checkFlaggedForRefill()
+    {
+        checkFlaggedForRefill( m_zone );
+    }
+
+    std::unique_ptr<BOARD> m_board;
+    ZONE*                  m_zone;
+    SHAPE_POLY_SET         m_fill;
+    std::string            m_path;
+    std::string            m_boardPath;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( ZoneFillCache, ZONE_FILL_CACHE_FIXTURE )
+
+
+BOOST_AUTO_TEST_CASE( RoundTrip )
+{
+    ZONE_FILL_CACHE( m_board.get() ).Save( m_path );
+    clearFill();
+
+    BOOST_CHECK( ZONE_FILL_CACHE( m_board.get() ).Load( m_path ) );
+
+    BOOST_CHECK( m_zone->IsFilled() );
+    BOOST_CHECK( !m_zone->NeedRefill() );
+
+    const SHAPE_POLY_SET& fill = m_zone->GetFilledPolysList( F_Cu );
+
+    BOOST_REQUIRE_EQUAL( fill.OutlineCount(), m_fill.OutlineCount() );
+
+    for( int ii = 0; ii < m_fill.OutlineCount(); ++ii )
+    {
+        BOOST_REQUIRE_EQUAL( fill.HoleCount( ii ), m_fill.HoleCount( ii ) );
+
+        for( int jj = -1; jj < m_fill.HoleCount( ii ); ++jj )
+        {
+            const SHAPE_LINE_CHAIN& expected = jj < 0 ? m_fill.COutline( ii )
+                                                      : m_fill.CHole( ii, jj );
+            const SHAPE_LINE_CHAIN& actual = jj < 0 ? fill.COutline( ii ) : fill.CHole( ii, jj );
+
+            BOOST_REQUIRE_EQUAL( actual.PointCount(), expected.PointCount() );
+
+            for( int kk = 0; kk < expected.PointCount(); ++kk )
+                BOOST_CHECK_EQUAL( actual.CPoint( kk ), expected.CPoint( kk ) );
+        }
+    }
+
+    BOOST_CHECK( !m_zone->IsIsland( F_Cu, 0 ) );
+    BOOST_CHECK( m_zone->IsIsland( F_Cu, 1 ) );
+}
+
+
+BOOST_AUTO_TEST_CASE( BoardFillTakesPrecedence )
+{
+    ZONE_FILL_CACHE( m_board.get() ).Save( m_path );
+
+    SHAPE_POLY_SET other;
+    other.AddOutline( closedChain( { VECTOR2I( 0, 0 ), VECTOR2I( 10, 0 ), VECTOR2I( 10, 10 ) } ) );
+    m_zone->SetFilledPolysList( F_Cu, other );
+
+    BOOST_CHECK( ZONE_FILL_CACHE( m_board.get() ).Load( m_path ) );
+
+    BOOST_CHECK( m_zone->IsFilled() );
+    BOOST_CHECK_EQUAL( m_zone->GetFilledPolysList( F_Cu ).OutlineCount(), 1 );
+    BOOST_CHECK_EQUAL( m_zone->GetFilledPolysList( F_Cu ).COutline( 0 ).PointCount(), 3 );
+}
+
+
+BOOST_AUTO_TEST_CASE( HashMismatch )
+{
+    ZONE_FILL_CACHE( m_board.get() ).Save( m_path );
+    clearFill();
+
+    // The fill no longer matches the zone's outline
+    m_zone->Outline()->Append( -1000000, 0 );
+
+    // The cache itself is fine; the stale fill is just not restored
+    BOOST_CHECK( ZONE_FILL_CACHE( m_board.get() ).Load( m_path ) );
+    checkFlaggedForRefill();
+}
+
+
+BOOST_AUTO_TEST_CASE( MissingFile )
+{
+    // A filled zone may well have an empty fill
+    clearFill();
+
+    // Saved with its fills, the board doesn't need a cache at all
+    std::unique_ptr<BOARD> board = saveAndLoad( CTL_FOR_BOARD );
+
+    BOOST_REQUIRE_EQUAL( board->Zones().size(), 1 );
+    BOOST_CHECK( board->Zones()[0]->IsFilled() );
+    BOOST_CHECK( !board->Zones()[0]->NeedRefill() );
+
+    // Saved without them, the fills are lost along with the cache
+    board = saveAndLoad( CTL_FOR_BOARD | CTL_OMIT_FILLS );
+
+    BOOST_REQUIRE_EQUAL( board->Zones().size(), 1 );
+    checkFlaggedForRefill( board->Zones()[0] );
+}
+
+
+BOOST_AUTO_TEST_CASE( BadHeader )
+{
+    ZONE_FILL_CACHE( m_board.get() ).Save( m_path );
+    clearFill();
+
+    std::string contents = readFile();
+
+    contents[0] = 'X';
+    writeFile( contents );
+
+    BOOST_CHECK( !ZONE_FILL_CACHE( m_board.get() ).Load( m_path ) );
+    checkFlaggedForRefill();
+}
+
+
+BOOST_AUTO_TEST_CASE( Truncated )
+{
+    ZONE_FILL_CACHE( m_board.get() ).Save( m_path );
+    clearFill();
+
+    std::string contents = readFile();
+
+    // Cut off inside the compressed payload, and right after the header
+    for( size_t size : { contents.size() - 1, contents.size() / 2, static_cast<size_t>( 5 ) } )
+    {
+        BOOST_TEST_CONTEXT( "Size " << size )
+        {
+            m_zone->SetIsFilled( true );
+            m_zone->SetNeedRefill( false );
+            writeFile( contents.substr( 0, size ) );
+
+            BOOST_CHECK( !ZONE_FILL_CACHE( m_board.get() ).Load( m_path ) );
+            checkFlaggedForRefill();
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE( Corrupt )
+{
+    ZONE_FILL_CACHE( m_board.get() ).Save( m_path );
+    clearFill();
+
+    std::string contents = readFile();
+
+    // Flip a byte of the compressed payload; the zlib checksum must catch it
+    contents[contents.size() / 2] ^= 0x55;
+    writeFile( contents );
+
+    BOOST_CHECK( !ZONE_FILL_CACHE( m_board.get() ).Load( m_path ) );
+    checkFlaggedForRefill();
+}
+
+
+BOOST_AUTO_TEST_CASE( CoordinateOutOfRange )
+{
+    clearFill();
+
+    // One outline whose second point steps past the largest coordinate
+    std::string payload;
+
+    appendVarint( payload, 1 );
+    appendString( payload, m_zone->m_Uuid.AsString().ToStdString() );
+    appendString( payload, "hash" );
+    appendVarint( payload, 1 );
+    appendVarint( payload, F_Cu );
+    appendVarint( payload, 1 );
+    appendVarint( payload, 0 );
+    appendVarint( payload, 0 );
+    appendVarint( payload, 2 );
+
+    // Zigzag encoded deltas
+    appendVarint( payload, uint64_t( std::numeric_limits<int>::max() ) * 2 );
+    appendVarint( payload, 0 );
+    appendVarint( payload, 2 );
+    appendVarint( payload, 0 );
+
+    writePayload( payload );
+
+    BOOST_CHECK( !ZONE_FILL_CACHE( m_board.get() ).Load( m_path ) );
+    checkFlaggedForRefill();
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,248 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <board.h>
+#include <pcb_shape.h>
+#include <track.h>
+#include <zone.h>
+#include <zone_filler.h>
+
+
+/**
+ * @return the area of \a aPolys, which may have holes.
+ */
+static double polyArea( const SHAPE_POLY_SET& aPolys )
+{
+    SHAPE_POLY_SET fractured = aPolys;
+    double         area = 0.0;
+
+    fractured.Fracture( SHAPE_POLY_SET::PM_FAST );
+
+    for( int ii = 0; ii < fractured.OutlineCount(); ++ii )
+        area += std::abs( fractured.Outline( ii ).Area() );
+
+    return area;
+}
+
+
+static SHAPE_POLY_SET rectPoly( const wxPoint& aCenter, int aSize )
+{
+    SHAPE_POLY_SET poly;
+
+    poly.NewOutline();
+    poly.Append( aCenter.x - aSize / 2, aCenter.y - aSize / 2 );
+    poly.Append( aCenter.x + aSize / 2, aCenter.y - aSize / 2 );
+    poly.Append( aCenter.x + aSize / 2, aCenter.y + aSize / 2 );
+    poly.Append( aCenter.x - aSize / 2, aCenter.y + aSize / 2 );
+
+    return poly;
+}
+
+
+/**
+ * A 40mm square GND pour on F.Cu, crossed by a short track of another net.
+ */
+struct ZONE_FILLER_INCREMENTAL_FIXTURE
+{
+    ZONE_FILLER_INCREMENTAL_FIXTURE() :
+            m_board( std::make_unique<BOARD>() )
+    {
+        const int halfSize = Millimeter2iu( 20 );
+
+        NETINFO_ITEM* gnd = new NETINFO_ITEM( m_board.get(), "GND", 1 );
+        NETINFO_ITEM* signal = new NETINFO_ITEM( m_board.get(), "SIG", 2 );
+
+        m_board->Add( gnd );
+        m_board->Add( signal );
+
+        PCB_SHAPE* edge = new PCB_SHAPE( m_board.get() );
+        edge->SetShape( S_RECT );
+        edge->SetLayer( Edge_Cuts );
+        edge->SetStart( wxPoint( -halfSize - Millimeter2iu( 1 ), -halfSize - Millimeter2iu( 1 ) ) );
+        edge->SetEnd( wxPoint( halfSize + Millimeter2iu( 1 ), halfSize + Millimeter2iu( 1 ) ) );
+        m_board->Add( edge );
+
+        m_zone = new ZONE( m_board.get() );
+        m_zone->SetLayer( F_Cu );
+        m_zone->SetNet( gnd );
+        m_zone->SetIslandRemovalMode( ISLAND_REMOVAL_MODE::NEVER );
+        m_zone->Outline()->NewOutline();
+        m_zone->Outline()->Append( -halfSize, -halfSize );
+        m_zone->Outline()->Append( halfSize, -halfSize );
+        m_zone->Outline()->Append( halfSize, halfSize );
+        m_zone->Outline()->Append( -halfSize, halfSize );
+        m_board->Add( m_zone );
+
+        m_track = new TRACK( m_board.get() );
+        m_track->SetLayer( F_Cu );
+        m_track->SetNet( signal );
+        m_track->SetWidth( Millimeter2iu( 0.25 ) );
+        m_track->SetStart( wxPoint( Millimeter2iu( -12 ), Millimeter2iu( -12 ) ) );
+        m_track->SetEnd( wxPoint( Millimeter2iu( -8 ), Millimeter2iu( -12 ) ) );
+        m_board->Add( m_track );
+    }
+
+    void fill( bool aIncremental )
+    {
+        std::vector<ZONE*> zones = { m_zone };
+        ZONE_FILLER        filler( m_board.get(), nullptr );
+
+        m_board->BuildConnectivity();
+        filler.SetIncremental( aIncremental );
+
+        BOOST_REQUIRE( filler.Fill( zones ) );
+    }
+
+    /**
+     * Move the track as a BOARD_COMMIT would, recording its old and new areas.
+     */
+    void moveTrack( const wxPoint& aOffset )
+    {
+        m_board->MarkZoneFillDirtyArea( m_track->GetBoundingBox() );
+        m_track->Move( aOffset );
+        m_board->MarkZoneFillDirtyArea( m_track->GetBoundingBox() );
+        m_board->OnZoneFillsModified();
+    }
+
+    std::unique_ptr<BOARD> m_board;
+    ZONE*                  m_zone;
+    TRACK*                 m_track;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( ZoneFillerIncremental, ZONE_FILLER_INCREMENTAL_FIXTURE )
+
+
+BOOST_AUTO_TEST_CASE( DirtyAreaRecord )
+{
+    std::vector<EDA_RECT>  areas;
+    std::set<const ZONE*>  zones;
+    EDA_RECT               area( wxPoint( 0, 0 ), wxSize( 100, 100 ) );
+
+    // Nothing is known about a board which was never filled
+    BOOST_CHECK( !m_board->GetZoneFillDirtyAreas( areas, zones ) );
+
+    m_board->ResetZoneFillDirtyAreas();
+    BOOST_REQUIRE( m_board->GetZoneFillDirtyAreas( areas, zones ) );
+    BOOST_CHECK( areas.empty() );
+    BOOST_CHECK( zones.empty() );
+
+    m_board->MarkZoneFillDirtyArea( area );
+    m_board->MarkZoneFillDirtyZone( m_zone );
+    m_board->OnZoneFillsModified();
+
+    BOOST_REQUIRE( m_board->GetZoneFillDirtyAreas( areas, zones ) );
+    BOOST_REQUIRE_EQUAL( areas.size(), 1 );
+    BOOST_CHECK( areas[0].GetOrigin() == area.GetOrigin() );
+    BOOST_CHECK( areas[0].GetSize() == area.GetSize() );
+    BOOST_CHECK_EQUAL( zones.count( m_zone ), 1 );
+
+    // A modification which didn't record what it changed requires a full refill
+    m_board->OnZoneFillsModified();
+    BOOST_CHECK( !m_board->GetZoneFillDirtyAreas( areas, zones ) );
+
+    // Changes recorded while the record is invalid don't make it valid again
+    m_board->MarkZoneFillDirtyArea( area );
+    m_board->OnZoneFillsModified();
+    BOOST_CHECK( !m_board->GetZoneFillDirtyAreas( areas, zones ) );
+}
+
+
+/**
+ * Refilling around a moved track must give the fill a full refill gives, and must leave the
+ * rest of the previous fill alone.
+ */
+BOOST_AUTO_TEST_CASE( RefillMatchesFullFill )
+{
+    const wxPoint  oldCenter( Millimeter2iu( -10 ), Millimeter2iu( -12 ) );
+    const wxPoint  newCenter( Millimeter2iu( -10 ), Millimeter2iu( -6 ) );
+    const wxPoint  farCenter( Millimeter2iu( 12 ), Millimeter2iu( 12 ) );
+    SHAPE_POLY_SET marker = rectPoly( farCenter, Millimeter2iu( 1 ) );
+
+    fill( false );
+    m_board->ResetZoneFillDirtyAreas();
+
+    BOOST_CHECK( !m_zone->GetFilledPolysList( F_Cu ).Contains( oldCenter ) );
+    BOOST_CHECK( m_zone->GetFilledPolysList( F_Cu ).Contains( newCenter ) );
+
+    // Mark the previous fill far away from the change, where a refill must not look
+    m_zone->RawPolysList( F_Cu ).BooleanSubtract( marker, SHAPE_POLY_SET::PM_FAST );
+    m_zone->RawPolysList( F_Cu ).Fracture( SHAPE_POLY_SET::PM_FAST );
+
+    moveTrack( newCenter - oldCenter );
+    fill( true );
+
+    SHAPE_POLY_SET incremental = m_zone->GetFilledPolysList( F_Cu );
+
+    BOOST_CHECK( incremental.Contains( oldCenter ) );
+    BOOST_CHECK( !incremental.Contains( newCenter ) );
+    BOOST_CHECK( !incremental.Contains( farCenter ) );
+
+    fill( false );
+
+    SHAPE_POLY_SET full = m_zone->GetFilledPolysList( F_Cu );
+
+    BOOST_CHECK( full.Contains( farCenter ) );
+
+    // Apart from the marker, both fills are the same
+    full.BooleanSubtract( marker, SHAPE_POLY_SET::PM_FAST );
+
+    SHAPE_POLY_SET onlyFull = full;
+    SHAPE_POLY_SET onlyIncremental = incremental;
+
+    onlyFull.BooleanSubtract( incremental, SHAPE_POLY_SET::PM_FAST );
+    onlyIncremental.BooleanSubtract( full, SHAPE_POLY_SET::PM_FAST );
+
+    // Allow for the rounding of the splice: well under the area of the track
+    double tolerance = Millimeter2iu( 0.01 ) * (double) Millimeter2iu( 0.01 );
+
+    BOOST_CHECK_LT( polyArea( onlyFull ), tolerance );
+    BOOST_CHECK_LT( polyArea( onlyIncremental ), tolerance );
+}
+
+
+/**
+ * Any change made outside a BOARD_COMMIT falls back to a full refill.
+ */
+BOOST_AUTO_TEST_CASE( UntrackedChangeFillsInFull )
+{
+    const wxPoint  farCenter( Millimeter2iu( 12 ), Millimeter2iu( 12 ) );
+    SHAPE_POLY_SET marker = rectPoly( farCenter, Millimeter2iu( 1 ) );
+
+    fill( false );
+    m_board->ResetZoneFillDirtyAreas();
+
+    m_zone->RawPolysList( F_Cu ).BooleanSubtract( marker, SHAPE_POLY_SET::PM_FAST );
+    m_zone->RawPolysList( F_Cu ).Fracture( SHAPE_POLY_SET::PM_FAST );
+
+    m_track->Move( wxPoint( 0, Millimeter2iu( 6 ) ) );
+    m_board->OnZoneFillsModified();
+    fill( true );
+
+    BOOST_CHECK( m_zone->GetFilledPolysList( F_Cu ).Contains( farCenter ) );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,434 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Benchmark of the phases of loading boards, footprint libraries and other s-expression files,
+ * reporting throughput in MB/s and items/s.  With --csv the results can be collected for
+ * regression tracking; without files, all the demo boards and libraries are loaded.
+ *
+ * Schematics are benchmarked by the sch_load_benchmark of qa_eeschema_tools, which links
+ * the schematic parser.
+ */
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <memory>
+
+#include <wx/cmdline.h>
+#include <wx/dir.h>
+#include <wx/filename.h>
+
+#include <board.h>
+#include <footprint.h>
+#include <zone.h>
+#include <dsnlexer.h>
+#include <profile.h>
+#include <richio.h>
+#include <wildcards_and_files_ext.h>
+#include <plugins/kicad/kicad_plugin.h>
+#include <plugins/kicad/pcb_parser.h>
+
+#include <qa_utils/utility_registry.h>
+
+
+#ifndef QA_DEMOS_LOCATION
+    #define QA_DEMOS_LOCATION "???"
+#endif
+
+
+struct PHASE_RESULT
+{
+    wxString    m_file;
+    std::string m_phase;
+    double      m_msecs;     ///< fastest of the repetitions
+    size_t      m_bytes;     ///< input size, or 0 if the phase does not read the file
+    size_t      m_items;     ///< tokens, board items, footprints, etc. handled by the phase
+};
+
+
+class LOAD_BENCHMARK
+{
+public:
+    LOAD_BENCHMARK( long aReps ) :
+            m_reps( aReps ),
+            m_failed( false )
+    {
+    }
+
+    /**
+     * Tokenize, load, build the connectivity of and hash the zone fills of a board.
+     */
+    void Board( const wxString& aFile );
+
+    /**
+     * Load a footprint library into a fresh FP_CACHE, then load every footprint from it.
+     */
+    void Library( const wxString& aPath );
+
+    /**
+     * Tokenize any other s-expression file (symbol libraries, footprints, ...).
+     */
+    void SExpression( const wxString& aFile );
+
+    const std::vector<PHASE_RESULT>& GetResults() const { return m_results; }
+    bool Failed() const { return m_failed; }
+
+private:
+    /**
+     * Run \a aPhase m_reps times and record the fastest run.  \a aPhase returns the number of
+     * items it handled.
+     */
+    void run( const wxString& aFile, const std::string& aPhaseName, size_t aBytes,
+              const std::function<size_t()>& aPhase );
+
+    long                      m_reps;
+    bool                      m_failed;
+    std::vector<PHASE_RESULT> m_results;
+};
+
+
+void LOAD_BENCHMARK::run( const wxString& aFile, const std::string& aPhaseName, size_t aBytes,
+                          const std::function<size_t()>& aPhase )
+{
+    PHASE_RESULT result = { aFile, aPhaseName, 0.0, aBytes, 0 };
+
+    for( long ii = 0; ii < m_reps; ++ii )
+    {
+        PROF_COUNTER counter( aPhaseName, false );
+
+        counter.Start();
+        result.m_items = aPhase();
+        counter.Stop();
+
+        if( ii == 0 || counter.msecs() < result.m_msecs )
+            result.m_msecs = counter.msecs();
+    }
+
+    m_results.push_back( result );
+}
+
+
+void LOAD_BENCHMARK::Board( const wxString& aFile )
+{
+    size_t                 bytes = wxFileName::GetSize( aFile ).GetValue();
+    std::unique_ptr<BOARD> board;
+
+    try
+    {
+        run( aFile, "tokenize", bytes,
+             [&]()
+             {
+                 MAPPED_FILE_LINE_READER reader( aFile );
+                 PCB_LEXER               lexer( &reader );
+                 size_t                  tokens = 0;
+
+                 while( lexer.NextTok() != PCB_KEYS_T::T_EOF )
+                     ++tokens;
+
+                 return tokens;
+             } );
+
+        run( aFile, "load", bytes,
+             [&]()
+             {
+                 PCB_IO io;
+
+                 board.reset( io.Load( aFile, nullptr ) );
+
+                 size_t items = board->Footprints().size() + board->Tracks().size()
+                                + board->Zones().size() + board->Drawings().size();
+
+                 for( FOOTPRINT* footprint : board->Footprints() )
+                     items += footprint->Pads().size() + footprint->GraphicalItems().size();
+
+                 return items;
+             } );
+
+        run( aFile, "connectivity", 0,
+             [&]()
+             {
+                 board->BuildConnectivity();
+
+                 size_t items = board->Tracks().size() + board->Zones().size();
+
+                 for( FOOTPRINT* footprint : board->Footprints() )
+                     items += footprint->Pads().size();
+
+                 return items;
+             } );
+
+        run( aFile, "zone_hash", 0,
+             [&]()
+             {
+                 size_t layers = 0;
+
+                 for( ZONE* zone : board->Zones() )
+                 {
+                     for( PCB_LAYER_ID layer : zone->GetLayerSet().Seq() )
+                     {
+                         zone->BuildHashValue( layer );
+                         ++layers;
+                     }
+                 }
+
+                 return layers;
+             } );
+    }
+    catch( const IO_ERROR& ioe )
+    {
+        std::cerr << "Error loading " << aFile << ": " << ioe.What() << std::endl;
+        m_failed = true;
+    }
+}
+
+
+void LOAD_BENCHMARK::Library( const wxString& aPath )
+{
+    wxArrayString files;
+    size_t        bytes = 0;
+
+    wxDir::GetAllFiles( aPath, &files, wxT( "*." ) + KiCadFootprintFileExtension, wxDIR_FILES );
+
+    for( const wxString& file : files )
+        bytes += wxFileName::GetSize( file ).GetValue();
+
+    std::unique_ptr<PCB_IO> io;
+    wxArrayString           names;
+
+    try
+    {
+        run( aPath, "fp_cache", bytes,
+             [&]()
+             {
+                 io = std::make_unique<PCB_IO>();
+                 names.Clear();
+                 io->FootprintEnumerate( names, aPath, false );
+
+                 return names.size();
+             } );
+
+        run( aPath, "fp_load", 0,
+             [&]()
+             {
+                 for( const wxString& name : names )
+                     delete io->FootprintLoad( aPath, name );
+
+                 return names.size();
+             } );
+    }
+    catch( const IO_ERROR& ioe )
+    {
+        std::cerr << "Error loading " << aPath << ": " << ioe.What() << std::endl;
+        m_failed = true;
+    }
+}
+
+
+void LOAD_BENCHMARK::SExpression( const wxString& aFile )
+{
+    size_t bytes = wxFileName::GetSize( aFile ).GetValue();
+
+    try
+    {
+        run( aFile, "tokenize", bytes,
+             [&]()
+             {
+                 MAPPED_FILE_LINE_READER reader( aFile );
+                 DSNLEXER                lexer( nullptr, 0, &reader );
+                 size_t                  tokens = 0;
+
+                 while( lexer.NextTok() != DSN_EOF )
+                     ++tokens;
+
+                 return tokens;
+             } );
+    }
+    catch( const IO_ERROR& ioe )
+    {
+        std::cerr << "Error reading " << aFile << ": " << ioe.What() << std::endl;
+        m_failed = true;
+    }
+}
+
+
+/**
+ * Collect the boards and footprint libraries below a directory.
+ */
+class DEMO_TRAVERSER : public wxDirTraverser
+{
+public:
+    DEMO_TRAVERSER( wxArrayString& aFiles ) :
+            m_files( aFiles )
+    {
+    }
+
+    wxDirTraverseResult OnFile( const wxString& aFile ) override
+    {
+        wxFileName fn( aFile );
+
+        if( fn.GetExt() == KiCadPcbFileExtension )
+            m_files.Add( aFile );
+
+        return wxDIR_CONTINUE;
+    }
+
+    wxDirTraverseResult OnDir( const wxString& aDir ) override
+    {
+        if( aDir.EndsWith( wxT( "." ) + KiCadFootprintLibPathExtension ) )
+        {
+            m_files.Add( aDir );
+            return wxDIR_IGNORE;
+        }
+
+        return wxDIR_CONTINUE;
+    }
+
+private:
+    wxArrayString& m_files;
+};
+
+
+static void printResults( const std::vector<PHASE_RESULT>& aResults, bool aCsv )
+{
+    auto& os = std::cout;
+
+    if( aCsv )
+        os << "file,phase,msecs,bytes,items,mb_per_sec,items_per_sec" << std::endl;
+
+    for( const PHASE_RESULT& result : aResults )
+    {
+        double secs = result.m_msecs / 1000.0;
+        double mbPerSec = secs > 0.0 ? result.m_bytes / 1e6 / secs : 0.0;
+        double itemsPerSec = secs > 0.0 ? result.m_items / secs : 0.0;
+
+        if( aCsv )
+        {
+            os << wxString::Format( "\"%s\",%s,%.3f,%zu,%zu,%.2f,%.0f", result.m_file,
+                                    result.m_phase, result.m_msecs, result.m_bytes,
+                                    result.m_items, mbPerSec, itemsPerSec )
+               << std::endl;
+        }
+        else
+        {
+            wxString throughput = result.m_bytes ? wxString::Format( "%8.1f MB/s", mbPerSec )
+                                                 : wxString( ' ', 13 );
+
+            os << wxString::Format( "%-40s %-12s %9.2f ms %s %12.0f items/s",
+                                    wxFileName( result.m_file ).GetFullName(), result.m_phase,
+                                    result.m_msecs, throughput, itemsPerSec )
+               << std::endl;
+        }
+    }
+}
+
+
+static const wxCmdLineEntryDesc g_cmdLineDesc[] = {
+    { wxCMD_LINE_SWITCH, "h", "help", _( "displays help on the command line parameters" ).mb_str(),
+            wxCMD_LINE_VAL_NONE, wxCMD_LINE_OPTION_HELP },
+    { wxCMD_LINE_OPTION, "r", "reps", _( "repetitions of each phase, of which the fastest is "
+                                         "reported (default 3)" ).mb_str(),
+            wxCMD_LINE_VAL_NUMBER },
+    { wxCMD_LINE_SWITCH, "c", "csv", _( "print the results as CSV" ).mb_str() },
+    { wxCMD_LINE_PARAM, nullptr, nullptr,
+            _( "boards, footprint libraries or other s-expression files" ).mb_str(),
+            wxCMD_LINE_VAL_STRING, wxCMD_LINE_PARAM_OPTIONAL | wxCMD_LINE_PARAM_MULTIPLE },
+    { wxCMD_LINE_NONE }
+};
+
+
+enum LOAD_BENCHMARK_RET_CODES
+{
+    LOAD_FAILED = KI_TEST::RET_CODES::TOOL_SPECIFIC,
+};
+
+
+int load_benchmark_main_func( int argc, char** argv )
+{
+    wxMessageOutput::Set( new wxMessageOutputStderr );
+    wxCmdLineParser cl_parser( argc, argv );
+    cl_parser.SetDesc( g_cmdLineDesc );
+    cl_parser.AddUsageText(
+            _( "This program times the tokenizing, loading, connectivity building and zone "
+               "hashing of boards, the loading of footprint libraries, and the tokenizing of "
+               "other s-expression files.  Without files, it benchmarks all the boards and "
+               "footprint libraries of the demos.  Schematics are benchmarked by "
+               "qa_eeschema_tools sch_load_benchmark." ) );
+
+    int cmd_parsed_ok = cl_parser.Parse();
+
+    if( cmd_parsed_ok != 0 )
+    {
+        // Help and invalid input both stop here
+        return ( cmd_parsed_ok == -1 ) ? KI_TEST::RET_CODES::OK : KI_TEST::RET_CODES::BAD_CMDLINE;
+    }
+
+    long reps = 3;
+
+    cl_parser.Found( "reps", &reps );
+
+    wxArrayString files;
+
+    for( unsigned i = 0; i < cl_parser.GetParamCount(); i++ )
+        files.Add( cl_parser.GetParam( i ) );
+
+    if( files.empty() )
+    {
+        wxDir          demos( QA_DEMOS_LOCATION );
+        DEMO_TRAVERSER traverser( files );
+
+        if( demos.IsOpened() )
+            demos.Traverse( traverser );
+
+        files.Sort();
+    }
+
+    LOAD_BENCHMARK benchmark( std::max( reps, 1L ) );
+
+    for( const wxString& file : files )
+    {
+        wxFileName fn( file );
+
+        if( wxDirExists( file ) )
+            benchmark.Library( file );
+        else if( fn.GetExt() == KiCadPcbFileExtension )
+            benchmark.Board( file );
+        else
+            benchmark.SExpression( file );
+    }
+
+    printResults( benchmark.GetResults(), cl_parser.Found( "csv" ) );
+
+    if( benchmark.Failed() )
+        return LOAD_BENCHMARK_RET_CODES::LOAD_FAILED;
+
+    return KI_TEST::RET_CODES::OK;
+}
+
+
+static bool registered = UTILITY_REGISTRY::Register( {
+        "load_benchmark",
+        "Benchmark the loading of boards, footprint libraries and s-expression files",
+        load_benchmark_main_func,
+} );
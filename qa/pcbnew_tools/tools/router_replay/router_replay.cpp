@@ -0,0 +1,485 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2021 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Replays a router event log, as saved by PNS::LOGGER, against its board without a GUI and
+ * reports the latency of the router per kind of interaction (routing in each mode, dragging,
+ * length tuning) as percentiles, along with the shove and walkaround iteration counts.
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <memory>
+
+#include <wx/cmdline.h>
+#include <wx/filename.h>
+
+#include <board.h>
+#include <footprint.h>
+#include <pad.h>
+#include <profile.h>
+#include <project.h>
+#include <wildcards_and_files_ext.h>
+#include <drc/drc_engine.h>
+#include <plugins/kicad/kicad_plugin.h>
+#include <settings/settings_manager.h>
+
+#include <router/pns_kicad_iface.h>
+#include <router/pns_logger.h>
+#include <router/pns_router.h>
+#include <router/pns_routing_settings.h>
+#include <router/pns_sizes_settings.h>
+#include <router/pns_solid.h>
+
+#include <qa_utils/utility_registry.h>
+
+
+struct EVENT_SAMPLE
+{
+    std::string m_phase;                ///< kind of interaction the event belongs to
+    double      m_msecs;
+    int         m_shoveIterations;
+    int         m_walkaroundIterations;
+};
+
+
+class ROUTER_REPLAY
+{
+public:
+    /**
+     * @param aRoutingMode the routing mode to replay the routing events in, or -1 to use the
+     *                     mode recorded in the log.
+     */
+    ROUTER_REPLAY( BOARD* aBoard, int aRoutingMode ) :
+            m_board( aBoard ),
+            m_routingMode( aRoutingMode )
+    {
+    }
+
+    /**
+     * Replay \a aEvents against a freshly synchronised router world, timing each event.
+     */
+    void Replay( const std::vector<PNS::LOGGER::EVENT_ENTRY>& aEvents );
+
+    const std::vector<EVENT_SAMPLE>& GetSamples() const { return m_samples; }
+    int GetUnresolvedItems() const { return m_unresolvedItems; }
+
+private:
+    PNS::ITEM* findItem( const KIID& aUuid );
+
+    void startRoute( const PNS::LOGGER::EVENT_ENTRY& aEvent, PNS::ITEM* aItem );
+    void startDrag( const PNS::LOGGER::EVENT_ENTRY& aEvent, PNS::ITEM* aItem );
+
+    BOARD*                                 m_board;
+    int                                    m_routingMode;
+    int                                    m_unresolvedItems = 0;
+    std::unique_ptr<PNS_KICAD_IFACE_BASE>  m_iface;
+    std::unique_ptr<PNS::ROUTER>           m_router;
+    std::unique_ptr<PNS::ROUTING_SETTINGS> m_settings;
+    std::string                            m_phase;
+    std::vector<EVENT_SAMPLE>              m_samples;
+};
+
+
+PNS::ITEM* ROUTER_REPLAY::findItem( const KIID& aUuid )
+{
+    if( aUuid == niluuid )
+        return nullptr;
+
+    PNS::ITEM* item = m_router->GetWorld()->FindItemByParent( m_board->GetItem( aUuid ) );
+
+    // Items created by earlier events of the log only exist in the router's world.
+    if( !item )
+        m_unresolvedItems++;
+
+    return item;
+}
+
+
+static std::string routingModeName( PNS::PNS_MODE aMode )
+{
+    switch( aMode )
+    {
+    case PNS::RM_MarkObstacles: return "mark_obstacles";
+    case PNS::RM_Shove:         return "shove";
+    case PNS::RM_Walkaround:    return "walkaround";
+    case PNS::RM_Smart:         return "smart";
+    default:                    return "unknown";
+    }
+}
+
+
+void ROUTER_REPLAY::startRoute( const PNS::LOGGER::EVENT_ENTRY& aEvent, PNS::ITEM* aItem )
+{
+    PNS::ROUTER_MODE mode = aEvent.mode ? static_cast<PNS::ROUTER_MODE>( aEvent.mode )
+                                        : PNS::PNS_MODE_ROUTE_SINGLE;
+    int              layer = aEvent.layer >= 0 ? aEvent.layer : aItem ? aItem->Layer() : F_Cu;
+
+    if( m_routingMode >= 0 )
+        m_settings->SetMode( static_cast<PNS::PNS_MODE>( m_routingMode ) );
+    else
+        m_settings->SetMode( static_cast<PNS::PNS_MODE>( aEvent.routingMode ) );
+
+    m_router->SetMode( mode );
+
+    PNS::SIZES_SETTINGS sizes( m_router->Sizes() );
+
+    m_iface->ImportSizes( sizes, aItem, aItem ? aItem->Net() : -1 );
+    sizes.ClearLayerPairs();
+    sizes.AddLayerPair( layer, layer );
+    m_router->UpdateSizes( sizes );
+
+    switch( mode )
+    {
+    case PNS::PNS_MODE_ROUTE_SINGLE:
+        m_phase = "route_" + routingModeName( m_settings->Mode() );
+        break;
+
+    case PNS::PNS_MODE_ROUTE_DIFF_PAIR:
+        m_phase = "diff_pair_" + routingModeName( m_settings->Mode() );
+        break;
+
+    default:
+        m_phase = "meander";
+        break;
+    }
+
+    m_router->StartRouting( aEvent.p, aItem, layer );
+}
+
+
+void ROUTER_REPLAY::startDrag( const PNS::LOGGER::EVENT_ENTRY& aEvent, PNS::ITEM* aItem )
+{
+    int dragMode = aEvent.mode ? aEvent.mode : PNS::DM_ANY;
+
+    if( m_routingMode >= 0 )
+        m_settings->SetMode( static_cast<PNS::PNS_MODE>( m_routingMode ) );
+    else
+        m_settings->SetMode( static_cast<PNS::PNS_MODE>( aEvent.routingMode ) );
+
+    if( !aItem )
+        return;
+
+    m_phase = "drag";
+
+    // Footprints are dragged by all their pads at once
+    if( ( dragMode & PNS::DM_COMPONENT ) && aItem->Parent() )
+    {
+        FOOTPRINT*    footprint = static_cast<PAD*>( aItem->Parent() )->GetParent();
+        PNS::ITEM_SET pads;
+
+        for( PAD* pad : footprint->Pads() )
+        {
+            if( PNS::ITEM* solid = m_router->GetWorld()->FindItemByParent( pad ) )
+                pads.Add( solid );
+        }
+
+        m_router->StartDragging( aEvent.p, pads, dragMode );
+    }
+    else
+    {
+        m_router->StartDragging( aEvent.p, aItem, dragMode );
+    }
+}
+
+
+void ROUTER_REPLAY::Replay( const std::vector<PNS::LOGGER::EVENT_ENTRY>& aEvents )
+{
+    m_iface = std::make_unique<PNS_KICAD_IFACE_BASE>();
+    m_iface->SetBoard( m_board );
+
+    m_router = std::make_unique<PNS::ROUTER>();
+    m_router->SetInterface( m_iface.get() );
+    m_router->ClearWorld();
+    m_router->SyncWorld();
+
+    m_settings = std::make_unique<PNS::ROUTING_SETTINGS>( nullptr, "" );
+    m_router->LoadSettings( m_settings.get() );
+
+    PNS::LOGGER* logger = m_router->Logger();
+
+    for( const PNS::LOGGER::EVENT_ENTRY& event : aEvents )
+    {
+        PNS::ITEM*   item = findItem( event.uuid );
+        PROF_COUNTER counter( "event", false );
+
+        logger->ResetCounters();
+
+        switch( event.type )
+        {
+        case PNS::LOGGER::EVT_START_ROUTE:
+            // Logs written before the end of an interaction was recorded go straight on to
+            // the next one.
+            if( m_router->RoutingInProgress() )
+                m_router->StopRouting();
+
+            counter.Start();
+            startRoute( event, item );
+            break;
+
+        case PNS::LOGGER::EVT_START_DRAG:
+            if( m_router->RoutingInProgress() )
+                m_router->StopRouting();
+
+            counter.Start();
+            startDrag( event, item );
+            break;
+
+        case PNS::LOGGER::EVT_MOVE:
+            counter.Start();
+            m_router->Move( event.p, item );
+            break;
+
+        case PNS::LOGGER::EVT_FIX:
+            counter.Start();
+            m_router->FixRoute( event.p, item );
+            break;
+
+        case PNS::LOGGER::EVT_ABORT:
+            counter.Start();
+            m_router->StopRouting();
+            break;
+        }
+
+        counter.Stop();
+
+        if( m_phase.empty() )
+            continue;
+
+        m_samples.push_back( { m_phase, counter.msecs(),
+                               logger->GetIterations( PNS::LOGGER::CNT_SHOVE ),
+                               logger->GetIterations( PNS::LOGGER::CNT_WALKAROUND ) } );
+    }
+
+    if( m_router->RoutingInProgress() )
+        m_router->StopRouting();
+
+    // The router logs the replayed events too
+    logger->Clear();
+
+    m_router.reset();
+    m_iface.reset();
+}
+
+
+static double percentile( const std::vector<double>& aSorted, double aFraction )
+{
+    if( aSorted.empty() )
+        return 0.0;
+
+    size_t index = std::min( aSorted.size() - 1, (size_t) ( aFraction * aSorted.size() ) );
+
+    return aSorted[index];
+}
+
+
+static void printResults( const wxString& aLogFile, const std::vector<EVENT_SAMPLE>& aSamples,
+                          bool aCsv )
+{
+    std::map<std::string, std::vector<const EVENT_SAMPLE*>> phases;
+
+    for( const EVENT_SAMPLE& sample : aSamples )
+        phases[sample.m_phase].push_back( &sample );
+
+    auto& os = std::cout;
+
+    if( aCsv )
+        os << "log,phase,events,p50_ms,p90_ms,p99_ms,max_ms,shove_iter,walkaround_iter" << std::endl;
+
+    for( const auto& phase : phases )
+    {
+        std::vector<double> msecs;
+        double              shoveIter = 0.0;
+        double              walkIter = 0.0;
+
+        for( const EVENT_SAMPLE* sample : phase.second )
+        {
+            msecs.push_back( sample->m_msecs );
+            shoveIter += sample->m_shoveIterations;
+            walkIter += sample->m_walkaroundIterations;
+        }
+
+        std::sort( msecs.begin(), msecs.end() );
+
+        // Iteration counts are reported as means per event
+        shoveIter /= msecs.size();
+        walkIter /= msecs.size();
+
+        if( aCsv )
+        {
+            os << wxString::Format( "\"%s\",%s,%zu,%.3f,%.3f,%.3f,%.3f,%.1f,%.1f", aLogFile,
+                                    phase.first, msecs.size(), percentile( msecs, 0.5 ),
+                                    percentile( msecs, 0.9 ), percentile( msecs, 0.99 ),
+                                    msecs.back(), shoveIter, walkIter )
+               << std::endl;
+        }
+        else
+        {
+            os << wxString::Format( "%-24s %6zu events  p50 %8.2f ms  p90 %8.2f ms  p99 %8.2f ms  "
+                                    "max %8.2f ms  shove %6.1f  walkaround %6.1f iter/event",
+                                    phase.first, msecs.size(), percentile( msecs, 0.5 ),
+                                    percentile( msecs, 0.9 ), percentile( msecs, 0.99 ),
+                                    msecs.back(), shoveIter, walkIter )
+               << std::endl;
+        }
+    }
+}
+
+
+static const wxCmdLineEntryDesc g_cmdLineDesc[] = {
+    { wxCMD_LINE_SWITCH, "h", "help", _( "displays help on the command line parameters" ).mb_str(),
+            wxCMD_LINE_VAL_NONE, wxCMD_LINE_OPTION_HELP },
+    { wxCMD_LINE_OPTION, "r", "reps", _( "number of times to replay the log (default 1)" ).mb_str(),
+            wxCMD_LINE_VAL_NUMBER },
+    { wxCMD_LINE_OPTION, "m", "mode", _( "replay the routing events in this mode instead of the "
+                                         "recorded one: shove, walkaround or mark" ).mb_str(),
+            wxCMD_LINE_VAL_STRING },
+    { wxCMD_LINE_SWITCH, "c", "csv", _( "print the results as CSV" ).mb_str() },
+    { wxCMD_LINE_PARAM, nullptr, nullptr, _( "board file" ).mb_str(),
+            wxCMD_LINE_VAL_STRING },
+    { wxCMD_LINE_PARAM, nullptr, nullptr, _( "router event log" ).mb_str(),
+            wxCMD_LINE_VAL_STRING },
+    { wxCMD_LINE_NONE }
+};
+
+
+enum ROUTER_REPLAY_RET_CODES
+{
+    LOAD_FAILED = KI_TEST::RET_CODES::TOOL_SPECIFIC,
+};
+
+
+int router_replay_main_func( int argc, char** argv )
+{
+    wxMessageOutput::Set( new wxMessageOutputStderr );
+    wxCmdLineParser cl_parser( argc, argv );
+    cl_parser.SetDesc( g_cmdLineDesc );
+    cl_parser.AddUsageText(
+            _( "This program replays an interactive router event log (as saved by the router's "
+               "debug logger) against the board it was recorded on, and reports the router's "
+               "latency per kind of interaction as percentiles, together with the mean number "
+               "of shove and walkaround iterations per event." ) );
+
+    int cmd_parsed_ok = cl_parser.Parse();
+
+    if( cmd_parsed_ok != 0 )
+    {
+        // Help and invalid input both stop here
+        return ( cmd_parsed_ok == -1 ) ? KI_TEST::RET_CODES::OK : KI_TEST::RET_CODES::BAD_CMDLINE;
+    }
+
+    long     reps = 1;
+    wxString modeName;
+    int      routingMode = -1;
+
+    cl_parser.Found( "reps", &reps );
+
+    if( cl_parser.Found( "mode", &modeName ) )
+    {
+        if( modeName == "shove" )
+            routingMode = PNS::RM_Shove;
+        else if( modeName == "walkaround" )
+            routingMode = PNS::RM_Walkaround;
+        else if( modeName == "mark" )
+            routingMode = PNS::RM_MarkObstacles;
+        else
+            return KI_TEST::RET_CODES::BAD_CMDLINE;
+    }
+
+    wxFileName boardFile( cl_parser.GetParam( 0 ) );
+    wxString   logFile = cl_parser.GetParam( 1 );
+
+    boardFile.MakeAbsolute();
+
+    PNS::LOGGER log;
+
+    if( !log.Load( std::string( logFile.ToUTF8() ) ) )
+    {
+        std::cerr << "Error reading " << logFile << std::endl;
+        return ROUTER_REPLAY_RET_CODES::LOAD_FAILED;
+    }
+
+    // The net classes and custom rules of the board live in its project
+    SETTINGS_MANAGER       manager( true );
+    std::unique_ptr<BOARD> board;
+    wxFileName             projectFile( boardFile );
+
+    projectFile.SetExt( ProjectFileExtension );
+    manager.LoadProject( projectFile.GetFullPath() );
+
+    try
+    {
+        PCB_IO io;
+
+        board.reset( io.Load( boardFile.GetFullPath(), nullptr ) );
+    }
+    catch( const IO_ERROR& ioe )
+    {
+        std::cerr << "Error loading " << boardFile.GetFullPath() << ": " << ioe.What()
+                  << std::endl;
+        return ROUTER_REPLAY_RET_CODES::LOAD_FAILED;
+    }
+
+    board->SetProject( &manager.Prj() );
+
+    BOARD_DESIGN_SETTINGS& bds = board->GetDesignSettings();
+    bds.m_DRCEngine = std::make_shared<DRC_ENGINE>( board.get(), &bds );
+
+    try
+    {
+        wxFileName rules( boardFile );
+        rules.SetExt( DesignRulesFileExtension );
+        bds.m_DRCEngine->InitEngine( rules );
+    }
+    catch( const PARSE_ERROR& pe )
+    {
+        std::cerr << "Error in the design rules: " << pe.What() << std::endl;
+    }
+
+    board->BuildConnectivity();
+
+    ROUTER_REPLAY replay( board.get(), routingMode );
+
+    for( long ii = 0; ii < std::max( reps, 1L ); ++ii )
+        replay.Replay( log.GetEvents() );
+
+    if( replay.GetUnresolvedItems() )
+    {
+        std::cerr << replay.GetUnresolvedItems()
+                  << " logged items were not found on the board and were replayed as empty space"
+                  << std::endl;
+    }
+
+    printResults( logFile, replay.GetSamples(), cl_parser.Found( "csv" ) );
+
+    return KI_TEST::RET_CODES::OK;
+}
+
+
+static bool registered = UTILITY_REGISTRY::Register( {
+        "router_replay",
+        "Replay a router event log against its board and report the router's latency",
+        router_replay_main_func,
+} );